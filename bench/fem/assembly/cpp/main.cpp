@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2008-07-22
-// Last changed: 2011-09-21
+// Last changed: 2013-11-06
 
 #include <string>
 #include <vector>
@@ -26,6 +26,9 @@
 
 using namespace dolfin;
 
+// Number of cells per batch for batched reassembly
+std::size_t tensor_batch_size = 1;
+
 double assemble_form(Form& form)
 {
   // Assemble once
@@ -50,6 +53,21 @@ double reassemble_form(Form& form)
   return time() - t0;
 }
 
+double reassemble_form_batched(Form& form)
+{
+  // Assemble once
+  Matrix A;
+  Assembler assembler;
+  assembler.assemble(A, form);
+
+  // Reassemble with batched cell tensor evaluation
+  const double t0 = time();
+  assembler.reset_sparsity = false;
+  assembler.tensor_batch_size = tensor_batch_size;
+  assembler.assemble(A, form);
+  return time() - t0;
+}
+
 int main(int argc, char* argv[])
 {
   info("Assembly for various forms and backends");
@@ -97,6 +115,7 @@ int main(int argc, char* argv[])
   Table t5("Assemble cells");
   Table t6("Overhead");
   Table t7("Reassemble total");
+  Table t8("Reassemble speedup with batched cell tensors");
 
   // Benchmark assembly
   for (unsigned int i = 0; i < forms.size(); i++)
@@ -138,6 +157,29 @@ int main(int argc, char* argv[])
         t7(forms[i], backends[j]) = bench_form(forms[i], reassemble_form);
       }
     }
+
+    // Benchmark batched reassembly for various batch sizes
+    std::vector<std::size_t> batch_sizes;
+    batch_sizes.push_back(8);
+    batch_sizes.push_back(32);
+    batch_sizes.push_back(128);
+    for (unsigned int i = 0; i < forms.size(); i++)
+    {
+      for (unsigned int j = 0; j < backends.size(); j++)
+      {
+        parameters["linear_algebra_backend"] = backends[j];
+        parameters["timer_prefix"] = backends[j];
+        for (unsigned int k = 0; k < batch_sizes.size(); k++)
+        {
+          tensor_batch_size = batch_sizes[k];
+          std::stringstream column;
+          column << backends[j] << " (" << batch_sizes[k] << ")";
+          t8(forms[i], column.str())
+            = t7.get_value(forms[i], backends[j])
+            / bench_form(forms[i], reassemble_form_batched);
+        }
+      }
+    }
   }
 
   // Display results
@@ -150,7 +192,10 @@ int main(int argc, char* argv[])
   std::cout << std::endl; info(t5, true);
   std::cout << std::endl; info(t6, true);
   if (argc == 1)
+  {
     std::cout << std::endl; info(t7, true);
+    std::cout << std::endl; info(t8, true);
+  }
 
   /*
   // Display LaTeX tables
@@ -0,0 +1,143 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark compares dof ordering strategies for a vector-valued
+// (elasticity) problem on a unit cube mesh whose cells have been
+// randomly shuffled. Reported are the time to build the dof map, the
+// time to assemble a matrix and a vector, and the time per
+// matrix-vector product, for UFC ordering (no re-ordering) and each
+// strategy of the parameter "dof_ordering_library".
+
+#include <cstdlib>
+#include <dolfin.h>
+#include "Elasticity.h"
+
+using namespace dolfin;
+
+#define SIZE 24
+#define NUM_REPS 10
+
+// Create copy of mesh with randomly shuffled cells
+Mesh shuffle(const Mesh& mesh)
+{
+  const std::size_t num_cells = mesh.num_cells();
+
+  std::srand(1);
+  std::vector<std::size_t> cell_order(num_cells);
+  for (std::size_t i = 0; i < num_cells; ++i)
+    cell_order[i] = i;
+  std::random_shuffle(cell_order.begin(), cell_order.end());
+
+  Mesh shuffled_mesh;
+  MeshEditor editor;
+  editor.open(shuffled_mesh, mesh.type().cell_type(), mesh.topology().dim(),
+              mesh.geometry().dim());
+  editor.init_vertices(mesh.num_vertices());
+  editor.init_cells(num_cells);
+  for (VertexIterator v(mesh); !v.end(); ++v)
+    editor.add_vertex(v->index(), v->point());
+  std::vector<std::size_t> vertices(mesh.type().num_entities(0));
+  for (std::size_t i = 0; i < num_cells; ++i)
+  {
+    const Cell cell(mesh, cell_order[i]);
+    for (std::size_t j = 0; j < vertices.size(); ++j)
+      vertices[j] = cell.entities(0)[j];
+    editor.add_cell(i, vertices);
+  }
+  editor.close();
+
+  return shuffled_mesh;
+}
+
+// Build dof map, assemble and multiply, and add timings to table
+void bench_ordering(const Mesh& mesh, std::string name, Table& table)
+{
+  // Build function space (dof map)
+  Timer t0("Build dof map");
+  Elasticity::FunctionSpace V(mesh);
+  const double t_dofmap = t0.stop();
+
+  // Assemble
+  Elasticity::BilinearForm a(V, V);
+  Elasticity::LinearForm L(V);
+  Function f(V);
+  *f.vector() = 1.0;
+  L.f = f;
+  Matrix A;
+  Vector b;
+  Assembler assembler;
+  assembler.assemble(A, a);
+  assembler.assemble(b, L);
+  assembler.reset_sparsity = false;
+  Timer t1("Assemble");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+  {
+    assembler.assemble(A, a);
+    assembler.assemble(b, L);
+  }
+  const double t_assemble = t1.stop()/NUM_REPS;
+
+  // Matrix-vector product
+  Vector y;
+  Timer t2("Matrix-vector product");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+    A.mult(b, y);
+  const double t_mult = t2.stop()/NUM_REPS;
+
+  table(name, "dof map") = t_dofmap;
+  table(name, "assemble") = t_assemble;
+  table(name, "product") = t_mult;
+
+  info("BENCH %s %g", name.c_str(), t_assemble + t_mult);
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  const Mesh mesh = shuffle(UnitCubeMesh(SIZE, SIZE, SIZE));
+  Table table("Dof ordering");
+
+  // UFC ordering
+  parameters["reorder_dofs_serial"] = false;
+  bench_ordering(mesh, "ufc", table);
+  parameters["reorder_dofs_serial"] = true;
+
+  // Re-ordering strategies
+  std::vector<std::string> strategies;
+  strategies.push_back("first_touch");
+  strategies.push_back("Boost");
+  #ifdef HAS_SCOTCH
+  strategies.push_back("SCOTCH");
+  strategies.push_back("nested_dissection");
+  #endif
+  for (std::size_t i = 0; i < strategies.size(); ++i)
+  {
+    parameters["dof_ordering_library"] = strategies[i];
+    bench_ordering(mesh, strategies[i], table);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+//
+// First added:  2013-11-11
+// Last changed: 2013-11-11
+//
+// This benchmark compares the matrix-free operator action of a
+// bilinear form (MatrixFreeOperator) with an assembled matrix, for
+// Poisson forms of increasing polynomial degree and roughly the same
+// number of dofs. Reported are the memory of the assembled matrix,
+// the time to assemble it, the time per matrix-vector product for
+// both approaches, and the number of products after which the
+// assembled matrix pays off. Run with --num_threads n to use a
+// multithreaded cell loop.
+
+#include <dolfin.h>
+#include "PoissonP1.h"
+#include "PoissonP2.h"
+#include "PoissonP3.h"
+#include "PoissonP4.h"
+
+#define NUM_REPS 10
+
+using namespace dolfin;
+
+boost::shared_ptr<Form> create_form(std::size_t degree, const Mesh& mesh)
+{
+  boost::shared_ptr<FunctionSpace> V;
+  switch (degree)
+  {
+  case 1:
+    V.reset(new PoissonP1::FunctionSpace(mesh));
+    return boost::shared_ptr<Form>(new PoissonP1::BilinearForm(V, V));
+  case 2:
+    V.reset(new PoissonP2::FunctionSpace(mesh));
+    return boost::shared_ptr<Form>(new PoissonP2::BilinearForm(V, V));
+  case 3:
+    V.reset(new PoissonP3::FunctionSpace(mesh));
+    return boost::shared_ptr<Form>(new PoissonP3::BilinearForm(V, V));
+  default:
+    V.reset(new PoissonP4::FunctionSpace(mesh));
+    return boost::shared_ptr<Form>(new PoissonP4::BilinearForm(V, V));
+  }
+}
+
+// Count nonzeros of matrix on local process
+std::size_t num_nonzeros(const GenericMatrix& A)
+{
+  std::size_t nnz = 0;
+  std::vector<std::size_t> columns;
+  std::vector<double> values;
+  const std::pair<std::size_t, std::size_t> range = A.local_range(0);
+  for (std::size_t i = range.first; i < range.second; ++i)
+  {
+    A.getrow(i, columns, values);
+    nnz += columns.size();
+  }
+  return nnz;
+}
+
+int main(int argc, char* argv[])
+{
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
+
+  // Mesh sizes giving roughly the same number of dofs for each degree
+  const std::size_t sizes[] = {48, 24, 16, 12};
+
+  Table table("Matrix-free operator vs assembled matrix");
+  for (std::size_t degree = 1; degree <= 4; ++degree)
+  {
+    const std::size_t n = sizes[degree - 1];
+    UnitCubeMesh mesh(n, n, n);
+    boost::shared_ptr<Form> a = create_form(degree, mesh);
+    std::stringstream s;
+    s << "P" << degree;
+
+    // Vectors for products
+    Function u(a->function_space(1));
+    Vector y;
+    u.vector()->zero();
+    *u.vector() += 1.0;
+    const GenericVector& x = *u.vector();
+
+    // Assembled matrix
+    Matrix A;
+    Timer t0("Assemble matrix");
+    assemble(A, *a);
+    const double t_assemble = t0.stop();
+    Timer t1("Matrix-vector product (assembled)");
+    for (std::size_t i = 0; i < NUM_REPS; ++i)
+      A.mult(x, y);
+    const double t_mult = t1.stop()/NUM_REPS;
+
+    // Matrix-free operator
+    Timer t2("Create matrix-free operator");
+    MatrixFreeOperator O(a);
+    const double t_setup = t2.stop();
+    Timer t3("Matrix-vector product (matrix-free)");
+    for (std::size_t i = 0; i < NUM_REPS; ++i)
+      O.mult(x, y);
+    const double t_mult_free = t3.stop()/NUM_REPS;
+
+    // Memory of matrix in compressed row storage (values and column
+    // indices)
+    const std::size_t nnz = num_nonzeros(A);
+    const double memory = nnz*(sizeof(double) + sizeof(dolfin::la_index))
+                          /(1024.0*1024.0);
+
+    table(s.str(), "dofs") = (int) a->function_space(0)->dim();
+    table(s.str(), "matrix memory (MB)") = memory;
+    table(s.str(), "assemble") = t_assemble;
+    table(s.str(), "product (assembled)") = t_mult;
+    table(s.str(), "setup (matrix-free)") = t_setup;
+    table(s.str(), "product (matrix-free)") = t_mult_free;
+    if (t_mult_free > t_mult)
+    {
+      table(s.str(), "break-even products")
+        = (t_assemble - t_setup)/(t_mult_free - t_mult);
+    }
+    else
+      table(s.str(), "break-even products") = 0.0;
+
+    info("BENCH P%d %g", (int) degree, t_mult_free);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+//
+// First added:  2013-11-04
+// Last changed: 2013-11-04
+//
+// This benchmark compares strong scaling of the color-by-color
+// OpenMpAssembler with the WorkStealingAssembler. If run without
+// command-line arguments, it iterates from one to MAX_NUM_THREADS
+// threads. If a command-line argument --num_threads n is given, the
+// benchmark is run with the specified number of threads only.
+
+#include <dolfin.h>
+#include "Poisson.h"
+#include "NavierStokes.h"
+
+#define MAX_NUM_THREADS 32
+#define SIZE 32
+#define NUM_REPS 10
+
+using namespace dolfin;
+
+boost::shared_ptr<Form> poisson(const Mesh& mesh)
+{
+  boost::shared_ptr<FunctionSpace> V(new Poisson::FunctionSpace(mesh));
+  return boost::shared_ptr<Form>(new Poisson::BilinearForm(V, V));
+}
+
+boost::shared_ptr<Form> navier_stokes(const Mesh& mesh)
+{
+  boost::shared_ptr<FunctionSpace> V(new NavierStokes::FunctionSpace(mesh));
+  boost::shared_ptr<Form> a(new NavierStokes::BilinearForm(V, V));
+
+  boost::shared_ptr<FunctionSpace>
+    W0(new NavierStokes::Form_a_FunctionSpace_2(mesh));
+  boost::shared_ptr<FunctionSpace>
+    W1(new NavierStokes::Form_a_FunctionSpace_3(mesh));
+  a->set_coefficient(0, boost::shared_ptr<Function>(new Function(W0)));
+  a->set_coefficient(1, boost::shared_ptr<Function>(new Function(W1)));
+  a->set_coefficient(2, boost::shared_ptr<Function>(new Function(W1)));
+  a->set_coefficient(3, boost::shared_ptr<Function>(new Function(W1)));
+  a->set_coefficient(4, boost::shared_ptr<Function>(new Function(W1)));
+
+  return a;
+}
+
+double bench(const Form& a, std::string assembler)
+{
+  parameters["threaded_assembler"] = assembler;
+
+  // Assemble once to initialize matrix and coloring
+  Matrix A;
+  assemble(A, a);
+
+  // Run timing
+  Assembler _assembler;
+  _assembler.reset_sparsity = false;
+  Timer timer("Assembly (" + assembler + ")");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+    _assembler.assemble(A, a);
+  return timer.stop()/NUM_REPS;
+}
+
+int main(int argc, char* argv[])
+{
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
+
+  // Create mesh. Note that the mesh is not renumbered by color, since
+  // the work stealing assembler relies on cell locality.
+  UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+
+  // Test cases
+  std::vector<std::pair<std::string, boost::shared_ptr<const Form> > > forms;
+  forms.push_back(std::make_pair("Poisson", poisson(mesh)));
+  forms.push_back(std::make_pair("NavierStokes", navier_stokes(mesh)));
+
+  // Numbers of threads to run
+  std::vector<std::size_t> threads;
+  if (parameters["num_threads"].change_count() > 0)
+  {
+    const std::size_t num_threads = parameters["num_threads"];
+    threads.push_back(num_threads);
+  }
+  else
+  {
+    for (std::size_t n = 1; n <= MAX_NUM_THREADS; n *= 2)
+      threads.push_back(n);
+  }
+
+  // Serial reference timings
+  parameters["num_threads"] = 0;
+  std::vector<double> t_serial;
+  for (std::size_t i = 0; i < forms.size(); ++i)
+    t_serial.push_back(bench(*forms[i].second, "coloring"));
+
+  Table timings("Assembly time");
+  Table speedups("Speedup relative to serial assembly");
+  for (std::size_t j = 0; j < threads.size(); ++j)
+  {
+    parameters["num_threads"] = (int) threads[j];
+    std::stringstream s;
+    s << threads[j] << " threads";
+
+    for (std::size_t i = 0; i < forms.size(); ++i)
+    {
+      const double t_coloring = bench(*forms[i].second, "coloring");
+      const double t_stealing = bench(*forms[i].second, "work_stealing");
+      timings(s.str(), forms[i].first + " (coloring)") = t_coloring;
+      timings(s.str(), forms[i].first + " (work stealing)") = t_stealing;
+      speedups(s.str(), forms[i].first + " (coloring)")
+        = t_serial[i]/t_coloring;
+      speedups(s.str(), forms[i].first + " (work stealing)")
+        = t_serial[i]/t_stealing;
+      info("BENCH %s_%d %g", forms[i].first.c_str(), (int) threads[j],
+           t_stealing);
+    }
+  }
+
+  // Display results
+  info("");
+  info(timings, true);
+  info("");
+  info(speedups, true);
+
+  return 0;
+}
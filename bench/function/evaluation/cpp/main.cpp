@@ -16,9 +16,12 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2010-06-10
-// Last changed: 2012-12-12
+// Last changed: 2013-12-11
 //
-// Description: Benchmark for the evaluations of functions at arbitrary points.
+// Description: Benchmark for the evaluations of functions at arbitrary
+// points, one point per call (eval) and for many points at a time
+// (eval_many). Points are taken at random and along a probe line. Run
+// with --num_threads n to evaluate using n threads.
 
 #include <dolfin.h>
 #include "P1.h"
@@ -36,57 +39,76 @@ public:
 
 };
 
-#ifdef HAS_CGAL
-
 int main(int argc, char* argv[])
 {
   not_working_in_parallel("Function evalutation benchmark");
 
-  info("Evaluations of functions at arbitrary points.");
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
 
-  const std::size_t mesh_max_size = 32;
-  const std::size_t num_points  = 10000000;
+  info("Evaluations of functions at arbitrary points.");
 
-  // Start timing
-  tic();
-  for (std::size_t N = 10; N < mesh_max_size; N += 2)
+  const std::size_t N = 32;
+  const std::size_t num_points = 1000000;
+
+  UnitCubeMesh mesh(N, N, N);
+  P1::FunctionSpace V(mesh);
+  Function f(V);
+  F g;
+  f.interpolate(g);
+
+  // Random points (produces same sequence each test) and points along
+  // a line through the domain
+  std::vector<double> random_points(3*num_points);
+  std::vector<double> line_points(3*num_points);
+  srand(1);
+  for (std::size_t i = 0; i < num_points; ++i)
   {
-    UnitCubeMesh mesh(N, N, N);
+    for (std::size_t j = 0; j < 3; ++j)
+      random_points[3*i + j] = std::rand()/static_cast<double>(RAND_MAX);
+    const double t = i/static_cast<double>(num_points);
+    line_points[3*i] = t;
+    line_points[3*i + 1] = 0.5*t;
+    line_points[3*i + 2] = 1.0 - t;
+  }
 
-    P1::FunctionSpace V0(mesh);
-    Function f0(V0);
-    F f;
-    f0.interpolate(f);
+  // Build bounding box tree
+  mesh.bounding_box_tree();
 
-    Array<double> X(3);
+  const std::size_t num_sets = 2;
+  const std::string names[num_sets] = {"random", "line"};
+  std::vector<double>* points[num_sets] = {&random_points, &line_points};
+  Table table("Function evaluation (points per second)");
+  double t_total = 0.0;
+  for (std::size_t k = 0; k < num_sets; ++k)
+  {
+    // One point per call
     Array<double> value(1);
-
-    // Initialize random generator generator (produces same sequence each test).
-    srand(1);
-
-    for (std::size_t i = 1; i <= num_points; ++i)
+    tic();
+    for (std::size_t i = 0; i < num_points; ++i)
     {
-      X[0] = std::rand()/static_cast<double>(RAND_MAX);
-      X[1] = std::rand()/static_cast<double>(RAND_MAX);
-      X[2] = std::rand()/static_cast<double>(RAND_MAX);
-
-      f.eval(value, X);
+      const Array<double> x(3, points[k]->data() + 3*i);
+      f.eval(value, x);
     }
-
-    // Use X variable.
-    info("x = %.12e\ty = %.12e\tz = %.12e\tf(x) = %.12e", X[0], X[1], X[2], value[0]);
+    const double t = toc();
+
+    // All points at once
+    Array<double> values(num_points);
+    Array<double> X(3*num_points, points[k]->data());
+    tic();
+    f.eval_many(values, X);
+    const double t_many = toc();
+
+    table(names[k], "eval") = num_points/t;
+    table(names[k], "eval_many") = num_points/t_many;
+    info("BENCH %s %g", names[k].c_str(), t_many);
+    t_total += t_many;
   }
-  info("BENCH  %g",toc());
 
-  return 0;
-}
+  // Display results
+  info("");
+  info(table, true);
+  info("BENCH %g", t_total);
 
-#else
-
-int main()
-{
-  info("DOLFIN must be compiled with CGAL to run function eval benchmark.");
   return 0;
 }
-
-#endif
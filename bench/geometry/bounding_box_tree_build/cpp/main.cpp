@@ -16,10 +16,12 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // This benchmark measures the performance of building a BoundingBoxTree (and
-// one call to compute_entities, which is dominated by building).
+// one call to compute_entities, which is dominated by building), and of
+// refitting the tree after the mesh has been moved. Run with --num_threads n
+// to build and refit the tree using n threads.
 //
 // First added:  2013-04-18
-// Last changed: 2013-06-25
+// Last changed: 2013-12-10
 
 #include <vector>
 #include <dolfin.h>
@@ -30,6 +32,9 @@ using namespace dolfin;
 
 int main(int argc, char* argv[])
 {
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
+
   // Create mesh
   UnitCubeMesh mesh(SIZE, SIZE, SIZE);
 
@@ -39,5 +44,13 @@ int main(int argc, char* argv[])
   tree.build(mesh);
   info("BENCH %g", toc());
 
+  // Move mesh and refit tree
+  std::vector<double>& x = mesh.coordinates();
+  for (std::size_t i = 0; i < x.size(); i++)
+    x[i] += 0.01*x[i]*x[i];
+  tic();
+  tree.refit();
+  info("BENCH refit %g", toc());
+
   return 0;
 }
@@ -15,10 +15,11 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
-// This benchmark measures the performance of compute_entity_collisions.
+// This benchmark measures the performance of compute_closest_entity,
+// for one point per call and for a list of points (batched).
 //
 // First added:  2013-05-23
-// Last changed: 2013-09-04
+// Last changed: 2013-12-10
 
 #include <vector>
 #include <dolfin.h>
@@ -49,8 +50,21 @@ int main(int argc, char* argv[])
   }
   const double t = toc();
 
+  // Call once for all points
+  std::vector<Point> points(NUM_REPS);
+  point = Point(-1.0, -1.0, 0.0);
+  for (int i = 0; i < NUM_REPS; i++)
+  {
+    points[i] = point;
+    point.coordinates()[1] += 2.0 / static_cast<double>(NUM_REPS);
+  }
+  tic();
+  tree.compute_closest_entity(points);
+  const double t_batched = toc();
+
   // Report result
   info("BENCH %g", t);
+  info("BENCH batched %g", t_batched);
 
   return 0;
 }
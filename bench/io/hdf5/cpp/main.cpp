@@ -0,0 +1,153 @@
+// Copyright (C) 2013 Chris N. Richardson
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark writes a checkpoint (mesh, mesh function and a
+// number of Function snapshots) to HDF5 files with contiguous,
+// chunked and compressed datasets, and reads it back. Reported are
+// the file size and the write and read throughput (uncompressed MB/s)
+// for each mode.
+
+#include <boost/filesystem.hpp>
+#include <dolfin.h>
+#include "P1.h"
+
+using namespace dolfin;
+
+#define SIZE 32
+#define NUM_SNAPSHOTS 10
+
+#ifdef HAS_HDF5
+
+class Source : public Expression
+{
+public:
+
+  Source() : t(0.0) {}
+
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    values[0] = sin(5.0*x[0] + t)*cos(3.0*x[1])*exp(-x[2]);
+  }
+
+  double t;
+
+};
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+  const std::size_t D = mesh.topology().dim();
+  MeshFunction<std::size_t> cell_markers(mesh, D);
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+    cell_markers[*cell] = cell->midpoint().x() < 0.5 ? 1 : 2;
+  boost::shared_ptr<FunctionSpace> V(new P1::FunctionSpace(mesh));
+  Function u(V);
+
+  // Snapshots
+  Source f;
+  std::vector<boost::shared_ptr<Function> > snapshots;
+  for (std::size_t j = 0; j < NUM_SNAPSHOTS; ++j)
+  {
+    f.t = 0.1*j;
+    snapshots.push_back(boost::shared_ptr<Function>(new Function(V)));
+    snapshots.back()->interpolate(f);
+  }
+
+  // Uncompressed size of checkpoint
+  const double size
+    = (mesh.num_vertices()*D*sizeof(double)
+       + mesh.num_cells()*(D + 1)*sizeof(std::size_t)
+       + mesh.num_cells()*sizeof(std::size_t)
+       + NUM_SNAPSHOTS*V->dim()*sizeof(double))/(1024.0*1024.0);
+
+  // Modes: (chunking, compression level)
+  const std::size_t num_modes = 5;
+  const char* names[] = {"contiguous", "chunked", "deflate1",
+                         "deflate4", "deflate9"};
+  const bool chunking[] = {false, true, true, true, true};
+  const int compression[] = {0, 0, 1, 4, 9};
+
+  Table table("HDF5 checkpoint");
+  for (std::size_t i = 0; i < num_modes; ++i)
+  {
+    const std::string filename = "checkpoint.h5";
+
+    // Write checkpoint
+    Timer t0("Write checkpoint");
+    {
+      HDF5File file(filename, "w");
+      file.parameters["chunking"] = chunking[i];
+      file.parameters["compression"] = compression[i];
+      file.write(mesh, "mesh");
+      file.write(cell_markers, "cell_markers");
+      for (std::size_t j = 0; j < NUM_SNAPSHOTS; ++j)
+      {
+        std::stringstream name;
+        name << "u_" << j;
+        file.write(*snapshots[j], name.str());
+      }
+    }
+    const double t_write = t0.stop();
+    const double file_size
+      = boost::filesystem::file_size(filename)/(1024.0*1024.0);
+
+    // Read checkpoint
+    Timer t1("Read checkpoint");
+    {
+      HDF5File file(filename, "r");
+      Mesh mesh_in;
+      file.read(mesh_in, "mesh");
+      MeshFunction<std::size_t> cell_markers_in(mesh_in, D);
+      file.read(cell_markers_in, "cell_markers");
+      for (std::size_t j = 0; j < NUM_SNAPSHOTS; ++j)
+      {
+        std::stringstream name;
+        name << "u_" << j;
+        file.read(u, name.str());
+      }
+    }
+    const double t_read = t1.stop();
+
+    table(names[i], "file size (MB)") = file_size;
+    table(names[i], "ratio") = size/file_size;
+    table(names[i], "write (MB/s)") = size/t_write;
+    table(names[i], "read (MB/s)") = size/t_read;
+
+    info("BENCH %s %g", names[i], t_write + t_read);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
+
+#else
+
+int main()
+{
+  info("DOLFIN must be compiled with HDF5 to run this benchmark.");
+  return 0;
+}
+
+#endif
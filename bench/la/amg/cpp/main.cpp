@@ -0,0 +1,152 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark compares the ILU and the smoothed aggregation AMG
+// preconditioners of the uBLAS Krylov solver for the Poisson problem
+// of the Poisson demo, in 2D and 3D, with the uBLAS and the CSR
+// backends. Reported are the number of iterations and the time to
+// solution (including the setup of the preconditioner).
+
+#include <dolfin.h>
+#include "Poisson2D.h"
+#include "Poisson3D.h"
+
+using namespace dolfin;
+
+#define SIZE_2D 256
+#define SIZE_3D 32
+
+// Source term (right-hand side)
+class Source : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    const double dx = x[0] - 0.5;
+    const double dy = x[1] - 0.5;
+    values[0] = 10*exp(-(dx*dx + dy*dy) / 0.02);
+  }
+};
+
+// Normal derivative (Neumann boundary condition)
+class dUdN : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    values[0] = sin(5*x[0]);
+  }
+};
+
+// Sub domain for Dirichlet boundary condition
+class DirichletBoundary : public SubDomain
+{
+  bool inside(const Array<double>& x, bool on_boundary) const
+  {
+    return x[0] < DOLFIN_EPS or x[0] > 1.0 - DOLFIN_EPS;
+  }
+};
+
+// Assemble and solve with given backend and preconditioner, and add
+// results to table
+void bench_solver(const Form& a, const Form& L, const DirichletBC& bc,
+                  GenericMatrix& A, GenericVector& b, GenericVector& x,
+                  std::string problem, std::string backend,
+                  std::string preconditioner, Table& table)
+{
+  assemble_system(A, b, a, L, bc);
+
+  uBLASKrylovSolver solver("bicgstab", preconditioner);
+  solver.parameters["report"] = false;
+  solver.parameters["error_on_nonconvergence"] = false;
+  Timer timer("Solve");
+  const std::size_t num_iterations = solver.solve(A, x, b);
+  const double t_solve = timer.stop();
+
+  const std::string name = problem + " " + backend + " " + preconditioner;
+  table(name, "size") = A.size(0);
+  table(name, "iterations") = num_iterations;
+  table(name, "time") = t_solve;
+
+  info("BENCH %s %g", name.c_str(), t_solve);
+}
+
+// Run all backends and preconditioners for given forms
+void bench_problem(const Form& a, const Form& L, const DirichletBC& bc,
+                   std::string problem, Table& table)
+{
+  std::vector<std::string> preconditioners;
+  preconditioners.push_back("ilu");
+  preconditioners.push_back("amg");
+  for (std::size_t i = 0; i < preconditioners.size(); ++i)
+  {
+    {
+      uBLASSparseMatrix A;
+      uBLASVector b, x;
+      bench_solver(a, L, bc, A, b, x, problem, "uBLAS", preconditioners[i],
+                   table);
+    }
+    {
+      CSRMatrix A;
+      CSRVector b, x;
+      bench_solver(a, L, bc, A, b, x, problem, "CSR", preconditioners[i],
+                   table);
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  Source f;
+  dUdN g;
+  Constant u0(0.0);
+  DirichletBoundary boundary;
+  Table table("ILU and AMG preconditioners");
+
+  // 2D
+  {
+    UnitSquareMesh mesh(SIZE_2D, SIZE_2D);
+    Poisson2D::FunctionSpace V(mesh);
+    DirichletBC bc(V, u0, boundary);
+    Poisson2D::BilinearForm a(V, V);
+    Poisson2D::LinearForm L(V);
+    L.f = f;
+    L.g = g;
+    bench_problem(a, L, bc, "2D", table);
+  }
+
+  // 3D
+  {
+    UnitCubeMesh mesh(SIZE_3D, SIZE_3D, SIZE_3D);
+    Poisson3D::FunctionSpace V(mesh);
+    DirichletBC bc(V, u0, boundary);
+    Poisson3D::BilinearForm a(V, V);
+    Poisson3D::LinearForm L(V);
+    L.f = f;
+    L.g = g;
+    bench_problem(a, L, bc, "3D", table);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
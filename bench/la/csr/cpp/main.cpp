@@ -0,0 +1,122 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark compares the multithreaded CSR backend with the
+// uBLAS backend for a Poisson problem on a unit cube mesh. Reported
+// are the time to assemble the matrix, the time per matrix-vector
+// product, the time per vector operation (inner product and axpy)
+// and the time to solve with GMRES and ILU. Run with
+// --num_threads <n> to set the number of threads of the CSR backend.
+
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 48
+#define NUM_REPS 20
+
+// Assemble, multiply and solve with given backend, and add timings
+// to table
+void bench_backend(const FunctionSpace& V, std::string name,
+                   GenericMatrix& A, GenericVector& b, GenericVector& x,
+                   Table& table)
+{
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Constant f(1.0);
+  L.f = f;
+
+  // Assemble
+  Assembler assembler;
+  assembler.assemble(A, a);
+  assembler.assemble(b, L);
+  assembler.reset_sparsity = false;
+  Timer t0("Assemble");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+    assembler.assemble(A, a);
+  const double t_assemble = t0.stop()/NUM_REPS;
+
+  // Matrix-vector product
+  A.resize(x, 1);
+  Timer t1("Matrix-vector product");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+    A.mult(b, x);
+  const double t_mult = t1.stop()/NUM_REPS;
+
+  // Vector operations
+  double value = 0.0;
+  Timer t2("Vector operations");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+  {
+    value += x.inner(b);
+    x.axpy(1.0e-3, b);
+  }
+  const double t_vector = t2.stop()/NUM_REPS;
+
+  // Solve (fix boundary dofs to make the system non-singular)
+  Constant zero(0.0);
+  DomainBoundary boundary;
+  DirichletBC bc(V, zero, boundary);
+  bc.apply(A, b);
+  x.zero();
+  uBLASKrylovSolver solver("gmres", "ilu");
+  Timer t3("Solve");
+  const std::size_t num_iterations = solver.solve(A, x, b);
+  const double t_solve = t3.stop();
+
+  table(name, "assemble") = t_assemble;
+  table(name, "product") = t_mult;
+  table(name, "vector ops") = t_vector;
+  table(name, "solve") = t_solve;
+  table(name, "iterations") = num_iterations;
+  table(name, "|x|") = x.norm("l2");
+
+  info("BENCH %s %g", name.c_str(), t_mult + t_vector);
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+  Poisson::FunctionSpace V(mesh);
+  Table table("CSR backend");
+
+  // uBLAS
+  {
+    uBLASSparseMatrix A;
+    uBLASVector b, x;
+    bench_backend(V, "uBLAS", A, b, x, table);
+  }
+
+  // CSR
+  {
+    CSRMatrix A;
+    CSRVector b, x;
+    bench_backend(V, "CSR", A, b, x, table);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
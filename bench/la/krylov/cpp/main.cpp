@@ -0,0 +1,132 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark compares the pipelined Krylov methods ("pipecg",
+// "pgmres") with the standard methods for a Poisson problem on a unit
+// cube mesh. The uBLAS Krylov solver is run with the CSR backend for
+// 1, 2, 4, ... threads up to --num_threads <n> (strong scaling in
+// threads). If PETSc is available, the PETSc Krylov solver is run as
+// well; run with mpirun -n <p> for strong scaling in processes.
+// Reported are the number of iterations and the time to solution.
+
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 48
+
+// Solve with given solver and add results to table
+void bench_solver(GenericLinearSolver& solver, const GenericMatrix& A,
+                  GenericVector& x, const GenericVector& b, std::string name,
+                  Table& table)
+{
+  solver.parameters["relative_tolerance"] = 1.0e-8;
+  solver.parameters["report"] = false;
+  solver.parameters["error_on_nonconvergence"] = false;
+  x.zero();
+
+  Timer timer("Solve");
+  const std::size_t num_iterations = solver.solve(A, x, b);
+  const double t_solve = timer.stop();
+
+  table(name, "iterations") = num_iterations;
+  table(name, "time") = t_solve;
+  table(name, "|x|") = x.norm("l2");
+
+  info("BENCH %s %g", name.c_str(), t_solve);
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+  const int max_threads = std::max((int) parameters["num_threads"], 1);
+
+  UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+  Poisson::FunctionSpace V(mesh);
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Constant f(1.0);
+  L.f = f;
+  Constant zero(0.0);
+  DomainBoundary boundary;
+  DirichletBC bc(V, zero, boundary);
+  Table table("Pipelined Krylov methods");
+
+  std::vector<std::string> methods;
+  methods.push_back("cg");
+  methods.push_back("pipecg");
+  methods.push_back("gmres");
+  methods.push_back("pgmres");
+
+  // uBLAS Krylov solver with CSR backend
+  if (MPI::num_processes() == 1)
+  {
+    CSRMatrix A;
+    CSRVector b, x;
+    assemble_system(A, b, a, L, bc);
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+      parameters["num_threads"] = num_threads;
+      for (std::size_t i = 0; i < methods.size(); ++i)
+      {
+        // uBLAS "cg" falls back to GMRES, so compare with BiCGStab
+        const std::string method = methods[i] == "cg" ? "bicgstab" : methods[i];
+        uBLASKrylovSolver solver(method, "none");
+        std::stringstream name;
+        name << "uBLAS " << method << " " << num_threads;
+        bench_solver(solver, A, x, b, name.str(), table);
+      }
+    }
+    parameters["num_threads"] = max_threads;
+  }
+
+  // PETSc Krylov solver
+  #ifdef HAS_PETSC
+  {
+    PETScMatrix A;
+    PETScVector b, x;
+    assemble_system(A, b, a, L, bc);
+
+    const std::vector<std::pair<std::string, std::string> >
+      petsc_methods = PETScKrylovSolver::methods();
+    for (std::size_t i = 0; i < methods.size(); ++i)
+    {
+      // Skip methods not provided by the installed PETSc version
+      bool available = false;
+      for (std::size_t j = 0; j < petsc_methods.size(); ++j)
+        available = available || petsc_methods[j].first == methods[i];
+      if (!available)
+        continue;
+      PETScKrylovSolver solver(methods[i], "jacobi");
+      std::stringstream name;
+      name << "PETSc " << methods[i] << " " << MPI::num_processes();
+      bench_solver(solver, A, x, b, name.str(), table);
+    }
+  }
+  #endif
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark measures the throughput of solves with multiple
+// right-hand sides for a Poisson problem on a unit cube mesh. A loop
+// of single solves (reusing the factorization or preconditioner) is
+// compared with one solve for a MultiVector of right-hand sides, for
+// UMFPACK LU (threaded over right-hand sides, set --num_threads <n>),
+// PETSc LU (MatMatSolve) and uBLAS Krylov (block CG). Reported are
+// the time per right-hand side and the number of iterations.
+
+#include <cmath>
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 24
+#define NUM_RHS 32
+
+// Create right-hand sides from b by scaling entries
+void create_rhs(MultiVector& B, GenericVector& b)
+{
+  std::vector<double> values, values_j;
+  b.get_local(values);
+  B.init(b, NUM_RHS);
+  for (std::size_t j = 0; j < NUM_RHS; ++j)
+  {
+    values_j = values;
+    for (std::size_t i = 0; i < values.size(); ++i)
+      values_j[i] *= 1.0 + 0.5*std::sin((double) (i*(j + 1)));
+    b.set_local(values_j);
+    b.apply("insert");
+    B.set(b, j);
+  }
+  b.set_local(values);
+  b.apply("insert");
+}
+
+// Solve for one right-hand side at a time and for all at once and add
+// results to table
+void bench_solver(GenericLinearSolver& solver, const GenericMatrix& A,
+                  const MultiVector& B, GenericVector& x, GenericVector& b,
+                  std::string name, Table& table)
+{
+  // Factorize or set up preconditioner
+  B.get(b, 0);
+  solver.solve(A, x, b);
+
+  // Loop of single solves
+  Timer timer_single("Single solves");
+  std::size_t iterations_single = 0;
+  for (std::size_t j = 0; j < B.num_vectors(); ++j)
+  {
+    B.get(b, j);
+    x.zero();
+    iterations_single += solver.solve(x, b);
+  }
+  const double t_single = timer_single.stop();
+
+  // Solve for all right-hand sides
+  MultiVector X;
+  Timer timer_multi("Multiple right-hand sides");
+  const std::size_t iterations_multi = solver.solve(X, B);
+  const double t_multi = timer_multi.stop();
+
+  table(name, "time/rhs (single)") = t_single/B.num_vectors();
+  table(name, "time/rhs (multiple)") = t_multi/B.num_vectors();
+  table(name, "speedup") = t_single/t_multi;
+  table(name, "iterations (single)") = iterations_single;
+  table(name, "iterations (multiple)") = iterations_multi;
+
+  info("BENCH %s %g %g", name.c_str(), t_single, t_multi);
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+  Poisson::FunctionSpace V(mesh);
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Constant f(1.0);
+  L.f = f;
+  Constant zero(0.0);
+  DomainBoundary boundary;
+  DirichletBC bc(V, zero, boundary);
+  Table table("Multiple right-hand sides");
+
+  if (MPI::num_processes() == 1)
+  {
+    // UMFPACK LU solver
+    #ifdef HAS_UMFPACK
+    {
+      uBLASMatrix<ublas_sparse_matrix> A;
+      uBLASVector b, x;
+      assemble_system(A, b, a, L, bc);
+      MultiVector B;
+      create_rhs(B, b);
+
+      UmfpackLUSolver solver;
+      solver.parameters["reuse_factorization"] = true;
+      bench_solver(solver, A, B, x, b, "UMFPACK LU", table);
+    }
+    #endif
+
+    // uBLAS Krylov solver with CSR backend, single solves use CG
+    // (pipelined) and multiple right-hand sides use block CG
+    {
+      CSRMatrix A;
+      CSRVector b, x;
+      assemble_system(A, b, a, L, bc);
+      MultiVector B;
+      create_rhs(B, b);
+
+      uBLASKrylovSolver solver("pipecg", "amg");
+      solver.parameters["relative_tolerance"] = 1.0e-8;
+      solver.parameters("preconditioner")["structure"] = "same";
+      bench_solver(solver, A, B, x, b, "uBLAS block CG", table);
+    }
+  }
+
+  // PETSc LU solver
+  #ifdef HAS_PETSC
+  {
+    PETScMatrix A;
+    PETScVector b, x;
+    assemble_system(A, b, a, L, bc);
+    MultiVector B;
+    create_rhs(B, b);
+
+    PETScLUSolver solver;
+    solver.parameters["reuse_factorization"] = true;
+    bench_solver(solver, A, B, x, b, "PETSc LU", table);
+  }
+  #endif
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
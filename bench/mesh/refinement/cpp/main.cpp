@@ -1,4 +1,4 @@
-// Copyright (C) 2006-2010 Anders Logg
+// Copyright (C) 2006-2013 Anders Logg
 //
 // This file is part of DOLFIN.
 //
@@ -16,7 +16,11 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-11-01
-// Last changed: 2012-12-12
+// Last changed: 2013-12-11
+//
+// This benchmark refines a unit cube mesh uniformly a number of
+// times, using 1, 2 and 4 threads. Reported is the total time of the
+// refinements for each number of threads.
 
 #include <dolfin.h>
 
@@ -33,15 +37,36 @@ int main(int argc, char* argv[])
   parameters.parse(argc, argv);
 
   UnitCubeMesh unitcube_mesh(SIZE, SIZE, SIZE);
-  Mesh mesh(unitcube_mesh);
 
-  tic();
-  for (int i = 0; i < NUM_REPS; i++)
+  Table table("Uniform refinement");
+  double t_serial = 0.0;
+  for (std::size_t num_threads = 1; num_threads <= 4; num_threads *= 2)
   {
-    mesh = refine(mesh);
-    dolfin::cout << "Refined mesh: " << mesh << dolfin::endl;
+    parameters["num_threads"] = (int) num_threads;
+    Mesh mesh(unitcube_mesh);
+
+    tic();
+    for (int i = 0; i < NUM_REPS; i++)
+    {
+      mesh = refine(mesh);
+      dolfin::cout << "Refined mesh: " << mesh << dolfin::endl;
+    }
+    const double t = toc();
+    if (num_threads == 1)
+      t_serial = t;
+
+    std::stringstream s;
+    s << num_threads << " threads";
+    table(s.str(), "cells") = (int) mesh.num_cells();
+    table(s.str(), "time") = t;
+    table(s.str(), "speedup") = t_serial/t;
+
+    info("BENCH threads%d %g", (int) num_threads, t);
   }
-  info("BENCH %g", toc());
+
+  // Display results
+  info("");
+  info(table, true);
 
   return 0;
 }
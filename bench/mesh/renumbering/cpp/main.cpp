@@ -0,0 +1,137 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// This benchmark measures the effect of mesh renumbering on
+// assembly. The cells and vertices of a unit cube mesh are randomly
+// shuffled, and the mesh is then renumbered along Hilbert and Morton
+// curves and by reverse Cuthill-McKee. Reported are the time to
+// renumber the mesh and the time to assemble a matrix and a vector,
+// relative to the shuffled mesh.
+
+#include <cstdlib>
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 32
+#define NUM_REPS 5
+
+// Create copy of mesh with randomly shuffled cells and vertices
+Mesh shuffle(const Mesh& mesh)
+{
+  const std::size_t num_vertices = mesh.num_vertices();
+  const std::size_t num_cells = mesh.num_cells();
+
+  std::srand(1);
+  std::vector<std::size_t> new_vertex_indices(num_vertices);
+  std::vector<std::size_t> cell_order(num_cells);
+  for (std::size_t i = 0; i < num_vertices; ++i)
+    new_vertex_indices[i] = i;
+  for (std::size_t i = 0; i < num_cells; ++i)
+    cell_order[i] = i;
+  std::random_shuffle(new_vertex_indices.begin(), new_vertex_indices.end());
+  std::random_shuffle(cell_order.begin(), cell_order.end());
+
+  Mesh shuffled_mesh;
+  MeshEditor editor;
+  editor.open(shuffled_mesh, mesh.type().cell_type(), mesh.topology().dim(),
+              mesh.geometry().dim());
+  editor.init_vertices(num_vertices);
+  editor.init_cells(num_cells);
+  for (VertexIterator v(mesh); !v.end(); ++v)
+    editor.add_vertex(new_vertex_indices[v->index()], v->point());
+  std::vector<std::size_t> vertices(mesh.type().num_entities(0));
+  for (std::size_t i = 0; i < num_cells; ++i)
+  {
+    const Cell cell(mesh, cell_order[i]);
+    for (std::size_t j = 0; j < vertices.size(); ++j)
+      vertices[j] = new_vertex_indices[cell.entities(0)[j]];
+    editor.add_cell(i, vertices);
+  }
+  editor.close();
+
+  return shuffled_mesh;
+}
+
+// Assemble matrix and vector repeatedly and return time per assembly
+double assemble_forms(const Mesh& mesh)
+{
+  Poisson::FunctionSpace V(mesh);
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Function f(V);
+  *f.vector() = 1.0;
+  L.f = f;
+
+  Matrix A;
+  Vector b;
+  Assembler assembler;
+  assembler.assemble(A, a);
+  assembler.assemble(b, L);
+  assembler.reset_sparsity = false;
+
+  Timer timer("Assemble");
+  for (std::size_t i = 0; i < NUM_REPS; ++i)
+  {
+    assembler.assemble(A, a);
+    assembler.assemble(b, L);
+  }
+  return timer.stop()/NUM_REPS;
+}
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  info("Renumbering of shuffled unit cube mesh of size %d x %d x %d",
+       SIZE, SIZE, SIZE);
+
+  const Mesh mesh = shuffle(UnitCubeMesh(SIZE, SIZE, SIZE));
+  const double t_shuffled = assemble_forms(mesh);
+
+  Table table("Mesh renumbering");
+  table("shuffled", "renumber") = 0.0;
+  table("shuffled", "assemble") = t_shuffled;
+  table("shuffled", "speedup") = 1.0;
+
+  const std::size_t num_methods = 3;
+  const char* methods[] = {"hilbert", "morton", "rcm"};
+  for (std::size_t i = 0; i < num_methods; ++i)
+  {
+    Mesh renumbered_mesh(mesh);
+    Timer timer("Renumber");
+    MeshRenumbering::renumber(renumbered_mesh, methods[i]);
+    const double t_renumber = timer.stop();
+    const double t_assemble = assemble_forms(renumbered_mesh);
+
+    table(methods[i], "renumber") = t_renumber;
+    table(methods[i], "assemble") = t_assemble;
+    table(methods[i], "speedup") = t_shuffled/t_assemble;
+
+    info("BENCH %s %g", methods[i], t_assemble);
+  }
+
+  // Display results
+  info("");
+  info(table, true);
+
+  return 0;
+}
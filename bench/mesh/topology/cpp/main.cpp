@@ -16,10 +16,16 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2010-11-25
-// Last changed: 2012-12-12
+// Last changed: 2013-12-11
+//
+// This benchmark measures the computation of edges, facets and
+// cell-cell connectivity for a unit cube, and the peak memory usage
+// (Linux only). Run with --num_threads n to compute entities with n
+// threads.
 
+#include <cstdlib>
+#include <fstream>
 #include <dolfin.h>
-#include <dolfin/log/LogLevel.h>
 
 using namespace dolfin;
 
@@ -30,24 +36,57 @@ using namespace dolfin;
 //#define NUM_REPS 2
 //#define SIZE 32
 
+// Return peak resident memory of process in MB (0 if not available)
+double peak_memory_usage()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return atof(line.c_str() + 6)/1024.0;
+  }
+  return 0.0;
+}
+
 int main(int argc, char* argv[])
 {
-  info("Creating cell-cell connectivity for unit cube of size %d x %d x %d (%d repetitions)",
+  info("Creating edges, facets and cell-cell connectivity for unit cube of size %d x %d x %d (%d repetitions)",
        SIZE, SIZE, SIZE, NUM_REPS);
 
-  set_log_level(DBG);
-
   parameters.parse(argc, argv);
 
   UnitCubeMesh mesh(SIZE, SIZE, SIZE);
   const int D = mesh.topology().dim();
+  const double memory_mesh = peak_memory_usage();
 
+  double t_edges = 0.0;
+  double t_facets = 0.0;
+  double t_cells = 0.0;
   for (int i = 0; i < NUM_REPS; i++)
   {
     mesh.clean();
+
+    Timer t0("Compute edges");
+    mesh.init(1);
+    t_edges += t0.stop();
+
+    Timer t1("Compute facets");
+    mesh.init(D - 1);
+    t_facets += t1.stop();
+
+    Timer t2("Compute cell-cell connectivity");
     mesh.init(D, D);
-    dolfin::cout << "Created unit cube: " << mesh << dolfin::endl;
+    t_cells += t2.stop();
   }
+  dolfin::cout << "Created unit cube: " << mesh << dolfin::endl;
+
+  info("Peak memory usage: %g MB (%g MB after creating mesh)",
+       peak_memory_usage(), memory_mesh);
+
+  info("BENCH edges %g", t_edges);
+  info("BENCH facets %g", t_facets);
+  info("BENCH cell-cell %g", t_cells);
 
   summary();
 
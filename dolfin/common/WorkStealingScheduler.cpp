@@ -0,0 +1,236 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-04
+// Last changed: 2013-11-04
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
+
+#include <dolfin/log/log.h>
+#include "WorkStealingScheduler.h"
+
+using namespace dolfin;
+
+const std::size_t WorkStealingScheduler::num_slots;
+
+#ifdef HAS_OPENMP
+namespace
+{
+  // Try to lock all given edges, releasing any acquired locks on
+  // failure
+  bool try_lock_edges(std::vector<omp_lock_t>& locks,
+                      const std::vector<std::size_t>& edges)
+  {
+    for (std::size_t i = 0; i < edges.size(); ++i)
+    {
+      if (!omp_test_lock(&locks[edges[i]]))
+      {
+        for (std::size_t j = 0; j < i; ++j)
+          omp_unset_lock(&locks[edges[j]]);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Lock all given edges, waiting if necessary. Edges are sorted, so
+  // acquiring in order cannot deadlock.
+  void lock_edges(std::vector<omp_lock_t>& locks,
+                  const std::vector<std::size_t>& edges)
+  {
+    for (std::size_t i = 0; i < edges.size(); ++i)
+      omp_set_lock(&locks[edges[i]]);
+  }
+
+  // Release all given edges
+  void unlock_edges(std::vector<omp_lock_t>& locks,
+                    const std::vector<std::size_t>& edges)
+  {
+    for (std::size_t i = 0; i < edges.size(); ++i)
+      omp_unset_lock(&locks[edges[i]]);
+  }
+
+  // Get next block from own queue (front), or steal from another
+  // thread (back)
+  bool pop_block(std::vector<std::deque<std::size_t> >& queues,
+                 std::vector<omp_lock_t>& queue_locks,
+                 std::size_t thread, std::size_t& block)
+  {
+    const std::size_t num_threads = queues.size();
+    for (std::size_t i = 0; i < num_threads; ++i)
+    {
+      const std::size_t victim = (thread + i) % num_threads;
+      bool found = false;
+      omp_set_lock(&queue_locks[victim]);
+      if (!queues[victim].empty())
+      {
+        if (victim == thread)
+        {
+          block = queues[victim].front();
+          queues[victim].pop_front();
+        }
+        else
+        {
+          block = queues[victim].back();
+          queues[victim].pop_back();
+        }
+        found = true;
+      }
+      omp_unset_lock(&queue_locks[victim]);
+      if (found)
+        return true;
+    }
+    return false;
+  }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+WorkStealingScheduler::WorkStealingScheduler(const Graph& conflicts)
+  : _block_edges(conflicts.size()), _num_edges(0)
+{
+  // Number the edges (b, c), b < c, of the conflict graph. Edges
+  // incident to a block are appended in increasing order, so each
+  // list of edges is sorted.
+  std::vector<std::size_t> neighbours;
+  for (std::size_t b = 0; b < conflicts.size(); ++b)
+  {
+    neighbours.assign(conflicts[b].begin(), conflicts[b].end());
+    std::sort(neighbours.begin(), neighbours.end());
+    for (std::size_t i = 0; i < neighbours.size(); ++i)
+    {
+      const std::size_t c = neighbours[i];
+      dolfin_assert(c < conflicts.size());
+      if (c > b)
+      {
+        _block_edges[b].push_back(_num_edges);
+        _block_edges[c].push_back(_num_edges);
+        ++_num_edges;
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void WorkStealingScheduler::run(Kernel& kernel, std::size_t num_threads) const
+{
+  const std::size_t num_blocks = _block_edges.size();
+
+  #ifdef HAS_OPENMP
+  if (num_threads > 1 && num_blocks > 1)
+  {
+    // Create locks for edges of conflict graph
+    std::vector<omp_lock_t> edge_locks(_num_edges);
+    for (std::size_t e = 0; e < _num_edges; ++e)
+      omp_init_lock(&edge_locks[e]);
+
+    // Distribute contiguous ranges of blocks to threads
+    std::vector<std::deque<std::size_t> > queues(num_threads);
+    std::vector<omp_lock_t> queue_locks(num_threads);
+    for (std::size_t t = 0; t < num_threads; ++t)
+    {
+      omp_init_lock(&queue_locks[t]);
+      const std::size_t b0 = (t*num_blocks)/num_threads;
+      const std::size_t b1 = ((t + 1)*num_blocks)/num_threads;
+      for (std::size_t b = b0; b < b1; ++b)
+        queues[t].push_back(b);
+    }
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+      const std::size_t thread = omp_get_thread_num();
+
+      // Blocks computed by this thread but not yet inserted (block,
+      // slot), and free buffer slots
+      std::vector<std::pair<std::size_t, std::size_t> > pending;
+      std::vector<std::size_t> free_slots;
+      for (std::size_t s = 0; s < num_slots; ++s)
+        free_slots.push_back(num_slots - s - 1);
+
+      while (true)
+      {
+        // Insert pending blocks that do not conflict with blocks
+        // currently being inserted by other threads
+        for (std::size_t i = 0; i < pending.size();)
+        {
+          const std::vector<std::size_t>& edges
+            = _block_edges[pending[i].first];
+          if (try_lock_edges(edge_locks, edges))
+          {
+            kernel.insert(pending[i].first, thread, pending[i].second);
+            unlock_edges(edge_locks, edges);
+            free_slots.push_back(pending[i].second);
+            pending.erase(pending.begin() + i);
+          }
+          else
+            ++i;
+        }
+
+        // Compute next block if a buffer slot is free, otherwise wait
+        // for the oldest pending block
+        std::size_t block = 0;
+        if (!free_slots.empty()
+            && pop_block(queues, queue_locks, thread, block))
+        {
+          const std::size_t slot = free_slots.back();
+          free_slots.pop_back();
+          kernel.compute(block, thread, slot);
+          pending.push_back(std::make_pair(block, slot));
+        }
+        else if (!pending.empty())
+        {
+          const std::vector<std::size_t>& edges
+            = _block_edges[pending[0].first];
+          lock_edges(edge_locks, edges);
+          kernel.insert(pending[0].first, thread, pending[0].second);
+          unlock_edges(edge_locks, edges);
+          free_slots.push_back(pending[0].second);
+          pending.erase(pending.begin());
+        }
+        else
+          break;
+      }
+    }
+
+    // Destroy locks
+    for (std::size_t t = 0; t < num_threads; ++t)
+      omp_destroy_lock(&queue_locks[t]);
+    for (std::size_t e = 0; e < _num_edges; ++e)
+      omp_destroy_lock(&edge_locks[e]);
+
+    return;
+  }
+  #endif
+
+  // Process blocks in order on the calling thread
+  for (std::size_t b = 0; b < num_blocks; ++b)
+  {
+    kernel.compute(b, 0, 0);
+    kernel.insert(b, 0, 0);
+  }
+}
+//-----------------------------------------------------------------------------
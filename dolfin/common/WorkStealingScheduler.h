@@ -0,0 +1,107 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-04
+// Last changed: 2013-11-04
+
+#ifndef __WORK_STEALING_SCHEDULER_H
+#define __WORK_STEALING_SCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+#include <dolfin/graph/Graph.h>
+
+namespace dolfin
+{
+
+  /// This class executes a set of blocks of work on a pool of threads
+  /// using work stealing. Each block is processed in two phases:
+  /// compute, which may run concurrently with any other block, and
+  /// insert, which is never run concurrently with the insert phase
+  /// of a conflicting block. Conflicts are given by a (symmetric)
+  /// graph over the blocks.
+  ///
+  /// Mutual exclusion is obtained by locking the edges of the
+  /// conflict graph incident to a block, so blocks that do not
+  /// conflict never wait for each other. There are no global
+  /// barriers: a thread that cannot insert a computed block goes on
+  /// computing other blocks (up to num_slots blocks are kept pending
+  /// per thread) and steals blocks from other threads when its own
+  /// queue is empty.
+  ///
+  /// If DOLFIN is compiled without OpenMP, or a single thread is
+  /// requested, blocks are processed in order on the calling thread.
+
+  class WorkStealingScheduler
+  {
+  public:
+
+    /// Number of computed-but-not-inserted blocks a thread may hold
+    static const std::size_t num_slots = 4;
+
+    /// Interface for the work done on each block
+    class Kernel
+    {
+    public:
+
+      /// Destructor
+      virtual ~Kernel() {}
+
+      /// Compute block, storing the result in buffer slot (thread,
+      /// slot). May be called concurrently for any blocks.
+      virtual void compute(std::size_t block, std::size_t thread,
+                           std::size_t slot) = 0;
+
+      /// Insert result of block previously computed into buffer
+      /// slot (thread, slot). Never called concurrently for two
+      /// conflicting blocks.
+      virtual void insert(std::size_t block, std::size_t thread,
+                          std::size_t slot) = 0;
+
+    };
+
+    /// Create scheduler for blocks 0, ..., conflicts.size() - 1 with
+    /// the given conflict graph
+    explicit WorkStealingScheduler(const Graph& conflicts);
+
+    /// Destructor
+    ~WorkStealingScheduler();
+
+    /// Process all blocks using the given number of threads
+    void run(Kernel& kernel, std::size_t num_threads) const;
+
+    /// Return number of blocks
+    std::size_t num_blocks() const
+    { return _block_edges.size(); }
+
+    /// Return number of edges in the conflict graph
+    std::size_t num_conflicts() const
+    { return _num_edges; }
+
+  private:
+
+    // Sorted list of conflict graph edges incident to each block
+    std::vector<std::vector<std::size_t> > _block_edges;
+
+    // Number of edges in the conflict graph
+    std::size_t _num_edges;
+
+  };
+
+}
+
+#endif
@@ -22,11 +22,12 @@
 // Modified by Martin Alnaes 2013
 //
 // First added:  2007-01-17
-// Last changed: 2013-09-19
+// Last changed: 2013-11-08
 
 #include <boost/scoped_ptr.hpp>
 
 #include <dolfin/log/dolfin_log.h>
+#include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
 #include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/la/GenericTensor.h>
@@ -43,7 +44,9 @@
 #include "UFC.h"
 #include "FiniteElement.h"
 #include "OpenMpAssembler.h"
+#include "WorkStealingAssembler.h"
 #include "AssemblerBase.h"
+#include "AssemblyPlan.h"
 #include "Assembler.h"
 
 #include <dolfin/la/GenericMatrix.h>
@@ -57,9 +60,21 @@ void Assembler::assemble(GenericTensor& A, const Form& a)
   // in turn calls the assembler functions below to assemble over
   // cells, exterior and interior facets.
 
-  // Check whether we should call the multi-core assembler
-  #ifdef HAS_OPENMP
+  // Check whether we should call a multi-core assembler
   const std::size_t num_threads = parameters["num_threads"];
+  const std::string threaded_assembler = parameters["threaded_assembler"];
+  if (num_threads > 0 && threaded_assembler == "work_stealing")
+  {
+    WorkStealingAssembler assembler;
+    assembler.reset_sparsity = reset_sparsity;
+    assembler.add_values = add_values;
+    assembler.finalize_tensor = finalize_tensor;
+    assembler.keep_diagonal = keep_diagonal;
+    assembler.assemble(A, a);
+    return;
+  }
+
+  #ifdef HAS_OPENMP
   if (num_threads > 0)
   {
     OpenMpAssembler assembler;
@@ -98,8 +113,21 @@ void Assembler::assemble(GenericTensor& A, const Form& a)
   // Initialize global tensor
   init_global_tensor(A, a);
 
+  // Get assembly plan (if any) for reassembly of matrix
+  boost::shared_ptr<const AssemblyPlan> plan;
+  const bool use_plan = use_assembly_plan && A.rank() == 2
+    && ufc.form.has_cell_integrals() && MPI::num_processes() == 1;
+  if (use_plan && !reset_sparsity)
+    plan = AssemblyPlan::find(as_type<const GenericMatrix>(A), a);
+
   // Assemble over cells
-  assemble_cells(A, a, ufc, cell_domains, 0);
+  if (plan && plan->supported())
+  {
+    assemble_cells_planned(as_type<GenericMatrix>(A), a, ufc, cell_domains,
+                           *plan);
+  }
+  else
+    assemble_cells(A, a, ufc, cell_domains, 0);
 
   // Assemble over exterior facets
   assemble_exterior_facets(A, a, ufc, exterior_facet_domains, 0);
@@ -110,6 +138,10 @@ void Assembler::assemble(GenericTensor& A, const Form& a)
   // Finalize assembly of global tensor
   if (finalize_tensor)
     A.apply("add");
+
+  // Compute assembly plan for subsequent reassembly
+  if (use_plan && finalize_tensor && !plan)
+    AssemblyPlan::build(as_type<const GenericMatrix>(A), a);
 }
 //-----------------------------------------------------------------------------
 void Assembler::assemble_cells(GenericTensor& A,
@@ -122,6 +154,13 @@ void Assembler::assemble_cells(GenericTensor& A,
   if (!ufc.form.has_cell_integrals())
     return;
 
+  // Use batched assembly if requested
+  if (tensor_batch_size > 1 && ufc.form.rank() > 0 && !values)
+  {
+    assemble_cells_batched(A, a, ufc, domains);
+    return;
+  }
+
   // Set timer
   Timer timer("Assemble cells");
 
@@ -193,6 +232,209 @@ void Assembler::assemble_cells(GenericTensor& A,
   }
 }
 //-----------------------------------------------------------------------------
+void Assembler::assemble_cells_batched(GenericTensor& A,
+                                       const Form& a,
+                                       UFC& ufc,
+                                       const MeshFunction<std::size_t>* domains)
+{
+  // Set timer
+  Timer timer("Assemble cells");
+
+  // Extract mesh
+  const Mesh& mesh = a.mesh();
+
+  // Form rank and number of coefficients
+  const std::size_t form_rank = ufc.form.rank();
+  const std::size_t num_coefficients = ufc.form.num_coefficients();
+
+  // Collect pointers to dof maps
+  std::vector<const GenericDofMap*> dofmaps;
+  for (std::size_t i = 0; i < form_rank; ++i)
+    dofmaps.push_back(a.function_space(i)->dofmap().get());
+
+  // Check whether integral is domain-dependent
+  bool use_domains = domains && !domains->empty();
+
+  // Batch data: integrals, orientations, dimensions and rows of
+  // element tensors, vertex coordinates and coefficients. Coordinates,
+  // each coefficient and element tensors are stored in contiguous
+  // arrays over the cells of the batch.
+  const std::size_t batch_size = tensor_batch_size;
+  const std::size_t num_coordinates
+    = mesh.type().num_vertices(mesh.topology().dim())*mesh.geometry().dim();
+  std::vector<const ufc::cell_integral*> batch_integrals(batch_size);
+  std::vector<int> batch_orientations(batch_size);
+  std::vector<dolfin::la_index> batch_num_rows(batch_size*form_rank);
+  std::vector<const dolfin::la_index*> batch_rows(batch_size*form_rank);
+  std::vector<std::size_t> batch_offsets(batch_size + 1, 0);
+  std::vector<double> batch_coordinates(batch_size*num_coordinates);
+  std::vector<std::vector<double> > batch_w(num_coefficients);
+  std::vector<std::size_t> w_dims(num_coefficients);
+  for (std::size_t j = 0; j < num_coefficients; ++j)
+  {
+    w_dims[j] = ufc.coefficient_dimension(j);
+    batch_w[j].resize(batch_size*w_dims[j]);
+  }
+  std::vector<double> batch_tensors(batch_size*ufc.A.size());
+  std::vector<double*> w(num_coefficients);
+
+  // Assemble over cells
+  ufc::cell ufc_cell;
+  std::vector<double> vertex_coordinates;
+  std::size_t num_batched = 0;
+  Progress p(AssemblerBase::progress_message(A.rank(), "cells"),
+             mesh.num_cells());
+  for (CellIterator cell(mesh); ; ++cell)
+  {
+    if (!cell.end())
+    {
+      // Get integral for sub domain (if any)
+      const ufc::cell_integral* integral
+        = use_domains ? ufc.get_cell_integral((*domains)[*cell])
+                      : ufc.default_cell_integral.get();
+
+      // Skip if no integral on current domain
+      if (!integral)
+        continue;
+
+      // Get local-to-global dof maps for cell
+      bool empty_dofmap = false;
+      std::size_t dim = 1;
+      for (std::size_t i = 0; i < form_rank; ++i)
+      {
+        const std::vector<dolfin::la_index>& dofs
+          = dofmaps[i]->cell_dofs(cell->index());
+        batch_num_rows[num_batched*form_rank + i] = dofs.size();
+        batch_rows[num_batched*form_rank + i] = dofs.data();
+        empty_dofmap = empty_dofmap || dofs.size() == 0;
+        dim *= dofs.size();
+      }
+
+      // Skip if at least one dofmap is empty
+      if (empty_dofmap)
+        continue;
+
+      // Gather vertex coordinates and coefficients for cell
+      cell->get_cell_data(ufc_cell);
+      cell->get_vertex_coordinates(vertex_coordinates);
+      std::copy(vertex_coordinates.begin(), vertex_coordinates.end(),
+                batch_coordinates.begin() + num_batched*num_coordinates);
+      for (std::size_t j = 0; j < num_coefficients; ++j)
+        w[j] = &batch_w[j][num_batched*w_dims[j]];
+      ufc.update(*cell, vertex_coordinates, ufc_cell, w.data());
+
+      batch_integrals[num_batched] = integral;
+      batch_orientations[num_batched] = ufc_cell.orientation;
+      batch_offsets[num_batched + 1] = batch_offsets[num_batched] + dim;
+      ++num_batched;
+      p++;
+
+      // Continue gathering until batch is full
+      if (num_batched < batch_size)
+        continue;
+    }
+
+    // Tabulate element tensors of batch
+    for (std::size_t k = 0; k < num_batched; ++k)
+    {
+      for (std::size_t j = 0; j < num_coefficients; ++j)
+        w[j] = &batch_w[j][k*w_dims[j]];
+      batch_integrals[k]->tabulate_tensor(&batch_tensors[batch_offsets[k]],
+                                          w.data(),
+                                          &batch_coordinates[k*num_coordinates],
+                                          batch_orientations[k]);
+    }
+
+    // Add element tensors to global tensor
+    if (num_batched > 0)
+    {
+      A.add_batch(num_batched, batch_tensors.data(), batch_num_rows.data(),
+                  batch_rows.data());
+    }
+    num_batched = 0;
+
+    if (cell.end())
+      break;
+  }
+}
+//-----------------------------------------------------------------------------
+void Assembler::assemble_cells_planned(GenericMatrix& A,
+                                       const Form& a,
+                                       UFC& ufc,
+                                       const MeshFunction<std::size_t>* domains,
+                                       const AssemblyPlan& plan)
+{
+  // Set timer
+  Timer timer("Assemble cells");
+
+  // Extract mesh
+  const Mesh& mesh = a.mesh();
+
+  // Cell integral
+  ufc::cell_integral* integral = ufc.default_cell_integral.get();
+
+  // Check whether integral is domain-dependent
+  bool use_domains = domains && !domains->empty();
+
+  // Element matrices of consecutive cells are tabulated into a buffer
+  // and added together, since their positions are contiguous in the
+  // plan
+  const std::size_t buffer_size = 4096;
+  std::vector<double> buffer(buffer_size + ufc.A.size());
+  std::size_t num_buffered = 0;
+  const std::size_t* buffer_positions = 0;
+
+  // Assemble over cells
+  ufc::cell ufc_cell;
+  std::vector<double> vertex_coordinates;
+  Progress p(AssemblerBase::progress_message(A.rank(), "cells"),
+             mesh.num_cells());
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  {
+    // Get integral for sub domain (if any)
+    if (use_domains)
+      integral = ufc.get_cell_integral((*domains)[*cell]);
+
+    // Skip if no integral on current domain or no dofs on cell, and
+    // add buffered values since the run of cells is broken
+    const std::size_t num_entries = plan.num_positions(cell->index());
+    if (!integral || num_entries == 0)
+    {
+      if (num_buffered > 0)
+        A.add_at_positions(buffer.data(), buffer_positions, num_buffered);
+      num_buffered = 0;
+      continue;
+    }
+
+    // Update to current cell
+    cell->get_cell_data(ufc_cell);
+    cell->get_vertex_coordinates(vertex_coordinates);
+    ufc.update(*cell, vertex_coordinates, ufc_cell);
+
+    // Tabulate cell tensor into buffer
+    dolfin_assert(num_entries == ufc.A.size());
+    if (num_buffered == 0)
+      buffer_positions = plan.positions(cell->index());
+    integral->tabulate_tensor(&buffer[num_buffered], ufc.w(),
+                              vertex_coordinates.data(),
+                              ufc_cell.orientation);
+    num_buffered += num_entries;
+
+    // Add buffered values to matrix when buffer is full
+    if (num_buffered >= buffer_size)
+    {
+      A.add_at_positions(buffer.data(), buffer_positions, num_buffered);
+      num_buffered = 0;
+    }
+
+    p++;
+  }
+
+  // Add remaining values
+  if (num_buffered > 0)
+    A.add_at_positions(buffer.data(), buffer_positions, num_buffered);
+}
+//-----------------------------------------------------------------------------
 void Assembler::assemble_exterior_facets(GenericTensor& A,
                                          const Form& a,
                                          UFC& ufc,
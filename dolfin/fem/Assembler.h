@@ -20,7 +20,7 @@
 // Modified by Joachim B Haga 2012
 //
 // First added:  2007-01-17
-// Last changed: 2013-09-19
+// Last changed: 2013-11-08
 
 #ifndef __ASSEMBLER_H
 #define __ASSEMBLER_H
@@ -32,6 +32,8 @@ namespace dolfin
 {
 
   // Forward declarations
+  class AssemblyPlan;
+  class GenericMatrix;
   class GenericTensor;
   class Form;
   class UFC;
@@ -91,6 +93,18 @@ namespace dolfin
 
   protected:
 
+    /// Assemble over cells in batches of tensor_batch_size cells.
+    /// Used by assemble_cells for forms of rank one or higher.
+    void assemble_cells_batched(GenericTensor& A, const Form& a, UFC& ufc,
+                                const MeshFunction<std::size_t>* domains);
+
+    /// Assemble over cells by adding element matrices directly to
+    /// the value storage of A at the positions given by an assembly
+    /// plan
+    void assemble_cells_planned(GenericMatrix& A, const Form& a, UFC& ufc,
+                                const MeshFunction<std::size_t>* domains,
+                                const AssemblyPlan& plan);
+
     /// Add cell tensor to global tensor. Hook to allow the SymmetricAssembler
     /// to split the cell tensor into symmetric/antisymmetric parts.
     void add_to_global_tensor(GenericTensor& A,
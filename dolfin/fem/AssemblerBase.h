@@ -19,7 +19,7 @@
 // Modified by Ola Skavhaug, 2008.
 //
 // First added:  2007-01-17
-// Last changed: 2013-09-19
+// Last changed: 2013-11-08
 
 #ifndef __ASSEMBLER_BASE_H
 #define __ASSEMBLER_BASE_H
@@ -48,7 +48,9 @@ namespace dolfin
       reset_sparsity(true),
       add_values(false),
       finalize_tensor(true),
-      keep_diagonal(false) {}
+      keep_diagonal(false),
+      tensor_batch_size(1),
+      use_assembly_plan(false) {}
 
     /// reset_sparsity (bool)
     ///     Default value is true.
@@ -76,6 +78,29 @@ namespace dolfin
     ///     if the matrix is finalised.
     bool keep_diagonal;
 
+    /// tensor_batch_size (std::size_t)
+    ///     Default value is 1.
+    ///     This controls the number of cells for which element
+    ///     tensors are computed together before being added to the
+    ///     global tensor in a single call. Coordinates and
+    ///     coefficients of a batch are gathered first, then all
+    ///     element tensors are tabulated, and finally inserted. A
+    ///     value of 1 assembles cell by cell.
+    std::size_t tensor_batch_size;
+
+    /// use_assembly_plan (bool)
+    ///     Default value is false.
+    ///     This controls whether an assembly plan is used for cell
+    ///     integrals of bilinear forms. After assembly with a reset
+    ///     sparsity pattern, the positions of all element matrix
+    ///     entries in the value storage of the matrix are recorded
+    ///     (see _AssemblyPlan_). Subsequent assemblies into the same
+    ///     matrix with reset_sparsity false then add element matrices
+    ///     directly into the value storage. Only supported in serial
+    ///     and for matrix backends that provide direct access to their
+    ///     values.
+    bool use_assembly_plan;
+
     // Initialize global tensor
     void init_global_tensor(GenericTensor& A, const Form& a);
 
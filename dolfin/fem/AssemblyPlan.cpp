@@ -0,0 +1,135 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-08
+// Last changed: 2013-11-08
+
+#include <dolfin/common/Timer.h>
+#include <dolfin/function/FunctionSpace.h>
+#include <dolfin/la/GenericMatrix.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/Mesh.h>
+#include "Form.h"
+#include "GenericDofMap.h"
+#include "AssemblyPlan.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+AssemblyPlan::AssemblyPlan(const GenericMatrix& A, const Form& a)
+  : _tensor_id(A.id()),
+    _sparsity_pattern_version(A.sparsity_pattern_version()),
+    _num_rows(A.size(0)), _num_cols(A.size(1)),
+    _mesh_id(a.mesh().id()), _num_cells(a.mesh().num_cells()),
+    _topology_hash(a.mesh().topology().hash()), _supported(true)
+{
+  Timer timer("Build assembly plan");
+
+  if (a.rank() != 2)
+  {
+    dolfin_error("AssemblyPlan.cpp",
+                 "build assembly plan",
+                 "Expecting a bilinear form (not rank %d)", a.rank());
+  }
+
+  // Get dofmaps
+  std::vector<const GenericDofMap*> dofmaps;
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    dofmaps.push_back(a.function_space(i)->dofmap().get());
+    _dofmap_ids.push_back(dofmaps[i]->id());
+    _global_dimensions.push_back(dofmaps[i]->global_dimension());
+  }
+
+  // Compute positions of element matrix entries for each cell
+  _offsets.resize(_num_cells + 1, 0);
+  for (std::size_t c = 0; c < _num_cells; ++c)
+  {
+    const std::vector<dolfin::la_index>& dofs0 = dofmaps[0]->cell_dofs(c);
+    const std::vector<dolfin::la_index>& dofs1 = dofmaps[1]->cell_dofs(c);
+    const std::size_t num_entries = dofs0.size()*dofs1.size();
+    _offsets[c + 1] = _offsets[c] + num_entries;
+    if (num_entries == 0)
+      continue;
+
+    _positions.resize(_offsets[c + 1]);
+    if (!A.get_positions(&_positions[_offsets[c]],
+                         dofs0.size(), dofs0.data(),
+                         dofs1.size(), dofs1.data()))
+    {
+      _supported = false;
+      _offsets.clear();
+      _positions.clear();
+      break;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+bool AssemblyPlan::valid(const GenericMatrix& A, const Form& a) const
+{
+  // Check matrix and its sparsity pattern
+  if (A.id() != _tensor_id
+      || A.sparsity_pattern_version() != _sparsity_pattern_version
+      || A.size(0) != _num_rows || A.size(1) != _num_cols)
+  {
+    return false;
+  }
+
+  // Check mesh
+  const Mesh& mesh = a.mesh();
+  if (mesh.id() != _mesh_id || mesh.num_cells() != _num_cells
+      || mesh.topology().hash() != _topology_hash)
+  {
+    return false;
+  }
+
+  // Check dofmaps
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    const GenericDofMap& dofmap = *a.function_space(i)->dofmap();
+    if (dofmap.id() != _dofmap_ids[i]
+        || dofmap.global_dimension() != _global_dimensions[i])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+//-----------------------------------------------------------------------------
+boost::shared_ptr<const AssemblyPlan>
+AssemblyPlan::find(const GenericMatrix& A, const Form& a)
+{
+  boost::shared_ptr<const AssemblyPlan> plan = A.assembly_plan();
+  if (plan && !plan->valid(A, a))
+  {
+    // Discard plan if matrix, mesh or dofmaps have changed
+    A.set_assembly_plan(boost::shared_ptr<const AssemblyPlan>());
+    plan.reset();
+  }
+
+  return plan;
+}
+//-----------------------------------------------------------------------------
+boost::shared_ptr<const AssemblyPlan>
+AssemblyPlan::build(const GenericMatrix& A, const Form& a)
+{
+  boost::shared_ptr<const AssemblyPlan> plan(new AssemblyPlan(A, a));
+  A.set_assembly_plan(plan);
+  return plan;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,110 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-08
+// Last changed: 2013-11-08
+
+#ifndef __ASSEMBLY_PLAN_H
+#define __ASSEMBLY_PLAN_H
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class Form;
+  class GenericDofMap;
+  class GenericMatrix;
+
+  /// This class stores, for each cell of a mesh, the positions in the
+  /// local value storage of a matrix of the entries of the element
+  /// matrix of the cell. Once a plan has been computed, a matrix with
+  /// an unchanged sparsity pattern may be reassembled by adding
+  /// element matrices directly to the value storage (see
+  /// GenericMatrix::add_at_positions), without locating each entry.
+  ///
+  /// Plans are computed from a finalized matrix and stored with the
+  /// matrix (see GenericMatrix::assembly_plan), so that they are
+  /// released together with the matrix. A stored plan is discarded
+  /// when the sparsity pattern of the matrix, the mesh (its topology
+  /// or number of cells) or a dofmap has changed.
+
+  class AssemblyPlan
+  {
+  public:
+
+    /// Compute plan for assembling the cell integrals of the bilinear
+    /// form a into the finalized matrix A
+    AssemblyPlan(const GenericMatrix& A, const Form& a);
+
+    /// Return true if the matrix backend supports direct insertion
+    /// for all cells
+    bool supported() const
+    { return _supported; }
+
+    /// Check whether plan applies to given matrix and form
+    bool valid(const GenericMatrix& A, const Form& a) const;
+
+    /// Return number of entries of element matrix of given cell
+    /// (zero if the cell has no dofs)
+    std::size_t num_positions(std::size_t cell) const
+    { return _offsets[cell + 1] - _offsets[cell]; }
+
+    /// Return positions of entries of element matrix of given cell
+    const std::size_t* positions(std::size_t cell) const
+    { return _positions.data() + _offsets[cell]; }
+
+    /// Return plan stored with A if it is valid for A and a,
+    /// otherwise an empty pointer
+    static boost::shared_ptr<const AssemblyPlan>
+      find(const GenericMatrix& A, const Form& a);
+
+    /// Compute plan for A and a and store it with A, replacing any
+    /// previous plan
+    static boost::shared_ptr<const AssemblyPlan>
+      build(const GenericMatrix& A, const Form& a);
+
+  private:
+
+    // Matrix id, sparsity pattern version and dimensions
+    std::size_t _tensor_id;
+    std::size_t _sparsity_pattern_version;
+    std::size_t _num_rows, _num_cols;
+
+    // Mesh id, number of cells and topology hash
+    std::size_t _mesh_id;
+    std::size_t _num_cells;
+    std::size_t _topology_hash;
+
+    // Dofmap ids and global dimensions
+    std::vector<std::size_t> _dofmap_ids;
+    std::vector<std::size_t> _global_dimensions;
+
+    // True if positions are available for all cells
+    bool _supported;
+
+    // Positions of element matrix entries, cell by cell
+    std::vector<std::size_t> _offsets;
+    std::vector<std::size_t> _positions;
+
+  };
+
+}
+
+#endif
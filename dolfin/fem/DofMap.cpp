@@ -24,7 +24,7 @@
 // Modified by Jan Blechta, 2013
 //
 // First added:  2007-03-01
-// Last changed: 2013-09-19
+// Last changed: 2013-12-11
 
 #include <boost/unordered_map.hpp>
 
@@ -33,9 +33,11 @@
 #include <dolfin/common/types.h>
 #include <dolfin/la/GenericVector.h>
 #include <dolfin/log/LogStream.h>
+#include <dolfin/mesh/MeshData.h>
 #include <dolfin/mesh/PeriodicBoundaryComputation.h>
 #include <dolfin/mesh/Restriction.h>
 #include <dolfin/mesh/Vertex.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "DofMapBuilder.h"
 #include "DofMap.h"
 
@@ -45,7 +47,7 @@ using namespace dolfin;
 DofMap::DofMap(boost::shared_ptr<const ufc::dofmap> ufc_dofmap,
                const Mesh& mesh)
   : _ufc_dofmap(ufc_dofmap), _is_view(false), _global_dimension(0),
-    _ufc_offset(0)
+    _ufc_offset(0), _mesh_id(mesh.id())
 {
   dolfin_assert(_ufc_dofmap);
 
@@ -57,7 +59,7 @@ DofMap::DofMap(boost::shared_ptr<const ufc::dofmap> ufc_dofmap,
                const Mesh& mesh,
                boost::shared_ptr<const SubDomain> constrained_domain)
   : _ufc_dofmap(ufc_dofmap), _is_view(false), _global_dimension(0),
-    _ufc_offset(0)
+    _ufc_offset(0), _mesh_id(mesh.id())
 {
   dolfin_assert(_ufc_dofmap);
 
@@ -85,7 +87,7 @@ DofMap::DofMap(boost::shared_ptr<const ufc::dofmap> ufc_dofmap,
 DofMap::DofMap(boost::shared_ptr<const ufc::dofmap> ufc_dofmap,
                boost::shared_ptr<const Restriction> restriction)
   : _ufc_dofmap(ufc_dofmap), _restriction(restriction), _is_view(false),
-    _global_dimension(0), _ufc_offset(0)
+    _global_dimension(0), _ufc_offset(0), _mesh_id(restriction->mesh().id())
 {
   dolfin_assert(_ufc_dofmap);
   dolfin_assert(_restriction);
@@ -108,7 +110,7 @@ DofMap::DofMap(boost::shared_ptr<const ufc::dofmap> ufc_dofmap,
 DofMap::DofMap(const DofMap& parent_dofmap,
   const std::vector<std::size_t>& component, const Mesh& mesh)
   : _is_view(true), _global_dimension(0), _ufc_offset(0),
-    _ownership_range(parent_dofmap._ownership_range)
+    _mesh_id(mesh.id()), _ownership_range(parent_dofmap._ownership_range)
 {
 
   // Share slave-master map with parent
@@ -118,10 +120,21 @@ DofMap::DofMap(const DofMap& parent_dofmap,
   DofMapBuilder::build_sub_map(*this, parent_dofmap, component, mesh);
 }
 //-----------------------------------------------------------------------------
+DofMap::DofMap(const DofMap& parent_dofmap, const Mesh& mesh)
+  : _ufc_dofmap(parent_dofmap._ufc_dofmap), _is_view(false),
+    _global_dimension(0), _ufc_offset(0), _mesh_id(mesh.id())
+{
+  dolfin_assert(_ufc_dofmap);
+  dolfin_assert(mesh.has_parent());
+
+  // Build dofmap reusing numbering of parent dofmap
+  DofMapBuilder::build_refined(*this, mesh, parent_dofmap, mesh.parent());
+}
+//-----------------------------------------------------------------------------
 DofMap::DofMap(boost::unordered_map<std::size_t, std::size_t>& collapsed_map,
                const DofMap& dofmap_view, const Mesh& mesh)
   :  _ufc_dofmap(dofmap_view._ufc_dofmap), _is_view(false),
-     _global_dimension(0), _ufc_offset(0)
+     _global_dimension(0), _ufc_offset(0), _mesh_id(mesh.id())
 {
   dolfin_assert(_ufc_dofmap);
 
@@ -174,10 +187,12 @@ DofMap::DofMap(const DofMap& dofmap)
   // Copy data
   _dofmap = dofmap._dofmap;
   _ufc_dofmap = dofmap._ufc_dofmap;
+  block_size = dofmap.block_size;
   ufc_map_to_dofmap = dofmap.ufc_map_to_dofmap;
   _is_view = dofmap._is_view;
   _global_dimension = dofmap._global_dimension;
   _ufc_offset = dofmap._ufc_offset;
+  _mesh_id = dofmap._mesh_id;
   _ownership_range = dofmap._ownership_range;
   _off_process_owner = dofmap._off_process_owner;
   _shared_dofs = dofmap._shared_dofs;
@@ -473,6 +488,19 @@ boost::shared_ptr<GenericDofMap> DofMap::copy() const
 //-----------------------------------------------------------------------------
 boost::shared_ptr<GenericDofMap> DofMap::create(const Mesh& new_mesh) const
 {
+  // Reuse numbering of this dof map if new mesh has been refined
+  // from the mesh of this dof map and re-ordering is not requested
+  const bool reorder = dolfin::parameters["reorder_dofs_refined"];
+  const std::size_t D = new_mesh.topology().dim();
+  if (!reorder && MPI::num_processes() == 1 && !_is_view && !_restriction
+      && !slave_master_mesh_entities && new_mesh.has_parent()
+      && new_mesh.parent().id() == _mesh_id
+      && new_mesh.parent().num_cells() == _dofmap.size()
+      && new_mesh.data().exists("parent_cell", D))
+  {
+    return boost::shared_ptr<GenericDofMap>(new DofMap(*this, new_mesh));
+  }
+
   // Get underlying UFC dof map
   boost::shared_ptr<const ufc::dofmap> ufc_dof_map(_ufc_dofmap);
   return boost::shared_ptr<GenericDofMap>(new DofMap(ufc_dof_map, new_mesh));
@@ -581,6 +609,31 @@ void DofMap::check_provided_entities(const ufc::dofmap& dofmap,
   }
 }
 //-----------------------------------------------------------------------------
+std::size_t DofMap::memory_usage() const
+{
+  // Cell dofs (one vector per cell)
+  std::size_t memory = sizeof(*this)
+    + _dofmap.capacity()*sizeof(std::vector<dolfin::la_index>);
+  for (std::size_t i = 0; i < _dofmap.size(); ++i)
+    memory += _dofmap[i].capacity()*sizeof(dolfin::la_index);
+
+  // Maps and sets
+  memory += num_global_mesh_entities.capacity()*sizeof(std::size_t);
+  memory += ufc_map_to_dofmap.size()*2*sizeof(std::size_t);
+  memory += _off_process_owner.size()*(sizeof(std::size_t)
+                                       + sizeof(unsigned int));
+  boost::unordered_map<std::size_t, std::vector<unsigned int> >::const_iterator
+    dof;
+  for (dof = _shared_dofs.begin(); dof != _shared_dofs.end(); ++dof)
+  {
+    memory += sizeof(std::size_t) + sizeof(std::vector<unsigned int>)
+      + dof->second.capacity()*sizeof(unsigned int);
+  }
+  memory += _neighbours.size()*sizeof(std::size_t);
+
+  return memory;
+}
+//-----------------------------------------------------------------------------
 std::string DofMap::str(bool verbose) const
 {
   // TODO: Display information on parallel stuff
@@ -595,6 +648,9 @@ std::string DofMap::str(bool verbose) const
     << ">" << std::endl;
   if (verbose)
   {
+    s << prefix.str() << "Memory usage (MB): "
+      << memory_usage()/(1024.0*1024.0) << std::endl;
+
     // Cell loop
     for (std::size_t i = 0; i < _dofmap.size(); ++i)
     {
@@ -23,7 +23,7 @@
 // Modified by Jan Blechta, 2013
 //
 // First added:  2007-03-01
-// Last changed: 2013-09-19
+// Last changed: 2013-12-11
 
 #ifndef __DOLFIN_DOF_MAP_H
 #define __DOLFIN_DOF_MAP_H
@@ -96,6 +96,11 @@ namespace dolfin
            const std::vector<std::size_t>& component,
            const Mesh& mesh);
 
+    // Create a dofmap on a mesh refined from the mesh of
+    // parent_dofmap, reusing the numbering of parent_dofmap on
+    // unrefined cells
+    DofMap(const DofMap& parent_dofmap, const Mesh& mesh);
+
     // Create a collapsed dofmap from parent_dofmap
     DofMap(boost::unordered_map<std::size_t, std::size_t>& collapsed_map,
            const DofMap& dofmap_view, const Mesh& mesh);
@@ -325,7 +330,10 @@ namespace dolfin
     ///         The Dofmap copy.
     boost::shared_ptr<GenericDofMap> copy() const;
 
-    /// Create a copy of the dof map on a new mesh
+    /// Create a copy of the dof map on a new mesh. If the new mesh
+    /// has been refined from the mesh of this dof map and the
+    /// parameter "reorder_dofs_refined" is false, the numbering of
+    /// this dof map is reused on unrefined cells (in serial)
     ///
     /// *Arguments*
     ///     new_mesh (_Mesh_)
@@ -409,6 +417,14 @@ namespace dolfin
     const std::vector<std::vector<dolfin::la_index> >& data() const
     { return _dofmap; }
 
+    /// Return memory used by the dof map on this process (in bytes),
+    /// excluding the memory used by nodes of maps
+    ///
+    /// *Returns*
+    ///     std::size_t
+    ///         The memory usage in bytes.
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     ///
     /// *Arguments*
@@ -461,6 +477,9 @@ namespace dolfin
     // UFC dof map offset
     std::size_t _ufc_offset;
 
+    // Id of the mesh the dof map was built on
+    std::size_t _mesh_id;
+
     // Ownership range (dofs in this range are owned by this
     // process). Set to (0, 0) if dofmap is a view
     std::pair<std::size_t, std::size_t> _ownership_range;
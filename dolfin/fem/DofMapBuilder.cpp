@@ -22,8 +22,10 @@
 // Modified by Martin Alnaes, 2013
 //
 // First added:  2008-08-12
-// Last changed: 2013-01-08
+// Last changed: 2013-12-11
 
+#include <algorithm>
+#include <limits>
 #include <ufc.h>
 #include <boost/random.hpp>
 #include <boost/unordered_map.hpp>
@@ -34,9 +36,11 @@
 #include <dolfin/graph/SCOTCH.h>
 #include <dolfin/log/log.h>
 #include <dolfin/mesh/BoundaryMesh.h>
+#include <dolfin/mesh/Cell.h>
 #include <dolfin/mesh/DistributedMeshTools.h>
 #include <dolfin/mesh/Facet.h>
 #include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshData.h>
 #include <dolfin/mesh/MeshEntityIterator.h>
 #include <dolfin/mesh/Restriction.h>
 #include <dolfin/mesh/SubDomain.h>
@@ -88,16 +92,147 @@ void DofMapBuilder::build(DofMap& dofmap, const Mesh& mesh,
   }
   else
   {
-    // Optionally re-order local dofmap for spatial locality
+    // Optionally re-order local dofmap for spatial locality. Without
+    // re-ordering, components are not interleaved (UFC numbering), so
+    // dofs are not blocked
     const bool reorder = dolfin::parameters["reorder_dofs_serial"];
     if (reorder)
       reorder_local(dofmap, mesh, block_size);
+    else
+      dofmap.block_size = 1;
 
     // Set local dof ownbership range
     dofmap._ownership_range = std::make_pair(0, dofmap.global_dimension());
   }
 }
 //-----------------------------------------------------------------------------
+void DofMapBuilder::build_refined(DofMap& dofmap, const Mesh& mesh,
+                                  const DofMap& parent_dofmap,
+                                  const Mesh& parent_mesh)
+{
+  // Start timer for dofmap initialization
+  Timer t0("Init dofmap from parent dofmap");
+
+  // Check that mesh has been ordered
+  if (!mesh.ordered())
+  {
+     dolfin_error("DofMapBuilder.cpp",
+                  "create mapping of degrees of freedom",
+                  "Mesh is not ordered according to the UFC numbering convention. "
+                  "Consider calling mesh.order()");
+  }
+
+  // Get parent cells
+  const std::size_t D = mesh.topology().dim();
+  if (!mesh.data().exists("parent_cell", D))
+  {
+     dolfin_error("DofMapBuilder.cpp",
+                  "create mapping of degrees of freedom from parent",
+                  "Mesh has no parent cell data");
+  }
+  const std::vector<std::size_t>& parent_cell
+    = mesh.data().array("parent_cell", D);
+  dolfin_assert(parent_cell.size() == mesh.num_cells());
+  dolfin_assert(parent_dofmap._dofmap.size() == parent_mesh.num_cells());
+
+  // Build dofmap based on UFC-provided map
+  map restricted_dofs_inverse;
+  boost::shared_ptr<const std::map<unsigned int, std::map<unsigned int,
+    std::pair<unsigned int, unsigned int> > > > slave_master_entities;
+  boost::shared_ptr<const Restriction> restriction;
+  build_ufc_dofmap(dofmap, restricted_dofs_inverse, mesh,
+                   slave_master_entities, restriction);
+
+  // Determine and set dof block size
+  dolfin_assert(dofmap._ufc_dofmap);
+  const std::size_t block_size = compute_blocksize(*dofmap._ufc_dofmap);
+  dofmap.block_size = block_size;
+
+  // Number of nodes (UFC numbering)
+  const std::size_t N = dofmap.global_dimension();
+  dolfin_assert(N % block_size == 0);
+  const std::size_t num_nodes = N/block_size;
+  const std::size_t gdim = mesh.geometry().dim();
+  const std::size_t unset = std::numeric_limits<std::size_t>::max();
+
+  // Find the node of the parent dofmap for each node on a cell that
+  // has not been refined, i.e. that has the same vertices (in the
+  // same order) as its parent cell. The dofs of the first block
+  // component of a node are used as keys
+  std::vector<std::size_t> parent_node(num_nodes, unset);
+  std::size_t num_unrefined_cells = 0;
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  {
+    const std::size_t p = parent_cell[cell->index()];
+    dolfin_assert(p < parent_mesh.num_cells());
+    const Cell _parent_cell(parent_mesh, p);
+
+    // Check whether cell is unrefined
+    bool unrefined = true;
+    for (std::size_t i = 0; i < cell->num_entities(0); ++i)
+    {
+      const double* x = mesh.geometry().x(cell->entities(0)[i]);
+      const double* x_parent
+        = parent_mesh.geometry().x(_parent_cell.entities(0)[i]);
+      if (!std::equal(x, x + gdim, x_parent))
+      {
+        unrefined = false;
+        break;
+      }
+    }
+    if (!unrefined)
+      continue;
+    ++num_unrefined_cells;
+
+    const std::vector<dolfin::la_index>& dofs
+      = dofmap._dofmap[cell->index()];
+    const std::vector<dolfin::la_index>& parent_dofs
+      = parent_dofmap._dofmap[p];
+    dolfin_assert(dofs.size() == parent_dofs.size());
+    const std::size_t nodes_per_cell = dofs.size()/block_size;
+    for (std::size_t i = 0; i < nodes_per_cell; ++i)
+      parent_node[dofs[i] % num_nodes] = parent_dofs[i];
+  }
+
+  // Number reused nodes first, in the order of the parent nodes
+  std::vector<std::pair<std::size_t, std::size_t> > reused_nodes;
+  for (std::size_t i = 0; i < num_nodes; ++i)
+  {
+    if (parent_node[i] != unset)
+      reused_nodes.push_back(std::make_pair(parent_node[i], i));
+  }
+  std::sort(reused_nodes.begin(), reused_nodes.end());
+  std::vector<std::size_t> node_remap(num_nodes, unset);
+  for (std::size_t i = 0; i < reused_nodes.size(); ++i)
+    node_remap[reused_nodes[i].second] = i;
+
+  // Number new nodes in the order they appear in cells
+  std::size_t new_node = reused_nodes.size();
+  std::vector<std::vector<dolfin::la_index> >::const_iterator cell_dofs;
+  for (cell_dofs = dofmap._dofmap.begin(); cell_dofs != dofmap._dofmap.end();
+       ++cell_dofs)
+  {
+    const std::size_t nodes_per_cell = cell_dofs->size()/block_size;
+    for (std::size_t i = 0; i < nodes_per_cell; ++i)
+    {
+      const std::size_t node = (*cell_dofs)[i] % num_nodes;
+      if (node_remap[node] == unset)
+        node_remap[node] = new_node++;
+    }
+  }
+  dolfin_assert(new_node == num_nodes);
+
+  log(TRACE, "Reused numbering of %d of %d nodes on %d of %d cells.",
+      (int) reused_nodes.size(), (int) num_nodes, (int) num_unrefined_cells,
+      (int) mesh.num_cells());
+
+  // Re-number dofs
+  renumber_nodes(dofmap, node_remap, block_size);
+
+  // Set local dof ownership range
+  dofmap._ownership_range = std::make_pair(0, dofmap.global_dimension());
+}
+//-----------------------------------------------------------------------------
 void DofMapBuilder::build_sub_map(DofMap& sub_dofmap,
                                   const DofMap& parent_dofmap,
                                   const std::vector<std::size_t>& component,
@@ -378,12 +513,17 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
   // Global dimension
   const std::size_t N = dofmap.global_dimension();
 
-  // Create empty graph
+  // Create empty graph, or list of nodes in the order they are touched
+  // by cells for "first_touch" (which does not need the graph)
   dolfin_assert(N % block_size == 0);
   const std::size_t num_nodes = N/block_size;
-  Graph graph(num_nodes);
+  const std::string ordering_library
+    = dolfin::parameters["dof_ordering_library"];
+  const bool first_touch = ordering_library == "first_touch";
+  Graph graph(first_touch ? 0 : num_nodes);
+  std::vector<std::size_t> cell_nodes;
 
-  // Build local graph for blocks
+  // Build local graph for blocks (or list of nodes)
   for (CellIterator cell(mesh); !cell.end(); ++cell)
   {
     const std::vector<dolfin::la_index>& dofs0
@@ -394,6 +534,13 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
     dolfin_assert(dofs0.size() % block_size == 0);
     const std::size_t nodes_per_cell = dofs0.size()/block_size;
 
+    if (first_touch)
+    {
+      for (std::size_t i = 0; i < nodes_per_cell; ++i)
+        cell_nodes.push_back(dofs0[i] % num_nodes);
+      continue;
+    }
+
     std::vector<dolfin::la_index>::const_iterator node0, node1;
     for (std::size_t i = 0; i < nodes_per_cell; ++i)
       for (std::size_t j = 0; j < nodes_per_cell; ++j)
@@ -402,21 +549,56 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
   }
 
   // Reorder block graph
+  const std::vector<std::size_t> block_remap
+    = compute_node_reordering(graph, cell_nodes, num_nodes);
+
+  // Re-number dofs
+  renumber_nodes(dofmap, block_remap, block_size);
+}
+//-----------------------------------------------------------------------------
+std::vector<std::size_t>
+DofMapBuilder::compute_node_reordering(const Graph& graph,
+                                       const std::vector<std::size_t>& cell_nodes,
+                                       std::size_t num_nodes)
+{
   const std::string ordering_library
     = dolfin::parameters["dof_ordering_library"];
-  std::vector<std::size_t> block_remap;
+  std::vector<std::size_t> node_remap;
   if (ordering_library == "Boost")
-    block_remap = BoostGraphOrdering::compute_cuthill_mckee(graph, true);
+    node_remap = BoostGraphOrdering::compute_cuthill_mckee(graph, true);
   else if (ordering_library == "SCOTCH")
-    block_remap = SCOTCH::compute_gps(graph);
+    node_remap = SCOTCH::compute_gps(graph);
+  else if (ordering_library == "nested_dissection")
+  {
+    // Default SCOTCH ordering strategy is nested dissection
+    node_remap = SCOTCH::compute_reordering(graph);
+  }
+  else if (ordering_library == "first_touch")
+  {
+    // Number nodes in the order they are first touched by cells
+    const std::size_t unset = std::numeric_limits<std::size_t>::max();
+    node_remap.assign(num_nodes, unset);
+    std::size_t counter = 0;
+    std::vector<std::size_t>::const_iterator node;
+    for (node = cell_nodes.begin(); node != cell_nodes.end(); ++node)
+    {
+      if (*node < num_nodes && node_remap[*node] == unset)
+        node_remap[*node] = counter++;
+    }
+    for (std::size_t i = 0; i < num_nodes; ++i)
+    {
+      if (node_remap[i] == unset)
+        node_remap[i] = counter++;
+    }
+  }
   else if (ordering_library == "random")
   {
     // NOTE: Randomised dof ordering should only be used for
     // testing/benchmarking
-    block_remap.resize(graph.size());
-    for (std::size_t i = 0; i < block_remap.size(); ++i)
-      block_remap[i] = i;
-    std::random_shuffle(block_remap.begin(), block_remap.end());
+    node_remap.resize(num_nodes);
+    for (std::size_t i = 0; i < node_remap.size(); ++i)
+      node_remap[i] = i;
+    std::random_shuffle(node_remap.begin(), node_remap.end());
   }
   else
   {
@@ -424,6 +606,18 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
                  "reorder degrees of freedom",
                  "The requested ordering library '%s' is unknown", ordering_library.c_str());
   }
+  dolfin_assert(node_remap.size() == num_nodes);
+
+  return node_remap;
+}
+//-----------------------------------------------------------------------------
+void DofMapBuilder::renumber_nodes(DofMap& dofmap,
+                                   const std::vector<std::size_t>& node_remap,
+                                   std::size_t block_size)
+{
+  // Number of nodes in UFC numbering
+  const std::size_t num_nodes = dofmap.global_dimension()/block_size;
+  dolfin_assert(node_remap.size() == num_nodes);
 
   // Re-number dofs for each cell
   std::vector<std::vector<dolfin::la_index> >::iterator cell_map;
@@ -434,7 +628,7 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
     for (dof = cell_map->begin(); dof != cell_map->end(); ++dof)
     {
       const std::size_t old_node = (*dof) % num_nodes;
-      const std::size_t new_node = block_remap[old_node];
+      const std::size_t new_node = node_remap[old_node];
       *dof = new_node*block_size + (*dof)/num_nodes;
     }
   }
@@ -444,7 +638,7 @@ void DofMapBuilder::reorder_local(DofMap& dofmap, const Mesh& mesh,
   for (std::size_t i = 0; i < dofmap.global_dimension(); ++i)
   {
     const std::size_t old_node = i % num_nodes;
-    const std::size_t new_node = block_remap[old_node];
+    const std::size_t new_node = node_remap[old_node];
     dofmap.ufc_map_to_dofmap[i] = new_node*block_size + i/num_nodes;
   }
 }
@@ -900,8 +1094,12 @@ DofMapBuilder::parallel_renumber(const boost::array<set, 3>& node_ownership,
   // Clear some data
   dofmap._off_process_owner.clear();
 
-  // Create graph
+  // Create graph, and list of owned nodes (local numbering) in the
+  // order they are touched by cells (only for "first_touch")
   Graph graph(owned_nodes.size());
+  std::vector<std::size_t> cell_nodes;
+  const bool first_touch
+    = std::string(dolfin::parameters["dof_ordering_library"]) == "first_touch";
 
   // Build graph for re-ordering. Below block is scoped to clear working
   // data structures once graph is constructed.
@@ -938,6 +1136,8 @@ DofMapBuilder::parallel_renumber(const boost::array<set, 3>& node_ownership,
         {
           const std::size_t n0_local = n0->second;
           dolfin_assert(n0_local < graph.size());
+          if (first_touch)
+            cell_nodes.push_back(n0_local);
           for (std::size_t j = 0; j < nodes_per_cell; ++j)
           {
             const std::size_t n1_old = dofs1[j] % num_nodes;
@@ -956,29 +1156,8 @@ DofMapBuilder::parallel_renumber(const boost::array<set, 3>& node_ownership,
   }
 
   // Reorder nodes locally
-  // Reorder block graph
-  const std::string ordering_library
-    = dolfin::parameters["dof_ordering_library"];
-  std::vector<std::size_t> node_remap;
-  if (ordering_library == "Boost")
-    node_remap = BoostGraphOrdering::compute_cuthill_mckee(graph, true);
-  else if (ordering_library == "SCOTCH")
-   node_remap = SCOTCH::compute_gps(graph);
-  else if (ordering_library == "random")
-  {
-    // NOTE: Randomised dof ordering should only be used for
-    // testing/benchmarking
-    node_remap.resize(graph.size());
-    for (std::size_t i = 0; i < node_remap.size(); ++i)
-      node_remap[i] = i;
-    std::random_shuffle(node_remap.begin(), node_remap.end());
-  }
-  else
-  {
-    dolfin_error("DofMapBuilder.cpp",
-                 "reorder degrees of freedom",
-                 "The requested ordering library '%s' is unknown", ordering_library.c_str());
-  }
+  const std::vector<std::size_t> node_remap
+    = compute_node_reordering(graph, cell_nodes, graph.size());
 
   // Map from old to new index for dofs
   boost::unordered_map<std::size_t, std::size_t> old_to_new_node_index;
@@ -20,7 +20,7 @@
 // Modified by Mikael Mortensen 2012.
 //
 // First added:  2008-08-12
-// Last changed: 2012-11-05
+// Last changed: 2013-12-11
 
 #ifndef __DOF_MAP_BUILDER_H
 #define __DOF_MAP_BUILDER_H
@@ -33,6 +33,7 @@
 #include <boost/unordered_set.hpp>
 #include <dolfin/common/types.h>
 #include <dolfin/common/Set.h>
+#include <dolfin/graph/Graph.h>
 
 namespace ufc
 {
@@ -84,6 +85,17 @@ namespace dolfin
           std::pair<unsigned int, unsigned int> > > > slave_master_entities,
         boost::shared_ptr<const Restriction> restriction);
 
+    /// Build dofmap on a mesh refined from parent_mesh, on which
+    /// parent_dofmap is defined. The mesh must carry the mesh data
+    /// array "parent_cell". Nodes on cells that have not been refined
+    /// keep the relative order of their parent nodes, and new nodes
+    /// are numbered after these in the order they appear in cells,
+    /// without global re-ordering. Only serial, unconstrained and
+    /// unrestricted dofmaps are supported.
+    static void build_refined(DofMap& dofmap, const Mesh& mesh,
+                              const DofMap& parent_dofmap,
+                              const Mesh& parent_mesh);
+
     /// Build sub-dofmap
     static void build_sub_map(DofMap& sub_dofmap,
                               const DofMap& parent_dofmap,
@@ -110,6 +122,22 @@ namespace dolfin
     static void reorder_local(DofMap& dofmap, const Mesh& mesh,
                               std::size_t block_size);
 
+    // Compute re-ordering (map[old] -> new) of num_nodes nodes with
+    // the strategy given by the parameter "dof_ordering_library".
+    // graph is the node graph (may be empty for "first_touch"), and
+    // cell_nodes lists the nodes in the order they appear in cells
+    // (only needed for "first_touch")
+    static std::vector<std::size_t>
+      compute_node_reordering(const Graph& graph,
+                              const std::vector<std::size_t>& cell_nodes,
+                              std::size_t num_nodes);
+
+    // Re-number dofs given new numbering of the nodes of the UFC
+    // dofmap (blocks of block_size dofs), and store UFC-to-dofmap map
+    static void renumber_nodes(DofMap& dofmap,
+                               const std::vector<std::size_t>& node_remap,
+                               std::size_t block_size);
+
     // Re-order distributed dof map for process locality
     static void reorder_distributed(DofMap& dofmap,
                                    const Mesh& mesh,
@@ -0,0 +1,382 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-11
+// Last changed: 2013-11-11
+
+#include <algorithm>
+#include <sstream>
+
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/NoDeleter.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/common/WorkStealingScheduler.h>
+#include <dolfin/function/Function.h>
+#include <dolfin/function/FunctionSpace.h>
+#include <dolfin/function/GenericFunction.h>
+#include <dolfin/graph/Graph.h>
+#include <dolfin/la/GenericVector.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/Cell.h>
+#include <dolfin/mesh/Facet.h>
+#include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshFunction.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "Form.h"
+#include "GenericDofMap.h"
+#include "UFC.h"
+#include "WorkStealingAssembler.h"
+#include "MatrixFreeOperator.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Create vector with the parallel layout of the dofs of the given
+  // argument of a bilinear form
+  boost::shared_ptr<GenericVector> create_vector(const Form& a, std::size_t i)
+  {
+    if (a.rank() != 2)
+    {
+      dolfin_error("MatrixFreeOperator.cpp",
+                   "create matrix-free operator",
+                   "Expecting a bilinear form (not rank %d)", a.rank());
+    }
+    Function u(a.function_space(i));
+    return u.vector();
+  }
+
+  // Kernel computing the action of the element matrices of a block
+  // of cells
+  class ActionKernel : public WorkStealingScheduler::Kernel
+  {
+  public:
+
+    ActionKernel(const Form& a, const UFC& ufc, std::size_t num_threads,
+                 const std::vector<std::size_t>& block_offsets,
+                 const std::vector<std::size_t>* cell_positions,
+                 const std::vector<std::size_t>* cell_offsets,
+                 const std::vector<double>& x, std::vector<double>& y)
+      : mesh(a.mesh()), block_offsets(block_offsets),
+        cell_positions(cell_positions), cell_offsets(cell_offsets),
+        x(x), y(y),
+        cell_domains(a.cell_domains().get()),
+        exterior_facet_domains(a.exterior_facet_domains().get()),
+        ufc_cells(num_threads), vertex_coordinates(num_threads),
+        buffers(num_threads*WorkStealingScheduler::num_slots)
+    {
+      // Each thread needs its own UFC object
+      for (std::size_t t = 0; t < num_threads; ++t)
+        ufcs.push_back(boost::shared_ptr<UFC>(new UFC(ufc)));
+    }
+
+    void compute(std::size_t block, std::size_t thread, std::size_t slot)
+    {
+      UFC& ufc = *ufcs[thread];
+      ufc::cell& ufc_cell = ufc_cells[thread];
+      std::vector<double>& _vertex_coordinates = vertex_coordinates[thread];
+
+      const bool use_cell_domains = cell_domains && !cell_domains->empty();
+      const bool use_exterior_facet_domains
+        = exterior_facet_domains && !exterior_facet_domains->empty();
+      const bool has_exterior_facet_integrals
+        = ufc.form.has_exterior_facet_integrals();
+
+      // Contributions to y of the cells of the block
+      const std::size_t c0 = block_offsets[block];
+      const std::size_t c1 = block_offsets[block + 1];
+      std::vector<double>& buffer
+        = buffers[thread*WorkStealingScheduler::num_slots + slot];
+      buffer.assign(cell_offsets[0][c1] - cell_offsets[0][c0], 0.0);
+
+      for (std::size_t c = c0; c < c1; ++c)
+      {
+        // Skip cells without dofs
+        const std::size_t m = cell_offsets[0][c + 1] - cell_offsets[0][c];
+        const std::size_t n = cell_offsets[1][c + 1] - cell_offsets[1][c];
+        if (m == 0 || n == 0)
+          continue;
+
+        const Cell cell(mesh, c);
+
+        // Get cell integral for sub domain (if any)
+        const ufc::cell_integral* cell_integral
+          = use_cell_domains ? ufc.get_cell_integral((*cell_domains)[c])
+                             : ufc.default_cell_integral.get();
+
+        // Check for exterior facets
+        bool on_boundary = false;
+        if (has_exterior_facet_integrals)
+        {
+          for (FacetIterator facet(cell); !facet.end(); ++facet)
+            on_boundary = on_boundary || facet->exterior();
+        }
+
+        // Skip if there is nothing to integrate
+        if (!cell_integral && !on_boundary)
+          continue;
+
+        // Update to current cell
+        cell.get_cell_data(ufc_cell);
+        cell.get_vertex_coordinates(_vertex_coordinates);
+        ufc.update(cell, _vertex_coordinates, ufc_cell);
+
+        // Tabulate element matrix
+        if (cell_integral)
+        {
+          cell_integral->tabulate_tensor(ufc.A.data(), ufc.w(),
+                                         _vertex_coordinates.data(),
+                                         ufc_cell.orientation);
+        }
+        else
+          std::fill(ufc.A.begin(), ufc.A.begin() + m*n, 0.0);
+
+        // Add exterior facet contributions
+        if (on_boundary)
+        {
+          for (FacetIterator facet(cell); !facet.end(); ++facet)
+          {
+            if (!facet->exterior())
+              continue;
+
+            const ufc::exterior_facet_integral* facet_integral
+              = use_exterior_facet_domains
+              ? ufc.get_exterior_facet_integral((*exterior_facet_domains)[*facet])
+              : ufc.default_exterior_facet_integral.get();
+            if (!facet_integral)
+              continue;
+
+            const std::size_t local_facet = cell.index(*facet);
+            ufc_cell.local_facet = local_facet;
+            ufc.update(cell, _vertex_coordinates, ufc_cell);
+            facet_integral->tabulate_tensor(ufc.A_facet.data(), ufc.w(),
+                                            _vertex_coordinates.data(),
+                                            local_facet);
+            for (std::size_t i = 0; i < m*n; ++i)
+              ufc.A[i] += ufc.A_facet[i];
+          }
+        }
+
+        // Apply element matrix to entries of x for the cell
+        const std::size_t* x_positions = &cell_positions[1][cell_offsets[1][c]];
+        double* y_cell = &buffer[cell_offsets[0][c] - cell_offsets[0][c0]];
+        for (std::size_t i = 0; i < m; ++i)
+        {
+          const double* A_row = &ufc.A[i*n];
+          double sum = 0.0;
+          for (std::size_t j = 0; j < n; ++j)
+            sum += A_row[j]*x[x_positions[j]];
+          y_cell[i] += sum;
+        }
+      }
+    }
+
+    void insert(std::size_t block, std::size_t thread, std::size_t slot)
+    {
+      const std::vector<double>& buffer
+        = buffers[thread*WorkStealingScheduler::num_slots + slot];
+      const std::size_t* y_positions
+        = &cell_positions[0][cell_offsets[0][block_offsets[block]]];
+      for (std::size_t k = 0; k < buffer.size(); ++k)
+        y[y_positions[k]] += buffer[k];
+    }
+
+  private:
+
+    // Mesh
+    const Mesh& mesh;
+
+    // Cell ranges of blocks
+    const std::vector<std::size_t>& block_offsets;
+
+    // Positions of cell dofs in x and y (test and trial space)
+    const std::vector<std::size_t>* cell_positions;
+    const std::vector<std::size_t>* cell_offsets;
+
+    // Entries of x and y for dofs of local cells
+    const std::vector<double>& x;
+    std::vector<double>& y;
+
+    // Domain markers
+    const MeshFunction<std::size_t>* cell_domains;
+    const MeshFunction<std::size_t>* exterior_facet_domains;
+
+    // Thread-local data
+    std::vector<boost::shared_ptr<UFC> > ufcs;
+    std::vector<ufc::cell> ufc_cells;
+    std::vector<std::vector<double> > vertex_coordinates;
+
+    // Block buffers
+    std::vector<std::vector<double> > buffers;
+
+  };
+}
+
+//-----------------------------------------------------------------------------
+MatrixFreeOperator::MatrixFreeOperator(const Form& a)
+  : LinearOperator(*create_vector(a, 1), *create_vector(a, 0)),
+    _a(reference_to_no_delete_pointer(a))
+{
+  init();
+}
+//-----------------------------------------------------------------------------
+MatrixFreeOperator::MatrixFreeOperator(boost::shared_ptr<const Form> a)
+  : LinearOperator(*create_vector(*a, 1), *create_vector(*a, 0)), _a(a)
+{
+  init();
+}
+//-----------------------------------------------------------------------------
+MatrixFreeOperator::~MatrixFreeOperator()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+std::size_t MatrixFreeOperator::size(std::size_t dim) const
+{
+  dolfin_assert(dim < 2);
+  return _a->function_space(dim)->dim();
+}
+//-----------------------------------------------------------------------------
+void MatrixFreeOperator::mult(const GenericVector& x, GenericVector& y) const
+{
+  Timer timer("Apply matrix-free operator");
+
+  dolfin_assert(_a);
+  const Form& a = *_a;
+
+  // Get entries of x for the trial space dofs of local cells
+  std::vector<double> x_values(_dofs[1].size());
+  if (MPI::num_processes() == 1)
+  {
+    if (!x_values.empty())
+      x.get_local(x_values.data(), x_values.size(), _dofs[1].data());
+  }
+  else
+    x.gather(x_values, _dofs[1]);
+
+  // Create data structure for local assembly data
+  UFC ufc(a);
+
+  // Update off-process coefficients
+  const std::vector<boost::shared_ptr<const GenericFunction> >
+    coefficients = a.coefficients();
+  for (std::size_t i = 0; i < coefficients.size(); ++i)
+    coefficients[i]->update();
+
+  // Number of threads (from parameter system)
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+
+  // Compute action for the test space dofs of local cells
+  std::vector<double> y_values(_dofs[0].size(), 0.0);
+  ActionKernel kernel(a, ufc, num_threads, _block_offsets, _cell_positions,
+                      _cell_offsets, x_values, y_values);
+  _scheduler->run(kernel, num_threads);
+
+  // Add result to y
+  if (y.size() == 0)
+    y.resize(a.function_space(0)->dofmap()->ownership_range());
+  y.zero();
+  if (!y_values.empty())
+    y.add(y_values.data(), y_values.size(), _dofs[0].data());
+  y.apply("add");
+}
+//-----------------------------------------------------------------------------
+std::string MatrixFreeOperator::str(bool verbose) const
+{
+  std::stringstream s;
+  s << "<MatrixFreeOperator of size " << size(0) << " x " << size(1) << ">";
+  return s.str();
+}
+//-----------------------------------------------------------------------------
+void MatrixFreeOperator::init()
+{
+  dolfin_assert(_a);
+  const Form& a = *_a;
+  dolfin_assert(a.ufc_form());
+
+  if (a.ufc_form()->has_interior_facet_integrals())
+  {
+    dolfin_error("MatrixFreeOperator.cpp",
+                 "create matrix-free operator",
+                 "Interior facet integrals are not supported");
+  }
+
+  // Compute facets and facet - cell connectivity if not already computed
+  const Mesh& mesh = a.mesh();
+  const std::size_t D = mesh.topology().dim();
+  if (a.ufc_form()->has_exterior_facet_integrals())
+  {
+    mesh.init(D - 1);
+    mesh.init(D - 1, D);
+    dolfin_assert(mesh.ordered());
+  }
+
+  // Collect dofs of local cells and their positions for the test and
+  // trial spaces
+  const std::size_t num_cells = mesh.num_cells();
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    const GenericDofMap& dofmap = *a.function_space(i)->dofmap();
+    std::vector<std::size_t>& offsets = _cell_offsets[i];
+    std::vector<std::size_t>& positions = _cell_positions[i];
+    offsets.assign(num_cells + 1, 0);
+    positions.clear();
+    for (std::size_t c = 0; c < num_cells; ++c)
+    {
+      const std::vector<dolfin::la_index>& dofs = dofmap.cell_dofs(c);
+      positions.insert(positions.end(), dofs.begin(), dofs.end());
+      offsets[c + 1] = positions.size();
+    }
+
+    _dofs[i].assign(positions.begin(), positions.end());
+    std::sort(_dofs[i].begin(), _dofs[i].end());
+    _dofs[i].erase(std::unique(_dofs[i].begin(), _dofs[i].end()),
+                   _dofs[i].end());
+    for (std::size_t k = 0; k < positions.size(); ++k)
+    {
+      positions[k] = std::lower_bound(_dofs[i].begin(), _dofs[i].end(),
+                                      (dolfin::la_index) positions[k])
+                     - _dofs[i].begin();
+    }
+  }
+
+  // Partition cells into blocks such that the contributions of a
+  // block to y fit in about 32 KB, with enough blocks to balance
+  // threads
+  const std::size_t max_dim
+    = std::max(a.function_space(0)->dofmap()->max_cell_dimension(),
+               (std::size_t) 1);
+  std::size_t block_size = (32*1024)/(sizeof(double)*max_dim);
+  block_size = std::min(block_size, num_cells/64);
+  block_size = std::max(block_size, (std::size_t) 1);
+  _block_offsets.assign(1, 0);
+  while (_block_offsets.back() < num_cells)
+  {
+    _block_offsets.push_back(std::min(_block_offsets.back() + block_size,
+                                      num_cells));
+  }
+
+  // Build scheduler for blocks, which conflict if they share a test
+  // space dof
+  Graph conflicts(_block_offsets.size() - 1);
+  WorkStealingAssembler::build_conflict_graph(conflicts, mesh,
+                                              *a.function_space(0)->dofmap(),
+                                              _block_offsets, false);
+  _scheduler.reset(new WorkStealingScheduler(conflicts));
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-11
+// Last changed: 2013-11-11
+
+#ifndef __MATRIX_FREE_OPERATOR_H
+#define __MATRIX_FREE_OPERATOR_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <dolfin/common/types.h>
+#include <dolfin/la/LinearOperator.h>
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class Form;
+  class GenericVector;
+  class WorkStealingScheduler;
+
+  /// This class defines the linear operator of a bilinear form
+  /// without assembling its matrix. The action y = Ax is computed
+  /// cell by cell: the element matrix of each cell (including the
+  /// contributions of its exterior facets) is tabulated and applied
+  /// to the entries of x for the dofs of the cell, and the result is
+  /// added to the entries of y.
+  ///
+  /// Since the operator implements the _LinearOperator_ interface it
+  /// may be passed directly to the Krylov solvers of the PETSc and
+  /// uBLAS backends. Memory usage is proportional to the number of
+  /// dofs rather than to the number of matrix entries, at the cost of
+  /// recomputing element matrices for each product.
+  ///
+  /// The cell loop is multithreaded when the global parameter
+  /// "num_threads" is positive, using a _WorkStealingScheduler_ over
+  /// blocks of cells. Forms with interior facet integrals are not
+  /// supported.
+
+  class MatrixFreeOperator : public LinearOperator
+  {
+  public:
+
+    /// Create operator for bilinear form
+    ///
+    /// *Arguments*
+    ///     a (_Form_)
+    ///         The bilinear form.
+    explicit MatrixFreeOperator(const Form& a);
+
+    /// Create operator for bilinear form (shared pointer version)
+    ///
+    /// *Arguments*
+    ///     a (_Form_)
+    ///         The bilinear form.
+    explicit MatrixFreeOperator(boost::shared_ptr<const Form> a);
+
+    /// Destructor
+    virtual ~MatrixFreeOperator();
+
+    /// Return size of given dimension
+    virtual std::size_t size(std::size_t dim) const;
+
+    /// Compute matrix-vector product y = Ax
+    virtual void mult(const GenericVector& x, GenericVector& y) const;
+
+    /// Return informal string representation (pretty-print)
+    virtual std::string str(bool verbose) const;
+
+    /// Return bilinear form
+    boost::shared_ptr<const Form> form() const
+    { return _a; }
+
+  private:
+
+    // Initialize dof data and blocks of cells
+    void init();
+
+    // The bilinear form
+    boost::shared_ptr<const Form> _a;
+
+    // Test (0) and trial (1) space dofs of local cells, and for each
+    // cell the positions of its dofs in these lists (compressed
+    // storage)
+    std::vector<dolfin::la_index> _dofs[2];
+    std::vector<std::size_t> _cell_positions[2];
+    std::vector<std::size_t> _cell_offsets[2];
+
+    // Cell ranges of blocks, and scheduler for blocks (blocks
+    // conflict if they share a test space dof)
+    std::vector<std::size_t> _block_offsets;
+    boost::shared_ptr<WorkStealingScheduler> _scheduler;
+
+  };
+
+}
+
+#endif
@@ -21,7 +21,7 @@
 // Modified by Martin Alnaes 2013
 //
 // First added:  2009-06-22
-// Last changed: 2013-08-01
+// Last changed: 2013-11-12
 
 #include <Eigen/Dense>
 #include <boost/array.hpp>
@@ -48,7 +48,7 @@ using namespace dolfin;
 
 //-----------------------------------------------------------------------------
 SystemAssembler::SystemAssembler(const Form& a, const Form& L)
-  : _a(reference_to_no_delete_pointer(a)),
+  : reuse_boundary_matrices(false), _a(reference_to_no_delete_pointer(a)),
     _L(reference_to_no_delete_pointer(L))
 {
   // Check arity of forms
@@ -57,7 +57,7 @@ SystemAssembler::SystemAssembler(const Form& a, const Form& L)
 //-----------------------------------------------------------------------------
 SystemAssembler::SystemAssembler(const Form& a, const Form& L,
                                  const DirichletBC& bc)
-  : _a(reference_to_no_delete_pointer(a)),
+  : reuse_boundary_matrices(false), _a(reference_to_no_delete_pointer(a)),
     _L(reference_to_no_delete_pointer(L))
 {
   // Check arity of forms
@@ -69,7 +69,7 @@ SystemAssembler::SystemAssembler(const Form& a, const Form& L,
 //-----------------------------------------------------------------------------
 SystemAssembler::SystemAssembler(const Form& a, const Form& L,
                                  const std::vector<const DirichletBC*> bcs)
-  : _a(reference_to_no_delete_pointer(a)),
+  : reuse_boundary_matrices(false), _a(reference_to_no_delete_pointer(a)),
     _L(reference_to_no_delete_pointer(L)), _bcs(bcs)
 {
   // Check arity of forms
@@ -78,7 +78,7 @@ SystemAssembler::SystemAssembler(const Form& a, const Form& L,
 //-----------------------------------------------------------------------------
 SystemAssembler::SystemAssembler(boost::shared_ptr<const Form> a,
                                  boost::shared_ptr<const Form> L)
-  : _a(a), _L(L)
+  : reuse_boundary_matrices(false), _a(a), _L(L)
 {
   // Check arity of forms
   check_arity(_a, _L);
@@ -87,7 +87,7 @@ SystemAssembler::SystemAssembler(boost::shared_ptr<const Form> a,
 SystemAssembler::SystemAssembler(boost::shared_ptr<const Form> a,
                                  boost::shared_ptr<const Form> L,
                                  const DirichletBC& bc)
-  : _a(a), _L(L)
+  : reuse_boundary_matrices(false), _a(a), _L(L)
 {
   // Check arity of forms
   check_arity(_a, _L);
@@ -99,7 +99,7 @@ SystemAssembler::SystemAssembler(boost::shared_ptr<const Form> a,
 SystemAssembler::SystemAssembler(boost::shared_ptr<const Form> a,
                                  boost::shared_ptr<const Form> L,
                                  const std::vector<const DirichletBC*> bcs)
-  : _a(a), _L(L), _bcs(bcs)
+  : reuse_boundary_matrices(false), _a(a), _L(L), _bcs(bcs)
 {
   // Check arity of forms
   check_arity(_a, _L);
@@ -131,6 +131,11 @@ void SystemAssembler::assemble(GenericVector& b, const GenericVector& x0)
   assemble(NULL, &b, &x0);
 }
 //-----------------------------------------------------------------------------
+void SystemAssembler::clear_boundary_matrices()
+{
+  _boundary_matrices.clear();
+}
+//-----------------------------------------------------------------------------
 void SystemAssembler::check_arity(boost::shared_ptr<const Form> a,
                                   boost::shared_ptr<const Form> L)
 {
@@ -289,9 +294,20 @@ problems is untested");
   if (!ufc[0]->form.has_interior_facet_integrals()
       && !ufc[1]->form.has_interior_facet_integrals())
   {
+    // Store element matrices of cells with Dirichlet dofs, or reuse
+    // them if only the vector is assembled
+    BoundaryMatrices* boundary_matrices = NULL;
+    if (reuse_boundary_matrices)
+    {
+      if (A || !_boundary_matrices.valid(mesh, boundary_values.size()))
+        _boundary_matrices.init(mesh, boundary_values.size());
+      boundary_matrices = &_boundary_matrices;
+    }
+
     // Assemble cell-wise (no interior facet integrals)
     cell_wise_assembly(tensors, ufc, data, boundary_values,
-                       cell_domains, exterior_facet_domains);
+                       cell_domains, exterior_facet_domains,
+                       boundary_matrices);
   }
   else
   {
@@ -334,7 +350,8 @@ SystemAssembler::cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
                                     Scratch& data,
                                     const DirichletBC::Map& boundary_values,
                                     const MeshFunction<std::size_t>* cell_domains,
-                                    const MeshFunction<std::size_t>* exterior_facet_domains)
+                                    const MeshFunction<std::size_t>* exterior_facet_domains,
+                                    BoundaryMatrices* boundary_matrices)
 {
   // Extract mesh
   const Mesh& mesh = ufc[0]->dolfin_form.mesh();
@@ -375,6 +392,13 @@ SystemAssembler::cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
   bool use_exterior_facet_domains
     = exterior_facet_domains && !exterior_facet_domains->empty();
 
+  // Reuse stored element matrices of cells with Dirichlet dofs if
+  // only the vector is assembled, otherwise store them (if requested)
+  const bool reuse_matrices = boundary_matrices
+    && boundary_matrices->available && !tensors[0];
+  const bool store_matrices = boundary_matrices && !reuse_matrices;
+  std::size_t boundary_cell = 0;
+
   // Iterate over all cells
   ufc::cell ufc_cell;
   std::vector<double> vertex_coordinates;
@@ -384,8 +408,28 @@ SystemAssembler::cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
     // Get cell vertex coordinates
     cell->get_vertex_coordinates(vertex_coordinates);
 
+    // Get stored element matrix if cell has Dirichlet dofs
+    bool has_stored_matrix = false;
+    if (reuse_matrices)
+    {
+      for (std::size_t dim = 0; dim < 2; ++dim)
+        cell_dofs[0][dim] = &(dofmaps[0][dim]->cell_dofs(cell->index()));
+
+      const std::vector<std::size_t>& cells = boundary_matrices->cells;
+      if (boundary_cell < cells.size()
+          && cells[boundary_cell] == cell->index())
+      {
+        const std::vector<std::size_t>& offsets = boundary_matrices->offsets;
+        std::copy(boundary_matrices->matrices.begin() + offsets[boundary_cell],
+                  boundary_matrices->matrices.begin() + offsets[boundary_cell + 1],
+                  data.Ae[0].begin());
+        has_stored_matrix = true;
+        ++boundary_cell;
+      }
+    }
+
     // Loop over lhs and then rhs contributions
-    for (std::size_t form = 0; form < 2; ++form)
+    for (std::size_t form = reuse_matrices ? 1 : 0; form < 2; ++form)
     {
       // Get rank (lhs=2, rhs=1)
       const std::size_t rank = (form == 0) ? 2 : 1;
@@ -486,9 +530,21 @@ SystemAssembler::cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
     // Check dofmap is the same for LHS columns and RHS vector
     dolfin_assert(cell_dofs[1][0] == cell_dofs[0][1]);
 
+    // Store element matrix if cell has Dirichlet dofs
+    if (store_matrices && has_bc(boundary_values, *cell_dofs[0][1]))
+    {
+      boundary_matrices->add(cell->index(), data.Ae[0].data(),
+                             cell_dofs[0][0]->size()*cell_dofs[0][1]->size());
+    }
+
     // Modify local matrix/element for Dirichlet boundary conditions
-    apply_bc(data.Ae[0].data(), data.Ae[1].data(), boundary_values,
-             *cell_dofs[0][0], *cell_dofs[0][1]);
+    // (cells without stored matrices have no Dirichlet dofs when
+    // reusing matrices)
+    if (!reuse_matrices || has_stored_matrix)
+    {
+      apply_bc(data.Ae[0].data(), data.Ae[1].data(), boundary_values,
+               *cell_dofs[0][0], *cell_dofs[0][1]);
+    }
 
     // Add entries to global tensor
     for (std::size_t form = 0; form < 2; ++form)
@@ -499,6 +555,9 @@ SystemAssembler::cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
 
     p++;
   }
+
+  if (store_matrices)
+    boundary_matrices->available = true;
 }
 //-----------------------------------------------------------------------------
 void
@@ -922,3 +981,42 @@ inline void SystemAssembler::Scratch::zero_cell()
   std::fill(Ae[1].begin(), Ae[1].end(), 0.0);
 }
 //-----------------------------------------------------------------------------
+SystemAssembler::BoundaryMatrices::BoundaryMatrices()
+  : available(false), mesh_id(0), num_cells(0), num_bc_dofs(0)
+{
+  clear();
+}
+//-----------------------------------------------------------------------------
+void SystemAssembler::BoundaryMatrices::clear()
+{
+  available = false;
+  cells.clear();
+  offsets.assign(1, 0);
+  matrices.clear();
+}
+//-----------------------------------------------------------------------------
+bool SystemAssembler::BoundaryMatrices::valid(const Mesh& mesh,
+                                              std::size_t num_bc_dofs) const
+{
+  return available && mesh.id() == mesh_id
+    && mesh.num_cells() == num_cells && num_bc_dofs == this->num_bc_dofs;
+}
+//-----------------------------------------------------------------------------
+void SystemAssembler::BoundaryMatrices::init(const Mesh& mesh,
+                                             std::size_t num_bc_dofs)
+{
+  clear();
+  mesh_id = mesh.id();
+  num_cells = mesh.num_cells();
+  this->num_bc_dofs = num_bc_dofs;
+}
+//-----------------------------------------------------------------------------
+void SystemAssembler::BoundaryMatrices::add(std::size_t cell, const double* Ae,
+                                            std::size_t size)
+{
+  dolfin_assert(cells.empty() || cell > cells.back());
+  cells.push_back(cell);
+  matrices.insert(matrices.end(), Ae, Ae + size);
+  offsets.push_back(matrices.size());
+}
+//-----------------------------------------------------------------------------
@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2008-2011
 //
 // First added:  2009-06-22
-// Last changed: 2013-04-23
+// Last changed: 2013-11-12
 
 #ifndef __SYSTEM_ASSEMBLER_H
 #define __SYSTEM_ASSEMBLER_H
@@ -44,6 +44,7 @@ namespace dolfin
   class Form;
   class GenericMatrix;
   class GenericVector;
+  class Mesh;
   template<typename T> class MeshFunction;
   class UFC;
 
@@ -80,6 +81,23 @@ namespace dolfin
                     boost::shared_ptr<const Form> L,
                     const std::vector<const DirichletBC*> bcs);
 
+    /// reuse_boundary_matrices (bool)
+    ///     Default value is false.
+    ///     This controls whether element matrices of cells with
+    ///     Dirichlet dofs are stored, and reused to lift the boundary
+    ///     conditions into b when only the vector b is assembled. The
+    ///     stored matrices are recomputed whenever A is assembled (or
+    ///     when b is first assembled), so the bilinear form must not
+    ///     change between assemblies of b only. The cached matrices
+    ///     are also discarded if the mesh or the number of Dirichlet
+    ///     dofs changes. Boundary values are evaluated on each call,
+    ///     so time-dependent boundary conditions are supported.
+    ///     Only used for forms without interior facet integrals.
+    bool reuse_boundary_matrices;
+
+    /// Discard stored element matrices of cells with Dirichlet dofs
+    void clear_boundary_matrices();
+
     /// Assemble system (A, b)
     void assemble(GenericMatrix& A, GenericVector& b);
 
@@ -116,6 +134,7 @@ namespace dolfin
     std::vector<const DirichletBC*> _bcs;
 
     class Scratch;
+    class BoundaryMatrices;
 
     static void
       cell_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
@@ -123,7 +142,8 @@ namespace dolfin
                          Scratch& data,
                          const DirichletBC::Map& boundary_values,
                          const MeshFunction<std::size_t>* cell_domains,
-                       const MeshFunction<std::size_t>* exterior_facet_domains);
+                       const MeshFunction<std::size_t>* exterior_facet_domains,
+                         BoundaryMatrices* boundary_matrices);
 
     static void
     facet_wise_assembly(boost::array<GenericTensor*, 2>& tensors,
@@ -165,6 +185,43 @@ namespace dolfin
 
     };
 
+    // Class to hold element matrices of cells with Dirichlet dofs
+    class BoundaryMatrices
+    {
+    public:
+
+      BoundaryMatrices();
+
+      // Discard stored matrices
+      void clear();
+
+      // Check whether stored matrices may be reused
+      bool valid(const Mesh& mesh, std::size_t num_bc_dofs) const;
+
+      // Start storing matrices
+      void init(const Mesh& mesh, std::size_t num_bc_dofs);
+
+      // Store element matrix of cell (cells must be added in
+      // increasing order)
+      void add(std::size_t cell, const double* Ae, std::size_t size);
+
+      // True if matrices are available
+      bool available;
+
+      // Mesh id, number of cells and number of Dirichlet dofs for which
+      // matrices were stored
+      std::size_t mesh_id, num_cells, num_bc_dofs;
+
+      // Cells and their element matrices (compressed storage)
+      std::vector<std::size_t> cells;
+      std::vector<std::size_t> offsets;
+      std::vector<double> matrices;
+
+    };
+
+    // Stored element matrices of cells with Dirichlet dofs
+    BoundaryMatrices _boundary_matrices;
+
   };
 
 }
@@ -140,6 +140,24 @@ void UFC::update(const Cell& c, const std::vector<double>& vertex_coordinates,
   }
 }
 //-----------------------------------------------------------------------------
+void UFC::update(const Cell& c, const std::vector<double>& vertex_coordinates,
+                 const ufc::cell& ufc_cell, double * const * w) const
+{
+  // Restrict coefficients to cell
+  for (std::size_t i = 0; i < coefficients.size(); ++i)
+  {
+    dolfin_assert(coefficients[i]);
+    coefficients[i]->restrict(w[i], coefficient_elements[i], c,
+                              vertex_coordinates.data(), ufc_cell);
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t UFC::coefficient_dimension(std::size_t i) const
+{
+  dolfin_assert(i < coefficient_elements.size());
+  return coefficient_elements[i].space_dimension();
+}
+//-----------------------------------------------------------------------------
 void UFC::update(const Cell& c0, const std::vector<double>& vertex_coordinates0,
                  const ufc::cell& ufc_cell0,
                  const Cell& c1, const std::vector<double>& vertex_coordinates1,
@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells 2009
 //
 // First added:  2007-01-17
-// Last changed: 2013-02-26
+// Last changed: 2013-11-06
 
 #ifndef __UFC_DATA_H
 #define __UFC_DATA_H
@@ -72,6 +72,17 @@ namespace dolfin
                 const std::vector<double>& vertex_coordinates1,
                 const ufc::cell& ufc_cell1);
 
+    /// Restrict coefficients to current cell, storing the expansion
+    /// coefficients of coefficient i in w[i] instead of the internal
+    /// coefficient data. Used for batched assembly.
+    void update(const Cell& cell,
+                const std::vector<double>& vertex_coordinates,
+                const ufc::cell& ufc_cell,
+                double * const * w) const;
+
+    /// Return dimension of expansion coefficients of coefficient i
+    std::size_t coefficient_dimension(std::size_t i) const;
+
     /// Pointer to coefficient data. Used to support UFC interface.
     const double* const * w() const
     { return &w_pointer[0]; }
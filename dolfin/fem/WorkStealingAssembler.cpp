@@ -0,0 +1,744 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-04
+// Last changed: 2013-11-04
+
+#include <algorithm>
+#include <numeric>
+#include <boost/shared_ptr.hpp>
+
+#include <dolfin/log/dolfin_log.h>
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/common/WorkStealingScheduler.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include <dolfin/la/GenericTensor.h>
+#include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/Cell.h>
+#include <dolfin/mesh/Facet.h>
+#include <dolfin/mesh/MeshData.h>
+#include <dolfin/mesh/MeshFunction.h>
+#include <dolfin/function/GenericFunction.h>
+#include <dolfin/function/FunctionSpace.h>
+#include "GenericDofMap.h"
+#include "Form.h"
+#include "UFC.h"
+#include "WorkStealingAssembler.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Element tensors of a block of entities, or the locally
+  // accumulated contribution of the block for rank one forms
+  struct BlockBuffer
+  {
+    // Number of rows in each dimension for each entity
+    std::vector<dolfin::la_index> num_rows;
+
+    // Rows for each dimension, concatenated over entities
+    std::vector<std::vector<dolfin::la_index> > rows;
+
+    // Element tensors, concatenated over entities
+    std::vector<double> values;
+  };
+
+  // Get cells of entities of block (the cells of interior facets if
+  // facets is true)
+  void block_cells(std::vector<std::size_t>& cells, const Mesh& mesh,
+                   const std::vector<std::size_t>& offsets, std::size_t b,
+                   bool facets)
+  {
+    cells.clear();
+    if (!facets)
+    {
+      for (std::size_t c = offsets[b]; c < offsets[b + 1]; ++c)
+        cells.push_back(c);
+      return;
+    }
+
+    const std::size_t D = mesh.topology().dim();
+    const MeshConnectivity& facet_cells = mesh.topology()(D - 1, D);
+    for (std::size_t f = offsets[b]; f < offsets[b + 1]; ++f)
+    {
+      if (facet_cells.size(f) == 2)
+      {
+        cells.push_back(facet_cells(f)[0]);
+        cells.push_back(facet_cells(f)[1]);
+      }
+    }
+  }
+
+  // Base class for kernels, handling per-block buffers and insertion
+  // into the global tensor
+  class BlockKernel : public WorkStealingScheduler::Kernel
+  {
+  public:
+
+    BlockKernel(GenericTensor& A, const Form& a, const UFC& ufc,
+                std::size_t num_threads,
+                const std::vector<std::size_t>& offsets)
+      : A(A), mesh(a.mesh()), offsets(offsets), form_rank(ufc.form.rank()),
+        scalars(num_threads, 0.0), ufc_cells(num_threads),
+        buffers(num_threads*WorkStealingScheduler::num_slots),
+        positions(num_threads)
+    {
+      for (std::size_t i = 0; i < form_rank; ++i)
+        dofmaps.push_back(a.function_space(i)->dofmap().get());
+
+      // Each thread needs its own UFC object
+      for (std::size_t t = 0; t < num_threads; ++t)
+        ufcs.push_back(boost::shared_ptr<UFC>(new UFC(ufc)));
+
+      // Rows of each buffer
+      for (std::size_t i = 0; i < buffers.size(); ++i)
+        buffers[i].rows.resize(form_rank);
+
+      // Positions of rows in local accumulation of rank one forms
+      if (form_rank == 1)
+      {
+        for (std::size_t t = 0; t < num_threads; ++t)
+          positions[t].resize(dofmaps[0]->global_dimension(), -1);
+      }
+    }
+
+    void insert(std::size_t block, std::size_t thread, std::size_t slot)
+    {
+      BlockBuffer& buffer = this->buffer(thread, slot);
+      if (form_rank == 0 || buffer.num_rows.empty())
+        return;
+
+      // Add entity tensors (or the accumulated vector) to global tensor
+      const std::size_t num_entities = buffer.num_rows.size()/form_rank;
+      std::vector<const dolfin::la_index*> rows(form_rank);
+      std::vector<std::size_t> row_offsets(form_rank, 0);
+      std::size_t value_offset = 0;
+      for (std::size_t e = 0; e < num_entities; ++e)
+      {
+        const dolfin::la_index* num_rows = &buffer.num_rows[e*form_rank];
+        std::size_t dim = 1;
+        for (std::size_t i = 0; i < form_rank; ++i)
+        {
+          rows[i] = &buffer.rows[i][row_offsets[i]];
+          row_offsets[i] += num_rows[i];
+          dim *= num_rows[i];
+        }
+        A.add(&buffer.values[value_offset], num_rows, rows.data());
+        value_offset += dim;
+      }
+    }
+
+    // Add contribution of thread-local scalars to global tensor
+    void add_scalars()
+    {
+      if (form_rank != 0)
+        return;
+      const double sum = std::accumulate(scalars.begin(), scalars.end(), 0.0);
+      const std::vector<const std::vector<dolfin::la_index>* > no_rows;
+      A.add(&sum, no_rows);
+    }
+
+  protected:
+
+    // Return buffer for slot of thread
+    BlockBuffer& buffer(std::size_t thread, std::size_t slot)
+    { return buffers[thread*WorkStealingScheduler::num_slots + slot]; }
+
+    // Clear buffer before computing a block
+    void clear(BlockBuffer& buffer) const
+    {
+      buffer.num_rows.clear();
+      buffer.values.clear();
+      for (std::size_t i = 0; i < form_rank; ++i)
+        buffer.rows[i].clear();
+    }
+
+    // Store element tensor for entity with the given dofs
+    void store(BlockBuffer& buffer, std::size_t thread,
+               const std::vector<double>& tensor,
+               const std::vector<const std::vector<dolfin::la_index>* >& dofs)
+    {
+      // Scalars are accumulated per thread
+      if (form_rank == 0)
+      {
+        scalars[thread] += tensor[0];
+        return;
+      }
+
+      // Vectors are accumulated per block
+      if (form_rank == 1)
+      {
+        std::vector<int>& position = positions[thread];
+        const std::vector<dolfin::la_index>& _dofs = *dofs[0];
+        for (std::size_t i = 0; i < _dofs.size(); ++i)
+        {
+          int& p = position[_dofs[i]];
+          if (p < 0)
+          {
+            p = buffer.values.size();
+            buffer.rows[0].push_back(_dofs[i]);
+            buffer.values.push_back(0.0);
+          }
+          buffer.values[p] += tensor[i];
+        }
+        return;
+      }
+
+      // Element matrices are stored
+      std::size_t dim = 1;
+      for (std::size_t i = 0; i < form_rank; ++i)
+      {
+        buffer.num_rows.push_back(dofs[i]->size());
+        buffer.rows[i].insert(buffer.rows[i].end(), dofs[i]->begin(),
+                              dofs[i]->end());
+        dim *= dofs[i]->size();
+      }
+      buffer.values.insert(buffer.values.end(), tensor.begin(),
+                           tensor.begin() + dim);
+    }
+
+    // Finish accumulation of block for rank one forms
+    void finish(BlockBuffer& buffer, std::size_t thread)
+    {
+      if (form_rank != 1)
+        return;
+      std::vector<int>& position = positions[thread];
+      for (std::size_t i = 0; i < buffer.rows[0].size(); ++i)
+        position[buffer.rows[0][i]] = -1;
+      if (!buffer.rows[0].empty())
+        buffer.num_rows.push_back(buffer.rows[0].size());
+    }
+
+    // Global tensor
+    GenericTensor& A;
+
+    // Mesh
+    const Mesh& mesh;
+
+    // Entity ranges of blocks
+    const std::vector<std::size_t>& offsets;
+
+    // Form rank
+    const std::size_t form_rank;
+
+    // Dofmaps
+    std::vector<const GenericDofMap*> dofmaps;
+
+    // Thread-local data
+    std::vector<double> scalars;
+    std::vector<boost::shared_ptr<UFC> > ufcs;
+    std::vector<ufc::cell> ufc_cells;
+
+    // Block buffers
+    std::vector<BlockBuffer> buffers;
+
+    // Thread-local map from rows to position in block buffer
+    std::vector<std::vector<int> > positions;
+
+  };
+
+  // Kernel for cells and exterior facets
+  class CellKernel : public BlockKernel
+  {
+  public:
+
+    CellKernel(GenericTensor& A, const Form& a, const UFC& ufc,
+               std::size_t num_threads,
+               const std::vector<std::size_t>& offsets,
+               const MeshFunction<std::size_t>* cell_domains,
+               const MeshFunction<std::size_t>* exterior_facet_domains)
+      : BlockKernel(A, a, ufc, num_threads, offsets),
+        cell_domains(cell_domains),
+        exterior_facet_domains(exterior_facet_domains),
+        vertex_coordinates(num_threads), dofs(num_threads)
+    {
+      for (std::size_t t = 0; t < num_threads; ++t)
+        dofs[t].resize(form_rank);
+    }
+
+    void compute(std::size_t block, std::size_t thread, std::size_t slot)
+    {
+      BlockBuffer& buffer = this->buffer(thread, slot);
+      clear(buffer);
+
+      UFC& ufc = *ufcs[thread];
+      ufc::cell& ufc_cell = ufc_cells[thread];
+      std::vector<double>& _vertex_coordinates = vertex_coordinates[thread];
+      std::vector<const std::vector<dolfin::la_index>* >& _dofs
+        = dofs[thread];
+
+      const bool use_cell_domains = cell_domains && !cell_domains->empty();
+      const bool use_exterior_facet_domains
+        = exterior_facet_domains && !exterior_facet_domains->empty();
+      const bool has_exterior_facet_integrals
+        = ufc.form.has_exterior_facet_integrals();
+
+      for (std::size_t c = offsets[block]; c < offsets[block + 1]; ++c)
+      {
+        const Cell cell(mesh, c);
+
+        // Get cell integral for sub domain (if any)
+        const ufc::cell_integral* cell_integral
+          = use_cell_domains ? ufc.get_cell_integral((*cell_domains)[c])
+                             : ufc.default_cell_integral.get();
+
+        // Check for exterior facets
+        bool on_boundary = false;
+        if (has_exterior_facet_integrals)
+        {
+          for (FacetIterator facet(cell); !facet.end(); ++facet)
+            on_boundary = on_boundary || facet->exterior();
+        }
+
+        // Skip if there is nothing to integrate
+        if (!cell_integral && !on_boundary)
+          continue;
+
+        // Get local-to-global dof maps for cell
+        bool empty_dofmap = false;
+        std::size_t dim = 1;
+        for (std::size_t i = 0; i < form_rank; ++i)
+        {
+          _dofs[i] = &(dofmaps[i]->cell_dofs(c));
+          empty_dofmap = empty_dofmap || _dofs[i]->empty();
+          dim *= _dofs[i]->size();
+        }
+        if (empty_dofmap)
+          continue;
+
+        // Update to current cell
+        cell.get_cell_data(ufc_cell);
+        cell.get_vertex_coordinates(_vertex_coordinates);
+        ufc.update(cell, _vertex_coordinates, ufc_cell);
+
+        // Tabulate cell tensor
+        if (cell_integral)
+        {
+          cell_integral->tabulate_tensor(ufc.A.data(), ufc.w(),
+                                         _vertex_coordinates.data(),
+                                         ufc_cell.orientation);
+        }
+        else
+          std::fill(ufc.A.begin(), ufc.A.begin() + dim, 0.0);
+
+        // Add exterior facet contributions
+        if (on_boundary)
+        {
+          for (FacetIterator facet(cell); !facet.end(); ++facet)
+          {
+            if (!facet->exterior())
+              continue;
+
+            const ufc::exterior_facet_integral* facet_integral
+              = use_exterior_facet_domains
+              ? ufc.get_exterior_facet_integral((*exterior_facet_domains)[*facet])
+              : ufc.default_exterior_facet_integral.get();
+            if (!facet_integral)
+              continue;
+
+            const std::size_t local_facet = cell.index(*facet);
+            ufc_cell.local_facet = local_facet;
+            ufc.update(cell, _vertex_coordinates, ufc_cell);
+            facet_integral->tabulate_tensor(ufc.A_facet.data(), ufc.w(),
+                                            _vertex_coordinates.data(),
+                                            local_facet);
+            for (std::size_t i = 0; i < dim; ++i)
+              ufc.A[i] += ufc.A_facet[i];
+          }
+        }
+
+        store(buffer, thread, ufc.A, _dofs);
+      }
+
+      finish(buffer, thread);
+    }
+
+  private:
+
+    // Domain markers
+    const MeshFunction<std::size_t>* cell_domains;
+    const MeshFunction<std::size_t>* exterior_facet_domains;
+
+    // Thread-local data
+    std::vector<std::vector<double> > vertex_coordinates;
+    std::vector<std::vector<const std::vector<dolfin::la_index>* > > dofs;
+
+  };
+
+  // Kernel for interior facets
+  class InteriorFacetKernel : public BlockKernel
+  {
+  public:
+
+    InteriorFacetKernel(GenericTensor& A, const Form& a, const UFC& ufc,
+                        std::size_t num_threads,
+                        const std::vector<std::size_t>& offsets,
+                        const MeshFunction<std::size_t>* domains,
+                        const std::vector<std::size_t>* facet_orientation)
+      : BlockKernel(A, a, ufc, num_threads, offsets), domains(domains),
+        facet_orientation(facet_orientation), ufc_cells1(num_threads),
+        vertex_coordinates0(num_threads), vertex_coordinates1(num_threads),
+        macro_dofs(num_threads), macro_dof_ptrs(num_threads)
+    {
+      for (std::size_t t = 0; t < num_threads; ++t)
+      {
+        macro_dofs[t].resize(form_rank);
+        for (std::size_t i = 0; i < form_rank; ++i)
+          macro_dof_ptrs[t].push_back(&macro_dofs[t][i]);
+      }
+    }
+
+    void compute(std::size_t block, std::size_t thread, std::size_t slot)
+    {
+      BlockBuffer& buffer = this->buffer(thread, slot);
+      clear(buffer);
+
+      UFC& ufc = *ufcs[thread];
+      const bool use_domains = domains && !domains->empty();
+
+      for (std::size_t f = offsets[block]; f < offsets[block + 1]; ++f)
+      {
+        const Facet facet(mesh, f);
+
+        // Only consider interior facets
+        if (facet.exterior())
+          continue;
+
+        // Get integral for sub domain (if any)
+        const ufc::interior_facet_integral* integral
+          = use_domains ? ufc.get_interior_facet_integral((*domains)[f])
+                        : ufc.default_interior_facet_integral.get();
+        if (!integral)
+          continue;
+
+        // Get cells incident with facet
+        std::pair<const Cell, const Cell> cells
+          = facet.adjacent_cells(facet_orientation);
+        const Cell& cell0 = cells.first;
+        const Cell& cell1 = cells.second;
+
+        // Get local index of facet with respect to each cell
+        const std::size_t local_facet0 = cell0.index(facet);
+        const std::size_t local_facet1 = cell1.index(facet);
+
+        // Update to current pair of cells
+        cell0.get_cell_data(ufc_cells[thread], local_facet0);
+        cell0.get_vertex_coordinates(vertex_coordinates0[thread]);
+        cell1.get_cell_data(ufc_cells1[thread], local_facet1);
+        cell1.get_vertex_coordinates(vertex_coordinates1[thread]);
+        ufc.update(cell0, vertex_coordinates0[thread], ufc_cells[thread],
+                   cell1, vertex_coordinates1[thread], ufc_cells1[thread]);
+
+        // Tabulate dofs for each dimension on macro element
+        for (std::size_t i = 0; i < form_rank; ++i)
+        {
+          const std::vector<dolfin::la_index>& cell_dofs0
+            = dofmaps[i]->cell_dofs(cell0.index());
+          const std::vector<dolfin::la_index>& cell_dofs1
+            = dofmaps[i]->cell_dofs(cell1.index());
+          macro_dofs[thread][i].assign(cell_dofs0.begin(), cell_dofs0.end());
+          macro_dofs[thread][i].insert(macro_dofs[thread][i].end(),
+                                       cell_dofs1.begin(), cell_dofs1.end());
+        }
+
+        // Tabulate interior facet tensor on macro element
+        integral->tabulate_tensor(ufc.macro_A.data(), ufc.macro_w(),
+                                  vertex_coordinates0[thread].data(),
+                                  vertex_coordinates1[thread].data(),
+                                  local_facet0, local_facet1);
+
+        store(buffer, thread, ufc.macro_A, macro_dof_ptrs[thread]);
+      }
+
+      finish(buffer, thread);
+    }
+
+  private:
+
+    // Domain markers
+    const MeshFunction<std::size_t>* domains;
+
+    // Facet orientation (may be null)
+    const std::vector<std::size_t>* facet_orientation;
+
+    // Thread-local data
+    std::vector<ufc::cell> ufc_cells1;
+    std::vector<std::vector<double> > vertex_coordinates0;
+    std::vector<std::vector<double> > vertex_coordinates1;
+    std::vector<std::vector<std::vector<dolfin::la_index> > > macro_dofs;
+    std::vector<std::vector<const std::vector<dolfin::la_index>* > >
+      macro_dof_ptrs;
+
+  };
+}
+
+//-----------------------------------------------------------------------------
+void WorkStealingAssembler::assemble(GenericTensor& A, const Form& a)
+{
+  if (MPI::num_processes() > 1)
+  {
+    dolfin_error("WorkStealingAssembler.cpp",
+                 "perform multithreaded assembly using work stealing assembler",
+                 "The work stealing assembler has not been tested in combination with MPI");
+  }
+
+  dolfin_assert(a.ufc_form());
+
+  // Get cell domains
+  const MeshFunction<std::size_t>* cell_domains = a.cell_domains().get();
+
+  // Get exterior facet domains
+  const MeshFunction<std::size_t>* exterior_facet_domains
+    = a.exterior_facet_domains().get();
+
+  // Get interior facet domains
+  const MeshFunction<std::size_t>* interior_facet_domains
+    = a.interior_facet_domains().get();
+
+  // Check form
+  AssemblerBase::check(a);
+
+  // Create data structure for local assembly data
+  UFC ufc(a);
+
+  // Update off-process coefficients
+  const std::vector<boost::shared_ptr<const GenericFunction> >
+    coefficients = a.coefficients();
+  for (std::size_t i = 0; i < coefficients.size(); ++i)
+    coefficients[i]->update();
+
+  // Initialize global tensor
+  init_global_tensor(A, a);
+
+  // Assemble over cells and exterior facets
+  assemble_cells_and_exterior_facets(A, a, ufc, cell_domains,
+                                     exterior_facet_domains);
+
+  // Assemble over interior facets
+  assemble_interior_facets(A, a, ufc, interior_facet_domains);
+
+  // Finalize assembly of global tensor
+  if (finalize_tensor)
+    A.apply("add");
+}
+//-----------------------------------------------------------------------------
+void WorkStealingAssembler::build_conflict_graph(Graph& graph,
+                                        const Mesh& mesh,
+                                        const GenericDofMap& dofmap,
+                                        const std::vector<std::size_t>& offsets,
+                                        bool facets)
+{
+  dolfin_assert(!offsets.empty());
+  const std::size_t num_blocks = offsets.size() - 1;
+  const std::size_t num_dofs = dofmap.global_dimension();
+
+  graph.clear();
+  graph.resize(num_blocks);
+
+  // Build map from dofs to blocks (compressed storage, two passes)
+  std::vector<std::size_t> cells;
+  std::vector<std::size_t> dof_offsets(num_dofs + 1, 0);
+  std::vector<std::size_t> last_block(num_dofs, num_blocks);
+  for (std::size_t b = 0; b < num_blocks; ++b)
+  {
+    block_cells(cells, mesh, offsets, b, facets);
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      const std::vector<dolfin::la_index>& dofs = dofmap.cell_dofs(cells[i]);
+      for (std::size_t j = 0; j < dofs.size(); ++j)
+      {
+        if (last_block[dofs[j]] != b)
+        {
+          last_block[dofs[j]] = b;
+          ++dof_offsets[dofs[j] + 1];
+        }
+      }
+    }
+  }
+  for (std::size_t i = 0; i < num_dofs; ++i)
+    dof_offsets[i + 1] += dof_offsets[i];
+
+  std::vector<std::size_t> dof_blocks(dof_offsets.back());
+  std::vector<std::size_t> position(dof_offsets.begin(), dof_offsets.end() - 1);
+  std::fill(last_block.begin(), last_block.end(), num_blocks);
+  for (std::size_t b = 0; b < num_blocks; ++b)
+  {
+    block_cells(cells, mesh, offsets, b, facets);
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      const std::vector<dolfin::la_index>& dofs = dofmap.cell_dofs(cells[i]);
+      for (std::size_t j = 0; j < dofs.size(); ++j)
+      {
+        if (last_block[dofs[j]] != b)
+        {
+          last_block[dofs[j]] = b;
+          dof_blocks[position[dofs[j]]++] = b;
+        }
+      }
+    }
+  }
+
+  // Connect blocks sharing a dof
+  for (std::size_t dof = 0; dof < num_dofs; ++dof)
+  {
+    for (std::size_t i = dof_offsets[dof]; i < dof_offsets[dof + 1]; ++i)
+    {
+      for (std::size_t j = i + 1; j < dof_offsets[dof + 1]; ++j)
+      {
+        graph[dof_blocks[i]].insert(dof_blocks[j]);
+        graph[dof_blocks[j]].insert(dof_blocks[i]);
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void WorkStealingAssembler::assemble_cells_and_exterior_facets(
+  GenericTensor& A, const Form& a, UFC& ufc,
+  const MeshFunction<std::size_t>* cell_domains,
+  const MeshFunction<std::size_t>* exterior_facet_domains)
+{
+  // Skip assembly if there are no cell or exterior facet integrals
+  if (!ufc.form.has_cell_integrals()
+      && !ufc.form.has_exterior_facet_integrals())
+  {
+    return;
+  }
+
+  Timer timer("Assemble cells and exterior facets");
+
+  // Number of threads (from parameter system)
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+
+  // Extract mesh
+  const Mesh& mesh = a.mesh();
+
+  // Compute facets and facet - cell connectivity if not already computed
+  const std::size_t D = mesh.topology().dim();
+  if (ufc.form.has_exterior_facet_integrals())
+  {
+    mesh.init(D - 1);
+    mesh.init(D - 1, D);
+    dolfin_assert(mesh.ordered());
+  }
+
+  // Size of element tensor
+  const std::size_t form_rank = ufc.form.rank();
+  std::size_t tensor_size = 1;
+  for (std::size_t i = 0; i < form_rank; ++i)
+    tensor_size *= a.function_space(i)->dofmap()->max_cell_dimension();
+
+  // Partition cells into blocks and build conflict graph
+  const std::vector<std::size_t> offsets
+    = block_offsets(mesh.num_cells(), tensor_size);
+  Graph conflicts(offsets.size() - 1);
+  if (form_rank > 0)
+  {
+    build_conflict_graph(conflicts, mesh, *a.function_space(0)->dofmap(),
+                         offsets, false);
+  }
+
+  // Assemble
+  WorkStealingScheduler scheduler(conflicts);
+  CellKernel kernel(A, a, ufc, num_threads, offsets, cell_domains,
+                    exterior_facet_domains);
+  scheduler.run(kernel, num_threads);
+  kernel.add_scalars();
+}
+//-----------------------------------------------------------------------------
+void WorkStealingAssembler::assemble_interior_facets(GenericTensor& A,
+                                     const Form& a, UFC& ufc,
+                                     const MeshFunction<std::size_t>* domains)
+{
+  // Skip assembly if there are no interior facet integrals
+  if (!ufc.form.has_interior_facet_integrals())
+    return;
+
+  Timer timer("Assemble interior facets");
+
+  // Number of threads (from parameter system)
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+
+  // Extract mesh
+  const Mesh& mesh = a.mesh();
+
+  // Compute facets and facet - cell connectivity if not already computed
+  const std::size_t D = mesh.topology().dim();
+  mesh.init(D - 1);
+  mesh.init(D - 1, D);
+  dolfin_assert(mesh.ordered());
+
+  // Get interior facet directions (if any)
+  const std::vector<std::size_t>* facet_orientation = NULL;
+  if (mesh.data().exists("facet_orientation", D - 1))
+    facet_orientation = &(mesh.data().array("facet_orientation", D - 1));
+  if (facet_orientation && facet_orientation->size() != mesh.num_facets())
+  {
+    dolfin_error("WorkStealingAssembler.cpp",
+                 "assemble form over interior facets",
+                 "Expecting facet orientation to be defined on facets");
+  }
+
+  // Size of macro element tensor
+  const std::size_t form_rank = ufc.form.rank();
+  std::size_t tensor_size = 1;
+  for (std::size_t i = 0; i < form_rank; ++i)
+    tensor_size *= 2*a.function_space(i)->dofmap()->max_cell_dimension();
+
+  // Partition facets into blocks and build conflict graph
+  const std::vector<std::size_t> offsets
+    = block_offsets(mesh.num_facets(), tensor_size);
+  Graph conflicts(offsets.size() - 1);
+  if (form_rank > 0)
+  {
+    build_conflict_graph(conflicts, mesh, *a.function_space(0)->dofmap(),
+                         offsets, true);
+  }
+
+  // Assemble
+  WorkStealingScheduler scheduler(conflicts);
+  InteriorFacetKernel kernel(A, a, ufc, num_threads, offsets, domains,
+                             facet_orientation);
+  scheduler.run(kernel, num_threads);
+  kernel.add_scalars();
+}
+//-----------------------------------------------------------------------------
+std::vector<std::size_t>
+WorkStealingAssembler::block_offsets(std::size_t num_entities,
+                                     std::size_t tensor_size) const
+{
+  std::size_t block_size = entities_per_block;
+  if (block_size == 0)
+  {
+    // Fit element tensors of a block in 128 KB, but make sure there
+    // are enough blocks to keep all threads busy
+    const std::size_t num_threads
+      = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+    block_size = (128*1024)/(sizeof(double)*std::max(tensor_size,
+                                                     (std::size_t) 1));
+    block_size = std::min(block_size, num_entities/(8*num_threads));
+    block_size = std::max(block_size, (std::size_t) 1);
+  }
+
+  std::vector<std::size_t> offsets(1, 0);
+  while (offsets.back() < num_entities)
+    offsets.push_back(std::min(offsets.back() + block_size, num_entities));
+  return offsets;
+}
+//-----------------------------------------------------------------------------
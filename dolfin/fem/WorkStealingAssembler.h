@@ -0,0 +1,104 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-11-04
+// Last changed: 2013-11-04
+
+#ifndef __WORK_STEALING_ASSEMBLER_H
+#define __WORK_STEALING_ASSEMBLER_H
+
+#include <vector>
+#include <dolfin/graph/Graph.h>
+#include "AssemblerBase.h"
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class GenericDofMap;
+  class GenericTensor;
+  class Form;
+  class Mesh;
+  class UFC;
+  template<typename T> class MeshFunction;
+
+  /// This class provides multithreaded assembly of a sparse tensor
+  /// from a given variational form without mesh coloring.
+  ///
+  /// Cells (or interior facets) are partitioned into blocks of
+  /// consecutive entities, sized such that the element tensors of a
+  /// block fit in cache. Two blocks conflict if they share a global
+  /// row of the tensor. Blocks are processed by a
+  /// _WorkStealingScheduler_: element tensors are computed
+  /// concurrently for any blocks and accumulated locally per block,
+  /// and only the insertion into the global tensor is serialised
+  /// between conflicting blocks. Unlike the _OpenMpAssembler_ there
+  /// are no barriers between colors.
+  ///
+  /// The number of threads is given by the global parameter
+  /// "num_threads". This assembler is used by _Assembler_ when
+  /// "num_threads" is positive and the global parameter
+  /// "threaded_assembler" is "work_stealing".
+
+  class WorkStealingAssembler : public AssemblerBase
+  {
+  public:
+
+    /// Constructor
+    WorkStealingAssembler() : entities_per_block(0) {}
+
+    /// entities_per_block (std::size_t)
+    ///     Default value is 0.
+    ///     Number of cells (or facets) per block. If zero, the block
+    ///     size is chosen such that the element tensors of a block
+    ///     occupy approximately 128 KB.
+    std::size_t entities_per_block;
+
+    /// Assemble tensor from given form
+    void assemble(GenericTensor& A, const Form& a);
+
+    /// Build conflict graph for blocks of cells. Block b holds the
+    /// cells [offsets[b], offsets[b + 1]) (or the cells of the
+    /// interior facets in that range if facets is true), and two
+    /// blocks are connected if they share a dof of the given dofmap.
+    static void build_conflict_graph(Graph& graph, const Mesh& mesh,
+                                     const GenericDofMap& dofmap,
+                                     const std::vector<std::size_t>& offsets,
+                                     bool facets);
+
+  private:
+
+    // Assemble over cells and exterior facets
+    void assemble_cells_and_exterior_facets(GenericTensor& A, const Form& a,
+                        UFC& ufc,
+                        const MeshFunction<std::size_t>* cell_domains,
+                        const MeshFunction<std::size_t>* exterior_facet_domains);
+
+    // Assemble over interior facets
+    void assemble_interior_facets(GenericTensor& A, const Form& a, UFC& ufc,
+                                  const MeshFunction<std::size_t>* domains);
+
+    // Compute block offsets for num_entities entities with element
+    // tensors of given size
+    std::vector<std::size_t> block_offsets(std::size_t num_entities,
+                                           std::size_t tensor_size) const;
+
+  };
+
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include <dolfin/fem/Form.h>
 #include <dolfin/fem/AssemblerBase.h>
 #include <dolfin/fem/Assembler.h>
+#include <dolfin/fem/AssemblyPlan.h>
 #include <dolfin/fem/SparsityPatternBuilder.h>
 #include <dolfin/fem/SystemAssembler.h>
 #include <dolfin/fem/LinearVariationalProblem.h>
@@ -29,6 +30,8 @@
 
 // Move up when ready or merge with Assembler.h
 #include <dolfin/fem/OpenMpAssembler.h>
+#include <dolfin/fem/WorkStealingAssembler.h>
+#include <dolfin/fem/MatrixFreeOperator.h>
 
 // Remove when no longer needed, here to give deprecation warning
 #include <dolfin/fem/VariationalProblem.h>
@@ -20,7 +20,7 @@
 // Modified by Andre Massing 2009
 //
 // First added:  2003-11-28
-// Last changed: 2013-10-25
+// Last changed: 2013-12-11
 
 #include <algorithm>
 #include <map>
@@ -405,6 +405,168 @@ void Function::eval(Array<double>& values, const Array<double>& x) const
   eval(values, x, cell, ufc_cell);
 }
 //-----------------------------------------------------------------------------
+void Function::eval_many(Array<double>& values, const Array<double>& x) const
+{
+  dolfin_assert(_function_space);
+  dolfin_assert(_function_space->mesh());
+  dolfin_assert(_function_space->element());
+  dolfin_assert(_function_space->dofmap());
+  dolfin_assert(_vector);
+  const Mesh& mesh = *_function_space->mesh();
+  const FiniteElement& element = *_function_space->element();
+  const GenericDofMap& dofmap = *_function_space->dofmap();
+
+  // Check dimensions
+  const std::size_t gdim = mesh.geometry().dim();
+  const std::size_t value_size_loc = value_size();
+  const std::size_t num_points = x.size()/gdim;
+  if (x.size() != num_points*gdim)
+  {
+    dolfin_error("Function.cpp",
+                 "evaluate function at points",
+                 "Size of coordinate array (%d) is not a multiple of the geometric dimension (%d)",
+                 x.size(), gdim);
+  }
+  if (values.size() != num_points*value_size_loc)
+  {
+    dolfin_error("Function.cpp",
+                 "evaluate function at points",
+                 "Size of value array (%d) does not match number of points (%d) times value size (%d)",
+                 values.size(), num_points, value_size_loc);
+  }
+
+  // Get number of threads
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+
+  // Get bounding box tree (built before entering parallel region)
+  const BoundingBoxTree& tree = *mesh.bounding_box_tree();
+
+  // Find cells containing points. Points are divided in contiguous
+  // ranges, one per thread, and the cell found for the previous point
+  // is tried first so that the tree is only searched when a
+  // (spatially coherent) sequence of points leaves a cell.
+  const unsigned int not_found = std::numeric_limits<unsigned int>::max();
+  std::vector<unsigned int> cells(num_points, not_found);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+  #endif
+  for (int k = 0; k < (int) num_threads; ++k)
+  {
+    unsigned int hint = not_found;
+    const std::size_t i0 = (k*num_points)/num_threads;
+    const std::size_t i1 = ((k + 1)*num_points)/num_threads;
+    for (std::size_t i = i0; i < i1; ++i)
+    {
+      const Point point(gdim, x.data() + i*gdim);
+      if (hint != not_found && Cell(mesh, hint).collides(point))
+        cells[i] = hint;
+      else
+      {
+        cells[i] = tree.compute_first_entity_collision(point);
+        if (cells[i] != not_found)
+          hint = cells[i];
+      }
+    }
+  }
+
+  // Use the closest cells for points not inside the domain
+  std::vector<std::size_t> outside;
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    if (cells[i] == not_found)
+      outside.push_back(i);
+  }
+  if (!outside.empty())
+  {
+    if (!allow_extrapolation)
+    {
+      cout << Point(gdim, x.data() + outside[0]*gdim) << endl;
+      dolfin_error("Function.cpp",
+                   "evaluate function at points",
+                   "The point is not inside the domain. Consider setting \"allow_extrapolation\" to allow extrapolation");
+    }
+
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < outside.size(); ++i)
+      points.push_back(Point(gdim, x.data() + outside[i]*gdim));
+    const std::vector<unsigned int> closest
+      = tree.compute_closest_entity(points).first;
+    for (std::size_t i = 0; i < outside.size(); ++i)
+      cells[outside[i]] = closest[i];
+    log(PROGRESS, "Extrapolating function values at %d points (not inside domain).",
+        outside.size());
+  }
+
+  // Group points by cell
+  std::vector<std::pair<unsigned int, unsigned int> > cell_points(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+    cell_points[i] = std::make_pair(cells[i], i);
+  std::sort(cell_points.begin(), cell_points.end());
+  std::vector<std::size_t> group_offsets;
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    if (i == 0 || cell_points[i].first != cell_points[i - 1].first)
+      group_offsets.push_back(i);
+  }
+  group_offsets.push_back(num_points);
+  const std::size_t num_groups = group_offsets.size() - 1;
+
+  // Get expansion coefficients for all cells (one call to vector)
+  const std::size_t space_dimension = element.space_dimension();
+  std::vector<dolfin::la_index> dofs(num_groups*space_dimension);
+  for (std::size_t g = 0; g < num_groups; ++g)
+  {
+    const std::vector<dolfin::la_index>& cell_dofs
+      = dofmap.cell_dofs(cell_points[group_offsets[g]].first);
+    dolfin_assert(cell_dofs.size() == space_dimension);
+    std::copy(cell_dofs.begin(), cell_dofs.end(),
+              dofs.begin() + g*space_dimension);
+  }
+  std::vector<double> coefficients(dofs.size());
+  if (!dofs.empty())
+    _vector->get_local(coefficients.data(), dofs.size(), dofs.data());
+
+  // Evaluate points cell by cell
+  #ifdef HAS_OPENMP
+  #pragma omp parallel num_threads(num_threads)
+  #endif
+  {
+    // Work arrays (one per thread)
+    std::vector<double> vertex_coordinates;
+    std::vector<double> basis(space_dimension*value_size_loc);
+
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(dynamic, 64)
+    #endif
+    for (int g = 0; g < (int) num_groups; ++g)
+    {
+      // Get cell vertex coordinates
+      const Cell cell(mesh, cell_points[group_offsets[g]].first);
+      cell.get_vertex_coordinates(vertex_coordinates);
+      const double* w = coefficients.data() + g*space_dimension;
+
+      for (std::size_t k = group_offsets[g]; k < group_offsets[g + 1]; ++k)
+      {
+        // Evaluate all basis functions at point
+        const std::size_t i = cell_points[k].second;
+        const int cell_orientation = 0;
+        element.evaluate_basis_all(basis.data(), x.data() + i*gdim,
+                                   vertex_coordinates.data(),
+                                   cell_orientation);
+
+        // Compute linear combination
+        double* _values = values.data() + i*value_size_loc;
+        for (std::size_t j = 0; j < value_size_loc; ++j)
+          _values[j] = 0.0;
+        for (std::size_t l = 0; l < space_dimension; ++l)
+          for (std::size_t j = 0; j < value_size_loc; ++j)
+            _values[j] += w[l]*basis[l*value_size_loc + j];
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
 void Function::eval(Array<double>& values, const Array<double>& x,
                     const Cell& dolfin_cell, const ufc::cell& ufc_cell) const
 {
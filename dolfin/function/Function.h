@@ -21,7 +21,7 @@
 // Modified by Andre Massing, 2009.
 //
 // First added:  2003-11-28
-// Last changed: 2013-10-22
+// Last changed: 2013-12-11
 
 #ifndef __FUNCTION_H
 #define __FUNCTION_H
@@ -264,6 +264,21 @@ namespace dolfin
     ///         The coordinates.
     void eval(Array<double>& values, const Array<double>& x) const;
 
+    /// Evaluate function at many points. This is considerably faster
+    /// than calling eval for each point: the cell last found is tried
+    /// first when locating the next point, points are grouped by
+    /// cell so that each cell is set up once, and evaluation is
+    /// multithreaded if the global parameter "num_threads" is
+    /// positive.
+    ///
+    /// *Arguments*
+    ///     values (_Array_ <double>)
+    ///         The values (num_points x value_size, row-major).
+    ///     x (_Array_ <double>)
+    ///         The coordinates of the points (num_points x gdim,
+    ///         row-major).
+    void eval_many(Array<double>& values, const Array<double>& x) const;
+
     /// Evaluate function at given coordinates in given cell
     ///
     /// *Arguments*
@@ -19,7 +19,7 @@
 // Modified by Nuno Lopes, 2008.
 //
 // First added:  2005-12-02
-// Last changed: 2012-11-12
+// Last changed: 2013-12-11
 
 #include <dolfin/common/constants.h>
 #include <dolfin/common/MPI.h>
@@ -72,31 +72,28 @@ BoxMesh::BoxMesh(double x0, double y0, double z0,
   MeshEditor editor;
   editor.open(*this, CellType::tetrahedron, 3, 3);
 
-  // Storage for vertex coordinates
-  std::vector<double> x(3);
-
   // Create vertices
-  editor.init_vertices((nx + 1)*(ny + 1)*(nz + 1));
-  std::size_t vertex = 0;
+  std::vector<double> coordinates(3*(nx + 1)*(ny + 1)*(nz + 1));
+  std::vector<double>::iterator x = coordinates.begin();
   for (std::size_t iz = 0; iz <= nz; iz++)
   {
-    x[2] = e + (static_cast<double>(iz))*(f-e) / static_cast<double>(nz);
+    const double z = e + (static_cast<double>(iz))*(f-e) / static_cast<double>(nz);
     for (std::size_t iy = 0; iy <= ny; iy++)
     {
-      x[1] = c + (static_cast<double>(iy))*(d-c) / static_cast<double>(ny);
+      const double y = c + (static_cast<double>(iy))*(d-c) / static_cast<double>(ny);
       for (std::size_t ix = 0; ix <= nx; ix++)
       {
-        x[0] = a + (static_cast<double>(ix))*(b-a) / static_cast<double>(nx);
-        editor.add_vertex(vertex, x);
-        vertex++;
+        *x++ = a + (static_cast<double>(ix))*(b-a) / static_cast<double>(nx);
+        *x++ = y;
+        *x++ = z;
       }
     }
   }
+  editor.set_vertices(coordinates);
 
   // Create tetrahedra
-  editor.init_cells(6*nx*ny*nz);
-  std::size_t cell = 0;
-  std::vector<std::vector<std::size_t> > cells(6, std::vector<std::size_t>(4));
+  std::vector<unsigned int> cells(6*4*nx*ny*nz);
+  std::vector<unsigned int>::iterator cell = cells.begin();
   for (std::size_t iz = 0; iz < nz; iz++)
   {
     for (std::size_t iy = 0; iy < ny; iy++)
@@ -113,20 +110,16 @@ BoxMesh::BoxMesh(double x0, double y0, double z0,
         const std::size_t v7 = v3 + (nx + 1)*(ny + 1);
 
         // Note that v0 < v1 < v2 < v3 < vmid.
-        cells[0][0] = v0; cells[0][1] = v1; cells[0][2] = v3; cells[0][3] = v7;
-        cells[1][0] = v0; cells[1][1] = v1; cells[1][2] = v7; cells[1][3] = v5;
-        cells[2][0] = v0; cells[2][1] = v5; cells[2][2] = v7; cells[2][3] = v4;
-        cells[3][0] = v0; cells[3][1] = v3; cells[3][2] = v2; cells[3][3] = v7;
-        cells[4][0] = v0; cells[4][1] = v6; cells[4][2] = v4; cells[4][3] = v7;
-        cells[5][0] = v0; cells[5][1] = v2; cells[5][2] = v6; cells[5][3] = v7;
-
-        // Add cells
-        std::vector<std::vector<std::size_t> >::const_iterator _cell;
-        for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-          editor.add_cell(cell++, *_cell);
+        *cell++ = v0; *cell++ = v1; *cell++ = v3; *cell++ = v7;
+        *cell++ = v0; *cell++ = v1; *cell++ = v7; *cell++ = v5;
+        *cell++ = v0; *cell++ = v5; *cell++ = v7; *cell++ = v4;
+        *cell++ = v0; *cell++ = v3; *cell++ = v2; *cell++ = v7;
+        *cell++ = v0; *cell++ = v6; *cell++ = v4; *cell++ = v7;
+        *cell++ = v0; *cell++ = v2; *cell++ = v6; *cell++ = v7;
       }
     }
   }
+  editor.set_cells(cells);
 
   // Close mesh editor
   editor.close();
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-09
-// Last changed: 2013-08-28
+// Last changed: 2013-12-10
 
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/geometry/Point.h>
@@ -98,6 +98,25 @@ void BoundingBoxTree::build(const std::vector<Point>& points, std::size_t gdim)
   // Build tree
   dolfin_assert(_tree);
   _tree->build(points);
+
+  // No mesh for point cloud
+  _mesh = 0;
+}
+//-----------------------------------------------------------------------------
+void BoundingBoxTree::refit()
+{
+  // Check that tree has been built
+  check_built();
+  if (!_mesh)
+  {
+    dolfin_error("BoundingBoxTree.cpp",
+                 "refit bounding box tree",
+                 "Bounding box tree has not been built for a mesh");
+  }
+
+  // Delegate call to implementation
+  dolfin_assert(_tree);
+  _tree->refit(*_mesh);
 }
 //-----------------------------------------------------------------------------
 std::vector<unsigned int>
@@ -195,6 +214,53 @@ BoundingBoxTree::compute_closest_point(const Point& point) const
   return _tree->compute_closest_point(point);
 }
 //-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+BoundingBoxTree::compute_collisions(const std::vector<Point>& points) const
+{
+  // Check that tree has been built
+  check_built();
+
+  // Delegate call to implementation
+  dolfin_assert(_tree);
+  return _tree->compute_collisions(points);
+}
+//-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+BoundingBoxTree::compute_entity_collisions(const std::vector<Point>& points) const
+{
+  // Check that tree has been built
+  check_built();
+
+  // Delegate call to implementation
+  dolfin_assert(_tree);
+  dolfin_assert(_mesh);
+  return _tree->compute_entity_collisions(points, *_mesh);
+}
+//-----------------------------------------------------------------------------
+std::vector<unsigned int>
+BoundingBoxTree::compute_first_entity_collision(const std::vector<Point>& points) const
+{
+  // Check that tree has been built
+  check_built();
+
+  // Delegate call to implementation
+  dolfin_assert(_tree);
+  dolfin_assert(_mesh);
+  return _tree->compute_first_entity_collision(points, *_mesh);
+}
+//-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<double> >
+BoundingBoxTree::compute_closest_entity(const std::vector<Point>& points) const
+{
+  // Check that tree has been built
+  check_built();
+
+  // Delegate call to implementation
+  dolfin_assert(_tree);
+  dolfin_assert(_mesh);
+  return _tree->compute_closest_entity(points, *_mesh);
+}
+//-----------------------------------------------------------------------------
 void BoundingBoxTree::check_built() const
 {
   if (!_tree)
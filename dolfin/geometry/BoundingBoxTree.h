@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-09
-// Last changed: 2013-09-02
+// Last changed: 2013-12-10
 
 #ifndef __BOUNDING_BOX_TREE_H
 #define __BOUNDING_BOX_TREE_H
@@ -37,6 +37,9 @@ namespace dolfin
   /// This class implements a (distributed) axis aligned bounding box
   /// tree (AABB tree). Bounding box trees can be created from meshes
   /// and [other data structures, to be filled in].
+  ///
+  /// Trees for mesh entities are built in parallel if the global
+  /// parameter "num_threads" is positive.
 
   class BoundingBoxTree
   {
@@ -62,7 +65,8 @@ namespace dolfin
     ///         The mesh for which to compute the bounding box tree.
     ///     dimension (std::size_t)
     ///         The entity dimension (topological dimension) for which
-    ///         to compute the bounding box tree.
+    ///         to compute the bounding box tree. For dimension 0, the
+    ///         tree is a point tree of the vertices of the mesh.
     void build(const Mesh& mesh, std::size_t tdim);
 
     /// Build bounding box tree for point cloud.
@@ -74,6 +78,13 @@ namespace dolfin
     ///         The geometric dimension.
     void build(const std::vector<Point>& points, std::size_t gdim);
 
+    /// Update bounding boxes after the coordinates of the mesh have
+    /// changed (for example by ALE::move), keeping the structure of
+    /// the tree. This is much cheaper than building the tree again,
+    /// but the tree may become less efficient for searching if the
+    /// mesh is strongly deformed.
+    void refit();
+
     /// Compute all collisions between bounding boxes and _Point_.
     ///
     /// *Returns*
@@ -205,6 +216,73 @@ namespace dolfin
     std::pair<unsigned int, double>
     compute_closest_point(const Point& point) const;
 
+    /// Compute all collisions between bounding boxes and a list of
+    /// points. Nearby points are grouped in packets that traverse
+    /// the tree together, and packets are processed in parallel if
+    /// the global parameter "num_threads" is positive.
+    ///
+    /// *Returns*
+    ///     std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    ///         The collisions in compressed storage. The local
+    ///         indices of entities contained in (leaf) bounding
+    ///         boxes that collide with point i are given by entries
+    ///         offsets[i] to offsets[i + 1] - 1 of the first list,
+    ///         where offsets is the second list.
+    ///
+    /// *Arguments*
+    ///     points (std::vector<_Point_>)
+    ///         The list of points.
+    std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    compute_collisions(const std::vector<Point>& points) const;
+
+    /// Compute all collisions between entities and a list of points
+    /// (batched version of compute_entity_collisions).
+    ///
+    /// *Returns*
+    ///     std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    ///         The collisions in compressed storage. The local
+    ///         indices of entities that collide with point i are
+    ///         given by entries offsets[i] to offsets[i + 1] - 1 of
+    ///         the first list, where offsets is the second list.
+    ///
+    /// *Arguments*
+    ///     points (std::vector<_Point_>)
+    ///         The list of points.
+    std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    compute_entity_collisions(const std::vector<Point>& points) const;
+
+    /// Compute first collision between entities and each point of a
+    /// list (batched version of compute_first_entity_collision).
+    ///
+    /// *Returns*
+    ///     std::vector<unsigned int>
+    ///         For each point, the local index for the first found
+    ///         entity that collides with (intersects) the point. If
+    ///         not found, std::numeric_limits<unsigned int>::max()
+    ///         is returned for the point.
+    ///
+    /// *Arguments*
+    ///     points (std::vector<_Point_>)
+    ///         The list of points.
+    std::vector<unsigned int>
+    compute_first_entity_collision(const std::vector<Point>& points) const;
+
+    /// Compute closest entity to each point of a list (batched
+    /// version of compute_closest_entity).
+    ///
+    /// *Returns*
+    ///     std::vector<unsigned int>
+    ///         For each point, the local index for the entity that
+    ///         is closest to the point.
+    ///     std::vector<double>
+    ///         For each point, the distance to the closest entity.
+    ///
+    /// *Arguments*
+    ///     points (std::vector<_Point_>)
+    ///         The list of points.
+    std::pair<std::vector<unsigned int>, std::vector<double> >
+    compute_closest_entity(const std::vector<Point>& points) const;
+
   private:
 
     // Check that tree has been built
@@ -16,14 +16,18 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-05-02
-// Last changed: 2013-12-09
+// Last changed: 2013-12-10
 
 // Define a maximum dimension used for a local array in the recursive
 // build function. Speeds things up compared to allocating it in each
 // recursion and is more convenient than sending it around.
 #define MAX_DIM 6
 
+#include <algorithm>
+#include <utility>
+#include <dolfin/common/constants.h>
 #include <dolfin/geometry/Point.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/mesh/Mesh.h>
 #include <dolfin/mesh/Cell.h>
 #include <dolfin/mesh/MeshEntity.h>
@@ -35,6 +39,41 @@
 
 using namespace dolfin;
 
+const std::size_t GenericBoundingBoxTree::packet_size;
+
+namespace
+{
+  // Node of the top levels of a tree built in parallel. Ranges of
+  // the leaf partition that are not split further are built as
+  // subtrees.
+  struct TopNode
+  {
+    std::size_t begin, end; // range of leaf partition
+    int child_0, child_1;   // children in top levels (-1 for subtrees)
+    double b[MAX_DIM];      // bounding box (split nodes only)
+    unsigned int node;      // index of node (root of subtree)
+  };
+
+  // Number nodes of top levels in post-order, reserving 2n - 1 nodes
+  // for each subtree with n leaves
+  void number_top_nodes(std::vector<TopNode>& top, int t,
+                        unsigned int& node, std::vector<int>& subtrees)
+  {
+    if (top[t].child_0 < 0)
+    {
+      node += 2*(top[t].end - top[t].begin) - 1;
+      top[t].node = node - 1; // root of subtree is numbered last
+      subtrees.push_back(t);
+    }
+    else
+    {
+      number_top_nodes(top, top[t].child_0, node, subtrees);
+      number_top_nodes(top, top[t].child_1, node, subtrees);
+      top[t].node = node++;
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 GenericBoundingBoxTree::GenericBoundingBoxTree() : _tdim(0)
 {
@@ -44,11 +83,11 @@ GenericBoundingBoxTree::GenericBoundingBoxTree() : _tdim(0)
 void GenericBoundingBoxTree::build(const Mesh& mesh, std::size_t tdim)
 {
   // Check dimension
-  if (tdim < 1 or tdim > mesh.topology().dim())
+  if (tdim > mesh.topology().dim())
   {
     dolfin_error("GenericBoundingBoxTree.cpp",
                  "compute bounding box tree",
-                 "Dimension must be a number between 1 and %d",
+                 "Dimension must be a number between 0 and %d",
                  mesh.topology().dim());
   }
 
@@ -62,20 +101,43 @@ void GenericBoundingBoxTree::build(const Mesh& mesh, std::size_t tdim)
   // Initialize entities of given dimension if they don't exist
   mesh.init(tdim);
 
+  // Get number of threads
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+
   // Create bounding boxes for all entities (leaves)
   const std::size_t _gdim = gdim();
   const unsigned int num_leaves = mesh.num_entities(tdim);
   std::vector<double> leaf_bboxes(2*_gdim*num_leaves);
-  for (MeshEntityIterator it(mesh, tdim); !it.end(); ++it)
-    compute_bbox_of_entity(leaf_bboxes.data() + 2*_gdim*it->index(), *it, _gdim);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int i = 0; i < (int) num_leaves; ++i)
+  {
+    const MeshEntity entity(mesh, tdim, i);
+    compute_bbox_of_entity(leaf_bboxes.data() + 2*_gdim*i, entity, _gdim);
+  }
 
   // Create leaf partition (to be sorted)
   std::vector<unsigned int> leaf_partition(num_leaves);
   for (unsigned int i = 0; i < num_leaves; ++i)
     leaf_partition[i] = i;
 
-  // Recursively build the bounding box tree from the leaves
-  _build(leaf_bboxes, leaf_partition.begin(), leaf_partition.end(), _gdim);
+  // Allocate storage for all nodes (2n - 1 nodes for n leaves)
+  const unsigned int num_nodes = num_leaves > 0 ? 2*num_leaves - 1 : 0;
+  _bboxes.resize(num_nodes);
+  _bbox_coordinates.resize(2*_gdim*num_nodes);
+
+  // Build the bounding box tree from the leaves (recursively, or in
+  // parallel for large trees)
+  if (num_threads > 1 && num_leaves > 1024)
+    _build_parallel(leaf_bboxes, leaf_partition, _gdim, num_threads);
+  else
+  {
+    unsigned int node = 0;
+    _build(leaf_bboxes, leaf_partition.begin(), leaf_partition.end(), _gdim,
+           node);
+  }
 
   log(PROGRESS,
       "Computed bounding box tree with %d nodes for %d entities.",
@@ -100,6 +162,59 @@ void GenericBoundingBoxTree::build(const std::vector<Point>& points)
        num_bboxes(), num_leaves);
 }
 //-----------------------------------------------------------------------------
+void GenericBoundingBoxTree::refit(const Mesh& mesh)
+{
+  // Check that tree has been built for entities of mesh
+  if (_tdim > mesh.topology().dim()
+      || num_bboxes() != 2*mesh.num_entities(_tdim) - 1)
+  {
+    dolfin_error("GenericBoundingBoxTree.cpp",
+                 "refit bounding box tree",
+                 "Bounding box tree has not been built for entities of mesh");
+  }
+
+  // Recompute bounding boxes of leaves
+  const std::size_t _gdim = gdim();
+  const int num_nodes = num_bboxes();
+  #ifdef HAS_OPENMP
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int i = 0; i < num_nodes; ++i)
+  {
+    const BBox& bbox = _bboxes[i];
+    if (is_leaf(bbox, i))
+    {
+      // child_1 denotes entity for leaves
+      const MeshEntity entity(mesh, _tdim, bbox.child_1);
+      compute_bbox_of_entity(_bbox_coordinates.data() + 2*_gdim*i, entity,
+                             _gdim);
+    }
+  }
+
+  // Recompute bounding boxes of remaining nodes from their children.
+  // Children are numbered before their parents.
+  for (int i = 0; i < num_nodes; ++i)
+  {
+    const BBox& bbox = _bboxes[i];
+    if (is_leaf(bbox, i))
+      continue;
+
+    double* b = _bbox_coordinates.data() + 2*_gdim*i;
+    const double* b0 = _bbox_coordinates.data() + 2*_gdim*bbox.child_0;
+    const double* b1 = _bbox_coordinates.data() + 2*_gdim*bbox.child_1;
+    for (std::size_t j = 0; j < _gdim; ++j)
+    {
+      b[j] = std::min(b0[j], b1[j]);
+      b[_gdim + j] = std::max(b0[_gdim + j], b1[_gdim + j]);
+    }
+  }
+
+  // Point search tree (of cell midpoints) is no longer valid
+  _point_search_tree.reset();
+}
+//-----------------------------------------------------------------------------
 std::vector<unsigned int>
 GenericBoundingBoxTree::compute_collisions(const Point& point) const
 {
@@ -264,6 +379,143 @@ GenericBoundingBoxTree::compute_closest_point(const Point& point) const
   return ret;
 }
 //-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+GenericBoundingBoxTree::compute_collisions(const std::vector<Point>& points) const
+{
+  // Compute collisions for each point
+  std::vector<std::vector<unsigned int> > entities;
+  compute_batched_collisions(entities, points, 0, false);
+
+  // Copy to compressed storage
+  std::pair<std::vector<unsigned int>, std::vector<unsigned int> > ret;
+  ret.second.push_back(0);
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    ret.first.insert(ret.first.end(), entities[i].begin(), entities[i].end());
+    ret.second.push_back(ret.first.size());
+  }
+
+  return ret;
+}
+//-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+GenericBoundingBoxTree::compute_entity_collisions(const std::vector<Point>& points,
+                                                  const Mesh& mesh) const
+{
+  // Point in entity only implemented for cells. Consider extending this.
+  if (_tdim != mesh.topology().dim())
+  {
+    dolfin_error("GenericBoundingBoxTree.cpp",
+                 "compute collision between points and mesh entities",
+                 "Point-in-entity is only implemented for cells");
+  }
+
+  // Compute collisions for each point
+  std::vector<std::vector<unsigned int> > entities;
+  compute_batched_collisions(entities, points, &mesh, false);
+
+  // Copy to compressed storage
+  std::pair<std::vector<unsigned int>, std::vector<unsigned int> > ret;
+  ret.second.push_back(0);
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    ret.first.insert(ret.first.end(), entities[i].begin(), entities[i].end());
+    ret.second.push_back(ret.first.size());
+  }
+
+  return ret;
+}
+//-----------------------------------------------------------------------------
+std::vector<unsigned int>
+GenericBoundingBoxTree::compute_first_entity_collision(const std::vector<Point>& points,
+                                                       const Mesh& mesh) const
+{
+  // Point in entity only implemented for cells. Consider extending this.
+  if (_tdim != mesh.topology().dim())
+  {
+    dolfin_error("GenericBoundingBoxTree.cpp",
+                 "compute collision between points and mesh entities",
+                 "Point-in-entity is only implemented for cells");
+  }
+
+  // Compute first collision for each point
+  std::vector<std::vector<unsigned int> > entities;
+  compute_batched_collisions(entities, points, &mesh, true);
+
+  // Get max integer to signify not found
+  std::vector<unsigned int> ret(points.size(),
+                                std::numeric_limits<unsigned int>::max());
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    if (!entities[i].empty())
+      ret[i] = entities[i][0];
+  }
+
+  return ret;
+}
+//-----------------------------------------------------------------------------
+std::pair<std::vector<unsigned int>, std::vector<double> >
+GenericBoundingBoxTree::compute_closest_entity(const std::vector<Point>& points,
+                                               const Mesh& mesh) const
+{
+  // Closest entity only implemented for cells. Consider extending this.
+  if (_tdim != mesh.topology().dim())
+  {
+    dolfin_error("GenericBoundingBoxTree.cpp",
+                 "compute closest entity of points",
+                 "Closest-entity is only implemented for cells");
+  }
+
+  // Compute point search tree if not already done (before entering
+  // parallel region)
+  build_point_search_tree(mesh);
+  dolfin_assert(_point_search_tree);
+
+  // Compute packets
+  std::vector<unsigned int> order;
+  compute_packets(order, points);
+
+  // Compute closest entity for each packet
+  const int num_packets = (points.size() + packet_size - 1)/packet_size;
+  std::pair<std::vector<unsigned int>, std::vector<double> > ret;
+  ret.first.resize(points.size());
+  ret.second.resize(points.size());
+  #ifdef HAS_OPENMP
+  const std::size_t num_threads = parameters["num_threads"];
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(std::max(num_threads, (std::size_t) 1))
+  #endif
+  for (int k = 0; k < num_packets; ++k)
+  {
+    const unsigned int* packet = order.data() + k*packet_size;
+    const std::size_t num_points
+      = std::min(packet_size, points.size() - k*packet_size);
+
+    // Search point cloud to get a good starting guess
+    unsigned int closest_entity[packet_size];
+    double R2[packet_size];
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+      const double r
+        = _point_search_tree->compute_closest_point(points[packet[i]]).second;
+      closest_entity[i] = std::numeric_limits<unsigned int>::max();
+      R2[i] = r*r;
+    }
+
+    // Search tree
+    compute_packet_closest_entity(points, packet, num_points, mesh,
+                                  closest_entity, R2);
+
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+      dolfin_assert(closest_entity[i] < std::numeric_limits<unsigned int>::max());
+      ret.first[packet[i]] = closest_entity[i];
+      ret.second[packet[i]] = sqrt(R2[i]);
+    }
+  }
+
+  return ret;
+}
+//-----------------------------------------------------------------------------
 // Implementation of protected functions
 //-----------------------------------------------------------------------------
 void GenericBoundingBoxTree::clear()
@@ -278,7 +530,8 @@ unsigned int
 GenericBoundingBoxTree::_build(const std::vector<double>& leaf_bboxes,
                                const std::vector<unsigned int>::iterator& begin,
                                const std::vector<unsigned int>::iterator& end,
-                               std::size_t gdim)
+                               std::size_t gdim,
+                               unsigned int& node)
 {
   dolfin_assert(begin < end);
 
@@ -293,9 +546,10 @@ GenericBoundingBoxTree::_build(const std::vector<double>& leaf_bboxes,
     const double* b = leaf_bboxes.data() + 2*gdim*entity_index;
 
     // Store bounding box data
-    bbox.child_0 = num_bboxes(); // child_0 == node denotes a leaf
+    bbox.child_0 = node;         // child_0 == node denotes a leaf
     bbox.child_1 = entity_index; // index of entity contained in leaf
-    return add_bbox(bbox, b, gdim);
+    set_bbox(node, bbox, b, gdim);
+    return node++;
   }
 
   // Compute bounding box of all bounding boxes
@@ -308,11 +562,110 @@ GenericBoundingBoxTree::_build(const std::vector<double>& leaf_bboxes,
   sort_bboxes(axis, leaf_bboxes, begin, middle, end);
 
   // Split bounding boxes into two groups and call recursively
-  bbox.child_0 = _build(leaf_bboxes, begin, middle, gdim);
-  bbox.child_1 = _build(leaf_bboxes, middle, end, gdim);
+  bbox.child_0 = _build(leaf_bboxes, begin, middle, gdim, node);
+  bbox.child_1 = _build(leaf_bboxes, middle, end, gdim, node);
 
   // Store bounding box data. Note that root box will be added last.
-  return add_bbox(bbox, b, gdim);
+  set_bbox(node, bbox, b, gdim);
+  return node++;
+}
+//-----------------------------------------------------------------------------
+void
+GenericBoundingBoxTree::_build_parallel(const std::vector<double>& leaf_bboxes,
+                                        std::vector<unsigned int>& leaf_partition,
+                                        std::size_t gdim,
+                                        std::size_t num_threads)
+{
+  // Split top levels until there are at least four subtrees per
+  // thread, splitting the ranges of each level in parallel
+  std::vector<TopNode> top(1);
+  top[0].begin = 0;
+  top[0].end = leaf_partition.size();
+  top[0].child_0 = top[0].child_1 = -1;
+  std::vector<int> level(1, 0);
+  std::size_t num_subtrees = 1;
+  while (num_subtrees < 4*num_threads && !level.empty())
+  {
+    // Compute bounding boxes and sort along longest axis
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+    #endif
+    for (int i = 0; i < (int) level.size(); ++i)
+    {
+      TopNode& t = top[level[i]];
+      if (t.end - t.begin < 2)
+        continue;
+
+      std::size_t axis;
+      const std::vector<unsigned int>::iterator begin
+        = leaf_partition.begin() + t.begin;
+      const std::vector<unsigned int>::iterator end
+        = leaf_partition.begin() + t.end;
+      compute_bbox_of_bboxes(t.b, axis, leaf_bboxes, begin, end);
+      const std::vector<unsigned int>::iterator middle
+        = begin + (end - begin) / 2;
+      sort_bboxes(axis, leaf_bboxes, begin, middle, end);
+    }
+
+    // Split ranges into two groups
+    std::vector<int> next_level;
+    for (std::size_t i = 0; i < level.size(); ++i)
+    {
+      const int t = level[i];
+      if (top[t].end - top[t].begin < 2)
+        continue;
+
+      const std::size_t middle
+        = top[t].begin + (top[t].end - top[t].begin) / 2;
+      TopNode child;
+      child.child_0 = child.child_1 = -1;
+      child.begin = top[t].begin;
+      child.end = middle;
+      top[t].child_0 = top.size();
+      top.push_back(child);
+      child.begin = middle;
+      child.end = top[t].end;
+      top[t].child_1 = top.size();
+      top.push_back(child);
+
+      next_level.push_back(top[t].child_0);
+      next_level.push_back(top[t].child_1);
+      ++num_subtrees;
+    }
+    level.swap(next_level);
+  }
+
+  // Number nodes of top levels and subtrees
+  unsigned int num_nodes = 0;
+  std::vector<int> subtrees;
+  number_top_nodes(top, 0, num_nodes, subtrees);
+  dolfin_assert(num_nodes == num_bboxes());
+
+  // Build subtrees in parallel
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  #endif
+  for (int i = 0; i < (int) subtrees.size(); ++i)
+  {
+    const TopNode& t = top[subtrees[i]];
+    unsigned int node = t.node + 2 - 2*(t.end - t.begin);
+    _build(leaf_bboxes,
+           leaf_partition.begin() + t.begin, leaf_partition.begin() + t.end,
+           gdim, node);
+    dolfin_assert(node == t.node + 1);
+  }
+
+  // Store bounding box data for top levels
+  for (std::size_t t = 0; t < top.size(); ++t)
+  {
+    if (top[t].child_0 < 0)
+      continue;
+
+    BBox bbox;
+    bbox.child_0 = top[top[t].child_0].node;
+    bbox.child_1 = top[top[t].child_1].node;
+    set_bbox(top[t].node, bbox, top[t].b, gdim);
+  }
 }
 //-----------------------------------------------------------------------------
 unsigned int
@@ -649,6 +1002,266 @@ GenericBoundingBoxTree::_compute_closest_point(const GenericBoundingBoxTree& tre
   }
 }
 //-----------------------------------------------------------------------------
+void GenericBoundingBoxTree::compute_batched_collisions(
+  std::vector<std::vector<unsigned int> >& entities,
+  const std::vector<Point>& points,
+  const Mesh* mesh,
+  bool first_only) const
+{
+  // Compute packets
+  std::vector<unsigned int> order;
+  compute_packets(order, points);
+
+  // Compute collisions for each packet
+  const int num_packets = (points.size() + packet_size - 1)/packet_size;
+  entities.clear();
+  entities.resize(points.size());
+  #ifdef HAS_OPENMP
+  const std::size_t num_threads = parameters["num_threads"];
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(std::max(num_threads, (std::size_t) 1))
+  #endif
+  for (int k = 0; k < num_packets; ++k)
+  {
+    const unsigned int* packet = order.data() + k*packet_size;
+    const std::size_t num_points
+      = std::min(packet_size, points.size() - k*packet_size);
+    std::vector<unsigned int> _entities[packet_size];
+    compute_packet_collisions(points, packet, num_points, mesh, first_only,
+                              _entities);
+    for (std::size_t i = 0; i < num_points; ++i)
+      entities[packet[i]].swap(_entities[i]);
+  }
+}
+//-----------------------------------------------------------------------------
+void
+GenericBoundingBoxTree::compute_packet_collisions(const std::vector<Point>& points,
+                                                  const unsigned int* packet,
+                                                  std::size_t num_points,
+                                                  const Mesh* mesh,
+                                                  bool first_only,
+                                                  std::vector<unsigned int>* entities) const
+{
+  dolfin_assert(num_points > 0 && num_points <= packet_size);
+  const std::size_t _gdim = gdim();
+
+  // Copy point coordinates to packet storage (coordinate by
+  // coordinate). Unused slots are filled with the first point.
+  double x[3*packet_size];
+  for (std::size_t i = 0; i < packet_size; ++i)
+  {
+    const double* _x = points[packet[i < num_points ? i : 0]].coordinates();
+    for (std::size_t j = 0; j < _gdim; ++j)
+      x[j*packet_size + i] = _x[j];
+  }
+
+  // Points of packet are marked by bits of a mask. Points with a
+  // found collision are removed when only the first is requested.
+  const unsigned int all_points = (1u << num_points) - 1;
+  unsigned int found = 0;
+
+  // Traverse tree depth first (in the same order as the recursive
+  // functions) using a stack of nodes and masks of points inside the
+  // parent bounding box
+  std::vector<std::pair<unsigned int, unsigned int> > stack;
+  stack.push_back(std::make_pair(num_bboxes() - 1, all_points));
+  int inside[packet_size];
+  while (!stack.empty())
+  {
+    const unsigned int node = stack.back().first;
+    unsigned int mask = stack.back().second & ~found;
+    stack.pop_back();
+    if (!mask)
+      continue;
+
+    // Check which points are in bounding box (same tolerance as
+    // point_in_bbox)
+    const double* b = _bbox_coordinates.data() + 2*_gdim*node;
+    for (std::size_t i = 0; i < packet_size; ++i)
+      inside[i] = 1;
+    for (std::size_t j = 0; j < _gdim; ++j)
+    {
+      const double eps = DOLFIN_EPS_LARGE*(b[_gdim + j] - b[j]);
+      const double x_min = b[j] - eps;
+      const double x_max = b[_gdim + j] + eps;
+      const double* _x = x + j*packet_size;
+      for (std::size_t i = 0; i < packet_size; ++i)
+        inside[i] &= (x_min <= _x[i]) & (_x[i] <= x_max);
+    }
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+      if (!inside[i])
+        mask &= ~(1u << i);
+    }
+    if (!mask)
+      continue;
+
+    // If box is a leaf, then add it for points inside
+    const BBox& bbox = _bboxes[node];
+    if (is_leaf(bbox, node))
+    {
+      // child_1 denotes entity for leaves
+      const unsigned int entity_index = bbox.child_1;
+      for (std::size_t i = 0; i < num_points; ++i)
+      {
+        if (!(mask & (1u << i)))
+          continue;
+
+        // If we have a mesh, check that the candidate is really a
+        // collision
+        if (mesh)
+        {
+          Cell cell(*mesh, entity_index);
+          if (!cell.collides(points[packet[i]]))
+            continue;
+        }
+
+        entities[i].push_back(entity_index);
+        if (first_only)
+          found |= (1u << i);
+      }
+    }
+
+    // Check both children (first child on top)
+    else
+    {
+      stack.push_back(std::make_pair(bbox.child_1, mask));
+      stack.push_back(std::make_pair(bbox.child_0, mask));
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void
+GenericBoundingBoxTree::compute_packet_closest_entity(const std::vector<Point>& points,
+                                                      const unsigned int* packet,
+                                                      std::size_t num_points,
+                                                      const Mesh& mesh,
+                                                      unsigned int* closest_entity,
+                                                      double* R2) const
+{
+  dolfin_assert(num_points > 0 && num_points <= packet_size);
+  dolfin_assert(_tdim == mesh.topology().dim());
+  const std::size_t _gdim = gdim();
+
+  // Copy point coordinates to packet storage (coordinate by
+  // coordinate). Unused slots are filled with the first point.
+  double x[3*packet_size];
+  for (std::size_t i = 0; i < packet_size; ++i)
+  {
+    const double* _x = points[packet[i < num_points ? i : 0]].coordinates();
+    for (std::size_t j = 0; j < _gdim; ++j)
+      x[j*packet_size + i] = _x[j];
+  }
+
+  // Traverse tree depth first (in the same order as the recursive
+  // function) using a stack of nodes and masks of points for which
+  // the parent bounding box is within radius
+  const unsigned int all_points = (1u << num_points) - 1;
+  std::vector<std::pair<unsigned int, unsigned int> > stack;
+  stack.push_back(std::make_pair(num_bboxes() - 1, all_points));
+  double r2[packet_size];
+  while (!stack.empty())
+  {
+    const unsigned int node = stack.back().first;
+    unsigned int mask = stack.back().second;
+    stack.pop_back();
+
+    // Compute squared distances to bounding box (same operations as
+    // compute_squared_distance_bbox)
+    const double* b = _bbox_coordinates.data() + 2*_gdim*node;
+    for (std::size_t i = 0; i < packet_size; ++i)
+      r2[i] = 0.0;
+    for (std::size_t j = 0; j < _gdim; ++j)
+    {
+      const double x_min = b[j];
+      const double x_max = b[_gdim + j];
+      const double* _x = x + j*packet_size;
+      for (std::size_t i = 0; i < packet_size; ++i)
+      {
+        if (_x[i] < x_min) r2[i] += (_x[i] - x_min)*(_x[i] - x_min);
+        if (_x[i] > x_max) r2[i] += (_x[i] - x_max)*(_x[i] - x_max);
+      }
+    }
+
+    // If bounding box is outside radius, then don't search further
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+      if (r2[i] > R2[i])
+        mask &= ~(1u << i);
+    }
+    if (!mask)
+      continue;
+
+    // If box is leaf (which we know is inside radius), then shrink radius
+    const BBox& bbox = _bboxes[node];
+    if (is_leaf(bbox, node))
+    {
+      // Get entity (child_1 denotes entity index for leaves)
+      const unsigned int entity_index = bbox.child_1;
+      Cell cell(mesh, entity_index);
+      for (std::size_t i = 0; i < num_points; ++i)
+      {
+        if (!(mask & (1u << i)))
+          continue;
+
+        // If entity is closer than best result so far, then keep it
+        const double _r2 = cell.squared_distance(points[packet[i]]);
+        if (_r2 < R2[i])
+        {
+          closest_entity[i] = entity_index;
+          R2[i] = _r2;
+        }
+      }
+    }
+
+    // Check both children (first child on top)
+    else
+    {
+      stack.push_back(std::make_pair(bbox.child_1, mask));
+      stack.push_back(std::make_pair(bbox.child_0, mask));
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void GenericBoundingBoxTree::compute_packets(std::vector<unsigned int>& order,
+                                             const std::vector<Point>& points) const
+{
+  // Number of bits per coordinate of keys
+  const std::size_t _gdim = gdim();
+  const std::size_t num_bits = 30/_gdim;
+  const double num_intervals = static_cast<double>(1u << num_bits);
+
+  // Compute key of each point by interleaving the bits of its
+  // (integer) coordinates relative to the root bounding box (Morton
+  // order)
+  const double* b = get_bbox_coordinates(num_bboxes() - 1);
+  std::vector<std::pair<unsigned int, unsigned int> > keys(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    const double* x = points[i].coordinates();
+    unsigned int c[3];
+    for (std::size_t j = 0; j < _gdim; ++j)
+    {
+      const double h = b[_gdim + j] - b[j];
+      double s = h > 0.0 ? (x[j] - b[j])/h*num_intervals : 0.0;
+      s = std::max(0.0, std::min(s, num_intervals - 1.0));
+      c[j] = static_cast<unsigned int>(s);
+    }
+
+    unsigned int key = 0;
+    for (std::size_t bit = 0; bit < num_bits; ++bit)
+      for (std::size_t j = 0; j < _gdim; ++j)
+        key |= ((c[j] >> bit) & 1u) << (bit*_gdim + j);
+    keys[i] = std::make_pair(key, i);
+  }
+
+  // Sort points by key. Consecutive packet_size points form a
+  // packet.
+  std::sort(keys.begin(), keys.end());
+  order.resize(points.size());
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    order[i] = keys[i].second;
+}
+//-----------------------------------------------------------------------------
 void GenericBoundingBoxTree::build_point_search_tree(const Mesh& mesh) const
 {
   // Don't build search tree if it already exists
@@ -696,6 +1309,16 @@ void GenericBoundingBoxTree::compute_bbox_of_entity(double* b,
 
   // Get mesh entity data
   const MeshGeometry& geometry = entity.mesh().geometry();
+
+  // Bounding box of vertex is the vertex itself
+  if (entity.dim() == 0)
+  {
+    const double* x = geometry.x(entity.index());
+    for (std::size_t j = 0; j < gdim; ++j)
+      xmin[j] = xmax[j] = x[j];
+    return;
+  }
+
   const size_t num_vertices = entity.num_entities(0);
   const unsigned int* vertices = entity.entities(0);
   dolfin_assert(num_vertices >= 2);
@@ -16,11 +16,12 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-23
-// Last changed: 2013-11-30
+// Last changed: 2013-12-10
 
 #ifndef __GENERIC_BOUNDING_BOX_TREE_H
 #define __GENERIC_BOUNDING_BOX_TREE_H
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <dolfin/geometry/Point.h>
@@ -50,6 +51,10 @@ namespace dolfin
     /// Build bounding box tree for point cloud
     void build(const std::vector<Point>& points);
 
+    /// Update bounding boxes after the coordinates of the mesh have
+    /// changed, keeping the tree structure
+    void refit(const Mesh& mesh);
+
     /// Compute all collisions between bounding boxes and _Point_
     std::vector<unsigned int>
     compute_collisions(const Point& point) const;
@@ -82,6 +87,36 @@ namespace dolfin
     /// Compute closest point and distance to _Point_
     std::pair<unsigned int, double> compute_closest_point(const Point& point) const;
 
+    //--- Batched queries ---
+
+    // The following functions answer queries for a list of points.
+    // Points are grouped in packets of nearby points that traverse the
+    // tree together, and packets are processed in parallel if the
+    // global parameter "num_threads" is positive.
+
+    /// Compute all collisions between bounding boxes and list of
+    /// _Point_ (compressed storage: entities for point i are given by
+    /// entries offsets[i] to offsets[i + 1] of the first list)
+    std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    compute_collisions(const std::vector<Point>& points) const;
+
+    /// Compute all collisions between entities and list of _Point_
+    /// (compressed storage)
+    std::pair<std::vector<unsigned int>, std::vector<unsigned int> >
+    compute_entity_collisions(const std::vector<Point>& points,
+                              const Mesh& mesh) const;
+
+    /// Compute first collision between entities and each _Point_ of
+    /// list
+    std::vector<unsigned int>
+    compute_first_entity_collision(const std::vector<Point>& points,
+                                   const Mesh& mesh) const;
+
+    /// Compute closest entity and distance to each _Point_ of list
+    std::pair<std::vector<unsigned int>, std::vector<double> >
+    compute_closest_entity(const std::vector<Point>& points,
+                           const Mesh& mesh) const;
+
   protected:
 
     // Bounding box data. Leaf nodes are indicated by setting child_0
@@ -110,11 +145,22 @@ namespace dolfin
 
     //--- Recursive build functions ---
 
-    // Build bounding box tree for entities (recursive)
+    // Build bounding box tree for entities (recursive). Nodes are
+    // numbered in post-order starting from node and stored in
+    // preallocated storage.
     unsigned int _build(const std::vector<double>& leaf_bboxes,
                         const std::vector<unsigned int>::iterator& begin,
                         const std::vector<unsigned int>::iterator& end,
-                        std::size_t gdim);
+                        std::size_t gdim,
+                        unsigned int& node);
+
+    // Build bounding box tree for entities (multithreaded). The top
+    // levels are split level by level and the remaining subtrees are
+    // built in parallel. The result is the same tree as for _build.
+    void _build_parallel(const std::vector<double>& leaf_bboxes,
+                         std::vector<unsigned int>& leaf_partition,
+                         std::size_t gdim,
+                         std::size_t num_threads);
 
     // Build bounding box tree for points (recursive)
     unsigned int _build(const std::vector<Point>& points,
@@ -175,6 +221,41 @@ namespace dolfin
                            unsigned int& closest_point,
                            double& R2);
 
+    //--- Packet search functions ---
+
+    // Number of points in a packet for batched queries
+    static const std::size_t packet_size = 8;
+
+    // Compute collisions for list of points, packet by packet
+    void compute_batched_collisions(std::vector<std::vector<unsigned int> >& entities,
+                                    const std::vector<Point>& points,
+                                    const Mesh* mesh,
+                                    bool first_only) const;
+
+    // Compute collisions for packet of points (iterative). The packet
+    // is given by the indices of its points, and the collisions of
+    // point i of the packet are added to entities[i].
+    void compute_packet_collisions(const std::vector<Point>& points,
+                                   const unsigned int* packet,
+                                   std::size_t num_points,
+                                   const Mesh* mesh,
+                                   bool first_only,
+                                   std::vector<unsigned int>* entities) const;
+
+    // Compute closest entities for packet of points (iterative),
+    // shrinking the initial squared radii R2
+    void compute_packet_closest_entity(const std::vector<Point>& points,
+                                       const unsigned int* packet,
+                                       std::size_t num_points,
+                                       const Mesh& mesh,
+                                       unsigned int* closest_entity,
+                                       double* R2) const;
+
+    // Compute packets of nearby points (ordered along a space-filling
+    // curve over the root bounding box)
+    void compute_packets(std::vector<unsigned int>& order,
+                         const std::vector<Point>& points) const;
+
     //--- Utility functions ---
 
     // Compute point search tree if not already done
@@ -207,6 +288,19 @@ namespace dolfin
       return _bboxes.size() - 1;
     }
 
+    // Set bounding box and coordinates for given node (preallocated)
+    inline void set_bbox(unsigned int node,
+                         const BBox& bbox,
+                         const double* b,
+                         std::size_t gdim)
+    {
+      // Set bounding box
+      _bboxes[node] = bbox;
+
+      // Set bounding box coordinates
+      std::copy(b, b + 2*gdim, _bbox_coordinates.begin() + 2*gdim*node);
+    }
+
     // Return bounding box for given node
     inline const BBox& get_bbox(unsigned int node) const
     {
@@ -19,13 +19,16 @@
 // Modified by Anders Logg 2011
 //
 // First added:  2011-02-21
-// Last changed: 2011-05-11
+// Last changed: 2013-12-11
 
 // Included here to avoid a C++ problem with some MPI implementations
 #include <dolfin/common/MPI.h>
 
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <dolfin/common/Array.h>
+#include <dolfin/common/Timer.h>
 #include <dolfin/log/log.h>
 #include <dolfin/parameter/GlobalParameters.h>
 #include "BoostGraphColoring.h"
@@ -35,6 +38,31 @@
 
 using namespace dolfin;
 
+namespace
+{
+  // Pseudo-random hash of vertex index, used to break ties between
+  // vertices of equal degree
+  inline unsigned int hash(unsigned int x)
+  {
+    x = ((x >> 16) ^ x)*0x45d9f3b;
+    x = ((x >> 16) ^ x)*0x45d9f3b;
+    return (x >> 16) ^ x;
+  }
+
+  // Return true if vertex u has higher coloring priority than vertex v
+  inline bool higher_priority(const Graph& graph, std::size_t u,
+                              std::size_t v)
+  {
+    if (graph[u].size() != graph[v].size())
+      return graph[u].size() > graph[v].size();
+    const unsigned int hu = hash(u);
+    const unsigned int hv = hash(v);
+    if (hu != hv)
+      return hu > hv;
+    return u > v;
+  }
+}
+
 //-----------------------------------------------------------------------------
 std::size_t GraphColoring::compute_local_vertex_coloring(const Graph& graph,
                                               std::vector<std::size_t>& colors)
@@ -43,16 +71,169 @@ std::size_t GraphColoring::compute_local_vertex_coloring(const Graph& graph,
   const std::string colorer = parameters["graph_coloring_library"];
 
   // Color mesh
+  std::size_t num_colors = 0;
   if (colorer == "Boost")
-    return BoostGraphColoring::compute_local_vertex_coloring(graph, colors);
+    num_colors = BoostGraphColoring::compute_local_vertex_coloring(graph, colors);
   else if (colorer == "Zoltan")
-    return ZoltanInterface::compute_local_vertex_coloring(graph, colors);
+    num_colors = ZoltanInterface::compute_local_vertex_coloring(graph, colors);
+  else if (colorer == "JonesPlassmann")
+    num_colors = compute_jones_plassmann_coloring(graph, colors);
   else
   {
     dolfin_error("GraphColoring.cpp",
                  "compute mesh coloring",
-                 "Unknown coloring type. Known types are \"Boost\" and \"Zoltan\"");
+                 "Unknown coloring type. Known types are \"Boost\", \"Zoltan\" and \"JonesPlassmann\"");
     return 0;
   }
+
+  // Balance color classes
+  if (parameters["balance_graph_coloring"])
+    balance_colors(graph, colors, num_colors);
+
+  return num_colors;
+}
+//----------------------------------------------------------------------------
+std::size_t
+GraphColoring::compute_jones_plassmann_coloring(const Graph& graph,
+                                                std::vector<std::size_t>& colors)
+{
+  Timer timer("Jones-Plassmann graph coloring");
+
+  #ifdef HAS_OPENMP
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+  #endif
+  const std::size_t uncolored = std::numeric_limits<std::size_t>::max();
+
+  // All vertices are uncolored to begin with
+  const std::size_t n = graph.size();
+  colors.assign(n, uncolored);
+  std::vector<std::size_t> remaining(n);
+  for (std::size_t i = 0; i < n; ++i)
+    remaining[i] = i;
+  std::vector<char> selected(n);
+
+  while (!remaining.empty())
+  {
+    const int num_remaining = remaining.size();
+
+    // Select uncolored vertices with higher priority than all their
+    // uncolored neighbours. Colors are only read here, and the
+    // selected vertices are not adjacent, so they can be colored
+    // concurrently below
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads) schedule(guided)
+    #endif
+    for (int i = 0; i < num_remaining; ++i)
+    {
+      const std::size_t v = remaining[i];
+      selected[i] = 1;
+      graph_set_type::const_iterator u;
+      for (u = graph[v].begin(); u != graph[v].end(); ++u)
+      {
+        if (*u != v && colors[*u] == uncolored
+            && higher_priority(graph, *u, v))
+        {
+          selected[i] = 0;
+          break;
+        }
+      }
+    }
+
+    // Give selected vertices the smallest color not used by a
+    // neighbour
+    #ifdef HAS_OPENMP
+    #pragma omp parallel num_threads(num_threads)
+    #endif
+    {
+      std::vector<char> used;
+
+      #ifdef HAS_OPENMP
+      #pragma omp for schedule(guided)
+      #endif
+      for (int i = 0; i < num_remaining; ++i)
+      {
+        if (!selected[i])
+          continue;
+        const std::size_t v = remaining[i];
+        used.assign(graph[v].size() + 1, 0);
+        graph_set_type::const_iterator u;
+        for (u = graph[v].begin(); u != graph[v].end(); ++u)
+        {
+          if (colors[*u] < used.size())
+            used[colors[*u]] = 1;
+        }
+        std::size_t color = 0;
+        while (used[color])
+          ++color;
+        colors[v] = color;
+      }
+    }
+
+    // Keep uncolored vertices
+    std::size_t k = 0;
+    for (int i = 0; i < num_remaining; ++i)
+    {
+      if (!selected[i])
+        remaining[k++] = remaining[i];
+    }
+    remaining.resize(k);
+  }
+
+  if (n == 0)
+    return 0;
+  return *std::max_element(colors.begin(), colors.end()) + 1;
+}
+//----------------------------------------------------------------------------
+void GraphColoring::balance_colors(const Graph& graph,
+                                   std::vector<std::size_t>& colors,
+                                   std::size_t num_colors)
+{
+  Timer timer("Balance graph coloring");
+
+  const std::size_t n = graph.size();
+  dolfin_assert(colors.size() == n);
+  if (num_colors < 2)
+    return;
+
+  // Compute size of color classes
+  std::vector<std::size_t> sizes(num_colors, 0);
+  for (std::size_t v = 0; v < n; ++v)
+  {
+    dolfin_assert(colors[v] < num_colors);
+    ++sizes[colors[v]];
+  }
+
+  // Move vertices from large classes to the smallest permitted class
+  const std::size_t target = (n + num_colors - 1)/num_colors;
+  std::vector<char> used(num_colors);
+  for (std::size_t v = 0; v < n; ++v)
+  {
+    const std::size_t color = colors[v];
+    if (sizes[color] <= target)
+      continue;
+
+    std::fill(used.begin(), used.end(), 0);
+    graph_set_type::const_iterator u;
+    for (u = graph[v].begin(); u != graph[v].end(); ++u)
+    {
+      if (*u != v)
+        used[colors[*u]] = 1;
+    }
+
+    std::size_t new_color = color;
+    for (std::size_t c = 0; c < num_colors; ++c)
+    {
+      if (!used[c] && sizes[c] < target && sizes[c] < sizes[new_color])
+        new_color = c;
+    }
+
+    if (new_color != color)
+    {
+      --sizes[color];
+      ++sizes[new_color];
+      colors[v] = new_color;
+    }
+  }
 }
 //----------------------------------------------------------------------------
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2011-02-21
-// Last changed:
+// Last changed: 2013-12-11
 
 #ifndef __GRAPH_COLORING_H
 #define __GRAPH_COLORING_H
@@ -36,10 +36,32 @@ namespace dolfin
 
   public:
 
-    /// Compute vertex colors
+    /// Compute vertex colors with the library given by the parameter
+    /// "graph_coloring_library". If the parameter
+    /// "balance_graph_coloring" is true, the color classes are
+    /// balanced afterwards (see balance_colors)
     static std::size_t compute_local_vertex_coloring(const Graph& graph,
                                             std::vector<std::size_t>& colors);
 
+    /// Compute vertex colors with the Jones-Plassmann algorithm,
+    /// using "num_threads" threads. In each round, the uncolored
+    /// vertices with higher priority (largest degree first, ties
+    /// broken by a pseudo-random hash) than all their uncolored
+    /// neighbours form an independent set, and are given the
+    /// smallest color not used by a neighbour. The coloring does not
+    /// depend on the number of threads
+    static std::size_t compute_jones_plassmann_coloring(const Graph& graph,
+                                            std::vector<std::size_t>& colors);
+
+    /// Balance the sizes of the color classes of a vertex coloring
+    /// by moving vertices out of classes larger than the average into
+    /// the smallest class not used by a neighbour, as long as that
+    /// class is smaller than the average. The number of colors does
+    /// not change
+    static void balance_colors(const Graph& graph,
+                               std::vector<std::size_t>& colors,
+                               std::size_t num_colors);
+
   };
 }
 
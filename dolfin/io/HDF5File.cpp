@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2012
 //
 // First added:  2012-06-01
-// Last changed: 2013-11-05
+// Last changed: 2013-12-11
 
 #ifdef HAS_HDF5
 
@@ -52,6 +52,7 @@
 #include <dolfin/mesh/Vertex.h>
 #include "HDF5Attribute.h"
 #include "HDF5Interface.h"
+#include "HDF5SeriesBuffer.h"
 #include "HDF5Utility.h"
 #include "HDF5File.h"
 
@@ -66,6 +67,16 @@ HDF5File::HDF5File(const std::string filename, const std::string file_mode,
   // HDF5 chunking
   parameters.add("chunking", false);
 
+  // HDF5 compression: deflate level (0 for none, implies chunking)
+  // and byte shuffling before compression. Compression is not used
+  // with MPI-IO.
+  parameters.add("compression", 0, 0, 9);
+  parameters.add("shuffle", true);
+
+  // Number of staged time series steps (0 writes each step at once
+  // to a separate dataset)
+  parameters.add("series_buffer_size", 0);
+
   // Open HDF5 file
   hdf5_file_id = HDF5Interface::open_file(filename, file_mode, mpi_io);
   hdf5_file_open = true;
@@ -78,14 +89,20 @@ HDF5File::~HDF5File()
 //-----------------------------------------------------------------------------
 void HDF5File::close()
 {
-  // Close HDF5 file
+  // Write staged steps and close HDF5 file
   if (hdf5_file_open)
+  {
+    series_buffer.reset();
     HDF5Interface::close_file(hdf5_file_id);
+    hdf5_file_open = false;
+  }
 }
 //-----------------------------------------------------------------------------
 void HDF5File::flush()
 {
   dolfin_assert(hdf5_file_open);
+  if (series_buffer)
+    series_buffer->flush();
   HDF5Interface::flush_file(hdf5_file_id);
 }
 //-----------------------------------------------------------------------------
@@ -101,9 +118,12 @@ void HDF5File::write(const GenericVector& x, const std::string dataset_name)
   // Write data to file
   std::pair<std::size_t, std::size_t> local_range = x.local_range();
   const bool chunking = parameters["chunking"];
+  const int compression = parameters["compression"];
+  const bool shuffle = parameters["shuffle"];
   const std::vector<std::size_t> global_size(1, x.size());
   HDF5Interface::write_dataset(hdf5_file_id, dataset_name, local_data,
-                               local_range, global_size, mpi_io, chunking);
+                               local_range, global_size, mpi_io, chunking,
+                               compression, shuffle);
 
   // Add partitioning attribute to dataset
   std::vector<std::size_t> partitions;
@@ -636,6 +656,29 @@ void HDF5File::write_mesh_function(const MeshFunction<T>& meshfunction,
 void HDF5File::write(const Function& u,  const std::string name,
                      double timestamp)
 {
+  dolfin_assert(hdf5_file_open);
+
+  const int series_buffer_size = parameters["series_buffer_size"];
+  if (series_buffer_size > 0)
+  {
+    // Write dofmap with first step
+    if (!HDF5Interface::has_dataset(hdf5_file_id, name + "/cells"))
+      write_cell_dofs(u, name);
+
+    // Stage vector
+    if (!series_buffer)
+    {
+      const int compression = parameters["compression"];
+      const bool shuffle = parameters["shuffle"];
+      series_buffer.reset(new HDF5SeriesBuffer(hdf5_file_id, mpi_io,
+                                               series_buffer_size,
+                                               compression, shuffle));
+    }
+    dolfin_assert(u.vector());
+    series_buffer->push(name + "/vector_series", *u.vector(), timestamp);
+    return;
+  }
+
   if (!HDF5Interface::has_dataset(hdf5_file_id, name))
   {
     write(u, name);
@@ -670,6 +713,15 @@ void HDF5File::write(const Function& u, const std::string name)
 {
   Timer t0("HDF5: write Function");
 
+  // Save dofmap
+  write_cell_dofs(u, name);
+
+  // Save vector
+  write(*u.vector(), name + "/vector");
+}
+//-----------------------------------------------------------------------------
+void HDF5File::write_cell_dofs(const Function& u, const std::string name)
+{
   // Get mesh and dofmap
   dolfin_assert(u.function_space()->mesh());
   const Mesh& mesh = *u.function_space()->mesh();
@@ -714,9 +766,6 @@ void HDF5File::write(const Function& u, const std::string name)
     mesh.topology().global_indices(mesh.topology().dim());
   global_size[0] = mesh.size_global(mesh.topology().dim());
   write_data(name + "/cells", cells, global_size);
-
-  // Save vector
-  write(*u.vector(), name + "/vector");
 }
 //-----------------------------------------------------------------------------
 void HDF5File::read(Function& u, const std::string name)
@@ -725,12 +774,6 @@ void HDF5File::read(Function& u, const std::string name)
 
   dolfin_assert(hdf5_file_open);
 
-  // FIXME: This routine is long and involves a lot of MPI, but it
-  // should work for the general case of reading a function that was
-  // written from a different number of processes.  Memory efficiency
-  // could be improved by limiting the scope of some of the temporary
-  // variables
-
   std::string basename = name;
   std::string vector_dataset_name = name + "/vector";
 
@@ -743,13 +786,76 @@ void HDF5File::read(Function& u, const std::string name)
     vector_dataset_name = name;
   }
 
+  // Check group exists
+  if (!HDF5Interface::has_group(hdf5_file_id, name))
+    error("Group with name \"%s\" does not exist", name.c_str());
+
+  read_function(u, basename, vector_dataset_name, -1);
+}
+//-----------------------------------------------------------------------------
+void HDF5File::read(Function& u, const std::string name, std::size_t step)
+{
+  Timer t0("HDF5: read Function");
+
+  dolfin_assert(hdf5_file_open);
+
+  // Make sure all staged steps are in file
+  if (series_buffer)
+    series_buffer->flush();
+
+  const std::string vector_dataset_name = name + "/vector_series";
+  if (!HDF5Interface::has_dataset(hdf5_file_id, vector_dataset_name))
+    error("Dataset with name \"%s\" does not exist",
+          vector_dataset_name.c_str());
+  const std::vector<std::size_t> series_size =
+    HDF5Interface::get_dataset_size(hdf5_file_id, vector_dataset_name);
+  if (series_size.size() != 2 || step >= series_size[0])
+  {
+    dolfin_error("HDF5File.cpp",
+                 "read Function from time series",
+                 "Step %d is not in time series \"%s\"",
+                 (int) step, name.c_str());
+  }
+
+  read_function(u, name, vector_dataset_name, step);
+}
+//-----------------------------------------------------------------------------
+std::vector<double> HDF5File::read_timestamps(const std::string name)
+{
+  dolfin_assert(hdf5_file_open);
+
+  // Make sure all staged steps are in file
+  if (series_buffer)
+    series_buffer->flush();
+
+  const std::string timestamp_dataset_name = name + "/timestamps";
+  if (!HDF5Interface::has_dataset(hdf5_file_id, timestamp_dataset_name))
+    error("Dataset with name \"%s\" does not exist",
+          timestamp_dataset_name.c_str());
+  const std::vector<std::size_t> num_steps =
+    HDF5Interface::get_dataset_size(hdf5_file_id, timestamp_dataset_name);
+
+  std::vector<double> timestamps;
+  HDF5Interface::read_dataset(hdf5_file_id, timestamp_dataset_name,
+                              std::make_pair(0, num_steps[0]), timestamps);
+  return timestamps;
+}
+//-----------------------------------------------------------------------------
+void HDF5File::read_function(Function& u, const std::string basename,
+                             const std::string vector_dataset_name,
+                             std::size_t step)
+{
+  // FIXME: This routine is long and involves a lot of MPI, but it
+  // should work for the general case of reading a function that was
+  // written from a different number of processes.  Memory efficiency
+  // could be improved by limiting the scope of some of the temporary
+  // variables
+
   const std::string cells_dataset_name = basename + "/cells";
   const std::string cell_dofs_dataset_name = basename + "/cell_dofs";
   const std::string x_cell_dofs_dataset_name = basename + "/x_cell_dofs";
 
   // Check datasets exist
-  if (!HDF5Interface::has_group(hdf5_file_id, name))
-    error("Group with name \"%s\" does not exist", name.c_str());
   if (!HDF5Interface::has_dataset(hdf5_file_id, cells_dataset_name))
     error("Dataset with name \"%s\" does not exist",
           cells_dataset_name.c_str());
@@ -807,17 +913,27 @@ void HDF5File::read(Function& u, const std::string name)
 
   GenericVector& x = *u.vector();
 
+  // Get number of dofs (number of columns of series dataset)
+  const bool series = (step != (std::size_t) -1);
   const std::vector<std::size_t> vector_size =
     HDF5Interface::get_dataset_size(hdf5_file_id, vector_dataset_name);
-  const std::size_t num_global_dofs = vector_size[0];
+  const std::size_t num_global_dofs = series ? vector_size[1] : vector_size[0];
   dolfin_assert(num_global_dofs == x.size(0));
   const std::pair<dolfin::la_index, dolfin::la_index>
-    input_vector_range = MPI::local_range(vector_size[0]);
+    input_vector_range = MPI::local_range(num_global_dofs);
 
   std::vector<double> input_values;
-  HDF5Interface::read_dataset(hdf5_file_id, vector_dataset_name,
-                              input_vector_range,
-                              input_values);
+  if (series)
+  {
+    HDF5Interface::read_dataset_row(hdf5_file_id, vector_dataset_name, step,
+                                    input_vector_range, input_values);
+  }
+  else
+  {
+    HDF5Interface::read_dataset(hdf5_file_id, vector_dataset_name,
+                                input_vector_range,
+                                input_values);
+  }
 
   // Calculate one (global cell, local_dof_index) to associate
   // with each item in the vector on this process
@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2012
 //
 // First added:  2012-05-22
-// Last changed: 2013-10-24
+// Last changed: 2013-12-11
 
 #ifndef __DOLFIN_HDF5FILE_H
 #define __DOLFIN_HDF5FILE_H
@@ -28,6 +28,7 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 #include "dolfin/common/MPI.h"
 #include "dolfin/common/Variable.h"
@@ -44,6 +45,15 @@ namespace dolfin
   template<typename T> class MeshFunction;
   template<typename T> class MeshValueCollection;
   class HDF5Attribute;
+  class HDF5SeriesBuffer;
+
+  /// This class provides reading and writing of meshes, mesh
+  /// functions, vectors and functions in HDF5 format. Datasets are
+  /// chunked if the parameter "chunking" is set, and compressed
+  /// (deflate, optionally with byte shuffling) if the parameter
+  /// "compression" is set to a level between 1 and 9. Chunk sizes
+  /// are chosen from the dataset shape (whole rows, about 1 MB per
+  /// chunk). Compressed datasets are read transparently.
 
   class HDF5File : public Variable
   {
@@ -78,13 +88,31 @@ namespace dolfin
     /// Write Function to file in a format suitable for re-reading
     void write(const Function& u, const std::string name);
 
-    /// Write Function to file with a timestamp
+    /// Write Function to file with a timestamp. If the parameter
+    /// "series_buffer_size" is positive, the vector is staged and
+    /// written later as a row of the extendable dataset
+    /// name/vector_series, holding one row per step, and the
+    /// timestamp is appended to the extendable dataset
+    /// name/timestamps (one row per step). At most
+    /// "series_buffer_size" steps are staged, and when the HDF5
+    /// library is thread-safe and MPI-IO is not used they are written
+    /// by a background thread. Staged steps are guaranteed to be in
+    /// the file only after flush() or close().
     void write(const Function& u, const std::string name, double timestamp);
 
     /// Read Function from file and distribute data according to
     /// the Mesh and dofmap associated with the Function
     void read(Function& u, const std::string name);
 
+    /// Read step of a Function time series written with a positive
+    /// "series_buffer_size" from file and distribute data according
+    /// to the Mesh and dofmap associated with the Function
+    void read(Function& u, const std::string name, std::size_t step);
+
+    /// Read timestamps of a Function time series written with a
+    /// positive "series_buffer_size" (one per step)
+    std::vector<double> read_timestamps(const std::string name);
+
     /// Read Mesh from file
     void read(Mesh& mesh, const std::string name) const;
 
@@ -147,7 +175,7 @@ namespace dolfin
     // Get/set attributes of an existing dataset
     HDF5Attribute attributes(const std::string dataset_name);
 
-    /// Flush buffered I/O to disk
+    /// Write staged time series steps and flush buffered I/O to disk
     void flush();
 
   private:
@@ -161,6 +189,15 @@ namespace dolfin
     void write_mesh_function(const MeshFunction<T>& meshfunction,
                              const std::string name);
 
+    // Write dofmap of Function to file
+    void write_cell_dofs(const Function& u, const std::string name);
+
+    // Read Function values from vector dataset, or from given row of
+    // vector series dataset (if step is not -1)
+    void read_function(Function& u, const std::string basename,
+                       const std::string vector_dataset_name,
+                       std::size_t step);
+
     // Read a MeshFunction from file
     template <typename T>
     void read_mesh_function(MeshFunction<T>& meshfunction,
@@ -189,6 +226,10 @@ namespace dolfin
 
     // Parallel mode
     const bool mpi_io;
+
+    // Staged time series steps
+    boost::shared_ptr<HDF5SeriesBuffer> series_buffer;
+
   };
 
   //---------------------------------------------------------------------------
@@ -214,8 +255,11 @@ namespace dolfin
 
     // Write data to HDF5 file
     const bool chunking = parameters["chunking"];
+    const int compression = parameters["compression"];
+    const bool shuffle = parameters["shuffle"];
     HDF5Interface::write_dataset(hdf5_file_id, dataset_name, data,
-                                 range, global_size, mpi_io, chunking);
+                                 range, global_size, mpi_io, chunking,
+                                 compression, shuffle);
   }
   //---------------------------------------------------------------------------
 
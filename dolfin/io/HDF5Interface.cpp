@@ -18,7 +18,7 @@
 // Modified by Johannes Ring, 2012
 //
 // First Added: 2012-09-21
-// Last Changed: 2013-10-24
+// Last Changed: 2013-12-11
 
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
@@ -108,6 +108,85 @@ void HDF5Interface::flush_file(const hid_t hdf5_file_handle)
   dolfin_assert(status != HDF5_FAIL);
 }
 //-----------------------------------------------------------------------------
+bool HDF5Interface::threadsafe()
+{
+  #ifdef H5_HAVE_THREADSAFE
+  return true;
+  #else
+  return false;
+  #endif
+}
+//-----------------------------------------------------------------------------
+std::vector<hsize_t>
+HDF5Interface::chunk_dimensions(const std::vector<hsize_t>& dims,
+                                const std::size_t type_size)
+{
+  dolfin_assert(!dims.empty());
+
+  // Size of a row in bytes
+  hsize_t row_size = type_size;
+  for (std::size_t i = 1; i < dims.size(); ++i)
+    row_size *= dims[i];
+  row_size = std::max(row_size, (hsize_t) 1);
+
+  // Use whole rows, about 1 MB per chunk
+  std::vector<hsize_t> chunk_dims(dims);
+  chunk_dims[0] = std::min((hsize_t) 1048576/row_size, dims[0]);
+  chunk_dims[0] = std::max(chunk_dims[0], (hsize_t) 1);
+
+  return chunk_dims;
+}
+//-----------------------------------------------------------------------------
+hid_t HDF5Interface::dataset_properties(const std::vector<hsize_t>& chunk_dims,
+                                        int compression_level,
+                                        bool use_shuffle, bool use_mpi_io)
+{
+  const hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+  dolfin_assert(properties != HDF5_FAIL);
+  herr_t status = H5Pset_chunk(properties, chunk_dims.size(),
+                               chunk_dims.data());
+  dolfin_assert(status != HDF5_FAIL);
+
+  if (compression_level <= 0)
+    return properties;
+
+  // Filters are not supported by HDF5 for parallel writes
+  if (use_mpi_io)
+  {
+    static bool warned = false;
+    if (!warned)
+    {
+      warning("HDF5 compression is not supported with MPI-IO. Writing uncompressed (chunked) datasets.");
+      warned = true;
+    }
+    return properties;
+  }
+
+  // Check that deflate filter is available
+  if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+  {
+    static bool warned = false;
+    if (!warned)
+    {
+      warning("HDF5 library does not provide deflate compression. Writing uncompressed (chunked) datasets.");
+      warned = true;
+    }
+    return properties;
+  }
+
+  // Shuffle bytes, which groups exponents and improves compression of
+  // floating point data, then deflate
+  if (use_shuffle)
+  {
+    status = H5Pset_shuffle(properties);
+    dolfin_assert(status != HDF5_FAIL);
+  }
+  status = H5Pset_deflate(properties, std::min(compression_level, 9));
+  dolfin_assert(status != HDF5_FAIL);
+
+  return properties;
+}
+//-----------------------------------------------------------------------------
 const std::string HDF5Interface::get_attribute_type(
                   const hid_t hdf5_file_handle,
                   const std::string dataset_name,
@@ -16,13 +16,14 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2012-09-21
-// Last changed:
+// Last changed: 2013-12-11
 
 #ifndef __DOLFIN_HDF5_INTERFACE_H
 #define __DOLFIN_HDF5_INTERFACE_H
 
 #ifdef HAS_HDF5
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <hdf5.h>
@@ -54,6 +55,10 @@ namespace dolfin
     /// Flush data to file to improve data integrity after interruption
     static void flush_file(const hid_t hdf5_file_handle);
 
+    /// Return true if the HDF5 library was built thread-safe, i.e. may
+    /// be called from several threads concurrently
+    static bool threadsafe();
+
     /// Write data to existing HDF file as defined by range blocks on
     /// each process
     /// data: data to be written, flattened into 1D vector
@@ -61,13 +66,47 @@ namespace dolfin
     /// global_size: the global multidimensional shape of the array
     /// use_mpio: whether using MPI or not
     /// use_chunking: whether using chunking or not
+    /// compression_level: deflate level 1-9, or 0 for no compression
+    /// (compression implies chunking, and is not used with MPI-IO)
+    /// use_shuffle: whether to shuffle bytes before compression
     template <typename T>
     static void write_dataset(const hid_t file_handle,
                               const std::string dataset_name,
                               const std::vector<T>& data,
                               const std::pair<std::size_t, std::size_t> range,
                               const std::vector<std::size_t> global_size,
-                              bool use_mpio, bool use_chunking);
+                              bool use_mpio, bool use_chunking,
+                              int compression_level=0,
+                              bool use_shuffle=false);
+
+    /// Append rows to a rank 2 dataset whose first dimension is
+    /// unlimited, creating the dataset (with chunks of about 1 MB) if
+    /// it does not exist. Each process writes the columns in its range.
+    /// data: rows to be written, flattened into 1D vector
+    /// num_rows: the number of rows to append
+    /// range: the local column range on this processor
+    /// num_columns: the global number of columns
+    /// use_mpio: whether using MPI or not
+    /// compression_level, use_shuffle: as for write_dataset
+    template <typename T>
+    static void append_dataset_rows(const hid_t file_handle,
+                                    const std::string dataset_name,
+                                    const std::vector<T>& data,
+                                    const std::size_t num_rows,
+                                    const std::pair<std::size_t, std::size_t> range,
+                                    const std::size_t num_columns,
+                                    bool use_mpio,
+                                    int compression_level=0,
+                                    bool use_shuffle=false);
+
+    /// Read the columns in range of one row of a rank 2 HDF5 dataset
+    /// "dataset_name"
+    template <typename T>
+    static void read_dataset_row(const hid_t file_handle,
+                                 const std::string dataset_name,
+                                 const std::size_t row,
+                                 const std::pair<std::size_t, std::size_t> range,
+                                 std::vector<T>& data);
 
     /// Read data from a HDF5 dataset "dataset_name"
     /// as defined by range blocks on each process
@@ -145,6 +184,18 @@ namespace dolfin
 
   private:
 
+    // Return chunk dimensions for dataset with given dimensions and
+    // size of data type: whole rows, about 1 MB per chunk
+    static std::vector<hsize_t>
+      chunk_dimensions(const std::vector<hsize_t>& dims,
+                       const std::size_t type_size);
+
+    // Create dataset creation property list for chunked dataset, with
+    // compression filters if compression_level is positive
+    static hid_t dataset_properties(const std::vector<hsize_t>& chunk_dims,
+                                    int compression_level, bool use_shuffle,
+                                    bool use_mpi_io);
+
     static herr_t attribute_iteration_function(hid_t loc_id,
                                                const char* name,
                                                const H5A_info_t* info,
@@ -211,7 +262,9 @@ namespace dolfin
                                            const std::vector<T>& data,
                                            const std::pair<std::size_t, std::size_t> range,
                                            const std::vector<std::size_t> global_size,
-                                           bool use_mpi_io, bool use_chunking)
+                                           bool use_mpi_io, bool use_chunking,
+                                           int compression_level,
+                                           bool use_shuffle)
   {
     // Data rank
     const std::size_t rank = global_size.size();
@@ -248,23 +301,18 @@ namespace dolfin
     const hid_t filespace0 = H5Screate_simple(rank, dimsf.data(), NULL);
     dolfin_assert(filespace0 != HDF5_FAIL);
 
-    // Set chunking parameters
-    hid_t chunking_properties;
-    if (use_chunking)
+    // Set chunking and compression parameters (chunks may not be
+    // empty)
+    std::size_t num_global_items = 1;
+    for (std::size_t i = 0; i < rank; ++i)
+      num_global_items *= global_size[i];
+    hid_t chunking_properties = H5P_DEFAULT;
+    if ((use_chunking || compression_level > 0) && num_global_items > 0)
     {
-      // Set chunk size and limit to 1kB min/1MB max
-      hsize_t chunk_size = dimsf[0]/2;
-      if (chunk_size > 1048576)
-        chunk_size = 1048576;
-      if (chunk_size < 1024)
-        chunk_size = 1024;
-
-      hsize_t chunk_dims[2] = {chunk_size, dimsf[1]};
-      chunking_properties = H5Pcreate(H5P_DATASET_CREATE);
-      H5Pset_chunk(chunking_properties, rank, chunk_dims);
+      chunking_properties
+        = dataset_properties(chunk_dimensions(dimsf, sizeof(T)),
+                             compression_level, use_shuffle, use_mpi_io);
     }
-    else
-      chunking_properties = H5P_DEFAULT;
 
     // Check that group exists and recursively create if required
     const std::string group_name(dataset_name, 0, dataset_name.rfind('/'));
@@ -276,9 +324,14 @@ namespace dolfin
                                      chunking_properties, H5P_DEFAULT);
     dolfin_assert(dset_id != HDF5_FAIL);
 
-    // Close global data space
+    // Close global data space and dataset creation properties
     status = H5Sclose(filespace0);
     dolfin_assert(status != HDF5_FAIL);
+    if (chunking_properties != H5P_DEFAULT)
+    {
+      status = H5Pclose(chunking_properties);
+      dolfin_assert(status != HDF5_FAIL);
+    }
 
     // Create a local data space
     const hid_t memspace = H5Screate_simple(rank, count.data(), NULL);
@@ -387,6 +440,166 @@ namespace dolfin
   }
   //-----------------------------------------------------------------------------
   template <typename T>
+  inline void HDF5Interface::append_dataset_rows(const hid_t file_handle,
+                                                 const std::string dataset_name,
+                                                 const std::vector<T>& data,
+                                                 const std::size_t num_rows,
+                                                 const std::pair<std::size_t, std::size_t> range,
+                                                 const std::size_t num_columns,
+                                                 bool use_mpi_io,
+                                                 int compression_level,
+                                                 bool use_shuffle)
+  {
+    dolfin_assert(data.size() == num_rows*(range.second - range.first));
+
+    // Get HDF5 data type
+    const hid_t h5type = hdf5_type<T>();
+
+    // Generic status report
+    herr_t status;
+
+    // Open dataset, or create it with an unlimited number of rows
+    hsize_t num_existing_rows = 0;
+    hid_t dset_id;
+    if (has_dataset(file_handle, dataset_name))
+    {
+      dset_id = H5Dopen2(file_handle, dataset_name.c_str(), H5P_DEFAULT);
+      dolfin_assert(dset_id != HDF5_FAIL);
+
+      const hid_t filespace = H5Dget_space(dset_id);
+      dolfin_assert(filespace != HDF5_FAIL);
+      dolfin_assert(H5Sget_simple_extent_ndims(filespace) == 2);
+      hsize_t dims[2];
+      H5Sget_simple_extent_dims(filespace, dims, NULL);
+      if (dims[1] != num_columns)
+      {
+        dolfin_error("HDF5Interface.cpp",
+                     "append rows to dataset in HDF5 file",
+                     "Number of columns does not match existing dataset");
+      }
+      num_existing_rows = dims[0];
+      status = H5Sclose(filespace);
+      dolfin_assert(status != HDF5_FAIL);
+    }
+    else
+    {
+      const hsize_t dims[2] = {0, num_columns};
+      const hsize_t max_dims[2] = {H5S_UNLIMITED, num_columns};
+      const hid_t filespace = H5Screate_simple(2, dims, max_dims);
+      dolfin_assert(filespace != HDF5_FAIL);
+
+      // Chunks of about 1 MB: whole rows, or parts of a row if a row
+      // is larger than that
+      std::vector<hsize_t> chunk_dims
+        = chunk_dimensions(std::vector<hsize_t>(max_dims, max_dims + 2),
+                           sizeof(T));
+      chunk_dims[1] = std::min(chunk_dims[1], (hsize_t) 1048576/sizeof(T));
+      chunk_dims[1] = std::max(chunk_dims[1], (hsize_t) 1);
+      const hid_t chunking_properties
+        = dataset_properties(chunk_dims, compression_level, use_shuffle,
+                             use_mpi_io);
+
+      // Check that group exists and recursively create if required
+      const std::string group_name(dataset_name, 0, dataset_name.rfind('/'));
+      add_group(file_handle, group_name);
+
+      dset_id = H5Dcreate2(file_handle, dataset_name.c_str(), h5type,
+                           filespace, H5P_DEFAULT, chunking_properties,
+                           H5P_DEFAULT);
+      dolfin_assert(dset_id != HDF5_FAIL);
+
+      status = H5Pclose(chunking_properties);
+      dolfin_assert(status != HDF5_FAIL);
+      status = H5Sclose(filespace);
+      dolfin_assert(status != HDF5_FAIL);
+    }
+
+    // Extend dataset (collective)
+    const hsize_t new_dims[2] = {num_existing_rows + num_rows, num_columns};
+    status = H5Dset_extent(dset_id, new_dims);
+    dolfin_assert(status != HDF5_FAIL);
+
+    // Select local columns of new rows in file
+    const hsize_t offset[2] = {num_existing_rows, range.first};
+    const hsize_t count[2] = {num_rows, range.second - range.first};
+    const hid_t filespace = H5Dget_space(dset_id);
+    dolfin_assert(filespace != HDF5_FAIL);
+    status = H5Sselect_hyperslab(filespace, H5S_SELECT_SET, offset, NULL,
+                                 count, NULL);
+    dolfin_assert(status != HDF5_FAIL);
+
+    // Create a local data space
+    const hid_t memspace = H5Screate_simple(2, count, NULL);
+    dolfin_assert(memspace != HDF5_FAIL);
+
+    // Set parallel access
+    const hid_t plist_id = H5Pcreate(H5P_DATASET_XFER);
+    if (use_mpi_io)
+    {
+      status = H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_COLLECTIVE);
+      dolfin_assert(status != HDF5_FAIL);
+    }
+
+    // Write local rows into selected hyperslab
+    status = H5Dwrite(dset_id, h5type, memspace, filespace, plist_id,
+                      data.data());
+    dolfin_assert(status != HDF5_FAIL);
+
+    // Close everything
+    status = H5Pclose(plist_id);
+    dolfin_assert(status != HDF5_FAIL);
+    status = H5Sclose(memspace);
+    dolfin_assert(status != HDF5_FAIL);
+    status = H5Sclose(filespace);
+    dolfin_assert(status != HDF5_FAIL);
+    status = H5Dclose(dset_id);
+    dolfin_assert(status != HDF5_FAIL);
+  }
+  //-----------------------------------------------------------------------------
+  template <typename T>
+  inline void HDF5Interface::read_dataset_row(const hid_t file_handle,
+                                              const std::string dataset_name,
+                                              const std::size_t row,
+                                              const std::pair<std::size_t, std::size_t> range,
+                                              std::vector<T>& data)
+  {
+    // Open the dataset
+    const hid_t dset_id = H5Dopen2(file_handle, dataset_name.c_str(), H5P_DEFAULT);
+    dolfin_assert(dset_id != HDF5_FAIL);
+
+    // Open dataspace
+    const hid_t dataspace = H5Dget_space(dset_id);
+    dolfin_assert(dataspace != HDF5_FAIL);
+    dolfin_assert(H5Sget_simple_extent_ndims(dataspace) == 2);
+
+    // Select columns in range of row
+    const hsize_t offset[2] = {row, range.first};
+    const hsize_t count[2] = {1, range.second - range.first};
+    herr_t status = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET,
+                                        offset, NULL, count, NULL);
+    dolfin_assert(status != HDF5_FAIL);
+
+    // Create a memory dataspace
+    const hid_t memspace = H5Screate_simple(2, count, NULL);
+    dolfin_assert (memspace != HDF5_FAIL);
+
+    // Read data on each process
+    data.resize(count[1]);
+    const int h5type = hdf5_type<T>();
+    status = H5Dread(dset_id, h5type, memspace, dataspace, H5P_DEFAULT,
+                     data.data());
+    dolfin_assert(status != HDF5_FAIL);
+
+    // Close dataspaces and dataset
+    status = H5Sclose(memspace);
+    dolfin_assert(status != HDF5_FAIL);
+    status = H5Sclose(dataspace);
+    dolfin_assert(status != HDF5_FAIL);
+    status = H5Dclose(dset_id);
+    dolfin_assert(status != HDF5_FAIL);
+  }
+  //-----------------------------------------------------------------------------
+  template <typename T>
   inline void HDF5Interface::get_attribute(hid_t hdf5_file_handle,
                                   const std::string dataset_name,
                                   const std::string attribute_name,
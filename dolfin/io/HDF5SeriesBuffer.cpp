@@ -0,0 +1,229 @@
+// Copyright (C) 2013 Chris N. Richardson
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifdef HAS_HDF5
+
+#include <exception>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <dolfin/common/MPI.h>
+#include <dolfin/la/GenericVector.h>
+#include <dolfin/log/log.h>
+#include "HDF5SeriesBuffer.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+HDF5SeriesBuffer::HDF5SeriesBuffer(const hid_t hdf5_file_id,
+                                   const bool mpi_io,
+                                   const std::size_t capacity,
+                                   int compression_level, bool use_shuffle)
+  : _hdf5_file_id(hdf5_file_id), _mpi_io(mpi_io),
+    _capacity(std::max(capacity, (std::size_t) 1)),
+    _compression_level(compression_level), _use_shuffle(use_shuffle),
+    _timestamp_range(0, 0), _writing(false), _stop(false)
+{
+  // Timestamps are written by the first process
+  if (MPI::process_number() == 0)
+    _timestamp_range.second = 1;
+
+  // Collective MPI-IO from a second thread is not safe in general, and
+  // a library that is not thread-safe may be used elsewhere
+  // meanwhile, so use a writer thread only when neither is the case
+  if (!_mpi_io && HDF5Interface::threadsafe())
+  {
+    _thread.reset(new boost::thread(boost::bind(&HDF5SeriesBuffer::run,
+                                                this)));
+  }
+}
+//-----------------------------------------------------------------------------
+HDF5SeriesBuffer::~HDF5SeriesBuffer()
+{
+  if (_thread)
+  {
+    // Stop thread when queue has been written
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _stop = true;
+    }
+    _condition.notify_all();
+    _thread->join();
+
+    if (!_error.empty())
+      warning("Writing of time series failed: %s", _error.c_str());
+  }
+  else
+    write(_queue);
+}
+//-----------------------------------------------------------------------------
+void HDF5SeriesBuffer::push(const std::string dataset_name,
+                            const GenericVector& x, double timestamp)
+{
+  // Copy local values to staging buffer
+  Step step;
+  step.dataset_name = dataset_name;
+  step.timestamp = timestamp;
+  x.get_local(step.values);
+  step.range = x.local_range();
+  step.global_size = x.size();
+
+  if (!_thread)
+  {
+    // Write queued steps together when queue is full
+    _queue.push_back(Step());
+    std::swap(_queue.back(), step);
+    if (_queue.size() >= _capacity)
+      write(_queue);
+    return;
+  }
+
+  // Report failure of earlier steps
+  check_error();
+
+  // Wait for space in queue (backpressure)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    while (_queue.size() >= _capacity)
+      _condition.wait(lock);
+    _queue.push_back(Step());
+    std::swap(_queue.back(), step);
+  }
+  _condition.notify_all();
+}
+//-----------------------------------------------------------------------------
+void HDF5SeriesBuffer::flush()
+{
+  if (!_thread)
+  {
+    write(_queue);
+    return;
+  }
+
+  // Wait for writer thread to empty queue
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    while (!_queue.empty() || _writing)
+      _condition.wait(lock);
+  }
+  check_error();
+}
+//-----------------------------------------------------------------------------
+void HDF5SeriesBuffer::write(std::deque<Step>& steps) const
+{
+  std::vector<double> values;
+  std::vector<double> timestamps;
+  while (!steps.empty())
+  {
+    // Gather consecutive steps of same series into one block of rows
+    const Step& first = steps.front();
+    const std::string dataset_name = first.dataset_name;
+    const std::pair<std::size_t, std::size_t> range = first.range;
+    const std::size_t global_size = first.global_size;
+    std::size_t num_steps = 0;
+    values.clear();
+    timestamps.clear();
+    while (num_steps < steps.size()
+           && steps[num_steps].dataset_name == dataset_name
+           && steps[num_steps].range == range
+           && steps[num_steps].global_size == global_size)
+    {
+      values.insert(values.end(), steps[num_steps].values.begin(),
+                    steps[num_steps].values.end());
+      timestamps.push_back(steps[num_steps].timestamp);
+      ++num_steps;
+    }
+
+    // Write rows, and append timestamps (one per row) to timestamp
+    // dataset in same group
+    HDF5Interface::append_dataset_rows(_hdf5_file_id, dataset_name, values,
+                                       num_steps, range, global_size,
+                                       _mpi_io, _compression_level,
+                                       _use_shuffle);
+    if (_timestamp_range.second == 0)
+      timestamps.clear();
+    const std::string timestamp_dataset_name
+      = dataset_name.substr(0, dataset_name.rfind('/')) + "/timestamps";
+    HDF5Interface::append_dataset_rows(_hdf5_file_id, timestamp_dataset_name,
+                                       timestamps, num_steps,
+                                       _timestamp_range, 1, _mpi_io);
+
+    steps.erase(steps.begin(), steps.begin() + num_steps);
+  }
+}
+//-----------------------------------------------------------------------------
+void HDF5SeriesBuffer::run()
+{
+  std::deque<Step> steps;
+  while (true)
+  {
+    // Wait for steps, and take all queued steps
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      while (_queue.empty() && !_stop)
+        _condition.wait(lock);
+      if (_queue.empty())
+        return;
+      steps.swap(_queue);
+      _writing = true;
+    }
+    _condition.notify_all();
+
+    // Keep first error for the calling thread, and drop steps that
+    // were not written
+    std::string error;
+    try
+    {
+      write(steps);
+    }
+    catch (std::exception& e)
+    {
+      error = e.what();
+      steps.clear();
+    }
+
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      if (_error.empty())
+        _error = error;
+      _writing = false;
+    }
+    _condition.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
+void HDF5SeriesBuffer::check_error()
+{
+  std::string error;
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    std::swap(error, _error);
+  }
+
+  if (!error.empty())
+  {
+    dolfin_error("HDF5SeriesBuffer.cpp",
+                 "write time series",
+                 "Writing of staged steps failed (%s)", error.c_str());
+  }
+}
+//-----------------------------------------------------------------------------
+
+#endif
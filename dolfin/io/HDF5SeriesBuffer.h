@@ -0,0 +1,139 @@
+// Copyright (C) 2013 Chris N. Richardson
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifndef __DOLFIN_HDF5SERIESBUFFER_H
+#define __DOLFIN_HDF5SERIESBUFFER_H
+
+#ifdef HAS_HDF5
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "HDF5Interface.h"
+
+namespace boost { class thread; }
+
+namespace dolfin
+{
+
+  class GenericVector;
+
+  /// This class stages the steps of time series written by
+  /// _HDF5File_ in a bounded queue and writes them into extendable
+  /// datasets (one row per step). The timestamps of a series in
+  /// group/dataset are appended to the extendable dataset
+  /// group/timestamps. The local values of each step are copied when
+  /// the step is pushed, so the caller may modify its vector
+  /// immediately.
+  ///
+  /// When the HDF5 library is thread-safe and the file is not
+  /// accessed with MPI-IO, the queue is drained by a background
+  /// thread, so that output overlaps with computation. push() then
+  /// blocks only while the queue is full. Otherwise, the queued steps
+  /// are written together (one collective write per dataset) when the
+  /// queue is full. In both cases, flush() returns when all staged
+  /// steps have been written. An error raised by the background
+  /// thread is reported by the next call to push() or flush().
+
+  class HDF5SeriesBuffer
+  {
+  public:
+
+    /// Create buffer for file, holding at most capacity steps, and
+    /// writing with given compression (see HDF5Interface::write_dataset)
+    HDF5SeriesBuffer(const hid_t hdf5_file_id, const bool mpi_io,
+                     const std::size_t capacity, int compression_level=0,
+                     bool use_shuffle=false);
+
+    /// Destructor (writes all staged steps)
+    ~HDF5SeriesBuffer();
+
+    /// Stage vector x as a step with given timestamp of the series in
+    /// dataset_name
+    void push(const std::string dataset_name, const GenericVector& x,
+              double timestamp);
+
+    /// Write all staged steps to file
+    void flush();
+
+    /// Return true if steps are written by a background thread
+    bool asynchronous() const
+    { return _thread.get() != 0; }
+
+  private:
+
+    // A staged step
+    struct Step
+    {
+      std::string dataset_name;
+      double timestamp;
+      std::vector<double> values;
+      std::pair<std::size_t, std::size_t> range;
+      std::size_t global_size;
+    };
+
+    // Write steps to file, grouping consecutive steps of the same
+    // series, and clear steps
+    void write(std::deque<Step>& steps) const;
+
+    // Background thread loop
+    void run();
+
+    // Report error raised by background thread (if any)
+    void check_error();
+
+    // HDF5 file descriptor and access mode
+    const hid_t _hdf5_file_id;
+    const bool _mpi_io;
+
+    // Maximum number of queued steps
+    const std::size_t _capacity;
+
+    // Compression
+    const int _compression_level;
+    const bool _use_shuffle;
+
+    // Range of timestamp dataset written by this process
+    std::pair<std::size_t, std::size_t> _timestamp_range;
+
+    // Queued steps
+    std::deque<Step> _queue;
+
+    // Background writer thread, and synchronisation of queue
+    boost::scoped_ptr<boost::thread> _thread;
+    boost::mutex _mutex;
+    boost::condition_variable _condition;
+    bool _writing;
+    bool _stop;
+
+    // Message of error raised by background thread (empty if none)
+    std::string _error;
+
+  };
+
+}
+
+#endif
+#endif
@@ -18,10 +18,11 @@
 // Modified by Garth N. Wells, 2012
 //
 // First added:  2013-05-08
-// Last changed: 2013-06-04
+// Last changed: 2013-12-11
 
 #ifdef HAS_HDF5
 
+#include <algorithm>
 #include <iostream>
 #include <boost/multi_array.hpp>
 
@@ -308,28 +309,32 @@ void HDF5Utility::build_local_mesh(Mesh& mesh, const LocalMeshData& mesh_data)
     = CellType::type2string((CellType::Type)mesh_data.tdim);
 
   editor.open(mesh, cell_type_str, mesh_data.tdim, mesh_data.gdim);
-  editor.init_vertices(mesh_data.num_global_vertices);
 
-  // Iterate over vertices and add to mesh
+  // Copy vertices to their positions and add to mesh
+  const std::size_t gdim = mesh_data.gdim;
+  std::vector<double> coordinates(mesh_data.num_global_vertices*gdim);
   for (std::size_t i = 0; i < mesh_data.num_global_vertices; ++i)
   {
     const std::size_t index = mesh_data.vertex_indices[i];
-    const std::vector<double> coords(mesh_data.vertex_coordinates[i].begin(),
-                                     mesh_data.vertex_coordinates[i].end());
-    Point p(mesh_data.gdim, coords.data());
-    editor.add_vertex(index, p);
+    dolfin_assert(index < mesh_data.num_global_vertices);
+    std::copy(mesh_data.vertex_coordinates[i].begin(),
+              mesh_data.vertex_coordinates[i].end(),
+              coordinates.begin() + index*gdim);
   }
+  editor.set_vertices(coordinates);
 
-  editor.init_cells(mesh_data.num_global_cells);
-
-  // Iterate over cells and add to mesh
+  // Copy cells to their positions and add to mesh
+  const std::size_t num_cell_vertices = mesh_data.tdim + 1;
+  std::vector<unsigned int> cells(mesh_data.num_global_cells*num_cell_vertices);
   for (std::size_t i = 0; i < mesh_data.num_global_cells; ++i)
   {
     const std::size_t index = mesh_data.global_cell_indices[i];
-    const std::vector<std::size_t> v(mesh_data.cell_vertices[i].begin(),
-                                     mesh_data.cell_vertices[i].end());
-    editor.add_cell(index, v);
+    dolfin_assert(index < mesh_data.num_global_cells);
+    std::copy(mesh_data.cell_vertices[i].begin(),
+              mesh_data.cell_vertices[i].end(),
+              cells.begin() + index*num_cell_vertices);
   }
+  editor.set_cells(cells);
 
   // Close mesh editor
   editor.close();
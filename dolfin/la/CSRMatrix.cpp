@@ -0,0 +1,703 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include <dolfin/common/Timer.h>
+#include <dolfin/log/dolfin_log.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "CSRFactory.h"
+#include "CSRMatrix.h"
+#include "GenericSparsityPattern.h"
+#include "TensorLayout.h"
+#include "uBLASVector.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Product of a row with vector x. Four independent partial sums
+  // break the dependency chain of the accumulation, so that the
+  // compiler can pipeline (and, where gathers are available,
+  // vectorise) the multiply-adds. The summation order depends only
+  // on the row, so results do not depend on the number of threads.
+  inline double row_product(const double* values, const std::size_t* cols,
+                            const double* x, std::size_t begin,
+                            std::size_t end)
+  {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    std::size_t k = begin;
+    for (; k + 4 <= end; k += 4)
+    {
+      s0 += values[k]*x[cols[k]];
+      s1 += values[k + 1]*x[cols[k + 1]];
+      s2 += values[k + 2]*x[cols[k + 2]];
+      s3 += values[k + 3]*x[cols[k + 3]];
+    }
+    for (; k < end; ++k)
+      s0 += values[k]*x[cols[k]];
+    return (s0 + s1) + (s2 + s3);
+  }
+}
+
+//-----------------------------------------------------------------------------
+CSRMatrix::CSRMatrix() : _num_cols(0), _row_ptr(1, 0)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+CSRMatrix::CSRMatrix(const CSRMatrix& A) : GenericMatrix(), _num_cols(0),
+                                           _row_ptr(1, 0)
+{
+  *this = A;
+}
+//-----------------------------------------------------------------------------
+CSRMatrix::~CSRMatrix()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::init(const TensorLayout& tensor_layout)
+{
+  if (!tensor_layout.sparsity_pattern())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "initialize CSR matrix",
+                 "Tensor layout does not have a sparsity pattern");
+  }
+
+  const std::pair<std::size_t, std::size_t> row_range
+    = tensor_layout.local_range(0);
+  if (row_range.first != 0 || row_range.second != tensor_layout.size(0))
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "initialize CSR matrix",
+                 "Distributed matrices not supported by CSR backend");
+  }
+
+  // Get sparsity pattern (all columns are local in serial)
+  const GenericSparsityPattern& sparsity_pattern
+    = *tensor_layout.sparsity_pattern();
+  const std::vector<std::vector<std::size_t> > pattern
+    = sparsity_pattern.diagonal_pattern(GenericSparsityPattern::sorted);
+  dolfin_assert(pattern.size() == tensor_layout.size(0));
+
+  // Compute row pointers
+  std::vector<std::size_t> row_ptr(pattern.size() + 1, 0);
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+    row_ptr[i + 1] = row_ptr[i] + pattern[i].size();
+
+  _num_cols = tensor_layout.size(1);
+  allocate(row_ptr);
+
+  // Copy column indices
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    for (std::size_t i = row_ranges[t]; i < row_ranges[t + 1]; ++i)
+    {
+      std::copy(pattern[i].begin(), pattern[i].end(),
+                _cols.get() + _row_ptr[i]);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t CSRMatrix::size(std::size_t dim) const
+{
+  if (dim > 1)
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "access size of CSR matrix",
+                 "Illegal axis (%d), must be 0 or 1", (int) dim);
+  }
+  return dim == 0 ? _row_ptr.size() - 1 : _num_cols;
+}
+//-----------------------------------------------------------------------------
+std::pair<std::size_t, std::size_t>
+CSRMatrix::local_range(std::size_t dim) const
+{
+  dolfin_assert(dim < 2);
+  return std::make_pair(0, size(dim));
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::zero()
+{
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    std::fill(_values.get() + _row_ptr[row_ranges[t]],
+              _values.get() + _row_ptr[row_ranges[t + 1]], 0.0);
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::apply(std::string mode)
+{
+  Timer timer("Apply (CSR matrix)");
+
+  // Do nothing (values are added directly to the value array)
+}
+//-----------------------------------------------------------------------------
+std::string CSRMatrix::str(bool verbose) const
+{
+  std::stringstream s;
+  if (verbose)
+  {
+    s << str(false) << std::endl << std::endl;
+    for (std::size_t i = 0; i < size(0); ++i)
+    {
+      s << "|";
+      for (std::size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k)
+      {
+        std::stringstream entry;
+        entry << std::setiosflags(std::ios::scientific);
+        entry << std::setprecision(16);
+        entry << " (" << i << ", " << _cols[k] << ", " << _values[k] << ")";
+        s << entry.str();
+      }
+      s << " |" << std::endl;
+    }
+  }
+  else
+  {
+    s << "<CSRMatrix of size " << size(0) << " x " << size(1)
+      << " with " << nnz() << " nonzeros>";
+  }
+
+  return s.str();
+}
+//-----------------------------------------------------------------------------
+boost::shared_ptr<GenericMatrix> CSRMatrix::copy() const
+{
+  boost::shared_ptr<GenericMatrix> A(new CSRMatrix(*this));
+  return A;
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::resize(GenericVector& z, std::size_t dim) const
+{
+  z.resize(size(dim));
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::get(double* block, std::size_t m,
+                    const dolfin::la_index* rows, std::size_t n,
+                    const dolfin::la_index* cols) const
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      const std::size_t k = position(rows[i], cols[j]);
+      block[i*n + j] = k < nnz() ? _values[k] : 0.0;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::set(const double* block, std::size_t m,
+                    const dolfin::la_index* rows, std::size_t n,
+                    const dolfin::la_index* cols)
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      _values[existing_position(rows[i], cols[j], "set values of CSR matrix")]
+        = block[i*n + j];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::add(const double* block, std::size_t m,
+                    const dolfin::la_index* rows, std::size_t n,
+                    const dolfin::la_index* cols)
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      _values[existing_position(rows[i], cols[j], "add values to CSR matrix")]
+        += block[i*n + j];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+bool CSRMatrix::get_positions(std::size_t* positions,
+                              std::size_t m, const dolfin::la_index* rows,
+                              std::size_t n,
+                              const dolfin::la_index* cols) const
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      const std::size_t k = position(rows[i], cols[j]);
+      if (k == nnz())
+        return false;
+      positions[i*n + j] = k;
+    }
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::axpy(double a, const GenericMatrix& A,
+                     bool same_nonzero_pattern)
+{
+  const CSRMatrix& B = as_type<const CSRMatrix>(A);
+  if (size(0) != B.size(0) || size(1) != B.size(1))
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "perform axpy operation with CSR matrix",
+                 "Dimensions don't match");
+  }
+
+  // Check whether sparsity patterns are the same
+  if (!same_nonzero_pattern)
+  {
+    same_nonzero_pattern = _row_ptr == B._row_ptr
+      && std::equal(_cols.get(), _cols.get() + nnz(), B._cols.get());
+  }
+
+  if (same_nonzero_pattern)
+  {
+    std::vector<std::size_t> row_ranges;
+    const int num_threads = partition(row_ranges);
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+    #endif
+    for (int t = 0; t < num_threads; ++t)
+    {
+      for (std::size_t k = _row_ptr[row_ranges[t]];
+           k < _row_ptr[row_ranges[t + 1]]; ++k)
+      {
+        _values[k] += a*B._values[k];
+      }
+    }
+    return;
+  }
+
+  // Merge sparsity patterns row by row
+  const std::size_t M = size(0);
+  std::vector<std::size_t> row_ptr(M + 1, 0);
+  std::vector<std::size_t> cols;
+  std::vector<double> values;
+  cols.reserve(std::max(nnz(), B.nnz()));
+  values.reserve(std::max(nnz(), B.nnz()));
+  for (std::size_t i = 0; i < M; ++i)
+  {
+    std::size_t k0 = _row_ptr[i];
+    std::size_t k1 = B._row_ptr[i];
+    while (k0 < _row_ptr[i + 1] || k1 < B._row_ptr[i + 1])
+    {
+      if (k1 == B._row_ptr[i + 1]
+          || (k0 < _row_ptr[i + 1] && _cols[k0] < B._cols[k1]))
+      {
+        cols.push_back(_cols[k0]);
+        values.push_back(_values[k0++]);
+      }
+      else if (k0 == _row_ptr[i + 1] || B._cols[k1] < _cols[k0])
+      {
+        cols.push_back(B._cols[k1]);
+        values.push_back(a*B._values[k1++]);
+      }
+      else
+      {
+        cols.push_back(_cols[k0]);
+        values.push_back(_values[k0++] + a*B._values[k1++]);
+      }
+    }
+    row_ptr[i + 1] = cols.size();
+  }
+
+  allocate(row_ptr);
+  std::copy(cols.begin(), cols.end(), _cols.get());
+  std::copy(values.begin(), values.end(), _values.get());
+}
+//-----------------------------------------------------------------------------
+double CSRMatrix::norm(std::string norm_type) const
+{
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+
+  if (norm_type == "l1")
+  {
+    // Maximum column sum
+    std::vector<double> column_sums(size(1), 0.0);
+    for (std::size_t k = 0; k < nnz(); ++k)
+      column_sums[_cols[k]] += std::abs(_values[k]);
+    return column_sums.empty() ? 0.0
+      : *std::max_element(column_sums.begin(), column_sums.end());
+  }
+  else if (norm_type == "linf")
+  {
+    // Maximum row sum
+    std::vector<double> max_row_sums(num_threads, 0.0);
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+    #endif
+    for (int t = 0; t < num_threads; ++t)
+    {
+      for (std::size_t i = row_ranges[t]; i < row_ranges[t + 1]; ++i)
+      {
+        double row_sum = 0.0;
+        for (std::size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k)
+          row_sum += std::abs(_values[k]);
+        max_row_sums[t] = std::max(max_row_sums[t], row_sum);
+      }
+    }
+    return *std::max_element(max_row_sums.begin(), max_row_sums.end());
+  }
+  else if (norm_type == "frobenius")
+  {
+    // Sum per thread, and add sums in fixed order
+    std::vector<double> sums(num_threads, 0.0);
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+    #endif
+    for (int t = 0; t < num_threads; ++t)
+    {
+      double sum = 0.0;
+      for (std::size_t k = _row_ptr[row_ranges[t]];
+           k < _row_ptr[row_ranges[t + 1]]; ++k)
+      {
+        sum += _values[k]*_values[k];
+      }
+      sums[t] = sum;
+    }
+
+    double sum = 0.0;
+    for (int t = 0; t < num_threads; ++t)
+      sum += sums[t];
+    return std::sqrt(sum);
+  }
+  else
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "compute norm of CSR matrix",
+                 "Unknown norm type (\"%s\")",
+                 norm_type.c_str());
+  }
+
+  return 0.0;
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::getrow(std::size_t row, std::vector<std::size_t>& columns,
+                       std::vector<double>& values) const
+{
+  dolfin_assert(row < size(0));
+  columns.assign(_cols.get() + _row_ptr[row],
+                 _cols.get() + _row_ptr[row + 1]);
+  values.assign(_values.get() + _row_ptr[row],
+                _values.get() + _row_ptr[row + 1]);
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::setrow(std::size_t row,
+                       const std::vector<std::size_t>& columns,
+                       const std::vector<double>& values)
+{
+  dolfin_assert(columns.size() == values.size());
+  for (std::size_t j = 0; j < columns.size(); ++j)
+  {
+    _values[existing_position(row, columns[j], "set row of CSR matrix")]
+      = values[j];
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::zero(std::size_t m, const dolfin::la_index* rows)
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    dolfin_assert((std::size_t) rows[i] < size(0));
+    std::fill(_values.get() + _row_ptr[rows[i]],
+              _values.get() + _row_ptr[rows[i] + 1], 0.0);
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::ident(std::size_t m, const dolfin::la_index* rows)
+{
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    const std::size_t k = position(rows[i], rows[i]);
+    if (k == nnz())
+    {
+      dolfin_error("CSRMatrix.cpp",
+                   "set row(s) of matrix to identity",
+                   "Row %d does not contain diagonal entry",
+                   rows[i]);
+    }
+    std::fill(_values.get() + _row_ptr[rows[i]],
+              _values.get() + _row_ptr[rows[i] + 1], 0.0);
+    _values[k] = 1.0;
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::mult(const GenericVector& x, GenericVector& y) const
+{
+  const uBLASVector& xx = as_type<const uBLASVector>(x);
+  uBLASVector& yy = as_type<uBLASVector>(y);
+
+  if (size(1) != xx.size())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "compute matrix-vector product with CSR matrix",
+                 "Non-matching dimensions for matrix-vector product");
+  }
+
+  // Resize RHS if empty
+  if (yy.size() == 0)
+    resize(yy, 0);
+
+  if (size(0) != yy.size())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "compute matrix-vector product with CSR matrix",
+                 "Vector for matrix-vector result has wrong size");
+  }
+
+  const double* _x = xx.vec().data().begin();
+  double* _y = yy.vec().data().begin();
+  const std::size_t* cols = _cols.get();
+  const double* values = _values.get();
+
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    for (std::size_t i = row_ranges[t]; i < row_ranges[t + 1]; ++i)
+      _y[i] = row_product(values, cols, _x, _row_ptr[i], _row_ptr[i + 1]);
+  }
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::transpmult(const GenericVector& x, GenericVector& y) const
+{
+  const uBLASVector& xx = as_type<const uBLASVector>(x);
+  uBLASVector& yy = as_type<uBLASVector>(y);
+
+  if (size(0) != xx.size())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "compute transpose matrix-vector product with CSR matrix",
+                 "Non-matching dimensions for transpose matrix-vector product");
+  }
+
+  // Resize RHS if empty
+  if (yy.size() == 0)
+    resize(yy, 1);
+
+  if (size(1) != yy.size())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 "compute transpose matrix-vector product with CSR matrix",
+                 "Vector for transpose matrix-vector result has wrong size");
+  }
+
+  // Scatter the rows of each thread into a buffer of its own, and
+  // add the buffers in fixed order
+  const std::size_t N = size(1);
+  const double* _x = xx.vec().data().begin();
+  double* _y = yy.vec().data().begin();
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  std::vector<std::vector<double> > buffers(num_threads);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    std::vector<double>& buffer = buffers[t];
+    buffer.assign(N, 0.0);
+    for (std::size_t i = row_ranges[t]; i < row_ranges[t + 1]; ++i)
+    {
+      for (std::size_t k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k)
+        buffer[_cols[k]] += _values[k]*_x[i];
+    }
+  }
+
+  const int n = N;
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int j = 0; j < n; ++j)
+  {
+    double value = 0.0;
+    for (int t = 0; t < num_threads; ++t)
+      value += buffers[t][j];
+    _y[j] = value;
+  }
+}
+//-----------------------------------------------------------------------------
+const CSRMatrix& CSRMatrix::operator*= (double a)
+{
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    for (std::size_t k = _row_ptr[row_ranges[t]];
+         k < _row_ptr[row_ranges[t + 1]]; ++k)
+    {
+      _values[k] *= a;
+    }
+  }
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRMatrix& CSRMatrix::operator/= (double a)
+{
+  *this *= 1.0/a;
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const GenericMatrix& CSRMatrix::operator= (const GenericMatrix& A)
+{
+  *this = as_type<const CSRMatrix>(A);
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRMatrix& CSRMatrix::operator= (const CSRMatrix& A)
+{
+  // Check for self-assignment
+  if (this == &A)
+    return *this;
+
+  _num_cols = A._num_cols;
+  allocate(A._row_ptr);
+
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    const std::size_t begin = _row_ptr[row_ranges[t]];
+    const std::size_t end = _row_ptr[row_ranges[t + 1]];
+    std::copy(A._cols.get() + begin, A._cols.get() + end,
+              _cols.get() + begin);
+    std::copy(A._values.get() + begin, A._values.get() + end,
+              _values.get() + begin);
+  }
+  return *this;
+}
+//-----------------------------------------------------------------------------
+boost::tuples::tuple<const std::size_t*, const std::size_t*, const double*, int>
+CSRMatrix::data() const
+{
+  return boost::tuples::tuple<const std::size_t*, const std::size_t*,
+                              const double*, int>(&_row_ptr[0], _cols.get(),
+                                                  _values.get(), nnz());
+}
+//-----------------------------------------------------------------------------
+GenericLinearAlgebraFactory& CSRMatrix::factory() const
+{
+  return CSRFactory::instance();
+}
+//-----------------------------------------------------------------------------
+void CSRMatrix::allocate(const std::vector<std::size_t>& row_ptr)
+{
+  dolfin_assert(!row_ptr.empty());
+  _row_ptr = row_ptr;
+
+  // Allocate without initialisation, and zero entries with the
+  // threads that own the rows (first touch)
+  const std::size_t num_nonzeros = _row_ptr.back();
+  _cols.reset(new std::size_t[num_nonzeros]);
+  _values.reset(new double[num_nonzeros]);
+  std::vector<std::size_t> row_ranges;
+  const int num_threads = partition(row_ranges);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    const std::size_t begin = _row_ptr[row_ranges[t]];
+    const std::size_t end = _row_ptr[row_ranges[t + 1]];
+    std::fill(_cols.get() + begin, _cols.get() + end, 0);
+    std::fill(_values.get() + begin, _values.get() + end, 0.0);
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t CSRMatrix::partition(std::vector<std::size_t>& row_ranges) const
+{
+  // Use one thread for small matrices, which are not worth the
+  // fork/join overhead
+  const std::size_t min_nonzeros_per_thread = 16384;
+  const std::size_t num_threads
+    = std::max(std::min((std::size_t) dolfin::parameters["num_threads"],
+                        nnz()/min_nonzeros_per_thread),
+               (std::size_t) 1);
+
+  // Split rows at nonzero counts t*nnz/num_threads
+  const std::size_t M = size(0);
+  row_ranges.resize(num_threads + 1);
+  row_ranges[0] = 0;
+  for (std::size_t t = 1; t < num_threads; ++t)
+  {
+    const std::size_t target = t*nnz()/num_threads;
+    row_ranges[t] = std::lower_bound(_row_ptr.begin(), _row_ptr.end(),
+                                     target) - _row_ptr.begin();
+    row_ranges[t] = std::min(row_ranges[t], M);
+  }
+  row_ranges[num_threads] = M;
+
+  return num_threads;
+}
+//-----------------------------------------------------------------------------
+std::size_t CSRMatrix::position(std::size_t i, std::size_t j) const
+{
+  if (i >= size(0))
+    return nnz();
+
+  // Binary search in (sorted) row
+  const std::size_t* begin = _cols.get() + _row_ptr[i];
+  const std::size_t* end = _cols.get() + _row_ptr[i + 1];
+  const std::size_t* entry = std::lower_bound(begin, end, j);
+  if (entry == end || *entry != j)
+    return nnz();
+  return entry - _cols.get();
+}
+//-----------------------------------------------------------------------------
+std::size_t CSRMatrix::existing_position(std::size_t i, std::size_t j,
+                                         std::string task) const
+{
+  const std::size_t k = position(i, j);
+  if (k == nnz())
+  {
+    dolfin_error("CSRMatrix.cpp",
+                 task,
+                 "Entry (%d, %d) is not in the sparsity pattern",
+                 (int) i, (int) j);
+  }
+  return k;
+}
+//-----------------------------------------------------------------------------
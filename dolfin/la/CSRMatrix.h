@@ -0,0 +1,239 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifndef __DOLFIN_CSR_MATRIX_H
+#define __DOLFIN_CSR_MATRIX_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/tuple/tuple.hpp>
+
+#include <dolfin/common/types.h>
+#include "GenericMatrix.h"
+
+namespace dolfin
+{
+
+  class GenericVector;
+  class TensorLayout;
+
+  /// This class implements the matrix of the CSR linear algebra
+  /// backend: a serial sparse matrix in compressed row storage
+  /// (row pointers, column indices and values in contiguous arrays),
+  /// with the sparsity pattern fixed when the matrix is initialised
+  /// from a _TensorLayout_. Entries are assembled directly into the
+  /// value array, so adding values outside the sparsity pattern is
+  /// an error.
+  ///
+  /// The matrix-vector product and the other operations on all
+  /// entries use multiple threads, as given by the global parameter
+  /// "num_threads". The rows are split between the threads in
+  /// contiguous ranges with roughly the same number of nonzeros, and
+  /// each thread initialises (first touches) the entries of its rows,
+  /// so that the entries are local to the thread that multiplies
+  /// with them on NUMA machines. The matrix works with _CSRVector_
+  /// (and _uBLASVector_), and so with _uBLASKrylovSolver_.
+
+  class CSRMatrix : public GenericMatrix
+  {
+  public:
+
+    /// Create empty matrix
+    CSRMatrix();
+
+    /// Copy constructor
+    CSRMatrix(const CSRMatrix& A);
+
+    /// Destructor
+    virtual ~CSRMatrix();
+
+    //--- Implementation of the GenericTensor interface ---
+
+    /// Initialize zero tensor using tensor layout
+    virtual void init(const TensorLayout& tensor_layout);
+
+    /// Return size of given dimension
+    virtual std::size_t size(std::size_t dim) const;
+
+    /// Return local ownership range
+    virtual std::pair<std::size_t, std::size_t>
+      local_range(std::size_t dim) const;
+
+    /// Set all entries to zero and keep any sparse structure
+    virtual void zero();
+
+    /// Finalize assembly of tensor
+    virtual void apply(std::string mode);
+
+    /// Return informal string representation (pretty-print)
+    virtual std::string str(bool verbose) const;
+
+    //--- Implementation of the GenericMatrix interface ---
+
+    /// Return copy of matrix
+    virtual boost::shared_ptr<GenericMatrix> copy() const;
+
+    /// Resize vector z to be compatible with the matrix-vector product
+    /// y = Ax (dim = 0 --> z = y, dim = 1 --> z = x)
+    virtual void resize(GenericVector& z, std::size_t dim) const;
+
+    /// Get block of values
+    virtual void get(double* block, std::size_t m,
+                     const dolfin::la_index* rows, std::size_t n,
+                     const dolfin::la_index* cols) const;
+
+    /// Set block of values
+    virtual void set(const double* block, std::size_t m,
+                     const dolfin::la_index* rows, std::size_t n,
+                     const dolfin::la_index* cols);
+
+    /// Add block of values
+    virtual void add(const double* block, std::size_t m,
+                     const dolfin::la_index* rows, std::size_t n,
+                     const dolfin::la_index* cols);
+
+    /// Compute positions of entries in the value array (see
+    /// GenericMatrix::get_positions)
+    virtual bool get_positions(std::size_t* positions,
+                               std::size_t m, const dolfin::la_index* rows,
+                               std::size_t n,
+                               const dolfin::la_index* cols) const;
+
+    /// Add values at positions in the value array
+    virtual void add_at_positions(const double* values,
+                                  const std::size_t* positions,
+                                  std::size_t num_values)
+    {
+      for (std::size_t i = 0; i < num_values; ++i)
+        _values[positions[i]] += values[i];
+    }
+
+    /// Add multiple of given matrix (AXPY operation)
+    virtual void axpy(double a, const GenericMatrix& A,
+                      bool same_nonzero_pattern);
+
+    /// Return norm of matrix
+    virtual double norm(std::string norm_type) const;
+
+    /// Get non-zero values of given row
+    virtual void getrow(std::size_t row, std::vector<std::size_t>& columns,
+                        std::vector<double>& values) const;
+
+    /// Set values for given row (entries must be in the sparsity
+    /// pattern)
+    virtual void setrow(std::size_t row,
+                        const std::vector<std::size_t>& columns,
+                        const std::vector<double>& values);
+
+    /// Set given rows to zero
+    virtual void zero(std::size_t m, const dolfin::la_index* rows);
+
+    /// Set given rows to identity matrix
+    virtual void ident(std::size_t m, const dolfin::la_index* rows);
+
+    /// Matrix-vector product, y = Ax
+    virtual void mult(const GenericVector& x, GenericVector& y) const;
+
+    /// Matrix-vector product, y = A^T x
+    virtual void transpmult(const GenericVector& x, GenericVector& y) const;
+
+    /// Multiply matrix by given number
+    virtual const CSRMatrix& operator*= (double a);
+
+    /// Divide matrix by given number
+    virtual const CSRMatrix& operator/= (double a);
+
+    /// Assignment operator
+    virtual const GenericMatrix& operator= (const GenericMatrix& A);
+
+    /// Return pointers to underlying compressed row storage data
+    /// (row pointers, column indices, values, number of nonzeros)
+    virtual boost::tuples::tuple<const std::size_t*, const std::size_t*,
+                                 const double*, int> data() const;
+
+    //--- Special functions ---
+
+    /// Return linear algebra backend factory
+    virtual GenericLinearAlgebraFactory& factory() const;
+
+    //--- Special CSR functions ---
+
+    /// Assignment operator
+    const CSRMatrix& operator= (const CSRMatrix& A);
+
+    /// Return number of nonzeros
+    std::size_t nnz() const
+    { return _row_ptr.empty() ? 0 : _row_ptr.back(); }
+
+    /// Return row pointers (size(0) + 1 entries)
+    const std::vector<std::size_t>& row_ptr() const
+    { return _row_ptr; }
+
+    /// Return column indices (sorted within each row)
+    const std::size_t* cols() const
+    { return _cols.get(); }
+
+    /// Return values
+    const double* values() const
+    { return _values.get(); }
+
+    /// Return values
+    double* values()
+    { return _values.get(); }
+
+  private:
+
+    // Allocate column indices and values for given row pointers and
+    // first touch them with the threads that own the rows
+    void allocate(const std::vector<std::size_t>& row_ptr);
+
+    // Split rows between threads in contiguous ranges with roughly
+    // the same number of nonzeros, and return number of threads
+    std::size_t partition(std::vector<std::size_t>& row_ranges) const;
+
+    // Return position of entry (i, j) in value array, or nnz() if
+    // the entry is not in the sparsity pattern
+    std::size_t position(std::size_t i, std::size_t j) const;
+
+    // Return position of entry (i, j), and throw an error if the
+    // entry is not in the sparsity pattern
+    std::size_t existing_position(std::size_t i, std::size_t j,
+                                  std::string task) const;
+
+    // Number of columns
+    std::size_t _num_cols;
+
+    // Row pointers
+    std::vector<std::size_t> _row_ptr;
+
+    // Column indices
+    boost::scoped_array<std::size_t> _cols;
+
+    // Values
+    boost::scoped_array<double> _values;
+
+  };
+
+}
+
+#endif
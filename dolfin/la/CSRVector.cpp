@@ -0,0 +1,289 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <dolfin/log/dolfin_log.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "CSRFactory.h"
+#include "CSRVector.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Number of threads for an operation on n values. Small vectors
+  // are not worth the fork/join overhead.
+  int get_num_threads(std::size_t n)
+  {
+    const std::size_t min_values_per_thread = 8192;
+    const std::size_t threads
+      = std::max((std::size_t) dolfin::parameters["num_threads"],
+                 (std::size_t) 1);
+    return std::max(std::min(threads, n/min_values_per_thread),
+                    (std::size_t) 1);
+  }
+
+  // Return pointer to values of vector (also valid for empty vector)
+  double* values(uBLASVector& x)
+  { return x.vec().data().begin(); }
+
+  const double* values(const uBLASVector& x)
+  { return x.vec().data().begin(); }
+
+  // Check that vectors have the same size
+  const uBLASVector& check_size(const uBLASVector& x,
+                                const GenericVector& y,
+                                std::string task)
+  {
+    if (x.size() != y.size())
+    {
+      dolfin_error("CSRVector.cpp",
+                   task,
+                   "Vectors are not of the same size");
+    }
+    return as_type<const uBLASVector>(y);
+  }
+}
+
+//-----------------------------------------------------------------------------
+CSRVector::CSRVector(std::string type) : uBLASVector(type)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+CSRVector::CSRVector(std::size_t N, std::string type) : uBLASVector(type)
+{
+  resize(N);
+}
+//-----------------------------------------------------------------------------
+CSRVector::CSRVector(const CSRVector& x) : uBLASVector()
+{
+  resize(x.size());
+  *this = x;
+}
+//-----------------------------------------------------------------------------
+CSRVector::~CSRVector()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+boost::shared_ptr<GenericVector> CSRVector::copy() const
+{
+  boost::shared_ptr<GenericVector> y(new CSRVector(*this));
+  return y;
+}
+//-----------------------------------------------------------------------------
+void CSRVector::resize(std::size_t N)
+{
+  if (size() == N)
+    return;
+
+  // Resize without initialisation and let the threads zero (first
+  // touch) their part of the vector
+  vec().resize(N, false);
+  zero();
+}
+//-----------------------------------------------------------------------------
+void CSRVector::zero()
+{
+  double* x = values(*this);
+  const int n = size();
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    x[i] = 0.0;
+}
+//-----------------------------------------------------------------------------
+void CSRVector::axpy(double a, const GenericVector& y)
+{
+  const double* _y
+    = values(check_size(*this, y, "perform axpy operation with CSR vector"));
+  double* x = values(*this);
+  const int n = size();
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    x[i] += a*_y[i];
+}
+//-----------------------------------------------------------------------------
+double CSRVector::inner(const GenericVector& y) const
+{
+  const double* _y
+    = values(check_size(*this, y, "compute inner product of CSR vectors"));
+  const double* x = values(*this);
+  const int n = size();
+  double value = 0.0;
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n)) reduction(+:value)
+  #endif
+  for (int i = 0; i < n; ++i)
+    value += x[i]*_y[i];
+  return value;
+}
+//-----------------------------------------------------------------------------
+double CSRVector::norm(std::string norm_type) const
+{
+  const double* x = values(*this);
+  const int n = size();
+  if (norm_type == "l1")
+  {
+    double value = 0.0;
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(get_num_threads(n)) reduction(+:value)
+    #endif
+    for (int i = 0; i < n; ++i)
+      value += std::abs(x[i]);
+    return value;
+  }
+  else if (norm_type == "l2")
+    return std::sqrt(inner(*this));
+  else if (norm_type == "linf")
+  {
+    // OpenMP 3.0 has no max reduction in C++, so reduce per thread
+    double value = 0.0;
+    #ifdef HAS_OPENMP
+    #pragma omp parallel num_threads(get_num_threads(n))
+    #endif
+    {
+      double local_value = 0.0;
+      #ifdef HAS_OPENMP
+      #pragma omp for nowait
+      #endif
+      for (int i = 0; i < n; ++i)
+        local_value = std::max(local_value, std::abs(x[i]));
+      #ifdef HAS_OPENMP
+      #pragma omp critical
+      #endif
+      value = std::max(value, local_value);
+    }
+    return value;
+  }
+  else
+  {
+    dolfin_error("CSRVector.cpp",
+                 "compute norm of CSR vector",
+                 "Unknown norm type (\"%s\")", norm_type.c_str());
+  }
+
+  return 0.0;
+}
+//-----------------------------------------------------------------------------
+double CSRVector::sum() const
+{
+  const double* x = values(*this);
+  const int n = size();
+  double value = 0.0;
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n)) reduction(+:value)
+  #endif
+  for (int i = 0; i < n; ++i)
+    value += x[i];
+  return value;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator*= (double a)
+{
+  double* x = values(*this);
+  const int n = size();
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    x[i] *= a;
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator/= (double a)
+{
+  *this *= 1.0/a;
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator+= (const GenericVector& y)
+{
+  axpy(1.0, y);
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator-= (const GenericVector& y)
+{
+  axpy(-1.0, y);
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const GenericVector& CSRVector::operator= (const GenericVector& y)
+{
+  if (size() != y.size())
+  {
+    dolfin_error("CSRVector.cpp",
+                 "assign one vector to another",
+                 "Vectors must be of the same length when assigning. "
+                 "Consider using the copy constructor instead");
+  }
+
+  const double* _y = values(as_type<const uBLASVector>(y));
+  double* x = values(*this);
+  const int n = size();
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    x[i] = _y[i];
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator= (double a)
+{
+  double* x = values(*this);
+  const int n = size();
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    x[i] = a;
+  return *this;
+}
+//-----------------------------------------------------------------------------
+const CSRVector& CSRVector::operator= (const CSRVector& y)
+{
+  *this = static_cast<const GenericVector&>(y);
+  return *this;
+}
+//-----------------------------------------------------------------------------
+std::string CSRVector::str(bool verbose) const
+{
+  if (verbose)
+    return uBLASVector::str(true);
+
+  std::stringstream s;
+  s << "<CSRVector of size " << size() << ">";
+  return s.str();
+}
+//-----------------------------------------------------------------------------
+GenericLinearAlgebraFactory& CSRVector::factory() const
+{
+  return CSRFactory::instance();
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,125 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifndef __DOLFIN_CSR_VECTOR_H
+#define __DOLFIN_CSR_VECTOR_H
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include "uBLASVector.h"
+
+namespace dolfin
+{
+
+  /// This class provides the vector of the CSR linear algebra
+  /// backend (see _CSRMatrix_). It stores its values in a uBLAS
+  /// vector, and so may be used wherever a _uBLASVector_ is
+  /// expected (e.g. with _uBLASKrylovSolver_), but computes the
+  /// vector operations (inner products, norms, axpy, scaling) with
+  /// multiple threads, as given by the global parameter
+  /// "num_threads". The values are partitioned between the threads
+  /// in contiguous ranges, so that a thread reuses the entries it has
+  /// first touched.
+
+  class CSRVector : public uBLASVector
+  {
+  public:
+
+    /// Create empty vector
+    explicit CSRVector(std::string type="global");
+
+    /// Create vector of size N
+    CSRVector(std::size_t N, std::string type="global");
+
+    /// Copy constructor
+    CSRVector(const CSRVector& x);
+
+    /// Destructor
+    virtual ~CSRVector();
+
+    //--- Implementation of the GenericTensor interface ---
+
+    /// Set all entries to zero and keep any sparse structure
+    virtual void zero();
+
+    /// Return informal string representation (pretty-print)
+    virtual std::string str(bool verbose) const;
+
+    //--- Implementation of the GenericVector interface ---
+
+    /// Create copy of tensor
+    virtual boost::shared_ptr<GenericVector> copy() const;
+
+    /// Resize vector to size N
+    virtual void resize(std::size_t N);
+
+    using uBLASVector::resize;
+
+    /// Add multiple of given vector (AXPY operation)
+    virtual void axpy(double a, const GenericVector& x);
+
+    /// Return inner product with given vector
+    virtual double inner(const GenericVector& x) const;
+
+    /// Compute norm of vector
+    virtual double norm(std::string norm_type) const;
+
+    /// Return sum of values of vector
+    virtual double sum() const;
+
+    using uBLASVector::sum;
+
+    /// Multiply vector by given number
+    virtual const CSRVector& operator*= (double a);
+
+    using uBLASVector::operator*=;
+
+    /// Divide vector by given number
+    virtual const CSRVector& operator/= (double a);
+
+    /// Add given vector
+    virtual const CSRVector& operator+= (const GenericVector& x);
+
+    using uBLASVector::operator+=;
+
+    /// Subtract given vector
+    virtual const CSRVector& operator-= (const GenericVector& x);
+
+    using uBLASVector::operator-=;
+
+    /// Assignment operator
+    virtual const GenericVector& operator= (const GenericVector& x);
+
+    /// Assignment operator
+    virtual const CSRVector& operator= (double a);
+
+    /// Assignment operator
+    const CSRVector& operator= (const CSRVector& x);
+
+    //--- Special functions ---
+
+    /// Return linear algebra backend factory
+    virtual GenericLinearAlgebraFactory& factory() const;
+
+  };
+
+}
+
+#endif
@@ -18,7 +18,7 @@
 // Modified by Fredrik Valdmanis, 2011
 //
 // First added:  2008-05-17
-// Last changed: 2011-11-11
+// Last changed: 2013-12-11
 
 #include <dolfin/parameter/GlobalParameters.h>
 #include "uBLASFactory.h"
@@ -26,6 +26,7 @@
 #include "PETScCuspFactory.h"
 #include "EpetraFactory.h"
 #include "STLFactory.h"
+#include "CSRFactory.h"
 #include "DefaultFactory.h"
 
 using namespace dolfin;
@@ -135,6 +136,10 @@ GenericLinearAlgebraFactory& DefaultFactory::factory()
   {
     return STLFactory::instance();
   }
+  else if (backend == "CSR")
+  {
+    return CSRFactory::instance();
+  }
 
   // Fallback
   log(WARNING, "Linear algebra backend \"" + backend + "\" not available, using " + default_backend + ".");
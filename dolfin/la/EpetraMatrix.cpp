@@ -20,13 +20,14 @@
 // Modified by Mikael Mortensen 2011
 //
 // First added:  2008-04-21
-// Last changed: 2012-03-15
+// Last changed: 2013-11-08
 
 #ifdef HAS_TRILINOS
 
 // Included here to avoid a C++ problem with some MPI implementations
 #include <dolfin/common/MPI.h>
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
@@ -58,30 +59,33 @@
 using namespace dolfin;
 
 //-----------------------------------------------------------------------------
-EpetraMatrix::EpetraMatrix()
+EpetraMatrix::EpetraMatrix() : _sparsity_pattern_version(0)
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
 EpetraMatrix::EpetraMatrix(const EpetraMatrix& A)
+  : _sparsity_pattern_version(0)
 {
   if (A.mat())
     _A.reset(new Epetra_FECrsMatrix(*A.mat()));
 }
 //-----------------------------------------------------------------------------
 EpetraMatrix::EpetraMatrix(Teuchos::RCP<Epetra_FECrsMatrix> A)
-  : _A(reference_to_no_delete_pointer(*A.get())), ref_keeper(A)
+  : _A(reference_to_no_delete_pointer(*A.get())), ref_keeper(A),
+    _sparsity_pattern_version(0)
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
-EpetraMatrix::EpetraMatrix(boost::shared_ptr<Epetra_FECrsMatrix> A) : _A(A)
+EpetraMatrix::EpetraMatrix(boost::shared_ptr<Epetra_FECrsMatrix> A)
+  : _A(A), _sparsity_pattern_version(0)
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
 EpetraMatrix::EpetraMatrix(const Epetra_CrsGraph& graph)
-    : _A(new Epetra_FECrsMatrix(Copy, graph))
+    : _A(new Epetra_FECrsMatrix(Copy, graph)), _sparsity_pattern_version(0)
 {
   // Do nothing
 }
@@ -177,6 +181,7 @@ void EpetraMatrix::init(const TensorLayout& tensor_layout)
 
   // Create matrix
   _A.reset(new Epetra_FECrsMatrix(Copy, matrix_map));
+  ++_sparsity_pattern_version;
 }
 //-----------------------------------------------------------------------------
 boost::shared_ptr<GenericMatrix> EpetraMatrix::copy() const
@@ -334,6 +339,62 @@ void EpetraMatrix::add(const double* block,
   }
 }
 //-----------------------------------------------------------------------------
+bool EpetraMatrix::get_positions(std::size_t* positions,
+                                 std::size_t m, const dolfin::la_index* rows,
+                                 std::size_t n,
+                                 const dolfin::la_index* cols) const
+{
+  dolfin_assert(_A);
+  if (!_A->Filled())
+    return false;
+
+  // Get compressed row storage (only available if storage is optimized)
+  int* offsets = 0;
+  int* indices = 0;
+  double* values = 0;
+  if (_A->ExtractCrsDataPointers(offsets, indices, values) != 0)
+    return false;
+
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    // Off-process rows are not stored locally
+    const int local_row = _A->LRID(rows[i]);
+    if (local_row < 0)
+      return false;
+
+    const int* row_begin = indices + offsets[local_row];
+    const int* row_end = indices + offsets[local_row + 1];
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      const int local_col = _A->LCID(cols[j]);
+      const int* entry = std::find(row_begin, row_end, local_col);
+      if (local_col < 0 || entry == row_end)
+        return false;
+      positions[i*n + j] = entry - indices;
+    }
+  }
+
+  return true;
+}
+//-----------------------------------------------------------------------------
+void EpetraMatrix::add_at_positions(const double* values,
+                                    const std::size_t* positions,
+                                    std::size_t num_values)
+{
+  dolfin_assert(_A);
+  int* offsets = 0;
+  int* indices = 0;
+  double* a = 0;
+  if (_A->ExtractCrsDataPointers(offsets, indices, a) != 0)
+  {
+    dolfin_error("EpetraMatrix.cpp",
+                 "add values at positions of Epetra matrix",
+                 "Epetra matrix storage is not optimized");
+  }
+  for (std::size_t i = 0; i < num_values; ++i)
+    a[positions[i]] += values[i];
+}
+//-----------------------------------------------------------------------------
 void EpetraMatrix::axpy(double a, const GenericMatrix& A,
                         bool same_nonzero_pattern)
 {
@@ -742,6 +803,7 @@ const EpetraMatrix& EpetraMatrix::operator= (const EpetraMatrix& A)
     _A.reset(new Epetra_FECrsMatrix(*A.mat()));
   else
     A.mat().reset();
+  ++_sparsity_pattern_version;
 
   return *this;
 }
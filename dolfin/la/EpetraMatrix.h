@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells 2008, 2009
 //
 // First added:  2008-04-21
-// Last changed: 2012-08-20
+// Last changed: 2013-11-08
 
 #ifndef __EPETRA_MATRIX_H
 #define __EPETRA_MATRIX_H
@@ -116,6 +116,17 @@ namespace dolfin
     /// Add block of values
     virtual void add(const double* block, std::size_t m, const dolfin::la_index* rows, std::size_t n, const dolfin::la_index* cols);
 
+    /// Compute positions of entries in local value storage (locally
+    /// owned rows of a filled matrix with optimized storage only)
+    virtual bool get_positions(std::size_t* positions, std::size_t m, const dolfin::la_index* rows, std::size_t n, const dolfin::la_index* cols) const;
+
+    /// Add values at positions in local value storage
+    virtual void add_at_positions(const double* values, const std::size_t* positions, std::size_t num_values);
+
+    /// Return number of times the sparsity pattern has been changed
+    virtual std::size_t sparsity_pattern_version() const
+    { return _sparsity_pattern_version; }
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A, bool same_nonzero_pattern);
 
@@ -172,6 +183,9 @@ namespace dolfin
     // Epetra_FECrsMatrix pointer, used when initialized with a Teuchos::RCP
     // shared_ptr
     Teuchos::RCP<Epetra_FECrsMatrix> ref_keeper;
+
+    // Number of times the sparsity pattern has been changed
+    std::size_t _sparsity_pattern_version;
   };
 
 }
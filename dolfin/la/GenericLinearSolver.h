@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2009-2013
 //
 // First added:  2008-08-26
-// Last changed: 2013-12-04
+// Last changed: 2013-12-11
 
 #ifndef __GENERIC_LINEAR_SOLVER_H
 #define __GENERIC_LINEAR_SOLVER_H
@@ -35,6 +35,7 @@ namespace dolfin
   class GenericLinearOperator;
   class GenericMatrix;
   class GenericVector;
+  class MultiVector;
   class VectorSpaceBasis;
 
   /// This class provides a general solver for linear systems Ax = b.
@@ -85,6 +86,27 @@ namespace dolfin
       return 0;
     }
 
+    /// Solve linear systems AX = B with multiple right-hand sides
+    /// (the columns of B) and return number of iterations
+    virtual std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                              const MultiVector& B)
+    {
+      dolfin_error("GenericLinearSolver.h",
+                   "solve linear system with multiple right-hand sides",
+                   "Not supported by current linear algebra backend");
+      return 0;
+    }
+
+    /// Solve linear systems AX = B with multiple right-hand sides
+    /// (the columns of B) and return number of iterations
+    virtual std::size_t solve(MultiVector& X, const MultiVector& B)
+    {
+      dolfin_error("GenericLinearSolver.h",
+                   "solve linear system with multiple right-hand sides",
+                   "Not supported by current linear algebra backend");
+      return 0;
+    }
+
     /// Solve linear system A^Tx = b
     virtual std::size_t solve_transpose(const GenericLinearOperator& A,
                                         GenericVector& x,
@@ -20,6 +20,8 @@
 // First added:  2010-02-23
 // Last changed: 2013-02-19
 
+#include <algorithm>
+#include <utility>
 #include <dolfin/common/constants.h>
 #include <dolfin/common/Timer.h>
 #include "GenericSparsityPattern.h"
@@ -29,6 +31,17 @@
 
 using namespace dolfin;
 
+namespace
+{
+  // Entry (row, column) and value of a block in a batch
+  typedef std::pair<std::pair<dolfin::la_index, dolfin::la_index>, double>
+    BatchEntry;
+
+  // Compare batch entries by row and column
+  bool compare_indices(const BatchEntry& a, const BatchEntry& b)
+  { return a.first < b.first; }
+}
+
 //-----------------------------------------------------------------------------
 void GenericMatrix::ident_zeros()
 {
@@ -175,3 +188,57 @@ void GenericMatrix::compress()
   apply("insert");
 }
 //-----------------------------------------------------------------------------
+void GenericMatrix::merge_batch(std::vector<dolfin::la_index>& merged_rows,
+                                std::vector<std::size_t>& row_offsets,
+                                std::vector<dolfin::la_index>& merged_cols,
+                                std::vector<double>& merged_values,
+                                std::size_t num_blocks, const double* blocks,
+                                const dolfin::la_index* num_rows,
+                                const dolfin::la_index * const * rows)
+{
+  // Collect entries of all blocks
+  std::vector<BatchEntry> entries;
+  std::size_t num_entries = 0;
+  for (std::size_t k = 0; k < num_blocks; ++k)
+    num_entries += num_rows[2*k]*num_rows[2*k + 1];
+  entries.reserve(num_entries);
+  for (std::size_t k = 0; k < num_blocks; ++k)
+  {
+    const std::size_t m = num_rows[2*k];
+    const std::size_t n = num_rows[2*k + 1];
+    for (std::size_t i = 0; i < m; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+      {
+        entries.push_back(BatchEntry(std::make_pair(rows[2*k][i],
+                                                    rows[2*k + 1][j]),
+                                     blocks[i*n + j]));
+      }
+    blocks += m*n;
+  }
+
+  // Sort entries by row and column and sum duplicates
+  std::sort(entries.begin(), entries.end(), compare_indices);
+  merged_rows.clear();
+  row_offsets.assign(1, 0);
+  merged_cols.clear();
+  merged_values.clear();
+  for (std::size_t e = 0; e < entries.size(); ++e)
+  {
+    const dolfin::la_index row = entries[e].first.first;
+    const dolfin::la_index col = entries[e].first.second;
+    if (merged_rows.empty() || row != merged_rows.back())
+    {
+      merged_rows.push_back(row);
+      row_offsets.push_back(row_offsets.back());
+    }
+    else if (col == merged_cols.back())
+    {
+      merged_values.back() += entries[e].second;
+      continue;
+    }
+    merged_cols.push_back(col);
+    merged_values.push_back(entries[e].second);
+    ++row_offsets.back();
+  }
+}
+//-----------------------------------------------------------------------------
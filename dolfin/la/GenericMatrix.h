@@ -23,11 +23,12 @@
 // Modified by Mikael Mortensen 2011
 //
 // First added:  2006-04-24
-// Last changed: 2012-08-20
+// Last changed: 2013-11-08
 
 #ifndef __GENERIC_MATRIX_H
 #define __GENERIC_MATRIX_H
 
+#include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <vector>
 #include "GenericTensor.h"
@@ -36,6 +37,7 @@
 namespace dolfin
 {
 
+  class AssemblyPlan;
   class GenericVector;
   class TensorLayout;
 
@@ -93,6 +95,19 @@ namespace dolfin
           &(rows[1])[0]);
     }
 
+    /// Add a batch of blocks of values
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows)
+    {
+      for (std::size_t k = 0; k < num_blocks; ++k)
+      {
+        add(blocks, num_rows[2*k], rows[2*k], num_rows[2*k + 1],
+            rows[2*k + 1]);
+        blocks += num_rows[2*k]*num_rows[2*k + 1];
+      }
+    }
+
     /// Set all entries to zero and keep any sparse structure
     virtual void zero() = 0;
 
@@ -131,6 +146,38 @@ namespace dolfin
                      std::size_t m, const dolfin::la_index* rows,
                      std::size_t n, const dolfin::la_index* cols) = 0;
 
+    /// Compute positions in the local value storage of the matrix of
+    /// the m x n entries of a block (stored row-wise, as for add).
+    /// The positions may be passed to add_at_positions for as long
+    /// as the sparsity pattern of the matrix is unchanged (see
+    /// sparsity_pattern_version). Returns
+    /// false if the backend does not provide direct access to its
+    /// value storage, or if an entry is not in the sparsity pattern
+    /// of the finalized matrix.
+    virtual bool get_positions(std::size_t* positions,
+                               std::size_t m, const dolfin::la_index* rows,
+                               std::size_t n,
+                               const dolfin::la_index* cols) const
+    { return false; }
+
+    /// Add values to the entries at the given positions in the local
+    /// value storage of the matrix (see get_positions)
+    virtual void add_at_positions(const double* values,
+                                  const std::size_t* positions,
+                                  std::size_t num_values)
+    {
+      dolfin_error("GenericMatrix.h",
+                   "add values at positions of matrix",
+                   "Direct access to value storage is not supported by this backend");
+    }
+
+    /// Return number of times the sparsity pattern of the matrix has
+    /// been changed (by init or otherwise). Backends that implement
+    /// get_positions must increase the number whenever positions of
+    /// entries in the value storage may change.
+    virtual std::size_t sparsity_pattern_version() const
+    { return 0; }
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A,
                       bool same_nonzero_pattern) = 0;
@@ -225,6 +272,35 @@ namespace dolfin
     /// Compress matrix
     virtual void compress();
 
+    /// Return assembly plan stored with the matrix (if any)
+    boost::shared_ptr<const AssemblyPlan> assembly_plan() const
+    { return _assembly_plan; }
+
+    /// Store assembly plan with the matrix (see _AssemblyPlan_)
+    void set_assembly_plan(boost::shared_ptr<const AssemblyPlan> plan) const
+    { _assembly_plan = plan; }
+
+  protected:
+
+    // Merge a batch of blocks (see add_batch) into a compressed row
+    // list of distinct entries, summing values added to the same
+    // entry. Entries of row merged_rows[i] are in positions
+    // row_offsets[i], ..., row_offsets[i + 1] - 1 of merged_cols and
+    // merged_values, and rows and columns are sorted.
+    static void merge_batch(std::vector<dolfin::la_index>& merged_rows,
+                            std::vector<std::size_t>& row_offsets,
+                            std::vector<dolfin::la_index>& merged_cols,
+                            std::vector<double>& merged_values,
+                            std::size_t num_blocks, const double* blocks,
+                            const dolfin::la_index* num_rows,
+                            const dolfin::la_index * const * rows);
+
+  private:
+
+    // Assembly plan for reassembly of the matrix. It is released
+    // together with the matrix.
+    mutable boost::shared_ptr<const AssemblyPlan> _assembly_plan;
+
   };
 
 }
@@ -84,6 +84,25 @@ namespace dolfin
     virtual void add(const double* block, const dolfin::la_index* num_rows,
                      const dolfin::la_index * const * rows) = 0;
 
+    /// Add a batch of blocks of values. The blocks are stored
+    /// consecutively in blocks, and the dimensions and rows of
+    /// block k are given by num_rows[k*rank() + i] and
+    /// rows[k*rank() + i] for i = 0, ..., rank() - 1.
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows)
+    {
+      const std::size_t r = rank();
+      for (std::size_t k = 0; k < num_blocks; ++k)
+      {
+        add(blocks, num_rows + k*r, rows + k*r);
+        std::size_t block_size = 1;
+        for (std::size_t i = 0; i < r; ++i)
+          block_size *= num_rows[k*r + i];
+        blocks += block_size;
+      }
+    }
+
     /// Set all entries to zero and keep any sparse structure
     virtual void zero() = 0;
 
@@ -97,6 +97,18 @@ namespace dolfin
                      const std::vector<std::vector<dolfin::la_index> >& rows)
     { add(block, rows[0].size(), &(rows[0])[0]); }
 
+    /// Add a batch of blocks of values
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows)
+    {
+      for (std::size_t k = 0; k < num_blocks; ++k)
+      {
+        add(blocks, num_rows[k], rows[k]);
+        blocks += num_rows[k];
+      }
+    }
+
     /// Set all entries to zero and keep any sparse structure
     virtual void zero() = 0;
 
@@ -19,7 +19,7 @@
 // Modified by Anders Logg 2008-2012
 //
 // First added:  2007-07-03
-// Last changed: 2013-11-25
+// Last changed: 2013-12-11
 
 #include <dolfin/common/Timer.h>
 #include <dolfin/parameter/GlobalParameters.h>
@@ -151,6 +151,25 @@ std::size_t KrylovSolver::solve(const GenericLinearOperator& A,
   return solver->solve(A, x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t KrylovSolver::solve(const GenericLinearOperator& A,
+                                MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(solver);
+
+  Timer timer("Krylov solver");
+  solver->parameters.update(parameters);
+  return solver->solve(A, X, B);
+}
+//-----------------------------------------------------------------------------
+std::size_t KrylovSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(solver);
+
+  Timer timer("Krylov solver");
+  solver->parameters.update(parameters);
+  return solver->solve(X, B);
+}
+//-----------------------------------------------------------------------------
 void KrylovSolver::init(std::string method, std::string preconditioner)
 {
   // Get default linear algebra factory
@@ -19,7 +19,7 @@
 // Modified by Anders Logg, 2008.
 //
 // First added:  2007-07-03
-// Last changed: 2013-11-25
+// Last changed: 2013-12-11
 
 #ifndef __KRYLOV_SOLVER_H
 #define __KRYLOV_SOLVER_H
@@ -35,6 +35,7 @@ namespace dolfin
 
   class GenericLinearOperator;
   class GenericVector;
+  class MultiVector;
   class VectorSpaceBasis;
 
   /// This class defines an interface for a Krylov solver. The
@@ -75,6 +76,13 @@ namespace dolfin
     std::size_t solve(const GenericLinearOperator& A,
                       GenericVector& x, const GenericVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
     /// Default parameter values
     static Parameters default_parameters();
 
@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2011-2012
 //
 // First added:  2010-07-11
-// Last changed: 2012-08-20
+// Last changed: 2013-12-11
 
 #include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/common/NoDeleter.h>
@@ -98,6 +98,25 @@ std::size_t LUSolver::solve_transpose(const GenericLinearOperator& A,
   return solver->solve_transpose(A, x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t LUSolver::solve(const GenericLinearOperator& A, MultiVector& X,
+                            const MultiVector& B)
+{
+  dolfin_assert(solver);
+
+  Timer timer("LU solver");
+  solver->parameters.update(parameters);
+  return solver->solve(A, X, B);
+}
+//-----------------------------------------------------------------------------
+std::size_t LUSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(solver);
+
+  Timer timer("LU solver");
+  solver->parameters.update(parameters);
+  return solver->solve(X, B);
+}
+//-----------------------------------------------------------------------------
 void LUSolver::init(std::string method)
 {
   // Get default linear algebra factory
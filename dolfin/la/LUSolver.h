@@ -21,7 +21,7 @@
 // Modified by Kent-Andre Mardal 2008
 //
 // First added:  2007-07-03
-// Last changed: 2013-11-25
+// Last changed: 2013-12-11
 
 #ifndef __LU_SOLVER_H
 #define __LU_SOLVER_H
@@ -36,6 +36,7 @@ namespace dolfin
   // Forward declarations
   class GenericLinearOperator;
   class GenericVector;
+  class MultiVector;
 
   /// LU solver for the built-in LA backends.
 
@@ -70,6 +71,15 @@ namespace dolfin
     std::size_t solve_transpose(const GenericLinearOperator& A,
                                 GenericVector& x, const GenericVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides,
+    /// reusing one factorization
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides,
+    /// reusing one factorization
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
     /// Default parameter values
     static Parameters default_parameters()
     {
@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells, 2010.
 //
 // First added:  2008-05-10
-// Last changed: 2013-12-04
+// Last changed: 2013-12-11
 
 #include "DefaultFactory.h"
 #include "KrylovSolver.h"
@@ -157,6 +157,21 @@ std::size_t LinearSolver::solve(GenericVector& x, const GenericVector& b)
   return solver->solve(x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t LinearSolver::solve(const GenericLinearOperator& A,
+                                MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(solver);
+  solver->parameters.update(parameters);
+  return solver->solve(A, X, B);
+}
+//-----------------------------------------------------------------------------
+std::size_t LinearSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(solver);
+  solver->parameters.update(parameters);
+  return solver->solve(X, B);
+}
+//-----------------------------------------------------------------------------
 bool
 LinearSolver::in_list(const std::string& method,
                       const std::vector<std::pair<std::string, std::string> > methods)
@@ -19,7 +19,7 @@
 // Modified by Ola Skavhaug 2008.
 //
 // First added:  2004-06-19
-// Last changed: 2013-12-04
+// Last changed: 2013-12-11
 
 #ifndef __LINEAR_SOLVER_H
 #define __LINEAR_SOLVER_H
@@ -34,6 +34,7 @@ namespace dolfin
 
   class GenericLinearOperator;
   class GenericVector;
+  class MultiVector;
   class LUSolver;
   class KrylovSolver;
   class LinearVariationalSolver;
@@ -65,6 +66,13 @@ namespace dolfin
     /// Solve linear system Ax = b
     std::size_t solve(GenericVector& x, const GenericVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
     /// Default parameter values
     static Parameters default_parameters()
     {
@@ -20,7 +20,7 @@
 // Modified by Martin Sandve Alnes, 2008.
 //
 // First added:  2006-05-15
-// Last changed: 2009-09-08
+// Last changed: 2013-11-08
 
 #ifndef __MATRIX_H
 #define __MATRIX_H
@@ -118,6 +118,29 @@ namespace dolfin
                      std::size_t n, const dolfin::la_index* cols)
     { matrix->add(block, m, rows, n, cols); }
 
+    /// Add a batch of blocks of values
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows)
+    { matrix->add_batch(num_blocks, blocks, num_rows, rows); }
+
+    /// Compute positions of entries in local value storage
+    virtual bool get_positions(std::size_t* positions,
+                               std::size_t m, const dolfin::la_index* rows,
+                               std::size_t n,
+                               const dolfin::la_index* cols) const
+    { return matrix->get_positions(positions, m, rows, n, cols); }
+
+    /// Add values at positions in local value storage
+    virtual void add_at_positions(const double* values,
+                                  const std::size_t* positions,
+                                  std::size_t num_values)
+    { matrix->add_at_positions(values, positions, num_values); }
+
+    /// Return number of times the sparsity pattern has been changed
+    virtual std::size_t sparsity_pattern_version() const
+    { return matrix->sparsity_pattern_version(); }
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A,
                       bool same_nonzero_pattern)
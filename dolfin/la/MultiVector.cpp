@@ -0,0 +1,133 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#include <algorithm>
+#include <sstream>
+#include <dolfin/log/log.h>
+#include "GenericVector.h"
+#include "MultiVector.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+MultiVector::MultiVector() : _size(0), _local_range(0, 0), _num_vectors(0)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+MultiVector::MultiVector(std::size_t size, std::size_t num_vectors)
+  : _size(0), _local_range(0, 0), _num_vectors(0)
+{
+  init(size, num_vectors);
+}
+//-----------------------------------------------------------------------------
+MultiVector::MultiVector(const GenericVector& x, std::size_t num_vectors)
+  : _size(0), _local_range(0, 0), _num_vectors(0)
+{
+  init(x, num_vectors);
+}
+//-----------------------------------------------------------------------------
+MultiVector::~MultiVector()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void MultiVector::init(std::size_t size, std::size_t num_vectors)
+{
+  _size = size;
+  _local_range = std::make_pair(0, size);
+  _num_vectors = num_vectors;
+  _values.assign(size*num_vectors, 0.0);
+}
+//-----------------------------------------------------------------------------
+void MultiVector::init(const GenericVector& x, std::size_t num_vectors)
+{
+  _size = x.size();
+  _local_range = x.local_range();
+  _num_vectors = num_vectors;
+  _values.assign(local_size()*num_vectors, 0.0);
+}
+//-----------------------------------------------------------------------------
+bool MultiVector::has_layout(const GenericVector& x) const
+{
+  return x.size() == _size && x.local_range() == _local_range;
+}
+//-----------------------------------------------------------------------------
+void MultiVector::zero()
+{
+  std::fill(_values.begin(), _values.end(), 0.0);
+}
+//-----------------------------------------------------------------------------
+void MultiVector::get(GenericVector& x, std::size_t j) const
+{
+  if (j >= _num_vectors || !has_layout(x))
+  {
+    dolfin_error("MultiVector.cpp",
+                 "get vector from block of vectors",
+                 "Vector %d does not exist or has a different layout",
+                 (int) j);
+  }
+
+  const std::size_t n = local_size();
+  std::vector<double> values(_values.begin() + j*n,
+                             _values.begin() + (j + 1)*n);
+  x.set_local(values);
+  x.apply("insert");
+}
+//-----------------------------------------------------------------------------
+void MultiVector::set(const GenericVector& x, std::size_t j)
+{
+  if (j >= _num_vectors || !has_layout(x))
+  {
+    dolfin_error("MultiVector.cpp",
+                 "set vector in block of vectors",
+                 "Vector %d does not exist or has a different layout",
+                 (int) j);
+  }
+
+  std::vector<double> values;
+  x.get_local(values);
+  dolfin_assert(values.size() == local_size());
+  std::copy(values.begin(), values.end(), _values.begin() + j*local_size());
+}
+//-----------------------------------------------------------------------------
+std::string MultiVector::str(bool verbose) const
+{
+  std::stringstream s;
+  if (verbose)
+  {
+    s << str(false) << std::endl << std::endl;
+    const std::size_t n = local_size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      s << "|";
+      for (std::size_t j = 0; j < _num_vectors; ++j)
+        s << " " << _values[j*n + i];
+      s << " |" << std::endl;
+    }
+  }
+  else
+  {
+    s << "<MultiVector of " << _num_vectors << " vectors of size "
+      << _size << ">";
+  }
+  return s.str();
+}
+//-----------------------------------------------------------------------------
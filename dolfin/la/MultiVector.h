@@ -0,0 +1,123 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifndef __DOLFIN_MULTI_VECTOR_H
+#define __DOLFIN_MULTI_VECTOR_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <dolfin/common/Variable.h>
+
+namespace dolfin
+{
+
+  class GenericVector;
+
+  /// This class implements a block of vectors with the same size and
+  /// parallel layout, for example the right-hand sides and solutions
+  /// of linear systems with multiple right-hand sides (see
+  /// _GenericLinearSolver_). The local entries of all vectors are
+  /// stored contiguously, one vector after the other (column-major
+  /// order), so that the block may be passed to a backend in a single
+  /// call.
+
+  class MultiVector : public Variable
+  {
+  public:
+
+    /// Create empty block of vectors
+    MultiVector();
+
+    /// Create block of num_vectors (serial) vectors of given size
+    MultiVector(std::size_t size, std::size_t num_vectors);
+
+    /// Create block of num_vectors vectors with the layout of x
+    MultiVector(const GenericVector& x, std::size_t num_vectors);
+
+    /// Destructor
+    ~MultiVector();
+
+    /// Initialize block of num_vectors (serial) vectors of given size
+    void init(std::size_t size, std::size_t num_vectors);
+
+    /// Initialize block of num_vectors vectors with the layout of x
+    void init(const GenericVector& x, std::size_t num_vectors);
+
+    /// Return global size of each vector
+    std::size_t size() const
+    { return _size; }
+
+    /// Return local size of each vector
+    std::size_t local_size() const
+    { return _local_range.second - _local_range.first; }
+
+    /// Return local ownership range of each vector
+    std::pair<std::size_t, std::size_t> local_range() const
+    { return _local_range; }
+
+    /// Return number of vectors
+    std::size_t num_vectors() const
+    { return _num_vectors; }
+
+    /// Check whether the block has the layout of x
+    bool has_layout(const GenericVector& x) const;
+
+    /// Set all entries to zero
+    void zero();
+
+    /// Copy vector j of the block to x (which must have the layout of
+    /// the block)
+    void get(GenericVector& x, std::size_t j) const;
+
+    /// Copy x to vector j of the block
+    void set(const GenericVector& x, std::size_t j);
+
+    /// Return pointer to local entries (vector j starts at offset
+    /// j*local_size())
+    double* data()
+    { return _values.empty() ? 0 : &_values[0]; }
+
+    /// Return pointer to local entries (const version)
+    const double* data() const
+    { return _values.empty() ? 0 : &_values[0]; }
+
+    /// Return informal string representation (pretty-print)
+    std::string str(bool verbose) const;
+
+  private:
+
+    // Global size of each vector
+    std::size_t _size;
+
+    // Local ownership range of each vector
+    std::pair<std::size_t, std::size_t> _local_range;
+
+    // Number of vectors
+    std::size_t _num_vectors;
+
+    // Local entries (column-major)
+    std::vector<double> _values;
+
+  };
+
+}
+
+#endif
@@ -20,7 +20,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2005-12-02
-// Last changed: 2013-11-25
+// Last changed: 2013-12-11
 
 #ifdef HAS_PETSC
 
@@ -33,6 +33,7 @@
 #include "GenericMatrix.h"
 #include "GenericVector.h"
 #include "KrylovSolver.h"
+#include "MultiVector.h"
 #include "PETScBaseMatrix.h"
 #include "PETScMatrix.h"
 #include "PETScPreconditioner.h"
@@ -80,6 +81,12 @@ const std::map<std::string, const KSPType> PETScKrylovSolver::_methods
                               ("minres",     KSPMINRES)
                               ("tfqmr",      KSPTFQMR)
                               ("richardson", KSPRICHARDSON)
+                              #ifdef KSPPGMRES
+                              ("pgmres",     KSPPGMRES)
+                              #endif
+                              #ifdef KSPPIPECG
+                              ("pipecg",     KSPPIPECG)
+                              #endif
                               ("bicgstab",   KSPBCGS);
 
 // Mapping from method string to description
@@ -91,6 +98,12 @@ const std::vector<std::pair<std::string, std::string> >
     ("minres",     "Minimal residual method")
     ("tfqmr",      "Transpose-free quasi-minimal residual method")
     ("richardson", "Richardson method")
+    #ifdef KSPPGMRES
+    ("pgmres",     "Pipelined generalized minimal residual method")
+    #endif
+    #ifdef KSPPIPECG
+    ("pipecg",     "Pipelined conjugate gradient method")
+    #endif
     ("bicgstab",   "Biconjugate gradient stabilized method");
 
 //-----------------------------------------------------------------------------
@@ -293,6 +306,13 @@ std::size_t PETScKrylovSolver::solve(const GenericLinearOperator& A,
 }
 //-----------------------------------------------------------------------------
 std::size_t PETScKrylovSolver::solve(PETScVector& x, const PETScVector& b)
+{
+  const std::string mat_structure = parameters("preconditioner")["structure"];
+  return solve(x, b, mat_structure);
+}
+//-----------------------------------------------------------------------------
+std::size_t PETScKrylovSolver::solve(PETScVector& x, const PETScVector& b,
+                                     const std::string& mat_structure)
 {
   Timer timer("PETSc Krylov solver");
 
@@ -328,7 +348,7 @@ std::size_t PETScKrylovSolver::solve(PETScVector& x, const PETScVector& b)
   set_petsc_ksp_options();
 
   // Set operators
-  set_petsc_operators();
+  set_petsc_operators(mat_structure);
 
   // Set (approxinate) null space for preconditioner
   if (_preconditioner)
@@ -470,6 +490,44 @@ std::size_t PETScKrylovSolver::solve(const PETScBaseMatrix& A,
   return solve(x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t PETScKrylovSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(_A);
+
+  // Create vectors compatible with A
+  PETScVector x, b;
+  _A->resize(x, 1);
+  _A->resize(b, 0);
+
+  // Initialize solutions if required
+  if (!X.has_layout(x) || X.num_vectors() != B.num_vectors())
+    X.init(x, B.num_vectors());
+
+  // Solve for one right-hand side at a time. The preconditioner is
+  // computed for the first right-hand side only and then reused.
+  std::string mat_structure = parameters("preconditioner")["structure"];
+  std::size_t num_iterations = 0;
+  for (std::size_t j = 0; j < B.num_vectors(); ++j)
+  {
+    B.get(b, j);
+    X.get(x, j);
+    num_iterations += solve(x, b, mat_structure);
+    X.set(x, j);
+    mat_structure = "same";
+  }
+
+  return num_iterations;
+}
+//-----------------------------------------------------------------------------
+std::size_t PETScKrylovSolver::solve(const GenericLinearOperator& A,
+                                     MultiVector& X, const MultiVector& B)
+{
+  boost::shared_ptr<const PETScBaseMatrix>
+    Atmp(&as_type<const PETScBaseMatrix>(A), NoDeleter());
+  set_operator(Atmp);
+  return solve(X, B);
+}
+//-----------------------------------------------------------------------------
 boost::shared_ptr<KSP> PETScKrylovSolver::ksp() const
 {
   return _ksp;
@@ -530,14 +588,11 @@ void PETScKrylovSolver::init(const std::string& method)
   }
 }
 //-----------------------------------------------------------------------------
-void PETScKrylovSolver::set_petsc_operators()
+void PETScKrylovSolver::set_petsc_operators(const std::string& mat_structure)
 {
   dolfin_assert(_A);
   dolfin_assert(_P);
 
-  // Get parameter
-  const std::string mat_structure = parameters("preconditioner")["structure"];
-
   // Set operators with appropriate option
   PetscErrorCode ierr;
   if (mat_structure == "same")
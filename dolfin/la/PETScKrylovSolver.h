@@ -21,7 +21,7 @@
 // Modified by Garth N. Wells 2005-2010
 //
 // First added:  2005-12-02
-// Last changed: 2012-08-20
+// Last changed: 2013-12-11
 
 #ifndef __DOLFIN_PETSC_KRYLOV_SOLVER_H
 #define __DOLFIN_PETSC_KRYLOV_SOLVER_H
@@ -42,6 +42,7 @@ namespace dolfin
   /// Forward declarations
   class GenericMatrix;
   class GenericVector;
+  class MultiVector;
   class PETScBaseMatrix;
   class PETScMatrix;
   class PETScVector;
@@ -123,6 +124,16 @@ namespace dolfin
     std::size_t solve(const PETScBaseMatrix& A, PETScVector& x,
                       const PETScVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides,
+    /// reusing the preconditioner, and return the total number of
+    /// iterations
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides and
+    /// return the total number of iterations
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -148,8 +159,13 @@ namespace dolfin
     // Initialize KSP solver
     void init(const std::string& method);
 
-    // Set PETSc operators
-    void set_petsc_operators();
+    // Solve linear system Ax = b with given preconditioner re-use
+    // option (see parameter ("preconditioner", "structure"))
+    std::size_t solve(PETScVector& x, const PETScVector& b,
+                      const std::string& mat_structure);
+
+    // Set PETSc operators with given preconditioner re-use option
+    void set_petsc_operators(const std::string& mat_structure);
 
     // Set options that affect KSP object
     void set_petsc_ksp_options();
@@ -20,7 +20,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2005
-// Last changed: 2011-11-11
+// Last changed: 2013-12-11
 
 #ifdef HAS_PETSC
 
@@ -34,6 +34,7 @@
 #include <dolfin/common/MPI.h>
 #include <dolfin/parameter/GlobalParameters.h>
 #include "LUSolver.h"
+#include "MultiVector.h"
 #include "PETScMatrix.h"
 #include "PETScVector.h"
 #include "PETScLUSolver.h"
@@ -279,6 +280,101 @@ std::size_t PETScLUSolver::solve(const PETScMatrix& A, PETScVector& x,
   return solve(x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t PETScLUSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  Timer timer("PETSc LU solver");
+
+  dolfin_assert(_ksp);
+  dolfin_assert(_A);
+
+  PetscErrorCode ierr;
+
+  // Check dimensions
+  if (_A->size(0) != _A->size(1))
+  {
+    dolfin_error("PETScLUSolver.cpp",
+                 "solve linear system using PETSc LU solver",
+                 "Cannot factorize non-square PETSc matrix");
+  }
+  if (_A->size(0) != B.size())
+  {
+    dolfin_error("PETScLUSolver.cpp",
+                 "solve linear system using PETSc LU solver",
+                 "Non-matching dimensions for linear system (columns of right-hand side block B have size %d, matrix has %d rows)",
+                 B.size(), _A->size(0));
+  }
+
+  // Check that right-hand sides have the row layout of A
+  PETScVector b, x;
+  _A->resize(b, 0);
+  if (!B.has_layout(b))
+  {
+    dolfin_error("PETScLUSolver.cpp",
+                 "solve linear system using PETSc LU solver",
+                 "Right-hand sides do not have the parallel layout of the matrix rows");
+  }
+
+  // Initialize solutions if required (make compatible with A in parallel)
+  _A->resize(x, 1);
+  if (!X.has_layout(x) || X.num_vectors() != B.num_vectors())
+    X.init(x, B.num_vectors());
+
+  // Set PETSc operators (depends on factorization re-use options);
+  set_petsc_operators();
+
+  // Write a pre-solve message
+  pre_report(*_A);
+
+  // Factorize (if required) and get factored matrix
+  configure_ksp(_solver_package);
+  ierr = KSPSetUp(*_ksp);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetUp");
+
+  PC pc;
+  ierr = KSPGetPC(*_ksp, &pc);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPGetPC");
+  Mat F;
+  ierr = PCFactorGetMatrix(pc, &F);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "PCFactorGetMatrix");
+
+  if (B.num_vectors() == 0)
+    return 1;
+
+  // Wrap blocks as dense PETSc matrices (no copy, both are stored
+  // column-major with leading dimension equal to the local size)
+  MPI_Comm comm;
+  ierr = PetscObjectGetComm((PetscObject) *_A->mat(), &comm);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "PetscObjectGetComm");
+
+  Mat _B, _X;
+  ierr = MatCreateDense(comm, B.local_size(), PETSC_DECIDE, B.size(),
+                        B.num_vectors(), const_cast<double*>(B.data()), &_B);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatCreateDense");
+  ierr = MatCreateDense(comm, X.local_size(), PETSC_DECIDE, X.size(),
+                        X.num_vectors(), X.data(), &_X);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatCreateDense");
+
+  // Solve linear systems
+  ierr = MatMatSolve(F, _B, _X);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatMatSolve");
+
+  ierr = MatDestroy(&_B);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatDestroy");
+  ierr = MatDestroy(&_X);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatDestroy");
+
+  return 1;
+}
+//-----------------------------------------------------------------------------
+std::size_t PETScLUSolver::solve(const GenericLinearOperator& A,
+                                 MultiVector& X, const MultiVector& B)
+{
+  boost::shared_ptr<const PETScMatrix>
+    Atmp(&as_type<const PETScMatrix>(require_matrix(A)), NoDeleter());
+  set_operator(Atmp);
+  return solve(X, B);
+}
+//-----------------------------------------------------------------------------
 std::size_t PETScLUSolver::solve_transpose(GenericVector& x,
                                            const GenericVector& b)
 {
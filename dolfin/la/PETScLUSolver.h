@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2009-2010.
 //
 // First added:  2005
-// Last changed: 2011-10-19
+// Last changed: 2013-12-11
 
 #ifndef __DOLFIN_PETSC_LU_SOLVER_H
 #define __DOLFIN_PETSC_LU_SOLVER_H
@@ -37,6 +37,7 @@ namespace dolfin
   /// Forward declarations
   class GenericLinearOperator;
   class GenericVector;
+  class MultiVector;
   class PETScLinearOperator;
   class PETScMatrix;
   class PETScVector;
@@ -84,6 +85,14 @@ namespace dolfin
     std::size_t solve(const PETScMatrix& A, PETScVector& x,
                       const PETScVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides
+    /// using one factorization
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
     /// Solve linear system A^Tx = b
     std::size_t solve_transpose(GenericVector& x, const GenericVector& b);
 
@@ -23,10 +23,11 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2004
-// Last changed: 2013-09-24
+// Last changed: 2013-12-11
 
 #ifdef HAS_PETSC
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -42,16 +43,92 @@
 #include "TensorLayout.h"
 #include "PETScFactory.h"
 #include "PETScCuspFactory.h"
+#include <dolfin/parameter/GlobalParameters.h>
 
 using namespace dolfin;
 
+namespace
+{
+  // Return block size of matrix if it is stored in block (BAIJ)
+  // format, otherwise 1
+  std::size_t block_format_size(const Mat A)
+  {
+    PetscBool is_seqbaij = PETSC_FALSE;
+    PetscBool is_mpibaij = PETSC_FALSE;
+    PetscErrorCode ierr = PetscObjectTypeCompare((PetscObject) A, MATSEQBAIJ,
+                                                 &is_seqbaij);
+    if (ierr != 0)
+      PETScObject::petsc_error(ierr, __FILE__, "PetscObjectTypeCompare");
+    ierr = PetscObjectTypeCompare((PetscObject) A, MATMPIBAIJ, &is_mpibaij);
+    if (ierr != 0)
+      PETScObject::petsc_error(ierr, __FILE__, "PetscObjectTypeCompare");
+    if (!is_seqbaij && !is_mpibaij)
+      return 1;
+
+    PetscInt block_size = 1;
+    ierr = MatGetBlockSize(A, &block_size);
+    if (ierr != 0) PETScObject::petsc_error(ierr, __FILE__, "MatGetBlockSize");
+    return block_size;
+  }
+
+  // Count number of nonzero blocks in each block row of a sparsity
+  // pattern (column indices for each row)
+  std::vector<PetscInt>
+  count_blocks(const std::vector<std::vector<std::size_t> >& pattern,
+               std::size_t block_size)
+  {
+    dolfin_assert(pattern.size() % block_size == 0);
+    std::vector<PetscInt> num_blocks(pattern.size()/block_size);
+    std::vector<std::size_t> block_columns;
+    for (std::size_t i = 0; i < num_blocks.size(); ++i)
+    {
+      block_columns.clear();
+      for (std::size_t k = 0; k < block_size; ++k)
+      {
+        const std::vector<std::size_t>& row = pattern[i*block_size + k];
+        for (std::size_t j = 0; j < row.size(); ++j)
+          block_columns.push_back(row[j]/block_size);
+      }
+      std::sort(block_columns.begin(), block_columns.end());
+      num_blocks[i] = std::unique(block_columns.begin(), block_columns.end())
+        - block_columns.begin();
+    }
+    return num_blocks;
+  }
+
+  // Extract block indices from dof indices if the dofs are numbered
+  // node by node with interleaved components, i.e. entry c*k + i is
+  // b*block_size + c for k = num_dofs/block_size nodes
+  bool extract_blocks(std::vector<PetscInt>& blocks, std::size_t num_dofs,
+                      const dolfin::la_index* dofs, std::size_t block_size)
+  {
+    if (num_dofs % block_size != 0)
+      return false;
+    const std::size_t num_nodes = num_dofs/block_size;
+    blocks.resize(num_nodes);
+    for (std::size_t i = 0; i < num_nodes; ++i)
+    {
+      if (dofs[i] % block_size != 0)
+        return false;
+      for (std::size_t c = 1; c < block_size; ++c)
+      {
+        if (dofs[c*num_nodes + i] != dofs[i] + (dolfin::la_index) c)
+          return false;
+      }
+      blocks[i] = dofs[i]/block_size;
+    }
+    return true;
+  }
+}
+
 const std::map<std::string, NormType> PETScMatrix::norm_types
   = boost::assign::map_list_of("l1",        NORM_1)
                               ("linf",      NORM_INFINITY)
                               ("frobenius", NORM_FROBENIUS);
 
 //-----------------------------------------------------------------------------
-PETScMatrix::PETScMatrix(bool use_gpu) : _use_gpu(use_gpu)
+PETScMatrix::PETScMatrix(bool use_gpu) : _use_gpu(use_gpu), _block_size(1),
+  _sparsity_pattern_version(0)
 {
 #ifndef HAS_PETSC_CUSP
   if (use_gpu)
@@ -66,7 +143,8 @@ PETScMatrix::PETScMatrix(bool use_gpu) : _use_gpu(use_gpu)
 }
 //-----------------------------------------------------------------------------
 PETScMatrix::PETScMatrix(boost::shared_ptr<Mat> A, bool use_gpu) :
-  PETScBaseMatrix(A), _use_gpu(use_gpu)
+  PETScBaseMatrix(A), _use_gpu(use_gpu), _block_size(1),
+  _sparsity_pattern_version(0)
 {
 #ifndef HAS_PETSC_CUSP
   if (use_gpu)
@@ -76,9 +154,14 @@ PETScMatrix::PETScMatrix(boost::shared_ptr<Mat> A, bool use_gpu) :
                  "PETSc not compiled with Cusp support");
   }
 #endif
+
+  if (_A)
+    _block_size = block_format_size(*_A);
 }
 //-----------------------------------------------------------------------------
-PETScMatrix::PETScMatrix(const PETScMatrix& A): _use_gpu(false)
+PETScMatrix::PETScMatrix(const PETScMatrix& A): _use_gpu(false),
+                                                _block_size(1),
+                                                _sparsity_pattern_version(0)
 {
   *this = A;
 }
@@ -136,6 +219,15 @@ void PETScMatrix::init(const TensorLayout& tensor_layout)
                  "More than one object points to the underlying PETSc object");
   }
   _A.reset(new Mat, PETScMatrixDeleter());
+  ++_sparsity_pattern_version;
+
+  // Use block (BAIJ) format if requested and dofs are blocked
+  const std::size_t block_size = tensor_layout.block_size;
+  const bool block_matrices = dolfin::parameters["block_matrices"];
+  const bool use_block_format = block_matrices && block_size > 1 && !_use_gpu
+    && M % block_size == 0 && N % block_size == 0
+    && m % block_size == 0 && n % block_size == 0;
+  _block_size = use_block_format ? block_size : 1;
 
   // Initialize matrix
   if (row_range.first == 0 && row_range.second == M)
@@ -161,7 +253,7 @@ void PETScMatrix::init(const TensorLayout& tensor_layout)
     // Set matrix type according to chosen architecture
     if (!_use_gpu)
     {
-      ierr = MatSetType(*_A, MATSEQAIJ);
+      ierr = MatSetType(*_A, use_block_format ? MATSEQBAIJ : MATSEQAIJ);
       if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetType");
     }
     #ifdef HAS_PETSC_CUSP
@@ -183,11 +275,24 @@ void PETScMatrix::init(const TensorLayout& tensor_layout)
 
     // Allocate space (using data from sparsity pattern)
 
-    // Copy number of non-zeros to PetscInt type
-    const std::vector<PetscInt> _num_nonzeros(num_nonzeros.begin(),
-                                              num_nonzeros.end());
-    ierr = MatSeqAIJSetPreallocation(*_A, 0, _num_nonzeros.data());
-    if (ierr != 0) petsc_error(ierr, __FILE__, "MatSeqAIJSetPreallocation");
+    if (use_block_format)
+    {
+      // Number of nonzero blocks for each block row
+      const std::vector<PetscInt> num_blocks
+        = count_blocks(sparsity_pattern.diagonal_pattern(GenericSparsityPattern::unsorted),
+                       block_size);
+      ierr = MatSeqBAIJSetPreallocation(*_A, block_size, 0,
+                                        num_blocks.data());
+      if (ierr != 0) petsc_error(ierr, __FILE__, "MatSeqBAIJSetPreallocation");
+    }
+    else
+    {
+      // Copy number of non-zeros to PetscInt type
+      const std::vector<PetscInt> _num_nonzeros(num_nonzeros.begin(),
+                                                num_nonzeros.end());
+      ierr = MatSeqAIJSetPreallocation(*_A, 0, _num_nonzeros.data());
+      if (ierr != 0) petsc_error(ierr, __FILE__, "MatSeqAIJSetPreallocation");
+    }
 
     // Set column indices
     /*
@@ -234,7 +339,7 @@ void PETScMatrix::init(const TensorLayout& tensor_layout)
     if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetSizes");
 
     // Set matrix type
-    ierr = MatSetType(*_A, MATMPIAIJ);
+    ierr = MatSetType(*_A, use_block_format ? MATMPIBAIJ : MATMPIAIJ);
     if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetType");
 
     // Set block size
@@ -244,15 +349,32 @@ void PETScMatrix::init(const TensorLayout& tensor_layout)
       if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetBlockSize");
     }
     // Allocate space (using data from sparsity pattern)
-    const std::vector<PetscInt>
-      _num_nonzeros_diagonal(num_nonzeros_diagonal.begin(),
-                             num_nonzeros_diagonal.end());
-    const std::vector<PetscInt>
-      _num_nonzeros_off_diagonal(num_nonzeros_off_diagonal.begin(),
-                                 num_nonzeros_off_diagonal.end());
-    ierr = MatMPIAIJSetPreallocation(*_A, 0, _num_nonzeros_diagonal.data(),
-                                     0, _num_nonzeros_off_diagonal.data());
-    if (ierr != 0) petsc_error(ierr, __FILE__, "MatMPIAIJSetPreallocation");
+    if (use_block_format)
+    {
+      // Number of nonzero blocks for each block row
+      const std::vector<PetscInt> num_blocks_diagonal
+        = count_blocks(sparsity_pattern.diagonal_pattern(GenericSparsityPattern::unsorted),
+                       block_size);
+      const std::vector<PetscInt> num_blocks_off_diagonal
+        = count_blocks(sparsity_pattern.off_diagonal_pattern(GenericSparsityPattern::unsorted),
+                       block_size);
+      ierr = MatMPIBAIJSetPreallocation(*_A, block_size,
+                                        0, num_blocks_diagonal.data(),
+                                        0, num_blocks_off_diagonal.data());
+      if (ierr != 0) petsc_error(ierr, __FILE__, "MatMPIBAIJSetPreallocation");
+    }
+    else
+    {
+      const std::vector<PetscInt>
+        _num_nonzeros_diagonal(num_nonzeros_diagonal.begin(),
+                               num_nonzeros_diagonal.end());
+      const std::vector<PetscInt>
+        _num_nonzeros_off_diagonal(num_nonzeros_off_diagonal.begin(),
+                                   num_nonzeros_off_diagonal.end());
+      ierr = MatMPIAIJSetPreallocation(*_A, 0, _num_nonzeros_diagonal.data(),
+                                       0, _num_nonzeros_off_diagonal.data());
+      if (ierr != 0) petsc_error(ierr, __FILE__, "MatMPIAIJSetPreallocation");
+    }
   }
 
   // Set some options
@@ -298,10 +420,128 @@ void PETScMatrix::add(const double* block,
                       std::size_t n, const dolfin::la_index* cols)
 {
   dolfin_assert(_A);
+
+  // Add block-wise to block matrix if dofs are blocked
+  if (_block_size > 1)
+  {
+    std::vector<PetscInt> block_rows, block_cols;
+    if (extract_blocks(block_rows, m, rows, _block_size)
+        && extract_blocks(block_cols, n, cols, _block_size))
+    {
+      // Permute values from component-wise to node-wise order
+      const std::size_t bs = _block_size;
+      const std::size_t mb = block_rows.size();
+      const std::size_t nb = block_cols.size();
+      std::vector<double> values(m*n);
+      for (std::size_t c0 = 0; c0 < bs; ++c0)
+        for (std::size_t i = 0; i < mb; ++i)
+          for (std::size_t c1 = 0; c1 < bs; ++c1)
+            for (std::size_t j = 0; j < nb; ++j)
+            {
+              values[(i*bs + c0)*n + j*bs + c1]
+                = block[(c0*mb + i)*n + c1*nb + j];
+            }
+
+      PetscErrorCode ierr = MatSetValuesBlocked(*_A, mb, block_rows.data(),
+                                                nb, block_cols.data(),
+                                                values.data(), ADD_VALUES);
+      if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetValuesBlocked");
+      return;
+    }
+  }
+
   PetscErrorCode ierr = MatSetValues(*_A, m, rows, n, cols, block, ADD_VALUES);
   if (ierr != 0) petsc_error(ierr, __FILE__, "MatSetValues");
 }
 //-----------------------------------------------------------------------------
+void PETScMatrix::add_batch(std::size_t num_blocks, const double* blocks,
+                            const dolfin::la_index* num_rows,
+                            const dolfin::la_index * const * rows)
+{
+  dolfin_assert(_A);
+
+  // The blocks are not merged into one MatSetValues call: the union
+  // of their rows and columns spans entries outside the sparsity
+  // pattern, and inserting (zero) values there is an error once the
+  // matrix has been assembled (MAT_NEW_NONZERO_ALLOCATION_ERR)
+  for (std::size_t k = 0; k < num_blocks; ++k)
+  {
+    add(blocks, num_rows[2*k], rows[2*k], num_rows[2*k + 1], rows[2*k + 1]);
+    blocks += num_rows[2*k]*num_rows[2*k + 1];
+  }
+}
+//-----------------------------------------------------------------------------
+bool PETScMatrix::get_positions(std::size_t* positions,
+                                std::size_t m, const dolfin::la_index* rows,
+                                std::size_t n,
+                                const dolfin::la_index* cols) const
+{
+  dolfin_assert(_A);
+
+  // Direct access to values is only available for sequential AIJ
+  // matrices
+  PetscBool is_seqaij = PETSC_FALSE;
+  PetscErrorCode ierr = PetscObjectTypeCompare((PetscObject)*_A, MATSEQAIJ,
+                                               &is_seqaij);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "PetscObjectTypeCompare");
+  if (!is_seqaij)
+    return false;
+
+  // Get compressed row structure
+  PetscInt num_rows = 0;
+  const PetscInt* ia = NULL;
+  const PetscInt* ja = NULL;
+  PetscBool done = PETSC_FALSE;
+  ierr = MatGetRowIJ(*_A, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &ia, &ja,
+                     &done);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatGetRowIJ");
+  if (!done)
+    return false;
+
+  // Locate entries (columns are sorted within each row)
+  bool found = true;
+  for (std::size_t i = 0; i < m && found; ++i)
+  {
+    if (rows[i] < 0 || rows[i] >= num_rows)
+    {
+      found = false;
+      break;
+    }
+    const PetscInt* row_begin = ja + ia[rows[i]];
+    const PetscInt* row_end = ja + ia[rows[i] + 1];
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      const PetscInt* entry = std::lower_bound(row_begin, row_end, cols[j]);
+      if (entry == row_end || *entry != cols[j])
+      {
+        found = false;
+        break;
+      }
+      positions[i*n + j] = entry - ja;
+    }
+  }
+
+  ierr = MatRestoreRowIJ(*_A, 0, PETSC_FALSE, PETSC_FALSE, &num_rows, &ia,
+                         &ja, &done);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatRestoreRowIJ");
+
+  return found;
+}
+//-----------------------------------------------------------------------------
+void PETScMatrix::add_at_positions(const double* values,
+                                   const std::size_t* positions,
+                                   std::size_t num_values)
+{
+  dolfin_assert(_A);
+  PetscScalar* a = NULL;
+  PetscErrorCode ierr = MatSeqAIJGetArray(*_A, &a);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatSeqAIJGetArray");
+  for (std::size_t i = 0; i < num_values; ++i)
+    a[positions[i]] += values[i];
+  ierr = MatSeqAIJRestoreArray(*_A, &a);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "MatSeqAIJRestoreArray");
+}
+//-----------------------------------------------------------------------------
 void PETScMatrix::axpy(double a, const GenericMatrix& A,
                        bool same_nonzero_pattern)
 {
@@ -317,8 +557,10 @@ void PETScMatrix::axpy(double a, const GenericMatrix& A,
   }
   else
   {
+    // The nonzero pattern of the matrix may grow
     ierr = MatAXPY(*_A, a, *AA->mat(), DIFFERENT_NONZERO_PATTERN);
     if (ierr != 0) petsc_error(ierr, __FILE__, "MatAXPY");
+    ++_sparsity_pattern_version;
   }
 }
 //-----------------------------------------------------------------------------
@@ -571,6 +813,7 @@ GenericLinearAlgebraFactory& PETScMatrix::factory() const
 //-----------------------------------------------------------------------------
 const PETScMatrix& PETScMatrix::operator= (const PETScMatrix& A)
 {
+  ++_sparsity_pattern_version;
   if (!A.mat())
     _A.reset();
   else if (this != &A) // Check for self-assignment
@@ -586,6 +829,7 @@ const PETScMatrix& PETScMatrix::operator= (const PETScMatrix& A)
     // Duplicate with the same pattern as A.A
     PetscErrorCode ierr = MatDuplicate(*A.mat(), MAT_COPY_VALUES, _A.get());
     if (ierr != 0) petsc_error(ierr, __FILE__, "MatDuplicate");
+    _block_size = A._block_size;
   }
   return *this;
 }
@@ -22,7 +22,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2004-01-01
-// Last changed: 2012-08-22
+// Last changed: 2013-12-11
 
 #ifndef __PETSC_MATRIX_H
 #define __PETSC_MATRIX_H
@@ -49,6 +49,11 @@ namespace dolfin
   /// The interface is intentionally simple. For advanced usage,
   /// access the PETSc Mat pointer using the function mat() and
   /// use the standard PETSc interface.
+  ///
+  /// If the global parameter "block_matrices" is true and the tensor
+  /// layout has a block size larger than one (vector-valued function
+  /// spaces with interleaved dofs), the matrix is created in block
+  /// (BAIJ) format and element matrices are added block by block.
 
   class PETScMatrix : public GenericMatrix, public PETScBaseMatrix
   {
@@ -126,6 +131,28 @@ namespace dolfin
                      std::size_t m, const dolfin::la_index* rows,
                      std::size_t n, const dolfin::la_index* cols);
 
+    /// Add a batch of blocks of values. The blocks are inserted one
+    /// at a time (one MatSetValues call per block).
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows);
+
+    /// Compute positions of entries in local value storage (serial
+    /// AIJ matrices only)
+    virtual bool get_positions(std::size_t* positions,
+                               std::size_t m, const dolfin::la_index* rows,
+                               std::size_t n,
+                               const dolfin::la_index* cols) const;
+
+    /// Add values at positions in local value storage
+    virtual void add_at_positions(const double* values,
+                                  const std::size_t* positions,
+                                  std::size_t num_values);
+
+    /// Return number of times the sparsity pattern has been changed
+    virtual std::size_t sparsity_pattern_version() const
+    { return _sparsity_pattern_version; }
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A,
                       bool same_nonzero_pattern);
@@ -180,6 +207,11 @@ namespace dolfin
     /// Dump matrix to PETSc binary format
     void binary_dump(std::string file_name) const;
 
+    /// Return block size if the matrix is stored in block (BAIJ)
+    /// format, otherwise 1
+    std::size_t block_size() const
+    { return _block_size; }
+
   private:
 
     // PETSc norm types
@@ -188,6 +220,12 @@ namespace dolfin
     // PETSc matrix architecture
     const bool _use_gpu;
 
+    // Block size if matrix is stored in block (BAIJ) format, otherwise 1
+    std::size_t _block_size;
+
+    // Number of times the sparsity pattern has been changed
+    std::size_t _sparsity_pattern_version;
+
   };
 
 }
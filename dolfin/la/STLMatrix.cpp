@@ -19,7 +19,7 @@
 // Modified by Ilmar Wilbers 2008
 //
 // First added:  2007-01-17
-// Last changed: 2012-03-15
+// Last changed: 2013-11-08
 
 #include <algorithm>
 #include <iomanip>
@@ -72,6 +72,7 @@ void STLMatrix::init(const TensorLayout& tensor_layout)
     - _local_range.first;
 
   _values.resize(num_primary_entiries);
+  ++_sparsity_pattern_version;
 
   // FIXME: Add function to sparsity pattern to get nnz per row to
   //        to reserve space for vectors
@@ -211,6 +212,125 @@ void STLMatrix::add(const double* block,
   }
 }
 //-----------------------------------------------------------------------------
+void STLMatrix::add_batch(std::size_t num_blocks, const double* blocks,
+                          const dolfin::la_index* num_rows,
+                          const dolfin::la_index * const * rows)
+{
+  // Merge blocks into distinct entries, stored row-wise or column-wise
+  // as the matrix
+  std::vector<dolfin::la_index> primary_indices, secondary_indices;
+  std::vector<std::size_t> offsets;
+  std::vector<double> values;
+  if (_primary_dim == 0)
+  {
+    merge_batch(primary_indices, offsets, secondary_indices, values,
+                num_blocks, blocks, num_rows, rows);
+  }
+  else
+  {
+    std::vector<dolfin::la_index> transposed_num_rows(2*num_blocks);
+    std::vector<const dolfin::la_index*> transposed_rows(2*num_blocks);
+    std::vector<double> transposed_blocks;
+    for (std::size_t k = 0; k < num_blocks; ++k)
+    {
+      const std::size_t m = num_rows[2*k];
+      const std::size_t n = num_rows[2*k + 1];
+      transposed_num_rows[2*k] = n;
+      transposed_num_rows[2*k + 1] = m;
+      transposed_rows[2*k] = rows[2*k + 1];
+      transposed_rows[2*k + 1] = rows[2*k];
+      for (std::size_t j = 0; j < n; ++j)
+        for (std::size_t i = 0; i < m; ++i)
+          transposed_blocks.push_back(blocks[i*n + j]);
+      blocks += m*n;
+    }
+    merge_batch(primary_indices, offsets, secondary_indices, values,
+                num_blocks, transposed_blocks.data(),
+                transposed_num_rows.data(), transposed_rows.data());
+  }
+
+  // Add each entry once
+  for (std::size_t i = 0; i < primary_indices.size(); ++i)
+  {
+    const std::size_t I = primary_indices[i];
+    if (I < _local_range.second && I >= _local_range.first)
+    {
+      std::vector<std::pair<std::size_t, double> >& slice
+        = _values[I - _local_range.first];
+      for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+      {
+        const std::size_t J = secondary_indices[k];
+        std::vector<std::pair<std::size_t, double> >::iterator entry
+          = std::find_if(slice.begin(), slice.end(), CompareIndex(J));
+        if (entry != slice.end())
+          entry->second += values[k];
+        else
+          slice.push_back(std::make_pair(J, values[k]));
+      }
+    }
+    else
+    {
+      for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+      {
+        const std::pair<std::size_t, std::size_t>
+          global_coordinate(I, secondary_indices[k]);
+        off_processs_data[global_coordinate] += values[k];
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+bool STLMatrix::get_positions(std::size_t* positions,
+                              std::size_t m, const dolfin::la_index* rows,
+                              std::size_t n,
+                              const dolfin::la_index* cols) const
+{
+  const dolfin::la_index* primary_slice = rows;
+  const dolfin::la_index* secondary_slice = cols;
+
+  std::size_t dim   = m;
+  std::size_t codim = n;
+  std::size_t map0  = 1;
+  std::size_t map1  = n;
+  if (_primary_dim == 1)
+  {
+    // Column-wise storage: slices are columns, entries within a
+    // slice are indexed by row
+    primary_slice = cols;
+    secondary_slice = rows;
+    dim = n;
+    codim = m;
+    map0  = n;
+    map1  = 1;
+  }
+
+  for (std::size_t i = 0; i < dim; i++)
+  {
+    // Off-process entries are not stored locally
+    const std::size_t I = primary_slice[i];
+    if (I >= _local_range.second || I < _local_range.first)
+      return false;
+
+    const std::size_t I_local = I - _local_range.first;
+    dolfin_assert(I_local < _values.size());
+    const std::vector<std::pair<std::size_t, double> >& slice = _values[I_local];
+    for (std::size_t j = 0; j < codim; j++)
+    {
+      const std::size_t J = secondary_slice[j];
+      std::vector<std::pair<std::size_t, double> >::const_iterator entry
+        = std::find_if(slice.begin(), slice.end(), CompareIndex(J));
+      if (entry == slice.end())
+        return false;
+
+      const std::size_t k = entry - slice.begin();
+      dolfin_assert(k <= 0xffffffff);
+      positions[i*map1 + j*map0] = (I_local << 32) | k;
+    }
+  }
+
+  return true;
+}
+//-----------------------------------------------------------------------------
 void STLMatrix::apply(std::string mode)
 {
   Timer timer("Apply (STLMatrix)");
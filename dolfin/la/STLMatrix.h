@@ -20,7 +20,7 @@
 // Modified by Ilmar Wilbers 2008
 //
 // First added:  2007-01-17
-// Last changed: 2012-08-20
+// Last changed: 2013-11-08
 
 #ifndef __DOLFIN_STL_MATRIX_H
 #define __DOLFIN_STL_MATRIX_H
@@ -58,7 +58,8 @@ namespace dolfin
 
     /// Create empty matrix
     STLMatrix(std::size_t primary_dim=0) : _primary_dim(primary_dim),
-      _block_size(1), _local_range(0, 0), num_codim_entities(0) {}
+      _block_size(1), _local_range(0, 0), num_codim_entities(0),
+      _sparsity_pattern_version(0) {}
 
     /// Destructor
     virtual ~STLMatrix() {}
@@ -120,6 +121,39 @@ namespace dolfin
                      const dolfin::la_index* rows, std::size_t n,
                      const dolfin::la_index* cols);
 
+    /// Add a batch of blocks of values. Values added to the same
+    /// entry by different blocks are summed before the entry is
+    /// located.
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows);
+
+    /// Compute positions of entries in local value storage. A
+    /// position encodes the local row (column for column-wise
+    /// storage) in the upper and the index within it in the lower 32
+    /// bits.
+    virtual bool get_positions(std::size_t* positions,
+                               std::size_t m, const dolfin::la_index* rows,
+                               std::size_t n,
+                               const dolfin::la_index* cols) const;
+
+    /// Add values at positions in local value storage
+    virtual void add_at_positions(const double* values,
+                                  const std::size_t* positions,
+                                  std::size_t num_values)
+    {
+      for (std::size_t i = 0; i < num_values; ++i)
+      {
+        _values[positions[i] >> 32][positions[i] & 0xffffffff].second
+          += values[i];
+      }
+    }
+
+    /// Return number of times the sparsity pattern has been changed
+    /// (entries added after init do not move existing entries)
+    virtual std::size_t sparsity_pattern_version() const
+    { return _sparsity_pattern_version; }
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A,
                       bool same_nonzero_pattern)
@@ -181,6 +215,7 @@ namespace dolfin
       num_codim_entities = 0;
       _values.clear();
       off_processs_data.clear();
+      ++_sparsity_pattern_version;
     }
 
     void sort()
@@ -188,6 +223,7 @@ namespace dolfin
       std::vector<std::vector<std::pair<std::size_t, double> > >::iterator row;
       for (row = _values.begin(); row < _values.end(); ++row)
         std::sort(row->begin(), row->end());
+      ++_sparsity_pattern_version;
     }
 
     /// Return matrix in CSR format
@@ -244,6 +280,9 @@ namespace dolfin
     boost::unordered_map<std::pair<std::size_t, std::size_t>, double>
       off_processs_data;
 
+    // Number of times the sparsity pattern has been changed
+    std::size_t _sparsity_pattern_version;
+
   };
 
   //---------------------------------------------------------------------------
@@ -19,17 +19,21 @@
 // Modified by Dag Lindbo 2008
 //
 // First added:  2006-06-01
-// Last changed: 2012-08-20
+// Last changed: 2013-12-11
 
 
+#include <algorithm>
+#include <vector>
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/log/dolfin_log.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "UmfpackLUSolver.h"
 #include "GenericLinearOperator.h"
 #include "GenericMatrix.h"
 #include "GenericVector.h"
 #include "KrylovSolver.h"
 #include "LUSolver.h"
+#include "MultiVector.h"
 
 extern "C"
 {
@@ -92,6 +96,54 @@ namespace dolfin
       }
     }
   };
+
+  // Solve for n_vectors right-hand sides with umfpack_di_wsolve or
+  // umfpack_dl_wsolve. Each thread has its own workspace, so no
+  // memory is allocated per right-hand side, and the numeric
+  // factorisation is only read.
+  template<typename T, typename R>
+  long int umfpack_wsolve_multiple(R (*wsolve)(T, const T*, const T*,
+                                               const double*, double*,
+                                               const double*, void*,
+                                               const double*, double*,
+                                               T*, double*),
+                                   const T* Ap, const T* Ai, const double* Ax,
+                                   double* X, const double* B, std::size_t n,
+                                   std::size_t num_vectors, void* numeric)
+  {
+    long int status = UMFPACK_OK;
+
+    #ifdef HAS_OPENMP
+    const std::size_t num_threads
+      = std::max((std::size_t) dolfin::parameters["num_threads"],
+                 (std::size_t) 1);
+    #pragma omp parallel num_threads(std::min(num_threads, num_vectors))
+    #endif
+    {
+      // Workspace (iterative refinement requires 5n doubles)
+      std::vector<T> Wi(n);
+      std::vector<double> W(5*n);
+
+      #ifdef HAS_OPENMP
+      #pragma omp for schedule(dynamic)
+      #endif
+      for (int j = 0; j < (int) num_vectors; ++j)
+      {
+        const long int _status = wsolve(UMFPACK_At, Ap, Ai, Ax, X + j*n,
+                                        B + j*n, numeric, 0, 0, &Wi[0],
+                                        &W[0]);
+        if (_status != UMFPACK_OK)
+        {
+          #ifdef HAS_OPENMP
+          #pragma omp critical
+          #endif
+          status = _status;
+        }
+      }
+    }
+
+    return status;
+  }
 }
 #endif
 
@@ -143,6 +195,64 @@ const GenericLinearOperator& UmfpackLUSolver::get_operator() const
 }
 //-----------------------------------------------------------------------------
 std::size_t UmfpackLUSolver::solve(GenericVector& x, const GenericVector& b)
+{
+  factorize();
+  return solve_factorized(x, b);
+}
+//-----------------------------------------------------------------------------
+std::size_t
+UmfpackLUSolver::solve(const GenericLinearOperator& A, GenericVector& x,
+                       const GenericVector& b)
+{
+  boost::shared_ptr<const GenericLinearOperator> Atmp(&A, NoDeleter());
+  set_operator(Atmp);
+  return solve(x, b);
+}
+//-----------------------------------------------------------------------------
+std::size_t UmfpackLUSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  factorize();
+
+  // Need matrix data
+  const boost::shared_ptr<const GenericMatrix> A = require_matrix(_A);
+  if (A->size(0) != B.size())
+  {
+    dolfin_error("UmfpackLUSolver.cpp",
+                 "solve linear system with UMFPACK LU solver",
+                 "Non-matching dimensions for linear system");
+  }
+
+  // Resize X if required
+  if (X.size() != A->size(1) || X.num_vectors() != B.num_vectors())
+    X.init(A->size(1), B.num_vectors());
+
+  // Get matrix data
+  boost::tuples::tuple<const std::size_t*, const std::size_t*, const double*, int> data = A->data();
+  const std::size_t* Ap  = boost::tuples::get<0>(data);
+  const std::size_t* Ai  = boost::tuples::get<1>(data);
+  const double*      Ax  = boost::tuples::get<2>(data);
+
+  log(PROGRESS, "Solving linear system of size %d x %d with %d right-hand sides (UMFPACK LU solver).",
+      A->size(0), A->size(1), B.num_vectors());
+
+  if (B.num_vectors() > 0)
+  {
+    umfpack_solve(Ap, Ai, Ax, X.data(), B.data(), B.size(), B.num_vectors(),
+                  numeric.get());
+  }
+
+  return 1;
+}
+//-----------------------------------------------------------------------------
+std::size_t UmfpackLUSolver::solve(const GenericLinearOperator& A,
+                                   MultiVector& X, const MultiVector& B)
+{
+  boost::shared_ptr<const GenericLinearOperator> Atmp(&A, NoDeleter());
+  set_operator(Atmp);
+  return solve(X, B);
+}
+//-----------------------------------------------------------------------------
+void UmfpackLUSolver::factorize()
 {
   dolfin_assert(_A);
 
@@ -161,18 +271,6 @@ std::size_t UmfpackLUSolver::solve(GenericVector& x, const GenericVector& b)
     numeric_factorize();
   else if (!reuse_fact)
     numeric_factorize();
-
-  // Solve
-  return solve_factorized(x, b);
-}
-//-----------------------------------------------------------------------------
-std::size_t
-UmfpackLUSolver::solve(const GenericLinearOperator& A, GenericVector& x,
-                       const GenericVector& b)
-{
-  boost::shared_ptr<const GenericLinearOperator> Atmp(&A, NoDeleter());
-  set_operator(Atmp);
-  return solve(x, b);
 }
 //-----------------------------------------------------------------------------
 void UmfpackLUSolver::symbolic_factorize()
@@ -425,6 +523,46 @@ void UmfpackLUSolver::umfpack_solve(const std::size_t* Ap,
   umfpack_check_status(status, "solve");
 }
 //-----------------------------------------------------------------------------
+void UmfpackLUSolver::umfpack_solve(const std::size_t* Ap,
+                                    const std::size_t* Ai,
+                                    const double* Ax, double* X,
+                                    const double* B, std::size_t n,
+                                    std::size_t num_vectors, void* numeric)
+{
+  dolfin_assert(Ap);
+  dolfin_assert(Ai);
+  dolfin_assert(Ax);
+  dolfin_assert(X);
+  dolfin_assert(B);
+  dolfin_assert(numeric);
+
+  // Solve systems. We assume CSR storage, but UMFPACK expects CSC, so
+  // solve for the transpose
+  long int status = 0;
+  if (sizeof(std::size_t) == sizeof(int))
+  {
+    const int* _Ap = reinterpret_cast<const int*>(Ap);
+    const int* _Ai = reinterpret_cast<const int*>(Ai);
+    status = umfpack_wsolve_multiple(umfpack_di_wsolve, _Ap, _Ai, Ax, X, B,
+                                     n, num_vectors, numeric);
+  }
+  else if (sizeof(std::size_t) == sizeof(UF_long))
+  {
+    const UF_long* _Ap = reinterpret_cast<const UF_long*>(Ap);
+    const UF_long* _Ai = reinterpret_cast<const UF_long*>(Ai);
+    status = umfpack_wsolve_multiple(umfpack_dl_wsolve, _Ap, _Ai, Ax, X, B,
+                                     n, num_vectors, numeric);
+  }
+  else
+  {
+    dolfin_error("UmfpackLUSolver.cpp",
+                 "solve linear system with UMFPACK LU solver",
+                 "Could not determine correct types for casting integers to pass to UMFPACK");
+  }
+
+  umfpack_check_status(status, "solve");
+}
+//-----------------------------------------------------------------------------
 void UmfpackLUSolver::umfpack_check_status(long int status,
                                            std::string function)
 {
@@ -500,6 +638,17 @@ void UmfpackLUSolver::umfpack_solve(const std::size_t* Ap,
                "UMFPACK has not been installed");
 }
 //-----------------------------------------------------------------------------
+void UmfpackLUSolver::umfpack_solve(const std::size_t* Ap,
+                                    const std::size_t* Ai,
+                                    const double* Ax, double* X,
+                                    const double* B, std::size_t n,
+                                    std::size_t num_vectors, void* numeric)
+{
+  dolfin_error("UmfpackLUSolver.cpp",
+               "solve linear system with UMFPACK",
+               "UMFPACK has not been installed");
+}
+//-----------------------------------------------------------------------------
 void UmfpackLUSolver::umfpack_check_status(long int status,
                                            std::string function)
 {
@@ -19,7 +19,7 @@
 // Modified by Dag Lindbo 2008
 //
 // First added:  2006-05-31
-// Last changed: 2012-08-20
+// Last changed: 2013-12-11
 
 #ifndef __UMFPACK_LU_SOLVER_H
 #define __UMFPACK_LU_SOLVER_H
@@ -35,6 +35,7 @@ namespace dolfin
   /// Forward declarations
   class GenericVector;
   class GenericLinearOperator;
+  class MultiVector;
   class uBLASVector;
   class uBLASLinearOperator;
   template<typename Mat> class uBLASMatrix;
@@ -71,11 +72,25 @@ namespace dolfin
     std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
                       const GenericVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides
+    /// using one factorization. The right-hand sides are solved for
+    /// concurrently by multiple threads (global parameter
+    /// "num_threads").
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
     /// Default parameter values
     static Parameters default_parameters();
 
   private:
 
+    // Perform symbolic and numeric factorisation as required by
+    // parameters
+    void factorize();
+
     // Perform symbolic factorisation
     void symbolic_factorize();
 
@@ -103,6 +118,11 @@ namespace dolfin
                               const double* Ax, double* x, const double* b,
                               void* numeric);
 
+    static void umfpack_solve(const std::size_t* Ap, const std::size_t* Ai,
+                              const double* Ax, double* X, const double* B,
+                              std::size_t n, std::size_t num_vectors,
+                              void* numeric);
+
     /// Check status flag returned by an UMFPACK function
     static void umfpack_check_status(long int status, std::string function);
 
@@ -137,6 +137,12 @@ namespace dolfin
                      const dolfin::la_index* rows)
     { vector->add(block, m, rows); }
 
+    /// Add a batch of blocks of values
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows)
+    { vector->add_batch(num_blocks, blocks, num_rows, rows); }
+
     /// Get all values on local process
     virtual void get_local(std::vector<double>& values) const
     { vector->get_local(values); }
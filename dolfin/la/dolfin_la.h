@@ -14,6 +14,7 @@
 #include <dolfin/la/GenericMatrix.h>
 #include <dolfin/la/GenericSparsityPattern.h>
 #include <dolfin/la/GenericVector.h>
+#include <dolfin/la/MultiVector.h>
 #include <dolfin/la/VectorSpaceBasis.h>
 #include <dolfin/la/GenericLinearSolver.h>
 #include <dolfin/la/GenericLUSolver.h>
@@ -44,6 +45,8 @@
 #include <dolfin/la/STLMatrix.h>
 #include <dolfin/la/CoordinateMatrix.h>
 #include <dolfin/la/uBLASVector.h>
+#include <dolfin/la/CSRMatrix.h>
+#include <dolfin/la/CSRVector.h>
 #include <dolfin/la/PETScVector.h>
 
 #include <dolfin/la/SparsityPattern.h>
@@ -55,6 +58,7 @@
 #include <dolfin/la/PETScCuspFactory.h>
 #include <dolfin/la/EpetraFactory.h>
 #include <dolfin/la/STLFactory.h>
+#include <dolfin/la/CSRFactory.h>
 #include <dolfin/la/SLEPcEigenSolver.h>
 #include <dolfin/la/TrilinosPreconditioner.h>
 #include <dolfin/la/uBLASSparseMatrix.h>
@@ -62,6 +66,7 @@
 #include <dolfin/la/uBLASPreconditioner.h>
 #include <dolfin/la/uBLASKrylovSolver.h>
 #include <dolfin/la/uBLASILUPreconditioner.h>
+#include <dolfin/la/uBLASAMGPreconditioner.h>
 #include <dolfin/la/Vector.h>
 #include <dolfin/la/Matrix.h>
 #include <dolfin/la/Scalar.h>
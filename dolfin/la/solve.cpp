@@ -20,7 +20,7 @@
 // Modified by Mikael Mortensen 2011
 //
 // First added:  2007-04-30
-// Last changed: 2011-12-21
+// Last changed: 2013-12-11
 
 #include <boost/shared_ptr.hpp>
 #include <boost/assign/list_of.hpp>
@@ -49,6 +49,17 @@ std::size_t dolfin::solve(const GenericLinearOperator& A,
   return solver.solve(A, x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t dolfin::solve(const GenericLinearOperator& A,
+                          MultiVector& X,
+                          const MultiVector& B,
+                          std::string method,
+                          std::string preconditioner)
+{
+  Timer timer("Solving linear system");
+  LinearSolver solver(method, preconditioner);
+  return solver.solve(A, X, B);
+}
+//-----------------------------------------------------------------------------
 void dolfin::list_linear_solver_methods()
 {
   // Get methods
@@ -253,6 +264,8 @@ bool dolfin::has_linear_algebra_backend(std::string backend)
   }
   else if (backend == "STL")
     return true;
+  else if (backend == "CSR")
+    return true;
 
   return false;
 }
@@ -295,6 +308,9 @@ dolfin::linear_algebra_backends()
 				    "from boost" + default_backend["uBLAS"]));
   backends.push_back(std::make_pair("STL",
                                   "Light weight storage backend for Tensors"));
+  backends.push_back(std::make_pair("CSR",
+                                    "Multithreaded compressed row storage "
+                                    "(serial)"));
 
   #ifdef HAS_PETSC
   backends.push_back(std::make_pair("PETSc",
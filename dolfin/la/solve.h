@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells 2011.
 //
 // First added:  2007-04-30
-// Last changed: 2011-10-19
+// Last changed: 2013-12-11
 
 #ifndef __SOLVE_LA_H
 #define __SOLVE_LA_H
@@ -35,6 +35,7 @@ namespace dolfin
   // Forward declarations
   class GenericLinearOperator;
   class GenericVector;
+  class MultiVector;
 
   /// Solve linear system Ax = b
   std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
@@ -42,6 +43,13 @@ namespace dolfin
                     std::string method = "lu",
                     std::string preconditioner = "none");
 
+  /// Solve linear systems AX = B with multiple right-hand sides (the
+  /// columns of B)
+  std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                    const MultiVector& B,
+                    std::string method = "lu",
+                    std::string preconditioner = "none");
+
   /// List available linear algebra backends
   void list_linear_algebra_backends();
 
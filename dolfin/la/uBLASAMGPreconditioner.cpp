@@ -0,0 +1,692 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+//
+// The aggregation follows P. Vanek, J. Mandel and M. Brezina,
+// "Algebraic multigrid by smoothed aggregation for second and fourth
+// order elliptic problems", Computing 56 (1996), and the Chebyshev
+// smoother follows Y. Saad, "Iterative Methods for Sparse Linear
+// Systems", Algorithm 12.1.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <dolfin/common/Timer.h>
+#include <dolfin/log/log.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "CSRMatrix.h"
+#include "UmfpackLUSolver.h"
+#include "uBLASAMGPreconditioner.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Marker for rows that belong to no aggregate
+  const std::size_t no_aggregate = std::numeric_limits<std::size_t>::max();
+
+  // Marker for rows that are not yet aggregated
+  const std::size_t not_aggregated = no_aggregate - 1;
+
+  // Number of threads for an operation on n rows. Small levels are
+  // not worth the fork/join overhead.
+  int get_num_threads(std::size_t n)
+  {
+    const std::size_t min_rows_per_thread = 4096;
+    const std::size_t threads
+      = std::max((std::size_t) dolfin::parameters["num_threads"],
+                 (std::size_t) 1);
+    return std::max(std::min(threads, n/min_rows_per_thread),
+                    (std::size_t) 1);
+  }
+
+  // Check whether connection a_ij is strong
+  inline bool strong(double a_ij, double a_ii, double a_jj, double threshold)
+  {
+    return a_ij*a_ij > threshold*threshold*std::abs(a_ii*a_jj);
+  }
+}
+
+//-----------------------------------------------------------------------------
+uBLASAMGPreconditioner::uBLASAMGPreconditioner(const Parameters& krylov_parameters)
+  : _smoother_sweeps(1), parameters(krylov_parameters)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+uBLASAMGPreconditioner::~uBLASAMGPreconditioner()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
+{
+  const std::string structure = parameters("preconditioner")["structure"];
+  const bool reuse = !_levels.empty() && _levels[0].A.num_rows == P.size(0);
+  if (reuse && structure == "same")
+    return;
+
+  // Copy operator on finest level
+  const ublas_sparse_matrix& _P = P.mat();
+  _levels.resize(std::max(_levels.size(), (std::size_t) 1));
+  copy(_P.size1(), _P.size2(), &_P.index1_data()[0], &_P.index2_data()[0],
+       &_P.value_data()[0], _levels[0].A);
+
+  setup(reuse && structure == "same_nonzero_pattern");
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::init(const CSRMatrix& P)
+{
+  const std::string structure = parameters("preconditioner")["structure"];
+  const bool reuse = !_levels.empty() && _levels[0].A.num_rows == P.size(0);
+  if (reuse && structure == "same")
+    return;
+
+  // Copy operator on finest level
+  _levels.resize(std::max(_levels.size(), (std::size_t) 1));
+  copy(P.size(0), P.size(1), &P.row_ptr()[0], P.cols(), P.values(),
+       _levels[0].A);
+
+  setup(reuse && structure == "same_nonzero_pattern");
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
+{
+  dolfin_assert(!_levels.empty());
+  dolfin_assert(b.size() == _levels[0].A.num_rows);
+
+  if (x.size() != b.size())
+    x.resize(b.size());
+  cycle(0, x.vec().data().begin(), b.vec().data().begin());
+}
+//-----------------------------------------------------------------------------
+double uBLASAMGPreconditioner::operator_complexity() const
+{
+  if (_levels.empty() || _levels[0].A.values.empty())
+    return 0.0;
+
+  std::size_t nnz = 0;
+  for (std::size_t l = 0; l < _levels.size(); ++l)
+    nnz += _levels[l].A.values.size();
+  return (double) nnz / (double) _levels[0].A.values.size();
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::setup(bool reuse_aggregates)
+{
+  Timer timer("Build AMG hierarchy");
+
+  const Parameters& amg_parameters = parameters("preconditioner")("amg");
+  const double threshold = amg_parameters["strong_threshold"];
+  const std::size_t max_levels
+    = std::max((int) amg_parameters["max_levels"], 1);
+  const std::size_t coarse_size
+    = std::max((int) amg_parameters["coarse_size"], 1);
+  _smoother = amg_parameters["smoother"].value_str();
+  _smoother_sweeps = std::max((int) amg_parameters["smoother_sweeps"], 1);
+
+  // Number of levels to keep when aggregates are reused
+  const std::size_t num_reused_levels = reuse_aggregates ? _levels.size() : 0;
+  if (!reuse_aggregates)
+    _levels.resize(1);
+
+  for (std::size_t l = 0; ; ++l)
+  {
+    Level& level = _levels[l];
+    const SparseMatrix& A = level.A;
+    const std::size_t n = A.num_rows;
+
+    // Work vectors
+    level.x.resize(n);
+    level.b.resize(n);
+    level.r.resize(n);
+    level.d.resize(n);
+
+    // Compute inverse diagonal and Gershgorin bound for largest
+    // eigenvalue of D^-1 A
+    level.inv_diagonal.resize(n);
+    level.lambda_max = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      double a_ii = 0.0;
+      double row_sum = 0.0;
+      for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+      {
+        if (A.cols[k] == i)
+          a_ii = A.values[k];
+        row_sum += std::abs(A.values[k]);
+      }
+      if (a_ii == 0.0)
+      {
+        dolfin_error("uBLASAMGPreconditioner.cpp",
+                     "initialize uBLAS AMG preconditioner",
+                     "Zero diagonal entry in row %d on level %d",
+                     (int) i, (int) l);
+      }
+      level.inv_diagonal[i] = 1.0/a_ii;
+      level.lambda_max = std::max(level.lambda_max, row_sum/std::abs(a_ii));
+    }
+
+    // Check for coarsest level
+    bool coarsest = false;
+    if (num_reused_levels > 0)
+      coarsest = l + 1 == num_reused_levels;
+    else
+    {
+      coarsest = n <= coarse_size || l + 1 == max_levels;
+      if (!coarsest)
+      {
+        aggregate(A, threshold, level.aggregates, level.num_aggregates);
+        coarsest = level.num_aggregates == 0 || level.num_aggregates == n;
+      }
+    }
+    if (coarsest)
+    {
+      level.P = SparseMatrix();
+      level.R = SparseMatrix();
+      _levels.resize(l + 1);
+      break;
+    }
+
+    // Build transfer operators and Galerkin operator A_c = R A P
+    prolongator(level, level.P);
+    transpose(level.P, level.R);
+    SparseMatrix AP;
+    multiply(A, level.P, AP);
+    if (_levels.size() == l + 1)
+      _levels.resize(l + 2);
+    multiply(_levels[l].R, AP, _levels[l + 1].A);
+  }
+
+  setup_coarse_solver();
+
+  if ((bool) parameters("preconditioner")["report"])
+  {
+    info("AMG hierarchy with %d levels (operator complexity %.3g):",
+         (int) _levels.size(), operator_complexity());
+    for (std::size_t l = 0; l < _levels.size(); ++l)
+    {
+      info("  level %d: %d rows, %d nonzeros", (int) l,
+           (int) _levels[l].A.num_rows, (int) _levels[l].A.values.size());
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::setup_coarse_solver()
+{
+  const SparseMatrix& A = _levels.back().A;
+  const std::size_t n = A.num_rows;
+
+  _coarse_x.resize(n);
+  _coarse_b.resize(n);
+
+  #ifdef HAS_UMFPACK
+
+  // Copy operator to uBLAS matrix and factorize with UMFPACK
+  _coarse_matrix.reset(new uBLASMatrix<ublas_sparse_matrix>(n, n));
+  ublas_sparse_matrix& _A = _coarse_matrix->mat();
+  _A.reserve(A.values.size());
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+      _A.push_back(i, A.cols[k], A.values[k]);
+
+  _coarse_solver.reset(new UmfpackLUSolver(_coarse_matrix));
+  _coarse_solver->parameters["reuse_factorization"] = true;
+
+  #else
+
+  // Compute dense inverse
+  uBLASMatrix<ublas_dense_matrix> A_dense(n, n);
+  ublas_dense_matrix& _A = A_dense.mat();
+  _A.clear();
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+      _A(i, A.cols[k]) = A.values[k];
+  A_dense.invert();
+  _coarse_inverse = _A;
+
+  #endif
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::cycle(std::size_t l, double* x,
+                                   const double* b) const
+{
+  if (l + 1 == _levels.size())
+  {
+    coarse_solve(x, b);
+    return;
+  }
+
+  const Level& level = _levels[l];
+  const Level& coarse_level = _levels[l + 1];
+  const int n = level.A.num_rows;
+  double* r = &level.r[0];
+
+  // Pre-smoothing
+  smooth(level, x, b, true);
+
+  // Restrict residual r = b - Ax
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+    r[i] = b[i];
+  mult(level.A, -1.0, x, 1.0, r);
+  mult(level.R, 1.0, r, 0.0, &coarse_level.b[0]);
+
+  // Coarse grid correction
+  cycle(l + 1, &coarse_level.x[0], &coarse_level.b[0]);
+  mult(level.P, 1.0, &coarse_level.x[0], 1.0, x);
+
+  // Post-smoothing
+  smooth(level, x, b, false);
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::smooth(const Level& level, double* x,
+                                    const double* b,
+                                    bool zero_initial_guess) const
+{
+  const std::size_t sweeps = _smoother_sweeps;
+  const int n = level.A.num_rows;
+  #ifdef HAS_OPENMP
+  const int num_threads = get_num_threads(n);
+  #endif
+  const double* inv_diagonal = &level.inv_diagonal[0];
+  double* r = &level.r[0];
+  double* d = &level.d[0];
+
+  if (_smoother == "jacobi")
+  {
+    // Damped Jacobi, x <- x + omega D^-1 (b - Ax)
+    const double omega = 4.0/(3.0*level.lambda_max);
+    for (std::size_t sweep = 0; sweep < sweeps; ++sweep)
+    {
+      if (sweep == 0 && zero_initial_guess)
+      {
+        #ifdef HAS_OPENMP
+        #pragma omp parallel for num_threads(num_threads)
+        #endif
+        for (int i = 0; i < n; ++i)
+          x[i] = omega*inv_diagonal[i]*b[i];
+        continue;
+      }
+
+      #ifdef HAS_OPENMP
+      #pragma omp parallel for num_threads(num_threads)
+      #endif
+      for (int i = 0; i < n; ++i)
+        r[i] = b[i];
+      mult(level.A, -1.0, x, 1.0, r);
+
+      #ifdef HAS_OPENMP
+      #pragma omp parallel for num_threads(num_threads)
+      #endif
+      for (int i = 0; i < n; ++i)
+        x[i] += omega*inv_diagonal[i]*r[i];
+    }
+    return;
+  }
+
+  // Chebyshev polynomial of D^-1 A with degree given by the number of
+  // sweeps, targeting the upper part [lambda_max/30, lambda_max] of
+  // the spectrum
+  const double upper = level.lambda_max;
+  const double lower = upper/30.0;
+  const double theta = 0.5*(upper + lower);
+  const double delta = 0.5*(upper - lower);
+  const double sigma = theta/delta;
+  double rho = 1.0/sigma;
+
+  // Initial residual and direction
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int i = 0; i < n; ++i)
+  {
+    r[i] = b[i];
+    if (zero_initial_guess)
+      x[i] = 0.0;
+  }
+  if (!zero_initial_guess)
+    mult(level.A, -1.0, x, 1.0, r);
+
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int i = 0; i < n; ++i)
+    d[i] = inv_diagonal[i]*r[i]/theta;
+
+  for (std::size_t k = 0; k < sweeps; ++k)
+  {
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads)
+    #endif
+    for (int i = 0; i < n; ++i)
+      x[i] += d[i];
+
+    if (k + 1 == sweeps)
+      break;
+
+    // Update residual and direction
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads)
+    #endif
+    for (int i = 0; i < n; ++i)
+      r[i] = b[i];
+    mult(level.A, -1.0, x, 1.0, r);
+
+    const double rho_new = 1.0/(2.0*sigma - rho);
+    const double a = rho_new*rho;
+    const double c = 2.0*rho_new/delta;
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads)
+    #endif
+    for (int i = 0; i < n; ++i)
+      d[i] = a*d[i] + c*inv_diagonal[i]*r[i];
+    rho = rho_new;
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::coarse_solve(double* x, const double* b) const
+{
+  const std::size_t n = _levels.back().A.num_rows;
+  ublas_vector& _b = _coarse_b.vec();
+  ublas_vector& _x = _coarse_x.vec();
+  std::copy(b, b + n, _b.begin());
+
+  #ifdef HAS_UMFPACK
+  dolfin_assert(_coarse_solver);
+  _coarse_solver->solve(_coarse_x, _coarse_b);
+  #else
+  ublas::axpy_prod(_coarse_inverse, _b, _x, true);
+  #endif
+
+  std::copy(_x.begin(), _x.end(), x);
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::mult(const SparseMatrix& A, double alpha,
+                                  const double* x, double beta, double* y)
+{
+  const int n = A.num_rows;
+  const std::size_t* row_ptr = &A.row_ptr[0];
+  const std::size_t* cols = A.cols.empty() ? 0 : &A.cols[0];
+  const double* values = A.values.empty() ? 0 : &A.values[0];
+
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(n))
+  #endif
+  for (int i = 0; i < n; ++i)
+  {
+    double value = 0.0;
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+      value += values[k]*x[cols[k]];
+    y[i] = (beta == 0.0 ? 0.0 : beta*y[i]) + alpha*value;
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::multiply(const SparseMatrix& A,
+                                      const SparseMatrix& B,
+                                      SparseMatrix& C)
+{
+  dolfin_assert(A.num_cols == B.num_rows);
+
+  C.num_rows = A.num_rows;
+  C.num_cols = B.num_cols;
+  C.row_ptr.assign(1, 0);
+  C.cols.clear();
+  C.values.clear();
+
+  // Position of column in current row of C (or no_aggregate if the
+  // column is not yet present)
+  std::vector<std::size_t> marker(B.num_cols, no_aggregate);
+  std::vector<std::pair<std::size_t, double> > row;
+  for (std::size_t i = 0; i < A.num_rows; ++i)
+  {
+    row.clear();
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t p = A.cols[k];
+      const double a = A.values[k];
+      for (std::size_t m = B.row_ptr[p]; m < B.row_ptr[p + 1]; ++m)
+      {
+        const std::size_t j = B.cols[m];
+        if (marker[j] == no_aggregate)
+        {
+          marker[j] = row.size();
+          row.push_back(std::make_pair(j, a*B.values[m]));
+        }
+        else
+          row[marker[j]].second += a*B.values[m];
+      }
+    }
+
+    // Store row with sorted column indices
+    std::sort(row.begin(), row.end());
+    for (std::size_t k = 0; k < row.size(); ++k)
+    {
+      marker[row[k].first] = no_aggregate;
+      C.cols.push_back(row[k].first);
+      C.values.push_back(row[k].second);
+    }
+    C.row_ptr.push_back(C.cols.size());
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::transpose(const SparseMatrix& A,
+                                       SparseMatrix& AT)
+{
+  AT.num_rows = A.num_cols;
+  AT.num_cols = A.num_rows;
+
+  // Count entries in each column
+  AT.row_ptr.assign(A.num_cols + 1, 0);
+  for (std::size_t k = 0; k < A.cols.size(); ++k)
+    ++AT.row_ptr[A.cols[k] + 1];
+  for (std::size_t j = 0; j < A.num_cols; ++j)
+    AT.row_ptr[j + 1] += AT.row_ptr[j];
+
+  // Insert entries (column indices are sorted since the rows of A
+  // are traversed in order)
+  AT.cols.resize(A.cols.size());
+  AT.values.resize(A.values.size());
+  std::vector<std::size_t> position(AT.row_ptr.begin(), AT.row_ptr.end() - 1);
+  for (std::size_t i = 0; i < A.num_rows; ++i)
+  {
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t p = position[A.cols[k]]++;
+      AT.cols[p] = i;
+      AT.values[p] = A.values[k];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::aggregate(const SparseMatrix& A,
+                                       double threshold,
+                                       std::vector<std::size_t>& aggregates,
+                                       std::size_t& num_aggregates)
+{
+  const std::size_t n = A.num_rows;
+
+  // Get diagonal
+  std::vector<double> diagonal(n, 0.0);
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+      if (A.cols[k] == i)
+        diagonal[i] = A.values[k];
+
+  // Rows without strong connections (e.g. Dirichlet rows) belong to
+  // no aggregate and are handled by the smoother alone
+  aggregates.assign(n, no_aggregate);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = A.cols[k];
+      if (j != i && strong(A.values[k], diagonal[i], diagonal[j], threshold))
+      {
+        aggregates[i] = not_aggregated;
+        break;
+      }
+    }
+  }
+
+  // Pass 1: make aggregates of rows whose strong neighbours are all
+  // unaggregated
+  num_aggregates = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (aggregates[i] != not_aggregated)
+      continue;
+
+    bool free_neighbourhood = true;
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = A.cols[k];
+      if (j != i && aggregates[j] != not_aggregated
+          && aggregates[j] != no_aggregate
+          && strong(A.values[k], diagonal[i], diagonal[j], threshold))
+      {
+        free_neighbourhood = false;
+        break;
+      }
+    }
+    if (!free_neighbourhood)
+      continue;
+
+    aggregates[i] = num_aggregates;
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = A.cols[k];
+      if (j != i && aggregates[j] == not_aggregated
+          && strong(A.values[k], diagonal[i], diagonal[j], threshold))
+      {
+        aggregates[j] = num_aggregates;
+      }
+    }
+    ++num_aggregates;
+  }
+
+  // Pass 2: add remaining rows to the aggregate of the strongest
+  // neighbour from pass 1
+  const std::vector<std::size_t> pass_one(aggregates);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (aggregates[i] != not_aggregated)
+      continue;
+
+    double strongest = 0.0;
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = A.cols[k];
+      if (j != i && pass_one[j] < num_aggregates
+          && strong(A.values[k], diagonal[i], diagonal[j], threshold)
+          && std::abs(A.values[k]) > strongest)
+      {
+        aggregates[i] = pass_one[j];
+        strongest = std::abs(A.values[k]);
+      }
+    }
+  }
+
+  // Pass 3: make aggregates of any rows left and their unaggregated
+  // strong neighbours
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (aggregates[i] != not_aggregated)
+      continue;
+
+    aggregates[i] = num_aggregates;
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = A.cols[k];
+      if (j != i && aggregates[j] == not_aggregated
+          && strong(A.values[k], diagonal[i], diagonal[j], threshold))
+      {
+        aggregates[j] = num_aggregates;
+      }
+    }
+    ++num_aggregates;
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::prolongator(const Level& level, SparseMatrix& P)
+{
+  const SparseMatrix& A = level.A;
+  const std::vector<std::size_t>& aggregates = level.aggregates;
+  const double omega = 4.0/(3.0*level.lambda_max);
+
+  P.num_rows = A.num_rows;
+  P.num_cols = level.num_aggregates;
+  P.row_ptr.assign(1, 0);
+  P.cols.clear();
+  P.values.clear();
+
+  // Row i of P is e_agg(i) - omega/a_ii sum_k a_ik e_agg(k)
+  std::vector<std::size_t> marker(level.num_aggregates, no_aggregate);
+  std::vector<std::pair<std::size_t, double> > row;
+  for (std::size_t i = 0; i < A.num_rows; ++i)
+  {
+    row.clear();
+    if (aggregates[i] != no_aggregate)
+    {
+      marker[aggregates[i]] = 0;
+      row.push_back(std::make_pair(aggregates[i], 1.0));
+    }
+
+    const double scale = omega*level.inv_diagonal[i];
+    for (std::size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; ++k)
+    {
+      const std::size_t j = aggregates[A.cols[k]];
+      if (j == no_aggregate)
+        continue;
+      if (marker[j] == no_aggregate)
+      {
+        marker[j] = row.size();
+        row.push_back(std::make_pair(j, -scale*A.values[k]));
+      }
+      else
+        row[marker[j]].second -= scale*A.values[k];
+    }
+
+    // Store row with sorted column indices
+    std::sort(row.begin(), row.end());
+    for (std::size_t k = 0; k < row.size(); ++k)
+    {
+      marker[row[k].first] = no_aggregate;
+      P.cols.push_back(row[k].first);
+      P.values.push_back(row[k].second);
+    }
+    P.row_ptr.push_back(P.cols.size());
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASAMGPreconditioner::copy(std::size_t num_rows, std::size_t num_cols,
+                                  const std::size_t* row_ptr,
+                                  const std::size_t* cols,
+                                  const double* values, SparseMatrix& A)
+{
+  A.num_rows = num_rows;
+  A.num_cols = num_cols;
+  A.row_ptr.assign(row_ptr, row_ptr + num_rows + 1);
+  A.cols.assign(cols, cols + row_ptr[num_rows]);
+  A.values.assign(values, values + row_ptr[num_rows]);
+}
+//-----------------------------------------------------------------------------
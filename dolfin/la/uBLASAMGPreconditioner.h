@@ -0,0 +1,178 @@
+// Copyright (C) 2013 The DOLFIN authors
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2013-12-11
+// Last changed: 2013-12-11
+
+#ifndef __UBLAS_AMG_PRECONDITIONER_H
+#define __UBLAS_AMG_PRECONDITIONER_H
+
+#include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include "ublas.h"
+#include "uBLASPreconditioner.h"
+#include "uBLASMatrix.h"
+#include "uBLASVector.h"
+
+namespace dolfin
+{
+
+  class CSRMatrix;
+  class Parameters;
+  class UmfpackLUSolver;
+
+  /// This class implements a smoothed aggregation algebraic
+  /// multigrid (AMG) preconditioner for the uBLAS Krylov solver. One
+  /// application of the preconditioner is a V-cycle with a Chebyshev
+  /// (or damped Jacobi) smoother and a direct solve (UMFPACK, if
+  /// installed) on the coarsest level. The smoother uses multiple
+  /// threads, as given by the global parameter "num_threads".
+  ///
+  /// The hierarchy is controlled by the parameters
+  /// ("preconditioner", "amg") of the Krylov solver. If the
+  /// parameter ("preconditioner", "structure") is "same", the
+  /// hierarchy is reused as is for subsequent solves, and if it is
+  /// "same_nonzero_pattern", the aggregates are reused and only the
+  /// operators of the hierarchy are recomputed. The smoother
+  /// parameters are read when the hierarchy is built.
+
+  class uBLASAMGPreconditioner : public uBLASPreconditioner
+  {
+  public:
+
+    /// Constructor
+    uBLASAMGPreconditioner(const Parameters& krylov_parameters);
+
+    /// Destructor
+    ~uBLASAMGPreconditioner();
+
+    /// Initialise preconditioner (sparse matrix)
+    void init(const uBLASMatrix<ublas_sparse_matrix>& P);
+
+    /// Initialise preconditioner (CSR matrix)
+    void init(const CSRMatrix& P);
+
+    /// Solve linear system Ax = b approximately (one V-cycle)
+    void solve(uBLASVector& x, const uBLASVector& b) const;
+
+    /// Return number of levels of the hierarchy
+    std::size_t num_levels() const
+    { return _levels.size(); }
+
+    /// Return operator complexity of the hierarchy (number of
+    /// nonzeros on all levels divided by number on the finest level)
+    double operator_complexity() const;
+
+  private:
+
+    // Sparse matrix in compressed row storage
+    struct SparseMatrix
+    {
+      SparseMatrix() : num_rows(0), num_cols(0) {}
+      std::size_t num_rows, num_cols;
+      std::vector<std::size_t> row_ptr, cols;
+      std::vector<double> values;
+    };
+
+    // Level of the hierarchy
+    struct Level
+    {
+      Level() : num_aggregates(0), lambda_max(1.0) {}
+
+      // Operator, prolongation from next level and restriction to
+      // next level
+      SparseMatrix A, P, R;
+
+      // Aggregate of each row (or no_aggregate)
+      std::vector<std::size_t> aggregates;
+      std::size_t num_aggregates;
+
+      // Inverse diagonal of operator and upper bound for largest
+      // eigenvalue of D^-1 A
+      std::vector<double> inv_diagonal;
+      double lambda_max;
+
+      // Work vectors
+      mutable std::vector<double> x, b, r, d;
+    };
+
+    // Build hierarchy from operator on finest level
+    void setup(bool reuse_aggregates);
+
+    // Set up direct solver on coarsest level
+    void setup_coarse_solver();
+
+    // Apply V-cycle from given level with zero initial guess
+    void cycle(std::size_t level, double* x, const double* b) const;
+
+    // Smooth x on given level
+    void smooth(const Level& level, double* x, const double* b,
+                bool zero_initial_guess) const;
+
+    // Solve on coarsest level
+    void coarse_solve(double* x, const double* b) const;
+
+    // Compute y = alpha*A*x + beta*y
+    static void mult(const SparseMatrix& A, double alpha, const double* x,
+                     double beta, double* y);
+
+    // Compute C = AB
+    static void multiply(const SparseMatrix& A, const SparseMatrix& B,
+                         SparseMatrix& C);
+
+    // Compute AT = A^T
+    static void transpose(const SparseMatrix& A, SparseMatrix& AT);
+
+    // Group strongly connected rows into aggregates
+    static void aggregate(const SparseMatrix& A, double threshold,
+                          std::vector<std::size_t>& aggregates,
+                          std::size_t& num_aggregates);
+
+    // Compute smoothed prolongator P = (I - omega D^-1 A) T from
+    // the tentative (piecewise constant) prolongator T of aggregates
+    static void prolongator(const Level& level, SparseMatrix& P);
+
+    // Copy matrix from arrays in compressed row storage
+    static void copy(std::size_t num_rows, std::size_t num_cols,
+                     const std::size_t* row_ptr, const std::size_t* cols,
+                     const double* values, SparseMatrix& A);
+
+    // Levels of the hierarchy (finest first)
+    std::vector<Level> _levels;
+
+    // Direct solver on coarsest level
+    boost::shared_ptr<uBLASMatrix<ublas_sparse_matrix> > _coarse_matrix;
+    boost::scoped_ptr<UmfpackLUSolver> _coarse_solver;
+    mutable uBLASVector _coarse_x, _coarse_b;
+
+    // Inverse of operator on coarsest level (when UMFPACK is not
+    // installed)
+    ublas_dense_matrix _coarse_inverse;
+
+    // Smoother ("chebyshev" or "jacobi") and number of sweeps
+    std::string _smoother;
+    std::size_t _smoother_sweeps;
+
+    const Parameters& parameters;
+
+  };
+
+}
+
+#endif
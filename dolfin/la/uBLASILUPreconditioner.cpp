@@ -18,15 +18,53 @@
 // Modified by Anders Logg, 2006-2010.
 //
 // First added:  2006-06-23
-// Last changed: 2010-08-31
+// Last changed: 2013-12-11
 
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <dolfin/common/constants.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "uBLASVector.h"
 #include "uBLASSparseMatrix.h"
 #include "uBLASILUPreconditioner.h"
+#include "CSRMatrix.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Number of threads for level-scheduled operations on n rows
+  int get_num_threads(std::size_t n)
+  {
+    const std::size_t min_rows_per_thread = 1024;
+    const std::size_t threads
+      = std::max((std::size_t) dolfin::parameters["num_threads"],
+                 (std::size_t) 1);
+    return std::max(std::min(threads, n/min_rows_per_thread),
+                    (std::size_t) 1);
+  }
+
+  // Sort rows by level into compressed storage (rows ascending
+  // within each level)
+  void sort_by_level(const std::vector<std::size_t>& level,
+                     std::size_t num_levels,
+                     std::vector<std::size_t>& level_ptr,
+                     std::vector<std::size_t>& level_rows)
+  {
+    level_ptr.assign(num_levels + 1, 0);
+    for (std::size_t i = 0; i < level.size(); ++i)
+      ++level_ptr[level[i] + 1];
+    for (std::size_t l = 0; l < num_levels; ++l)
+      level_ptr[l + 1] += level_ptr[l];
+
+    level_rows.resize(level.size());
+    std::vector<std::size_t> position(level_ptr.begin(), level_ptr.end() - 1);
+    for (std::size_t i = 0; i < level.size(); ++i)
+      level_rows[position[level[i]]++] = i;
+  }
+}
+
 //-----------------------------------------------------------------------------
 uBLASILUPreconditioner::uBLASILUPreconditioner(const Parameters& krylov_parameters)
   : parameters(krylov_parameters)
@@ -47,11 +85,41 @@ void uBLASILUPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
   _M.resize(size, size, false);
   _M.assign(P.mat());
 
+  factorize();
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::init(const CSRMatrix& P)
+{
+  ublas_sparse_matrix& _M = M.mat();
+
+  // Copy matrix row by row (column indices are sorted within rows)
+  const std::size_t size = P.size(0);
+  _M.resize(size, size, false);
+  _M.clear();
+  _M.reserve(P.nnz());
+  const std::vector<std::size_t>& row_ptr = P.row_ptr();
+  for (std::size_t i = 0; i < size; ++i)
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+      _M.push_back(i, P.cols()[k], P.values()[k]);
+
+  factorize();
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::factorize()
+{
+  ublas_sparse_matrix& _M = M.mat();
+  const std::size_t size = _M.size1();
+
   // Add term to diagonal to avoid negative pivots
   const double zero_shift = parameters("preconditioner")["shift_nonzero"];
   if(zero_shift > 0.0)
     _M.plus_assign( zero_shift*ublas::identity_matrix<double>(size) );
 
+  // Extend pattern with fill for ILU(k)
+  const int fill_level = parameters("preconditioner")("ilu")["fill_level"];
+  if (fill_level > 0)
+    add_fill(fill_level);
+
   /*
   // Straightforward and very slow implementation. This is used for verification
   tic();
@@ -96,59 +164,210 @@ void uBLASILUPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
 
   // The below algorithm is based on that in the book
   // Y. Saad, "Iterative Methods for Sparse Linear Systems", p.276-278.
-  // It is specific to compressed row storage
+  // It is specific to compressed row storage. Row k depends only on
+  // the rows j < k with M(k, j) nonzero, so rows of the same level
+  // set of the lower triangular part can be factorized concurrently.
 
-  // Initialise some data
   diagonal.resize(size);
-  diagonal[0] = 0;
+  std::size_t zero_pivot = size;
+
+  const std::string schedule = parameters("preconditioner")("ilu")["schedule"];
+  if (schedule == "level")
+  {
+    compute_level_sets();
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel num_threads(get_num_threads(size))
+    #endif
+    {
+      std::vector<std::size_t> iw(size, 0);
+      for (std::size_t l = 0; l + 1 < lower_level_ptr.size(); ++l)
+      {
+        const int begin = lower_level_ptr[l];
+        const int end = lower_level_ptr[l + 1];
+        #ifdef HAS_OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int r = begin; r < end; ++r)
+        {
+          const std::size_t k = lower_level_rows[r];
+          if (!factorize_row(k, iw))
+          {
+            #ifdef HAS_OPENMP
+            #pragma omp critical
+            #endif
+            zero_pivot = std::min(zero_pivot, k);
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    lower_level_ptr.clear();
+    lower_level_rows.clear();
+    upper_level_ptr.clear();
+    upper_level_rows.clear();
+
+    std::vector<std::size_t> iw(size, 0);
+    for (std::size_t k = 0; k < size && zero_pivot == size; ++k)
+    {
+      if (!factorize_row(k, iw))
+        zero_pivot = k;
+    }
+  }
+
+  if (zero_pivot < size)
+  {
+    dolfin_error("uBLASILUPreconditioner.cpp",
+                 "initialize uBLAS ILU preconditioner",
+                 "Zero pivot detected in row %u", zero_pivot);
+  }
+}
+//-----------------------------------------------------------------------------
+bool uBLASILUPreconditioner::factorize_row(std::size_t k,
+                                           std::vector<std::size_t>& iw)
+{
+  ublas_sparse_matrix& _M = M.mat();
+  const std::size_t* row_ptr = &_M.index1_data()[0];
+  const std::size_t* cols = &_M.index2_data()[0];
+  double* values = &_M.value_data()[0];
 
-  std::vector<std::size_t> iw(size);
-  for(std::size_t i=0; i< size; ++i)
-    iw[i] = 0;
+  const std::size_t j0 = row_ptr[k];
+  const std::size_t j1 = row_ptr[k + 1];
 
-  std::size_t j0=0, j1=0, j=0, jrow=0, jw=0;
-  double t1;
+  // Initialise working array iw
+  for (std::size_t i = j0; i < j1; ++i)
+    iw[cols[i]] = i;
 
-  for (std::size_t k = 0; k < size ; ++k)        // i (rows)
+  // Move along row looking for diagonal
+  std::size_t j = j0;
+  std::size_t jrow = 0;
+  while (j < j1)
   {
-    j0 = _M.index1_data () [k];    // ia
-    j1 = _M.index1_data () [k+1]-1;
+    jrow = cols[j];
 
-    // Initialise working array iw
-    for (std::size_t i = j0;  i <= j1; ++i)
-      iw[ _M.index2_data () [i] ] = i;  // ja
+    if (jrow >= k) // passed or found diagonal, therefore break
+      break;
 
-    // Move along row looking for diagonal
-    j=j0;
-    while(j <= j1)
+    const double t1 = values[j]/values[diagonal[jrow]]; // M(k,j) = M(k,j)/M(j,j)
+    values[j] = t1;
+    for (std::size_t jj = diagonal[jrow] + 1; jj < row_ptr[jrow + 1]; ++jj)
     {
-      jrow = _M.index2_data () [j];  // ja
+      const std::size_t jw = iw[cols[jj]];
+      if (jw != 0)
+        values[jw] -= t1*values[jj];
+    }
+    ++j;
+  }
+  diagonal[k] = j;
+
+  for (std::size_t i = j0; i < j1; ++i)
+    iw[cols[i]] = 0;
+
+  return j < j1 && jrow == k && std::abs(values[j]) >= DOLFIN_EPS;
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::add_fill(std::size_t fill_level)
+{
+  ublas_sparse_matrix& _M = M.mat();
+  const std::size_t size = _M.size1();
+  const std::size_t* row_ptr = &_M.index1_data()[0];
+  const std::size_t* cols = &_M.index2_data()[0];
+  const double* values = &_M.value_data()[0];
 
-      if( jrow >= k ) // passed or found diagonal, therefore break
-        break;
+  // Compute pattern of ILU(k) factors row by row (Saad, Algorithm
+  // 10.5). The level of fill of entry (i, j) created by eliminating
+  // with row k is lev(i, k) + lev(k, j) + 1.
+  std::vector<std::size_t> F_row_ptr(1, 0), F_cols, F_levels;
+  std::vector<std::size_t> F_upper(size);
+  std::map<std::size_t, std::size_t> row;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    row.clear();
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+      row[cols[k]] = 0;
 
-      t1 = (_M.value_data() [j])/(_M.value_data() [ diagonal[jrow] ]);  //M(k,j) = M(k,j)/M(j,j)
-      _M.value_data() [j] = t1;
-      for(std::size_t jj = diagonal[jrow]+1; jj <= _M.index1_data () [jrow+1]-1; ++jj)
+    // Eliminate with preceding rows in increasing order (entries
+    // created below the diagonal are visited in turn)
+    std::map<std::size_t, std::size_t>::iterator ik;
+    for (ik = row.begin(); ik != row.end() && ik->first < i; ++ik)
+    {
+      const std::size_t k = ik->first;
+      const std::size_t level_ik = ik->second;
+      for (std::size_t m = F_upper[k]; m < F_row_ptr[k + 1]; ++m)
       {
-        jw = iw[ _M.index2_data () [jj] ];
-        if(jw != 0)
-          _M.value_data() [jw] = _M.value_data() [jw] -t1*(_M.value_data() [jj]);
-      } // jj
-      ++j;
+        const std::size_t level = level_ik + F_levels[m] + 1;
+        if (level > fill_level)
+          continue;
+        std::map<std::size_t, std::size_t>::iterator ij
+          = row.insert(std::make_pair(F_cols[m], level)).first;
+        ij->second = std::min(ij->second, level);
+      }
     }
-    diagonal[k] = j;
 
-    if (jrow != k || fabs( _M.value_data() [j] ) < DOLFIN_EPS)
+    // Store row
+    F_upper[i] = F_cols.size();
+    std::map<std::size_t, std::size_t>::const_iterator ij;
+    for (ij = row.begin(); ij != row.end(); ++ij)
     {
-      dolfin_error("uBLASILUPreconditioner.cpp",
-                   "initialize uBLAS ILU preconditioner",
-                   "Zero pivot detected in row %u", k);
+      if (ij->first <= i)
+        F_upper[i] = F_cols.size() + 1;
+      F_cols.push_back(ij->first);
+      F_levels.push_back(ij->second);
     }
+    F_row_ptr.push_back(F_cols.size());
+  }
 
-    for(std::size_t i=j0; i <= j1; ++i)
-      iw[ _M.index2_data () [i] ] = 0;
-  } // k
+  // Copy values to extended pattern (column indices are sorted
+  // within rows in both patterns)
+  ublas_sparse_matrix F(size, size, F_cols.size());
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::size_t k = row_ptr[i];
+    for (std::size_t m = F_row_ptr[i]; m < F_row_ptr[i + 1]; ++m)
+    {
+      double value = 0.0;
+      if (k < row_ptr[i + 1] && cols[k] == F_cols[m])
+        value = values[k++];
+      F.push_back(i, F_cols[m], value);
+    }
+  }
+  _M.swap(F);
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::compute_level_sets()
+{
+  const ublas_sparse_matrix& _M = M.mat();
+  const std::size_t size = _M.size1();
+  const std::size_t* row_ptr = &_M.index1_data()[0];
+  const std::size_t* cols = &_M.index2_data()[0];
+
+  // The level of a row is one more than the highest level of the
+  // rows it depends on in the lower triangular part
+  std::vector<std::size_t> level(size);
+  std::size_t num_levels = 0;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::size_t l = 0;
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1] && cols[k] < i; ++k)
+      l = std::max(l, level[cols[k]] + 1);
+    level[i] = l;
+    num_levels = std::max(num_levels, l + 1);
+  }
+  sort_by_level(level, num_levels, lower_level_ptr, lower_level_rows);
+
+  // Same for upper triangular part, from the last row
+  num_levels = 0;
+  for (std::size_t i = size; i-- > 0; )
+  {
+    std::size_t l = 0;
+    for (std::size_t k = row_ptr[i + 1]; k-- > row_ptr[i] && cols[k] > i; )
+      l = std::max(l, level[cols[k]] + 1);
+    level[i] = l;
+    num_levels = std::max(num_levels, l + 1);
+  }
+  sort_by_level(level, num_levels, upper_level_ptr, upper_level_rows);
 }
 //-----------------------------------------------------------------------------
 void uBLASILUPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
@@ -165,8 +384,58 @@ void uBLASILUPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
   // Solve in-place
   _x.assign(_b);
 
-  // Perform substutions for compressed row storage. This is the fastest.
   const std::size_t size = _M.size1();
+  if (!lower_level_ptr.empty())
+  {
+    // Perform substitutions by level sets (rows of a level depend
+    // only on rows of preceding levels)
+    const std::size_t* row_ptr = &_M.index1_data()[0];
+    const std::size_t* cols = &_M.index2_data()[0];
+    const double* values = &_M.value_data()[0];
+    double* x_data = &_x[0];
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel num_threads(get_num_threads(size))
+    #endif
+    {
+      for (std::size_t l = 0; l + 1 < lower_level_ptr.size(); ++l)
+      {
+        const int begin = lower_level_ptr[l];
+        const int end = lower_level_ptr[l + 1];
+        #ifdef HAS_OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int r = begin; r < end; ++r)
+        {
+          const std::size_t i = lower_level_rows[r];
+          double value = x_data[i];
+          for (std::size_t k = row_ptr[i]; k < diagonal[i]; ++k)
+            value -= values[k]*x_data[cols[k]];
+          x_data[i] = value;
+        }
+      }
+
+      for (std::size_t l = 0; l + 1 < upper_level_ptr.size(); ++l)
+      {
+        const int begin = upper_level_ptr[l];
+        const int end = upper_level_ptr[l + 1];
+        #ifdef HAS_OPENMP
+        #pragma omp for schedule(static)
+        #endif
+        for (int r = begin; r < end; ++r)
+        {
+          const std::size_t i = upper_level_rows[r];
+          double value = x_data[i];
+          for (std::size_t k = row_ptr[i + 1] - 1; k > diagonal[i]; --k)
+            value -= values[k]*x_data[cols[k]];
+          x_data[i] = value/values[diagonal[i]];
+        }
+      }
+    }
+    return;
+  }
+
+  // Perform substutions for compressed row storage. This is the fastest.
   for(std::size_t i =0; i < size; ++i)
   {
     std::size_t k;
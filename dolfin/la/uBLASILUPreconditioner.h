@@ -18,11 +18,12 @@
 // Modified by Anders Logg 2006.
 //
 // First added:  2006-06-23
-// Last changed: 2009-07-03
+// Last changed: 2013-12-11
 
 #ifndef __UBLAS_ILU_PRECONDITIONER_H
 #define __UBLAS_ILU_PRECONDITIONER_H
 
+#include <vector>
 #include "ublas.h"
 #include "uBLASPreconditioner.h"
 #include "uBLASMatrix.h"
@@ -32,9 +33,16 @@ namespace dolfin
 
   template<typename Mat> class uBLASMatrix;
   class uBLASVector;
+  class CSRMatrix;
 
-  /// This class implements an incomplete LU factorization (ILU)
-  /// preconditioner for the uBLAS Krylov solver.
+  /// This class implements an incomplete LU factorization (ILU(k))
+  /// preconditioner for the uBLAS Krylov solver. The level of fill k
+  /// is given by the parameter ("preconditioner", "ilu",
+  /// "fill_level"). If the parameter ("preconditioner", "ilu",
+  /// "schedule") is "level", the factorization and the triangular
+  /// solves process the rows by level sets using multiple threads
+  /// (global parameter "num_threads"). This gives the same result as
+  /// the sequential schedule.
 
   class uBLASILUPreconditioner : public uBLASPreconditioner
   {
@@ -49,17 +57,39 @@ namespace dolfin
     // Initialize preconditioner
     void init(const uBLASMatrix<ublas_sparse_matrix>& P);
 
+    // Initialize preconditioner
+    void init(const CSRMatrix& P);
+
     /// Solve linear system Ax = b approximately
     void solve(uBLASVector& x, const uBLASVector& b) const;
 
   private:
 
+    // Compute factorization of M in place
+    void factorize();
+
+    // Extend pattern of M with fill up to given level (ILU(k))
+    void add_fill(std::size_t fill_level);
+
+    // Compute level sets of rows for the lower and upper triangular
+    // parts of M
+    void compute_level_sets();
+
+    // Factorize row k of M using work array iw (zero on entry and
+    // exit). Returns false if a zero pivot is detected.
+    bool factorize_row(std::size_t k, std::vector<std::size_t>& iw);
+
     // Preconditioner matrix (factorised)
     uBLASMatrix<ublas_sparse_matrix> M;
 
     // Diagonal
     std::vector<std::size_t> diagonal;
 
+    // Rows of each level set for the lower (forward) and upper
+    // (backward) triangular parts, in compressed storage
+    std::vector<std::size_t> lower_level_ptr, lower_level_rows;
+    std::vector<std::size_t> upper_level_ptr, upper_level_rows;
+
     const Parameters& parameters;
 
   };
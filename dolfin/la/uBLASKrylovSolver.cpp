@@ -18,18 +18,42 @@
 // Modified by Anders Logg 2006-2012
 //
 // First added:  2006-05-31
-// Last changed: 2012-05-07
+// Last changed: 2013-12-11
 
+#include <algorithm>
+#include <cmath>
 #include <boost/assign/list_of.hpp>
+#include <dolfin/common/constants.h>
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/log/LogStream.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "uBLASILUPreconditioner.h"
+#include "uBLASAMGPreconditioner.h"
 #include "uBLASDummyPreconditioner.h"
+#include "GenericLinearAlgebraFactory.h"
 #include "uBLASKrylovSolver.h"
+#include "CSRMatrix.h"
 #include "KrylovSolver.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Number of rows per chunk in fused vector operations. Partial sums
+  // are computed per chunk and added in order, so results do not
+  // depend on the number of threads.
+  const std::size_t chunk_size = 2048;
+
+  // Number of threads for an operation on given number of chunks
+  int get_num_threads(std::size_t num_chunks)
+  {
+    const std::size_t threads
+      = std::max((std::size_t) dolfin::parameters["num_threads"],
+                 (std::size_t) 1);
+    return std::max(std::min(threads, num_chunks), (std::size_t) 1);
+  }
+}
+
 //-----------------------------------------------------------------------------
 std::vector<std::pair<std::string, std::string> >
 uBLASKrylovSolver::methods()
@@ -38,7 +62,9 @@ uBLASKrylovSolver::methods()
     ("default",  "default Krylov method")
     ("cg",       "Conjugate gradient method")
     ("gmres",    "Generalized minimal residual method")
-    ("bicgstab", "Biconjugate gradient stabilized method");
+    ("bicgstab", "Biconjugate gradient stabilized method")
+    ("pipecg",   "Pipelined conjugate gradient method")
+    ("pgmres",   "Generalized minimal residual method (single reduction)");
 }
 //-----------------------------------------------------------------------------
 std::vector<std::pair<std::string, std::string> >
@@ -47,13 +73,33 @@ uBLASKrylovSolver::preconditioners()
   return boost::assign::pair_list_of
     ("default", "default preconditioner")
     ("none",    "No preconditioner")
-    ("ilu",     "Incomplete LU factorization");
+    ("ilu",     "Incomplete LU factorization")
+    ("amg",     "Smoothed aggregation algebraic multigrid");
 }
 //-----------------------------------------------------------------------------
 Parameters uBLASKrylovSolver::default_parameters()
 {
   Parameters p(KrylovSolver::default_parameters());
   p.rename("ublas_krylov_solver");
+
+  // Schedule of ILU factorization and triangular solves
+  std::set<std::string> schedule_options;
+  schedule_options.insert("sequential");
+  schedule_options.insert("level");
+  p("preconditioner")("ilu").add("schedule", "sequential", schedule_options);
+
+  // Algebraic multigrid preconditioner parameters
+  Parameters p_amg("amg");
+  p_amg.add("strong_threshold", 0.08);
+  p_amg.add("max_levels", 10);
+  p_amg.add("coarse_size", 500);
+  std::set<std::string> smoother_options;
+  smoother_options.insert("chebyshev");
+  smoother_options.insert("jacobi");
+  p_amg.add("smoother", "chebyshev", smoother_options);
+  p_amg.add("smoother_sweeps", 2);
+  p("preconditioner").add(p_amg);
+
   return p;
 }
 //-----------------------------------------------------------------------------
@@ -110,6 +156,21 @@ std::size_t uBLASKrylovSolver::solve(GenericVector& x, const GenericVector& b)
                         *P);
   }
 
+  // Try to use operator as a CSR matrix
+  if (has_type<const CSRMatrix>(*_A))
+  {
+    boost::shared_ptr<const CSRMatrix> A = as_type<const CSRMatrix>(_A);
+    boost::shared_ptr<const CSRMatrix> P = as_type<const CSRMatrix>(_P);
+
+    dolfin_assert(A);
+    dolfin_assert(P);
+
+    return solve_krylov(*A,
+                        as_type<uBLASVector>(x),
+                        as_type<const uBLASVector>(b),
+                        *P);
+  }
+
   // If that fails, try to use it as a uBLAS linear operator
   if (has_type<const uBLASLinearOperator>(*_A))
   {
@@ -140,12 +201,71 @@ std::size_t uBLASKrylovSolver::solve(const GenericLinearOperator& A,
   return solve(as_type<uBLASVector>(x), as_type<const uBLASVector>(b));
 }
 //-----------------------------------------------------------------------------
+std::size_t uBLASKrylovSolver::solve(MultiVector& X, const MultiVector& B)
+{
+  dolfin_assert(_A);
+  dolfin_assert(_P);
+
+  // Try to first use operator as a uBLAS matrix
+  if (has_type<const uBLASMatrix<ublas_sparse_matrix> >(*_A))
+  {
+    boost::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > A
+      = as_type<const uBLASMatrix<ublas_sparse_matrix> >(_A);
+    boost::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > P
+      = as_type<const uBLASMatrix<ublas_sparse_matrix> >(_P);
+
+    dolfin_assert(A);
+    dolfin_assert(P);
+
+    return solve_krylov(*A, X, B, *P);
+  }
+
+  // Try to use operator as a CSR matrix
+  if (has_type<const CSRMatrix>(*_A))
+  {
+    boost::shared_ptr<const CSRMatrix> A = as_type<const CSRMatrix>(_A);
+    boost::shared_ptr<const CSRMatrix> P = as_type<const CSRMatrix>(_P);
+
+    dolfin_assert(A);
+    dolfin_assert(P);
+
+    return solve_krylov(*A, X, B, *P);
+  }
+
+  // If that fails, try to use it as a uBLAS linear operator
+  if (has_type<const uBLASLinearOperator>(*_A))
+  {
+    boost::shared_ptr<const uBLASLinearOperator> A
+      =  as_type<const uBLASLinearOperator>(_A);
+    boost::shared_ptr<const uBLASLinearOperator> P
+      =  as_type<const uBLASLinearOperator>(_P);
+
+    dolfin_assert(A);
+    dolfin_assert(P);
+
+    return solve_krylov(*A, X, B, *P);
+  }
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+std::size_t uBLASKrylovSolver::solve(const GenericLinearOperator& A,
+                                     MultiVector& X, const MultiVector& B)
+{
+  // Set operator
+  boost::shared_ptr<const GenericLinearOperator> Atmp(&A, NoDeleter());
+  set_operator(Atmp);
+  return solve(X, B);
+}
+//-----------------------------------------------------------------------------
 void uBLASKrylovSolver::select_preconditioner(std::string preconditioner)
 {
   if (preconditioner == "none")
     _pc.reset(new uBLASDummyPreconditioner());
   else if (preconditioner == "ilu")
     _pc.reset(new uBLASILUPreconditioner(parameters));
+  else if (preconditioner == "amg")
+    _pc.reset(new uBLASAMGPreconditioner(parameters));
   else if (preconditioner == "default")
     _pc.reset(new uBLASILUPreconditioner(parameters));
   else
@@ -166,3 +286,229 @@ void uBLASKrylovSolver::read_parameters()
   report  = parameters["report"];
 }
 //-----------------------------------------------------------------------------
+void uBLASKrylovSolver::pipecg_inner(const ublas_vector& r,
+                                     const ublas_vector& u,
+                                     const ublas_vector& w,
+                                     double& gamma, double& delta, double& rr)
+{
+  const std::size_t n = r.size();
+  const int num_chunks = (n + chunk_size - 1)/chunk_size;
+  const double* _r = r.data().begin();
+  const double* _u = u.data().begin();
+  const double* _w = w.data().begin();
+
+  std::vector<double> partial(3*num_chunks);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(get_num_threads(num_chunks))
+  #endif
+  for (int c = 0; c < num_chunks; ++c)
+  {
+    const std::size_t begin = c*chunk_size;
+    const std::size_t end = std::min(begin + chunk_size, n);
+    double ru = 0.0, wu = 0.0, rr_c = 0.0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      ru += _r[i]*_u[i];
+      wu += _w[i]*_u[i];
+      rr_c += _r[i]*_r[i];
+    }
+    partial[3*c] = ru;
+    partial[3*c + 1] = wu;
+    partial[3*c + 2] = rr_c;
+  }
+
+  gamma = delta = rr = 0.0;
+  for (int c = 0; c < num_chunks; ++c)
+  {
+    gamma += partial[3*c];
+    delta += partial[3*c + 1];
+    rr += partial[3*c + 2];
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASKrylovSolver::pipecg_update(double alpha, double beta,
+                                      const ublas_vector& m,
+                                      const ublas_vector& n,
+                                      ublas_vector& z, ublas_vector& q,
+                                      ublas_vector& s, ublas_vector& p,
+                                      ublas_vector& x, ublas_vector& r,
+                                      ublas_vector& u, ublas_vector& w)
+{
+  const int size = x.size();
+  const double* _m = m.data().begin();
+  const double* _n = n.data().begin();
+  double* _z = z.data().begin();
+  double* _q = q.data().begin();
+  double* _s = s.data().begin();
+  double* _p = p.data().begin();
+  double* _x = x.data().begin();
+  double* _r = r.data().begin();
+  double* _u = u.data().begin();
+  double* _w = w.data().begin();
+
+  #ifdef HAS_OPENMP
+  const int num_chunks = (size + chunk_size - 1)/chunk_size;
+  #pragma omp parallel for num_threads(get_num_threads(num_chunks)) schedule(static)
+  #endif
+  for (int i = 0; i < size; ++i)
+  {
+    _z[i] = _n[i] + beta*_z[i];
+    _q[i] = _m[i] + beta*_q[i];
+    _s[i] = _w[i] + beta*_s[i];
+    _p[i] = _u[i] + beta*_p[i];
+    _x[i] += alpha*_p[i];
+    _r[i] -= alpha*_s[i];
+    _u[i] -= alpha*_q[i];
+    _w[i] -= alpha*_z[i];
+  }
+}
+//-----------------------------------------------------------------------------
+bool uBLASKrylovSolver::solve_dense(ublas_dense_matrix A,
+                                    ublas_dense_matrix& B)
+{
+  // Factorize
+  ublas::permutation_matrix<std::size_t> pmatrix(A.size1());
+  if (ublas::lu_factorize(A, pmatrix) != 0)
+    return false;
+
+  // Check for (numerically) zero pivots
+  double max_pivot = 0.0;
+  for (std::size_t i = 0; i < A.size1(); ++i)
+    max_pivot = std::max(max_pivot, std::abs(A(i, i)));
+  for (std::size_t i = 0; i < A.size1(); ++i)
+  {
+    if (std::abs(A(i, i)) <= DOLFIN_EPS*max_pivot)
+      return false;
+  }
+
+  // Solve
+  ublas::lu_substitute(A, pmatrix, B);
+  return true;
+}
+//-----------------------------------------------------------------------------
+void uBLASKrylovSolver::orthonormalize(const std::vector<uBLASVector>& w,
+                                       std::vector<uBLASVector>& v)
+{
+  v.clear();
+  for (std::size_t j = 0; j < w.size(); ++j)
+  {
+    uBLASVector u(w[j]);
+    ublas_vector& _u = u.vec();
+    const double u0_norm = norm_2(_u);
+    for (std::size_t i = 0; i < v.size(); ++i)
+      noalias(_u) -= ublas::inner_prod(v[i].vec(), _u)*v[i].vec();
+
+    // Drop vector if it (nearly) vanished
+    const double u_norm = norm_2(_u);
+    if (u_norm > 0.0 && u_norm > 1.0e-12*u0_norm)
+    {
+      _u /= u_norm;
+      v.push_back(u);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+double uBLASKrylovSolver::orthogonalize(const std::vector<boost::shared_ptr<uBLASVector> >& V,
+                                        std::size_t j, ublas_vector& w,
+                                        ublas_vector& h)
+{
+  const std::size_t n = w.size();
+  const std::size_t k = j + 1;
+  const int num_chunks = (n + chunk_size - 1)/chunk_size;
+  dolfin_assert(V.size() > j);
+
+  // Get pointers to the vectors v_i
+  std::vector<const double*> v(k);
+  for (std::size_t i = 0; i < k; ++i)
+  {
+    dolfin_assert(V[i]->size() == n);
+    v[i] = V[i]->data();
+  }
+  double* _w = w.data().begin();
+
+  for (std::size_t i = 0; i < k; ++i)
+    h(i) = 0.0;
+
+  double norm_before = 0.0, norm = 0.0;
+  std::vector<double> partial((k + 1)*num_chunks);
+  std::vector<double> coefficients(k + 1);
+  for (std::size_t pass = 0; pass < 2; ++pass)
+  {
+    // Compute (w, v_i) for i = 0, ..., j and (w, w) in one pass
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(get_num_threads(num_chunks))
+    #endif
+    for (int c = 0; c < num_chunks; ++c)
+    {
+      const std::size_t begin = c*chunk_size;
+      const std::size_t end = std::min(begin + chunk_size, n);
+      for (std::size_t i = 0; i < k; ++i)
+      {
+        const double* v_i = v[i];
+        double value = 0.0;
+        for (std::size_t row = begin; row < end; ++row)
+          value += v_i[row]*_w[row];
+        partial[c*(k + 1) + i] = value;
+      }
+      double value = 0.0;
+      for (std::size_t row = begin; row < end; ++row)
+        value += _w[row]*_w[row];
+      partial[c*(k + 1) + k] = value;
+    }
+    std::fill(coefficients.begin(), coefficients.end(), 0.0);
+    for (int c = 0; c < num_chunks; ++c)
+      for (std::size_t i = 0; i <= k; ++i)
+        coefficients[i] += partial[c*(k + 1) + i];
+    if (pass == 0)
+      norm_before = std::sqrt(coefficients[k]);
+
+    // Compute w = w - V h and (w, w) in one pass
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(get_num_threads(num_chunks))
+    #endif
+    for (int c = 0; c < num_chunks; ++c)
+    {
+      const std::size_t begin = c*chunk_size;
+      const std::size_t end = std::min(begin + chunk_size, n);
+      for (std::size_t i = 0; i < k; ++i)
+      {
+        const double* v_i = v[i];
+        const double h_i = coefficients[i];
+        for (std::size_t row = begin; row < end; ++row)
+          _w[row] -= h_i*v_i[row];
+      }
+      double value = 0.0;
+      for (std::size_t row = begin; row < end; ++row)
+        value += _w[row]*_w[row];
+      partial[c] = value;
+    }
+    norm = 0.0;
+    for (int c = 0; c < num_chunks; ++c)
+      norm += partial[c];
+    norm = std::sqrt(norm);
+
+    for (std::size_t i = 0; i < k; ++i)
+      h(i) += coefficients[i];
+
+    // Repeat once if cancellation is severe (Daniel, Gragg, Kaufman
+    // and Stewart criterion)
+    if (norm > norm_before/std::sqrt(2.0))
+      break;
+  }
+
+  return norm;
+}
+//-----------------------------------------------------------------------------
+std::vector<boost::shared_ptr<uBLASVector> >
+uBLASKrylovSolver::create_vectors(const uBLASVector& x, std::size_t n)
+{
+  std::vector<boost::shared_ptr<uBLASVector> > v(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    boost::shared_ptr<GenericVector> _v = x.factory().create_vector();
+    _v->resize(x.size());
+    v[i] = as_type<uBLASVector>(_v);
+  }
+  return v;
+}
+//-----------------------------------------------------------------------------
@@ -18,17 +18,19 @@
 // Modified by Anders Logg 2006-2012
 //
 // First added:  2006-05-31
-// Last changed: 2012-08-20
+// Last changed: 2013-12-11
 
 #ifndef __UBLAS_KRYLOV_SOLVER_H
 #define __UBLAS_KRYLOV_SOLVER_H
 
 #include <set>
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <dolfin/common/types.h>
 #include "ublas.h"
 #include "GenericLinearSolver.h"
+#include "MultiVector.h"
 #include "uBLASLinearOperator.h"
 #include "uBLASMatrix.h"
 #include "uBLASVector.h"
@@ -90,6 +92,18 @@ namespace dolfin
     std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
                       const GenericVector& b);
 
+    /// Solve linear systems AX = B with multiple right-hand sides and
+    /// return number of iterations. The methods "cg" and "pipecg" use
+    /// block CG, the other methods solve for one right-hand side at a
+    /// time. The preconditioner is computed once for all right-hand
+    /// sides.
+    std::size_t solve(MultiVector& X, const MultiVector& B);
+
+    /// Solve linear systems AX = B with multiple right-hand sides and
+    /// return number of iterations
+    std::size_t solve(const GenericLinearOperator& A, MultiVector& X,
+                      const MultiVector& B);
+
     /// Return a list of available solver methods
     static std::vector<std::pair<std::string, std::string> > methods();
 
@@ -108,21 +122,81 @@ namespace dolfin
                       const uBLASVector& b,
                       const MatP& P);
 
+    /// Solve linear systems AX = B with multiple right-hand sides and
+    /// return number of iterations
+    template<typename MatA, typename MatP>
+    std::size_t solve_krylov(const MatA& A, MultiVector& X,
+                             const MultiVector& B, const MatP& P);
+
+    /// Select method and solve linear system Ax = b
+    template<typename Mat>
+    std::size_t solve_method(const Mat& A, uBLASVector& x,
+                             const uBLASVector& b, bool& converged) const;
+
     /// Solve linear system Ax = b using CG
     template<typename Mat>
     std::size_t solveCG(const Mat& A, uBLASVector& x, const uBLASVector& b,
                  bool& converged) const;
 
-    /// Solve linear system Ax = b using restarted GMRES
+    /// Solve linear system Ax = b using pipelined CG
+    template<typename Mat>
+    std::size_t solvePipeCG(const Mat& A, uBLASVector& x,
+                            const uBLASVector& b, bool& converged) const;
+
+    /// Solve linear system Ax = b using restarted GMRES. If fused is
+    /// true, the Arnoldi vectors are orthogonalised by classical
+    /// Gram-Schmidt with all inner products computed in one pass.
     template<typename Mat>
     std::size_t solveGMRES(const Mat& A, uBLASVector& x, const uBLASVector& b,
-                        bool& converged) const;
+                           bool& converged, bool fused=false) const;
 
     /// Solve linear system Ax = b using BiCGStab
     template<typename Mat>
     std::size_t solveBiCGStab(const Mat& A, uBLASVector& x, const uBLASVector& b,
                         bool& converged) const;
 
+    /// Solve linear systems AX = B using block CG
+    template<typename Mat>
+    std::size_t solveBlockCG(const Mat& A, MultiVector& X,
+                             const MultiVector& B, bool& converged) const;
+
+    /// Solve small dense system AX = B in place of B by LU
+    /// factorization. Returns false if A is (numerically) singular.
+    static bool solve_dense(ublas_dense_matrix A, ublas_dense_matrix& B);
+
+    /// Orthonormalise the vectors w by modified Gram-Schmidt and
+    /// store the result in v, dropping vectors that are (numerically)
+    /// linearly dependent on the previous ones
+    static void orthonormalize(const std::vector<uBLASVector>& w,
+                               std::vector<uBLASVector>& v);
+
+    /// Compute gamma = (r, u), delta = (w, u) and rr = (r, r) in a
+    /// single pass (pipelined CG)
+    static void pipecg_inner(const ublas_vector& r, const ublas_vector& u,
+                             const ublas_vector& w, double& gamma,
+                             double& delta, double& rr);
+
+    /// Update the vectors of pipelined CG in a single pass
+    static void pipecg_update(double alpha, double beta,
+                              const ublas_vector& m, const ublas_vector& n,
+                              ublas_vector& z, ublas_vector& q,
+                              ublas_vector& s, ublas_vector& p,
+                              ublas_vector& x, ublas_vector& r,
+                              ublas_vector& u, ublas_vector& w);
+
+    /// Orthogonalise w against vectors 0, ..., j of V by classical
+    /// Gram-Schmidt (repeated once on severe cancellation), store
+    /// coefficients in h and return the norm of the result
+    static double orthogonalize(const std::vector<boost::shared_ptr<uBLASVector> >& V,
+                                std::size_t j, ublas_vector& w,
+                                ublas_vector& h);
+
+    /// Create n work vectors of the same type and size as x, so that
+    /// the vector operations of derived types (e.g. CSRVector) are
+    /// used by the solvers
+    static std::vector<boost::shared_ptr<uBLASVector> >
+      create_vectors(const uBLASVector& x, std::size_t n);
+
     /// Select and create named preconditioner
     void select_preconditioner(std::string preconditioner);
 
@@ -185,20 +259,80 @@ namespace dolfin
 
     // Choose solver and solve
     bool converged = false;
-    std::size_t iterations = 0;
-    if (_method == "cg")
-      iterations = solveCG(A, x, b, converged);
-    else if (_method == "gmres")
-      iterations = solveGMRES(A, x, b, converged);
-    else if (_method == "bicgstab")
-      iterations = solveBiCGStab(A, x, b, converged);
-    else if (_method == "default")
-      iterations = solveBiCGStab(A, x, b, converged);
-    else
+    const std::size_t iterations = solve_method(A, x, b, converged);
+
+    // Check for convergence
+    if (!converged)
+    {
+      bool error_on_nonconvergence = parameters["error_on_nonconvergence"];
+      if (error_on_nonconvergence)
+      {
+        dolfin_error("uBLASKrylovSolver.h",
+                     "solve linear system using uBLAS Krylov solver",
+                     "Solution failed to converge");
+      }
+      else
+        warning("uBLAS Krylov solver failed to converge.");
+    }
+    else if (report)
+      info("Krylov solver converged in %d iterations.", iterations);
+
+    return iterations;
+  }
+  //-----------------------------------------------------------------------------
+  template<typename MatA, typename MatP>
+  std::size_t uBLASKrylovSolver::solve_krylov(const MatA& A,
+                                               MultiVector& X,
+                                               const MultiVector& B,
+                                               const MatP& P)
+  {
+    // Check dimensions
+    const std::size_t M = A.size(0);
+    const std::size_t N = A.size(1);
+    if (N != B.size())
     {
       dolfin_error("uBLASKrylovSolver.h",
                    "solve linear system using uBLAS Krylov solver",
-                   "Requested Krylov method (\"%s\") is unknown", _method.c_str());
+                   "Non-matching dimensions for linear system");
+    }
+
+    // Reinitialise X if necessary
+    if (X.size() != B.size() || X.local_size() != B.size()
+        || X.num_vectors() != B.num_vectors())
+    {
+      X.init(B.size(), B.num_vectors());
+    }
+
+    // Read parameters if not done
+    read_parameters();
+
+    // Write a message
+    if (report)
+    {
+      info("Solving linear system of size %d x %d with %d right-hand sides (uBLAS Krylov solver).",
+           M, N, B.num_vectors());
+    }
+
+    // Initialise preconditioner (once for all right-hand sides)
+    _pc->init(P);
+
+    bool converged = true;
+    std::size_t iterations = 0;
+    if (_method == "cg" || _method == "pipecg")
+      iterations = solveBlockCG(A, X, B, converged);
+    else
+    {
+      // Solve for one right-hand side at a time
+      uBLASVector x(N), b(N);
+      for (std::size_t j = 0; j < B.num_vectors(); ++j)
+      {
+        std::copy(B.data() + j*N, B.data() + (j + 1)*N, b.vec().begin());
+        std::copy(X.data() + j*N, X.data() + (j + 1)*N, x.vec().begin());
+        bool _converged = false;
+        iterations += solve_method(A, x, b, _converged);
+        converged = converged && _converged;
+        std::copy(x.vec().begin(), x.vec().end(), X.data() + j*N);
+      }
     }
 
     // Check for convergence
@@ -221,6 +355,34 @@ namespace dolfin
   }
   //-----------------------------------------------------------------------------
   template<typename Mat>
+  std::size_t uBLASKrylovSolver::solve_method(const Mat& A,
+                                               uBLASVector& x,
+                                               const uBLASVector& b,
+                                               bool& converged) const
+  {
+    std::size_t iterations = 0;
+    if (_method == "cg")
+      iterations = solveCG(A, x, b, converged);
+    else if (_method == "gmres")
+      iterations = solveGMRES(A, x, b, converged);
+    else if (_method == "pipecg")
+      iterations = solvePipeCG(A, x, b, converged);
+    else if (_method == "pgmres")
+      iterations = solveGMRES(A, x, b, converged, true);
+    else if (_method == "bicgstab")
+      iterations = solveBiCGStab(A, x, b, converged);
+    else if (_method == "default")
+      iterations = solveBiCGStab(A, x, b, converged);
+    else
+    {
+      dolfin_error("uBLASKrylovSolver.h",
+                   "solve linear system using uBLAS Krylov solver",
+                   "Requested Krylov method (\"%s\") is unknown", _method.c_str());
+    }
+    return iterations;
+  }
+  //-----------------------------------------------------------------------------
+  template<typename Mat>
   std::size_t uBLASKrylovSolver::solveCG(const Mat& A,
                                           uBLASVector& x,
                                           const uBLASVector& b,
@@ -231,21 +393,96 @@ namespace dolfin
   }
   //-----------------------------------------------------------------------------
   template<typename Mat>
-  std::size_t uBLASKrylovSolver::solveGMRES(const Mat& A, uBLASVector& x,
-                                             const uBLASVector& b,
-                                             bool& converged) const
+  std::size_t uBLASKrylovSolver::solvePipeCG(const Mat& A,
+                                              uBLASVector& x,
+                                              const uBLASVector& b,
+                                              bool& converged) const
   {
-    // Get underlying uBLAS vectors
-    ublas_vector& _x = x.vec();
-    const ublas_vector& _b = b.vec();
+    // Pipelined preconditioned CG (P. Ghysels and W. Vanroose, "Hiding
+    // global synchronization latency in the preconditioned Conjugate
+    // Gradient algorithm", Parallel Computing 40 (2014)). The inner
+    // products and the vector updates of an iteration are each done
+    // in a single pass over memory.
 
-    // Get size of system
-    const std::size_t size = A.size(0);
-
-    // Create residual vector
-    uBLASVector r(size);
+    // Allocate vectors
+    std::vector<boost::shared_ptr<uBLASVector> > work = create_vectors(x, 9);
+    uBLASVector& r = *work[0];
+    uBLASVector& u = *work[1];
+    uBLASVector& w = *work[2];
+    uBLASVector& m = *work[3];
+    uBLASVector& n = *work[4];
+    uBLASVector& z = *work[5];
+    uBLASVector& q = *work[6];
+    uBLASVector& s = *work[7];
+    uBLASVector& p = *work[8];
     ublas_vector& _r = r.vec();
 
+    // Compute residual r = b - A*x, u = M^-1 r and w = A*u
+    A.mult(x, r);
+    r *= -1.0;
+    r += b;
+    _pc->solve(u, r);
+    A.mult(u, w);
+
+    double alpha = 0.0, gamma_old = 0.0, r0_norm = 0.0;
+
+    converged = false;
+    std::size_t iteration = 0;
+    while (true)
+    {
+      // Compute inner products
+      double gamma = 0.0, delta = 0.0, rr = 0.0;
+      pipecg_inner(_r, u.vec(), w.vec(), gamma, delta, rr);
+      const double r_norm = std::sqrt(rr);
+      if (iteration == 0)
+        r0_norm = r_norm;
+
+      // Check for convergence
+      if (r_norm < atol || r_norm < rtol*r0_norm)
+      {
+        converged = true;
+        break;
+      }
+      if (iteration == max_it || r_norm > div_tol*r0_norm)
+        break;
+
+      // m = M^-1 w, n = A*m (these would overlap with the reductions
+      // above in a distributed setting)
+      _pc->solve(m, w);
+      A.mult(m, n);
+
+      // Compute step lengths
+      double beta = 0.0;
+      if (iteration == 0)
+        alpha = gamma/delta;
+      else
+      {
+        beta = gamma/gamma_old;
+        alpha = gamma/(delta - beta*gamma/alpha);
+      }
+      gamma_old = gamma;
+
+      // Update vectors
+      pipecg_update(alpha, beta, m.vec(), n.vec(), z.vec(), q.vec(), s.vec(),
+                    p.vec(), x.vec(), _r, u.vec(), w.vec());
+
+      ++iteration;
+    }
+
+    return iteration;
+  }
+  //-----------------------------------------------------------------------------
+  template<typename Mat>
+  std::size_t uBLASKrylovSolver::solveGMRES(const Mat& A, uBLASVector& x,
+                                             const uBLASVector& b,
+                                             bool& converged,
+                                             bool fused) const
+  {
+    // Create residual vector and w vector
+    std::vector<boost::shared_ptr<uBLASVector> > work = create_vectors(x, 2);
+    boost::shared_ptr<uBLASVector> r = work[0];
+    boost::shared_ptr<uBLASVector> w = work[1];
+
     // Create H matrix and h vector
     ublas_matrix_cmajor_tri H(restart, restart);
     ublas_vector _h(restart+1);
@@ -253,12 +490,9 @@ namespace dolfin
     // Create gamma vector
     ublas_vector _gamma(restart+1);
 
-    // Matrix containing v_k as columns.
-    ublas_matrix_cmajor V(size, restart+1);
-
-    // w vector
-    uBLASVector w(size);
-    ublas_vector& _w = w.vec();
+    // Vectors v_k
+    std::vector<boost::shared_ptr<uBLASVector> > V
+      = create_vectors(x, restart + 1);
 
     // Givens vectors
     ublas_vector _c(restart), _s(restart);
@@ -270,19 +504,14 @@ namespace dolfin
     std::size_t iteration = 0;
     while (iteration < max_it && !converged)
     {
-      // Compute residual r = b -A*x
-      //noalias(r) = b;
-      //axpy_prod(A, -x, r, false);
-      A.mult(x, r);
-      _r *= -1.0;
-      noalias(_r) += _b;
-
-      // Apply preconditioner (use w for temporary storage)
-      _w.assign(_r);
-      _pc->solve(r, w);
+      // Compute residual b - A*x (in w) and apply preconditioner
+      A.mult(x, *w);
+      *w *= -1.0;
+      *w += b;
+      _pc->solve(*r, *w);
 
       // L2 norm of residual (for most recent restart)
-      const double beta = norm_2(_r);
+      const double beta = r->norm("l2");
 
      // Save intial residual (from restart 0)
      if(iteration == 0)
@@ -298,32 +527,34 @@ namespace dolfin
       _gamma.clear();
       _gamma(0) = beta;
 
-      // Create first column of V
-      noalias(column(V, 0)) = _r/beta;
+      // Create first vector v_0 (r takes the storage of the old v_0)
+      *r /= beta;
+      V[0].swap(r);
 
       // Modified Gram-Schmidt procedure
       std::size_t subiteration = 0;
       std::size_t j = 0;
       while (subiteration < restart && iteration < max_it && !converged && r_norm/beta < div_tol)
       {
-        // Compute product w = A*V_j (use r for temporary storage)
-        //axpy_prod(A, column(V, j), w, true);
-        noalias(_r) = column(V, j);
-        A.mult(r, w);
-
-        // Apply preconditioner (use r for temporary storage)
-        _r.assign(_w);
-        _pc->solve(w, r);
+        // Compute product w = M^-1 A*v_j (use r for temporary storage)
+        A.mult(*V[j], *r);
+        _pc->solve(*w, *r);
 
-        for (std::size_t i=0; i <= j; ++i)
+        if (fused)
+          _h(j+1) = orthogonalize(V, j, w->vec(), _h);
+        else
         {
-          _h(i)= inner_prod(_w, column(V,i));
-          noalias(_w) -= _h(i)*column(V,i);
+          for (std::size_t i=0; i <= j; ++i)
+          {
+            _h(i) = w->inner(*V[i]);
+            w->axpy(-_h(i), *V[i]);
+          }
+          _h(j+1) = w->norm("l2");
         }
-        _h(j+1) = norm_2(_w);
 
-        // Insert column of V (inserting v_(j+1)
-        noalias(column(V,j+1)) = _w/_h(j+1);
+        // Insert v_(j+1) (w takes the storage of the old v_(j+1))
+        *w /= _h(j+1);
+        V[j+1].swap(w);
 
         // Apply previous Givens rotations to the "new" column
         // (this could be improved? - use more uBLAS functions.
@@ -381,8 +612,8 @@ namespace dolfin
       ublas::inplace_solve(Htrunc, _g, ublas::upper_tag ());
 
       // x_m = x_0 + V*y
-      ublas_matrix_cmajor_range _v( V, ublas::range(0,V.size1()), ublas::range(0,subiteration) );
-      axpy_prod(_v, _g, _x, false);
+      for (std::size_t i = 0; i < subiteration; ++i)
+        x.axpy(_g(i), *V[i]);
     }
     return iteration;
   }
@@ -393,49 +624,35 @@ namespace dolfin
                                                 const uBLASVector& b,
                                                 bool& converged) const
   {
-    // Get uderlying uBLAS vectors
-    ublas_vector& _x = x.vec();
-    const ublas_vector& _b = b.vec();
-
-   // Get size of system
-    const std::size_t size = A.size(0);
-
     // Allocate vectors
-    uBLASVector r(size), rstar(size), p(size), s(size), v(size), t(size), y(size), z(size);
-    ublas_vector& _r = r.vec();
-    ublas_vector& _rstar = rstar.vec();
-    ublas_vector& _p = p.vec();
-    ublas_vector& _s = s.vec();
-    ublas_vector& _v = v.vec();
-    ublas_vector& _t = t.vec();
-    ublas_vector& _y = y.vec();
-    ublas_vector& _z = z.vec();
+    std::vector<boost::shared_ptr<uBLASVector> > work = create_vectors(x, 7);
+    uBLASVector& r = *work[0];
+    uBLASVector& rstar = *work[1];
+    uBLASVector& p = *work[2];
+    uBLASVector& v = *work[3];
+    uBLASVector& t = *work[4];
+    uBLASVector& y = *work[5];
+    uBLASVector& z = *work[6];
 
     double alpha = 1.0, beta = 0.0, omega = 1.0, r_norm = 0.0;
     double rho_old = 1.0, rho = 1.0;
 
     // Compute residual r = b -A*x
-    //r.assign(b);
-    //axpy_prod(A, -x, r, false);
     A.mult(x, r);
     r *= -1.0;
-    noalias(_r) += _b;
+    r += b;
 
-    const double r0_norm = norm_2(_r);
+    const double r0_norm = r.norm("l2");
     if( r0_norm < atol )
     {
       converged = true;
       return 0;
     }
 
-    // Initialise r^star, v and p
-    _rstar.assign(_r);
-    _v.clear();
-    _p.clear();
-
-    // Apply preconditioner to r^start. This is a trick to avoid problems in which
-    // (r^start, r) = 0  after the first iteration (such as PDE's with homogeneous
-    // Neumann bc's and no forcing/source term.
+    // Apply preconditioner to r to get r^star (v and p are zero). This is a
+    // trick to avoid problems in which (r^start, r) = 0  after the first
+    // iteration (such as PDE's with homogeneous Neumann bc's and no
+    // forcing/source term.
     _pc->solve(rstar, r);
 
     // Right-preconditioned Bi-CGSTAB
@@ -449,7 +666,7 @@ namespace dolfin
       rho_old = rho;
 
       // Compute new rho
-      rho = ublas::inner_prod(_r, _rstar);
+      rho = r.inner(rstar);
       if( fabs(rho) < 1e-25 )
       {
         dolfin_error("uBLASKrylovSolver.h",
@@ -461,39 +678,39 @@ namespace dolfin
 
       // p = r1 + beta*p - beta*omega*A*p
       p *= beta;
-      noalias(_p) += _r - beta*omega*_v;
+      p += r;
+      p.axpy(-beta*omega, v);
 
       // My = p
       _pc->solve(y, p);
 
       // v = A*y
-      //axpy_prod(A, y, v, true);
       A.mult(y, v);
 
       // alpha = (r, rstart) / (v, rstar)
-      alpha = rho/ublas::inner_prod(_v, _rstar);
+      alpha = rho/v.inner(rstar);
 
-      // s = r - alpha*v
-      noalias(_s) = _r - alpha*_v;
+      // s = r - alpha*v (stored in r)
+      r.axpy(-alpha, v);
 
       // Mz = s
-      _pc->solve(z, s);
+      _pc->solve(z, r);
 
       // t = A*z
-      //axpy_prod(A, z, t, true);
       A.mult(z, t);
 
       // omega = (t, s) / (t,t)
-      omega = ublas::inner_prod(_t, _s)/ublas::inner_prod(_t, _t);
+      omega = t.inner(r)/t.inner(t);
 
-      // x = x + alpha*p + omega*s
-      noalias(_x) += alpha*_y + omega*_z;
+      // x = x + alpha*y + omega*z
+      x.axpy(alpha, y);
+      x.axpy(omega, z);
 
       // r = s - omega*t
-      noalias(_r) = _s - omega*_t;
+      r.axpy(-omega, t);
 
       // Compute norm of the residual and check for convergence
-      r_norm = norm_2(_r);
+      r_norm = r.norm("l2");
       if( r_norm/r0_norm < rtol || r_norm < atol)
         converged = true;
 
@@ -503,6 +720,129 @@ namespace dolfin
     return iteration;
   }
   //-----------------------------------------------------------------------------
+  template<typename Mat>
+  std::size_t uBLASKrylovSolver::solveBlockCG(const Mat& A,
+                                               MultiVector& X,
+                                               const MultiVector& B,
+                                               bool& converged) const
+  {
+    // Preconditioned block CG (D. P. O'Leary, "The block conjugate
+    // gradient algorithm and related methods", Linear Algebra Appl. 29
+    // (1980)). The search directions of all right-hand sides span one
+    // Krylov space, so fewer iterations are needed than for separate
+    // solves. The search directions are orthonormalised and linearly
+    // dependent directions are dropped (H. Ji and Y. Li, "A
+    // breakdown-free block conjugate gradient method", BIT 57 (2017)),
+    // which avoids breakdown when the block becomes rank deficient,
+    // for example when columns converge.
+
+    // Get size of system and number of right-hand sides
+    const std::size_t size = A.size(0);
+    const std::size_t num_vectors = B.num_vectors();
+
+    // Copy solutions and compute residuals r = b - A*x
+    std::vector<uBLASVector> x(num_vectors), r(num_vectors), z(num_vectors);
+    std::vector<double> r0_norm(num_vectors);
+    for (std::size_t j = 0; j < num_vectors; ++j)
+    {
+      x[j].resize(size);
+      r[j].resize(size);
+      z[j].resize(size);
+      std::copy(X.data() + j*size, X.data() + (j + 1)*size,
+                x[j].vec().begin());
+      std::copy(B.data() + j*size, B.data() + (j + 1)*size,
+                z[j].vec().begin());
+      A.mult(x[j], r[j]);
+      r[j].vec() *= -1.0;
+      noalias(r[j].vec()) += z[j].vec();
+      r0_norm[j] = norm_2(r[j].vec());
+    }
+
+    // Search directions p = orth(M^-1 r)
+    std::vector<uBLASVector> p, q;
+    for (std::size_t j = 0; j < num_vectors; ++j)
+      _pc->solve(z[j], r[j]);
+    orthonormalize(z, p);
+
+    converged = false;
+    std::size_t iteration = 0;
+    while (true)
+    {
+      // Check for convergence and divergence
+      bool diverged = false;
+      converged = true;
+      for (std::size_t j = 0; j < num_vectors; ++j)
+      {
+        const double r_norm = norm_2(r[j].vec());
+        if (!(r_norm < atol || r_norm < rtol*r0_norm[j]))
+          converged = false;
+        if (r_norm > div_tol*r0_norm[j])
+          diverged = true;
+      }
+      if (converged || diverged || iteration == max_it || p.empty())
+        break;
+
+      // q = A*p
+      const std::size_t s = p.size();
+      q.resize(s);
+      for (std::size_t i = 0; i < s; ++i)
+      {
+        q[i].resize(size);
+        A.mult(p[i], q[i]);
+      }
+
+      // alpha = (P^T Q)^-1 P^T R
+      ublas_dense_matrix PtQ(s, s), alpha(s, num_vectors);
+      for (std::size_t i = 0; i < s; ++i)
+      {
+        for (std::size_t k = 0; k < s; ++k)
+          PtQ(i, k) = ublas::inner_prod(p[i].vec(), q[k].vec());
+        for (std::size_t j = 0; j < num_vectors; ++j)
+          alpha(i, j) = ublas::inner_prod(p[i].vec(), r[j].vec());
+      }
+      if (!solve_dense(PtQ, alpha))
+        break;
+
+      // X = X + P*alpha, R = R - Q*alpha
+      for (std::size_t j = 0; j < num_vectors; ++j)
+      {
+        ublas_vector& _x = x[j].vec();
+        ublas_vector& _r = r[j].vec();
+        for (std::size_t i = 0; i < s; ++i)
+        {
+          noalias(_x) += alpha(i, j)*p[i].vec();
+          noalias(_r) -= alpha(i, j)*q[i].vec();
+        }
+      }
+      ++iteration;
+
+      // Z = M^-1 R, beta = -(P^T Q)^-1 Q^T Z
+      ublas_dense_matrix beta(s, num_vectors);
+      for (std::size_t j = 0; j < num_vectors; ++j)
+      {
+        _pc->solve(z[j], r[j]);
+        for (std::size_t i = 0; i < s; ++i)
+          beta(i, j) = -ublas::inner_prod(q[i].vec(), z[j].vec());
+      }
+      if (!solve_dense(PtQ, beta))
+        break;
+
+      // P = orth(Z + P*beta)
+      for (std::size_t j = 0; j < num_vectors; ++j)
+      {
+        for (std::size_t i = 0; i < s; ++i)
+          noalias(z[j].vec()) += beta(i, j)*p[i].vec();
+      }
+      orthonormalize(z, p);
+    }
+
+    // Copy solutions
+    for (std::size_t j = 0; j < num_vectors; ++j)
+      std::copy(x[j].vec().begin(), x[j].vec().end(), X.data() + j*size);
+
+    return iteration;
+  }
+  //-----------------------------------------------------------------------------
 }
 
 #endif
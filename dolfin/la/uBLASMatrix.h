@@ -128,6 +128,13 @@ namespace dolfin
     /// Add block of values
     virtual void add(const double* block, std::size_t m, const dolfin::la_index* rows, std::size_t n, const dolfin::la_index* cols);
 
+    /// Add a batch of blocks of values. Values added to the same
+    /// entry by different blocks are summed before the entry is
+    /// located.
+    virtual void add_batch(std::size_t num_blocks, const double* blocks,
+                           const dolfin::la_index* num_rows,
+                           const dolfin::la_index * const * rows);
+
     /// Add multiple of given matrix (AXPY operation)
     virtual void axpy(double a, const GenericMatrix& A,
                       bool same_nonzero_pattern);
@@ -355,6 +362,25 @@ namespace dolfin
   }
   //---------------------------------------------------------------------------
   template <typename Mat>
+  void uBLASMatrix<Mat>::add_batch(std::size_t num_blocks, const double* blocks,
+                                   const dolfin::la_index* num_rows,
+                                   const dolfin::la_index * const * rows)
+  {
+    // Merge blocks into distinct entries and add each entry once, row
+    // by row
+    std::vector<dolfin::la_index> merged_rows, merged_cols;
+    std::vector<std::size_t> offsets;
+    std::vector<double> values;
+    merge_batch(merged_rows, offsets, merged_cols, values,
+                num_blocks, blocks, num_rows, rows);
+    for (std::size_t i = 0; i < merged_rows.size(); ++i)
+    {
+      for (std::size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+        _A(merged_rows[i], merged_cols[k]) += values[k];
+    }
+  }
+  //---------------------------------------------------------------------------
+  template <typename Mat>
   void uBLASMatrix<Mat>::get(double* block, std::size_t m, const dolfin::la_index* rows,
                              std::size_t n, const dolfin::la_index* cols) const
   {
@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2006-2011
 //
 // First added:  2006-06-23
-// Last changed: 2011-11-11
+// Last changed: 2013-12-11
 
 #ifndef __UBLAS_PRECONDITIONER_H
 #define __UBLAS_PRECONDITIONER_H
@@ -30,6 +30,7 @@ namespace dolfin
 
   class uBLASVector;
   class uBLASLinearOperator;
+  class CSRMatrix;
   template<typename Mat> class uBLASMatrix;
 
   /// This class specifies the interface for preconditioners for the
@@ -61,6 +62,14 @@ namespace dolfin
                    "No init() function for preconditioner uBLASMatrix<ublas_dense_matrix>");
     }
 
+    /// Initialise preconditioner (CSR matrix)
+    virtual void init(const CSRMatrix& P)
+    {
+      dolfin_error("uBLASPreconditioner",
+                   "initialize uBLAS preconditioner",
+                   "No init() function for preconditioner CSRMatrix");
+    }
+
     /// Initialise preconditioner (virtual matrix)
     virtual void init(const uBLASLinearOperator& P)
     {
@@ -20,7 +20,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-06-05
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #ifndef __CELL_TYPE_H
 #define __CELL_TYPE_H
@@ -95,6 +95,12 @@ namespace dolfin
     virtual void refine_cell(Cell& cell, MeshEditor& editor,
                              std::size_t& current_cell) const = 0;
 
+    /// Refine cell uniformly, storing the vertices of the new cells
+    /// contiguously in cells. The new vertex on edge e of the mesh is
+    /// numbered num_vertices + e, where num_vertices is the number of
+    /// vertices of the mesh.
+    virtual void refine_cell(const Cell& cell, unsigned int* cells) const = 0;
+
     /// Compute (generalized) volume of mesh entity
     virtual double volume(const MeshEntity& entity) const = 0;
 
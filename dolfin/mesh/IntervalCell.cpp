@@ -20,7 +20,7 @@
 // Modified by Marie E. Rognes 2011
 //
 // First added:  2006-06-05
-// Last changed: 2013-12-09
+// Last changed: 2013-12-11
 
 #include <algorithm>
 #include <dolfin/log/log.h>
@@ -89,6 +89,22 @@ void IntervalCell::create_entities(std::vector<std::vector<std::size_t> >& e,
 //-----------------------------------------------------------------------------
 void IntervalCell::refine_cell(Cell& cell, MeshEditor& editor,
                                std::size_t& current_cell) const
+{
+  // Compute the two new cells
+  unsigned int cells[2*2];
+  refine_cell(cell, cells);
+
+  // Add the two new cells
+  std::vector<std::size_t> new_cell(2);
+
+  new_cell[0] = cells[0]; new_cell[1] = cells[1];
+  editor.add_cell(current_cell++, new_cell);
+
+  new_cell[0] = cells[2]; new_cell[1] = cells[3];
+  editor.add_cell(current_cell++, new_cell);
+}
+//-----------------------------------------------------------------------------
+void IntervalCell::refine_cell(const Cell& cell, unsigned int* cells) const
 {
   // Get vertices
   const unsigned int* v = cell.entities(0);
@@ -102,14 +118,9 @@ void IntervalCell::refine_cell(Cell& cell, MeshEditor& editor,
   const std::size_t v1 = v[1];
   const std::size_t e0 = offset + cell.index();
 
-  // Add the two new cells
-  std::vector<std::size_t> new_cell(2);
-
-  new_cell[0] = v0; new_cell[1] = e0;
-  editor.add_cell(current_cell++, new_cell);
-
-  new_cell[0] = e0; new_cell[1] = v1;
-  editor.add_cell(current_cell++, new_cell);
+  // Create the two new cells
+  cells[0] = v0; cells[1] = e0;
+  cells[2] = e0; cells[3] = v1;
 }
 //-----------------------------------------------------------------------------
 double IntervalCell::volume(const MeshEntity& interval) const
@@ -18,7 +18,7 @@
 // Modified by Kristoffer Selim 2008
 //
 // First added:  2006-06-05
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #ifndef __INTERVAL_CELL_H
 #define __INTERVAL_CELL_H
@@ -63,6 +63,9 @@ namespace dolfin
     /// Refine cell uniformly
     void refine_cell(Cell& cell, MeshEditor& editor, std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (vertices of new cells)
+    void refine_cell(const Cell& cell, unsigned int* cells) const;
+
     /// Compute (generalized) volume (length) of interval
     double volume(const MeshEntity& interval) const;
 
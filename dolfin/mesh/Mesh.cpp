@@ -26,7 +26,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-05-09
-// Last changed: 2013-06-27
+// Last changed: 2013-12-11
 
 #include <dolfin/ale/ALE.h>
 #include <dolfin/common/Array.h>
@@ -267,6 +267,7 @@ void Mesh::clear()
   _cell_type = 0;
   _ordered = false;
   _cell_orientations.clear();
+  _tree.reset();
 }
 //-----------------------------------------------------------------------------
 void Mesh::clean()
@@ -317,46 +318,57 @@ dolfin::Mesh Mesh::renumber_by_color() const
 void Mesh::translate(const Point& point)
 {
   MeshTransformation::translate(*this, point);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 void Mesh::rotate(double angle, std::size_t axis)
 {
   MeshTransformation::rotate(*this, angle, axis);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 void Mesh::rotate(double angle, std::size_t axis, const Point& point)
 {
   MeshTransformation::rotate(*this, angle, axis, point);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 boost::shared_ptr<MeshDisplacement> Mesh::move(BoundaryMesh& boundary)
 {
-  return ALE::move(*this, boundary);
+  boost::shared_ptr<MeshDisplacement> u = ALE::move(*this, boundary);
+  refit_bounding_box_tree();
+  return u;
 }
 //-----------------------------------------------------------------------------
 boost::shared_ptr<MeshDisplacement> Mesh::move(Mesh& mesh)
 {
-  return ALE::move(*this, mesh);
+  boost::shared_ptr<MeshDisplacement> u = ALE::move(*this, mesh);
+  refit_bounding_box_tree();
+  return u;
 }
 //-----------------------------------------------------------------------------
 void Mesh::move(const GenericFunction& displacement)
 {
   ALE::move(*this, displacement);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 void Mesh::smooth(std::size_t num_iterations)
 {
   MeshSmoothing::smooth(*this, num_iterations);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 void Mesh::smooth_boundary(std::size_t num_iterations, bool harmonic_smoothing)
 {
   MeshSmoothing::smooth_boundary(*this, num_iterations, harmonic_smoothing);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 void Mesh::snap_boundary(const SubDomain& sub_domain, bool harmonic_smoothing)
 {
   MeshSmoothing::snap_boundary(*this, sub_domain, harmonic_smoothing);
+  refit_bounding_box_tree();
 }
 //-----------------------------------------------------------------------------
 const std::vector<std::size_t>& Mesh::color(std::string coloring_type) const
@@ -404,6 +416,13 @@ boost::shared_ptr<BoundingBoxTree> Mesh::bounding_box_tree() const
   return _tree;
 }
 //-----------------------------------------------------------------------------
+void Mesh::refit_bounding_box_tree()
+{
+  // Update bounding box tree (if any) after coordinates have changed
+  if (_tree)
+    _tree->refit();
+}
+//-----------------------------------------------------------------------------
 double Mesh::hmin() const
 {
   CellIterator cell(*this);
@@ -452,6 +471,12 @@ std::size_t Mesh::hash() const
   return (k1 + k2)*(k1 + k2 + 1)/2 + k2;
 }
 //-----------------------------------------------------------------------------
+std::size_t Mesh::memory_usage() const
+{
+  return sizeof(*this) + _geometry.memory_usage() + _topology.memory_usage()
+    + _data.memory_usage() + _cell_orientations.capacity()*sizeof(int);
+}
+//-----------------------------------------------------------------------------
 std::string Mesh::str(bool verbose) const
 {
   std::stringstream s;
@@ -462,6 +487,34 @@ std::string Mesh::str(bool verbose) const
     s << indent(_geometry.str(true));
     s << indent(_topology.str(true));
     s << indent(_data.str(true));
+
+    // Memory usage by data structure
+    const double MB = 1024.0*1024.0;
+    const std::size_t D = _topology.dim();
+    s << "  Memory usage (MB):" << std::endl << std::endl;
+    s << "    geometry: " << _geometry.memory_usage()/MB << std::endl;
+    for (std::size_t d0 = 0; d0 <= D; d0++)
+    {
+      for (std::size_t d1 = 0; d1 <= D; d1++)
+      {
+        if (!_topology(d0, d1).empty())
+        {
+          s << "    connectivity " << d0 << " - " << d1 << ": "
+            << _topology(d0, d1).memory_usage()/MB << std::endl;
+        }
+      }
+    }
+    for (std::size_t d = 0; d <= D; d++)
+    {
+      if (!_topology.global_indices(d).empty())
+      {
+        s << "    global indices " << d << ": "
+          << _topology.memory_usage_global_indices(d)/MB << std::endl;
+      }
+    }
+    s << "    topology (total): " << _topology.memory_usage()/MB << std::endl;
+    s << "    mesh data: " << _data.memory_usage()/MB << std::endl;
+    s << "    total: " << memory_usage()/MB << std::endl;
   }
   else
   {
@@ -26,7 +26,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-05-08
-// Last changed: 2013-06-27
+// Last changed: 2013-12-11
 
 #ifndef __MESH_H
 #define __MESH_H
@@ -336,7 +336,10 @@ namespace dolfin
     /// collisions between the mesh and other objects. It is the
     /// responsibility of the caller to use (and possibly rebuild) the
     /// tree. It is stored as a (mutable) member of the mesh to enable
-    /// sharing of the bounding box tree data structure.
+    /// sharing of the bounding box tree data structure. The tree is
+    /// refitted when the mesh is transformed, moved or smoothed by
+    /// the member functions translate, rotate, move, smooth,
+    /// smooth_boundary and snap_boundary.
     boost::shared_ptr<BoundingBoxTree> bounding_box_tree() const;
 
     /// Get mesh data.
@@ -601,6 +604,15 @@ namespace dolfin
     ///
     std::size_t hash() const;
 
+    /// Return memory used by the mesh (geometry, topology, mesh data
+    /// and cell orientations) on this process, in bytes. A breakdown
+    /// by data structure is given by str(true).
+    ///
+    /// *Returns*
+    ///     std::size_t
+    ///         The memory usage in bytes.
+    std::size_t memory_usage() const;
+
     /// Informal string representation.
     ///
     /// *Arguments*
@@ -646,8 +658,12 @@ namespace dolfin
     friend class MeshEditor;
     friend class TopologyComputation;
     friend class MeshOrdering;
+    friend class MeshRenumbering;
     friend class BinaryFile;
 
+    // Refit bounding box tree (if any) after coordinates have changed
+    void refit_bounding_box_tree();
+
     // Mesh topology
     MeshTopology _topology;
 
@@ -19,11 +19,14 @@
 // Modified by Johannes Ring 2011
 //
 // First added:  2010-11-15
-// Last changed: 2011-11-14
+// Last changed: 2013-12-11
 
+#include <algorithm>
 #include <map>
+#include <sstream>
 #include <utility>
 #include <dolfin/common/Array.h>
+#include <dolfin/common/Timer.h>
 #include <dolfin/common/utils.h>
 #include <dolfin/graph/Graph.h>
 #include <dolfin/graph/GraphBuilder.h>
@@ -61,6 +64,7 @@ MeshColoring::color(Mesh& mesh,
   typedef std::pair<std::vector<std::size_t>, std::vector<std::vector<std::size_t> > > ColorData;
 
   info("Coloring mesh.");
+  Timer timer("Compute mesh coloring");
 
   // Create empty coloring data
   ColorData _color_data;
@@ -93,6 +97,23 @@ MeshColoring::color(Mesh& mesh,
     entities_of_color[color].push_back(i);
   }
 
+  // Report sizes of color classes
+  if (num_colors > 0)
+  {
+    std::vector<std::size_t> sizes(num_colors);
+    std::stringstream histogram;
+    for (std::size_t c = 0; c < num_colors; ++c)
+    {
+      sizes[c] = entities_of_color[c].size();
+      histogram << " " << sizes[c];
+    }
+    info("Computed %d colors in %g seconds (class sizes %d to %d).",
+         (int) num_colors, timer.stop(),
+         (int) *std::min_element(sizes.begin(), sizes.end()),
+         (int) *std::max_element(sizes.begin(), sizes.end()));
+    log(TRACE, "Size of color classes:%s", histogram.str().c_str());
+  }
+
   return colors;
 }
 //-----------------------------------------------------------------------------
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-09
-// Last changed: 2010-11-25
+// Last changed: 2013-12-11
 
 #include <boost/functional/hash.hpp>
 #include <dolfin/log/log.h>
@@ -102,6 +102,43 @@ void MeshConnectivity::init(std::vector<std::size_t>& num_connections)
   std::fill(_connections.begin(), _connections.end(), 0);
 }
 //-----------------------------------------------------------------------------
+void MeshConnectivity::set(std::vector<unsigned int>& connections,
+                           std::size_t num_connections)
+{
+  dolfin_assert(num_connections > 0);
+  dolfin_assert(connections.size() % num_connections == 0);
+
+  // Clear old data if any
+  clear();
+
+  // Initialize offsets
+  const std::size_t num_entities = connections.size()/num_connections;
+  index_to_position.resize(num_entities + 1);
+  for (std::size_t e = 0; e < index_to_position.size(); e++)
+    index_to_position[e] = e*num_connections;
+
+  // Take connections
+  _connections.swap(connections);
+  connections.clear();
+}
+//-----------------------------------------------------------------------------
+void MeshConnectivity::set(std::vector<unsigned int>& connections,
+                           std::vector<unsigned int>& offsets)
+{
+  dolfin_assert(!offsets.empty());
+  dolfin_assert(offsets.front() == 0);
+  dolfin_assert(offsets.back() == connections.size());
+
+  // Clear old data if any
+  clear();
+
+  // Take offsets and connections
+  index_to_position.swap(offsets);
+  offsets.clear();
+  _connections.swap(connections);
+  connections.clear();
+}
+//-----------------------------------------------------------------------------
 void MeshConnectivity::set(std::size_t entity, std::size_t connection,
                            std::size_t pos)
 {
@@ -152,6 +189,13 @@ std::size_t MeshConnectivity::hash() const
   return global_hash;
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshConnectivity::memory_usage() const
+{
+  return sizeof(*this)
+    + (_connections.capacity() + _num_global_connections.capacity()
+       + index_to_position.capacity())*sizeof(unsigned int);
+}
+//-----------------------------------------------------------------------------
 std::string MeshConnectivity::str(bool verbose) const
 {
   std::stringstream s;
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-09
-// Last changed: 2010-11-28
+// Last changed: 2013-12-11
 
 #ifndef __MESH_CONNECTIVITY_H
 #define __MESH_CONNECTIVITY_H
@@ -136,6 +136,19 @@ namespace dolfin
         _connections.insert(_connections.end(), e->begin(), e->end());
     }
 
+    /// Set all connections for all entities from a flat array with
+    /// the same number of connections for each entity. The array is
+    /// swapped into the connectivity (and left empty) to avoid a copy.
+    void set(std::vector<unsigned int>& connections,
+             std::size_t num_connections);
+
+    /// Set all connections for all entities from a flat array and the
+    /// offsets of the first connection of each entity (num_entities
+    /// + 1 values). Both arrays are swapped into the connectivity (and
+    /// left empty) to avoid a copy.
+    void set(std::vector<unsigned int>& connections,
+             std::vector<unsigned int>& offsets);
+
     /// Set global number of connections for all local entities
     void set_global_size(const std::vector<unsigned int>& num_global_connections)
     {
@@ -146,6 +159,9 @@ namespace dolfin
     /// Hash of connections
     std::size_t hash() const;
 
+    /// Return memory used by connectivity (in bytes)
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -18,7 +18,7 @@
 // Modified by Niclas Jansson 2008
 //
 // First added:  2008-05-19
-// Last changed: 2011-11-14
+// Last changed: 2013-12-11
 
 #include <sstream>
 #include <dolfin/common/utils.h>
@@ -179,6 +179,18 @@ void MeshData::erase_array(const std::string name, std::size_t dim)
     warning("Mesh data named \"%s\" does not exist.", name.c_str());
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshData::memory_usage() const
+{
+  std::size_t memory = sizeof(*this);
+  for (std::size_t d = 0; d < _arrays.size(); ++d)
+  {
+    std::map<std::string, std::vector<std::size_t> >::const_iterator it;
+    for (it = _arrays[d].begin(); it != _arrays[d].end(); ++it)
+      memory += it->second.capacity()*sizeof(std::size_t);
+  }
+  return memory;
+}
+//-----------------------------------------------------------------------------
 std::string MeshData::str(bool verbose) const
 {
   std::stringstream s;
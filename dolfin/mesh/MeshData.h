@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells, 2011.
 //
 // First added:  2008-05-19
-// Last changed: 2011-09-15
+// Last changed: 2013-12-11
 
 #ifndef __MESH_DATA_H
 #define __MESH_DATA_H
@@ -54,6 +54,12 @@ namespace dolfin
   ///
   ///   * "parent_vertex_indices" - _std::vector_ <std::size_t> of dimension 0
   ///
+  /// Mesh refinement (used by adapt to map mesh functions to the
+  /// refined mesh)
+  ///
+  ///   * "parent_cell"  - _std::vector_ <std::size_t> of dimension D
+  ///   * "parent_facet" - _std::vector_ <std::size_t> of dimension D - 1
+  ///
   /// Note to developers: use underscore in names in place of spaces.
 
   class MeshData : public Variable
@@ -173,6 +179,13 @@ namespace dolfin
 
     //--- Misc ---
 
+    /// Return memory used by mesh data (in bytes)
+    ///
+    /// *Returns*
+    ///     std::size_t
+    ///         The memory used by all arrays.
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     ///
     /// *Arguments*
@@ -186,6 +199,7 @@ namespace dolfin
 
     /// Friends
     friend class XMLMesh;
+    friend class MeshRenumbering;
 
   private:
 
@@ -18,8 +18,9 @@
 // Modified by Benjamin Kehlet, 2012
 //
 // First added:  2006-05-16
-// Last changed: 2012-10-30
+// Last changed: 2013-12-11
 
+#include <algorithm>
 #include <dolfin/log/log.h>
 #include <dolfin/geometry/Point.h>
 #include "Mesh.h"
@@ -257,6 +258,119 @@ void MeshEditor::add_cell(std::size_t local_index, std::size_t global_index,
   _mesh->_topology.set_global_index(_tdim, local_index, global_index);
 }
 //-----------------------------------------------------------------------------
+void MeshEditor::set_vertices(std::vector<double>& coordinates)
+{
+  std::vector<std::size_t> global_indices;
+  set_vertices(coordinates, global_indices);
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_vertices(std::vector<double>& coordinates,
+                              std::vector<std::size_t>& global_indices)
+{
+  // Check if we are currently editing a mesh
+  if (!_mesh)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set vertices in mesh editor",
+                 "No mesh opened, unable to edit");
+  }
+
+  // Check size of arrays
+  if (_gdim == 0 || coordinates.size() % _gdim != 0)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set vertices in mesh editor",
+                 "Size of coordinate array (%d) is not a multiple of the geometric dimension (%d)",
+                 coordinates.size(), _gdim);
+  }
+  const std::size_t num_vertices = coordinates.size()/_gdim;
+  if (!global_indices.empty() && global_indices.size() != num_vertices)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set vertices in mesh editor",
+                 "Number of global vertex indices (%d) does not match number of vertices (%d)",
+                 global_indices.size(), num_vertices);
+  }
+
+  // Initialize mesh data
+  _num_vertices = num_vertices;
+  next_vertex = num_vertices;
+  _mesh->_topology.init(0, num_vertices);
+
+  // Set coordinates (array positions are local indices)
+  MeshGeometry& geometry = _mesh->_geometry;
+  geometry.init(_gdim, 0);
+  geometry.coordinates.swap(coordinates);
+  geometry.position_to_local_index.resize(num_vertices);
+  geometry.local_index_to_position.resize(num_vertices);
+  for (std::size_t i = 0; i < num_vertices; ++i)
+  {
+    geometry.position_to_local_index[i] = i;
+    geometry.local_index_to_position[i] = i;
+  }
+
+  // Set global indices
+  set_global_indices(0, num_vertices, global_indices);
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_cells(std::vector<unsigned int>& cell_vertices)
+{
+  std::vector<std::size_t> global_indices;
+  set_cells(cell_vertices, global_indices);
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_cells(std::vector<unsigned int>& cell_vertices,
+                           std::vector<std::size_t>& global_indices)
+{
+  // Check if we are currently editing a mesh
+  if (!_mesh)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set cells in mesh editor",
+                 "No mesh opened, unable to edit");
+  }
+
+  // Check size of arrays
+  const std::size_t num_cell_vertices = _mesh->type().num_vertices(_tdim);
+  if (cell_vertices.size() % num_cell_vertices != 0)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set cells in mesh editor",
+                 "Size of cell array (%d) is not a multiple of the number of vertices per cell (%d)",
+                 cell_vertices.size(), num_cell_vertices);
+  }
+  const std::size_t num_cells = cell_vertices.size()/num_cell_vertices;
+  if (!global_indices.empty() && global_indices.size() != num_cells)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set cells in mesh editor",
+                 "Number of global cell indices (%d) does not match number of cells (%d)",
+                 global_indices.size(), num_cells);
+  }
+
+  // Check vertices (if known)
+  if (_num_vertices > 0)
+  {
+    const std::vector<unsigned int>::const_iterator v
+      = std::max_element(cell_vertices.begin(), cell_vertices.end());
+    if (v != cell_vertices.end() && *v >= _num_vertices)
+    {
+      dolfin_error("MeshEditor.cpp",
+                   "set cells in mesh editor",
+                   "Vertex index (%d) out of range [0, %d)", *v, _num_vertices);
+    }
+  }
+
+  // Initialize mesh data and set cells
+  _num_cells = num_cells;
+  next_cell = num_cells;
+  _mesh->_topology.init(_tdim, num_cells);
+  _mesh->_topology(_tdim, 0).set(cell_vertices, num_cell_vertices);
+
+  // Set global indices
+  set_global_indices(_tdim, num_cells, global_indices);
+}
+//-----------------------------------------------------------------------------
 void MeshEditor::close(bool order)
 {
   // Order mesh if requested
@@ -364,6 +478,23 @@ void MeshEditor::clear()
   _vertices.clear();
 }
 //-----------------------------------------------------------------------------
+void MeshEditor::set_global_indices(std::size_t dim, std::size_t size,
+                                    std::vector<std::size_t>& global_indices)
+{
+  std::vector<std::size_t>& indices = _mesh->_topology._global_indices[dim];
+  if (global_indices.empty())
+  {
+    indices.resize(size);
+    for (std::size_t i = 0; i < size; ++i)
+      indices[i] = i;
+  }
+  else
+  {
+    indices.swap(global_indices);
+    global_indices.clear();
+  }
+}
+//-----------------------------------------------------------------------------
 void MeshEditor::check_vertices(const std::vector<std::size_t>& v) const
 {
   for (std::size_t i = 0; i < v.size(); ++i)
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-16
-// Last changed: 2012-09-27
+// Last changed: 2013-12-11
 
 #ifndef __MESH_EDITOR_H
 #define __MESH_EDITOR_H
@@ -257,6 +257,52 @@ namespace dolfin
     void add_cell(std::size_t local_index, std::size_t global_index,
                   const std::vector<std::size_t>& v);
 
+    /// Set all vertices at once. The coordinates are swapped into the
+    /// mesh geometry without copying (the argument is left empty).
+    /// Vertices are given global indices equal to their local
+    /// indices. This replaces init_vertices() and add_vertex().
+    ///
+    /// *Arguments*
+    ///     coordinates (std::vector<double>)
+    ///         The vertex coordinates (num_vertices x gdim, row-major).
+    void set_vertices(std::vector<double>& coordinates);
+
+    /// Set all vertices at once, with given global indices. The
+    /// coordinates and global indices are swapped into the mesh
+    /// without copying (the arguments are left empty).
+    ///
+    /// *Arguments*
+    ///     coordinates (std::vector<double>)
+    ///         The vertex coordinates (num_vertices x gdim, row-major).
+    ///     global_indices (std::vector<std::size_t>)
+    ///         The global (user) vertex indices.
+    void set_vertices(std::vector<double>& coordinates,
+                      std::vector<std::size_t>& global_indices);
+
+    /// Set all cells at once. The cell vertices are swapped into the
+    /// mesh topology without copying (the argument is left empty).
+    /// Cells are given global indices equal to their local indices.
+    /// This replaces init_cells() and add_cell().
+    ///
+    /// *Arguments*
+    ///     cell_vertices (std::vector<unsigned int>)
+    ///         The vertices (local indices) of the cells
+    ///         (num_cells x num_vertices_per_cell, row-major).
+    void set_cells(std::vector<unsigned int>& cell_vertices);
+
+    /// Set all cells at once, with given global indices. The cell
+    /// vertices and global indices are swapped into the mesh without
+    /// copying (the arguments are left empty).
+    ///
+    /// *Arguments*
+    ///     cell_vertices (std::vector<unsigned int>)
+    ///         The vertices (local indices) of the cells
+    ///         (num_cells x num_vertices_per_cell, row-major).
+    ///     global_indices (std::vector<std::size_t>)
+    ///         The global (user) cell indices.
+    void set_cells(std::vector<unsigned int>& cell_vertices,
+                   std::vector<std::size_t>& global_indices);
+
     /// Close mesh, finish editing, and order entities locally
     ///
     /// *Arguments*
@@ -290,6 +336,11 @@ namespace dolfin
     // Clear all data
     void clear();
 
+    // Set global indices of entities of given dimension (swapped from
+    // global_indices, or equal to local indices if empty)
+    void set_global_indices(std::size_t dim, std::size_t size,
+                            std::vector<std::size_t>& global_indices);
+
     // Check that vertices are in range
     void check_vertices(const std::vector<std::size_t>& v) const;
 
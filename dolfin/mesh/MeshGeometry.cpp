@@ -19,7 +19,7 @@
 // Modified by Kristoffer Selim, 2008.
 //
 // First added:  2006-05-19
-// Last changed: 2010-04-29
+// Last changed: 2013-12-11
 
 #include <boost/functional/hash.hpp>
 
@@ -131,6 +131,13 @@ std::size_t MeshGeometry::hash() const
   return global_hash;
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshGeometry::memory_usage() const
+{
+  return sizeof(*this) + coordinates.capacity()*sizeof(double)
+    + (position_to_local_index.capacity()
+       + local_index_to_position.capacity())*sizeof(unsigned int);
+}
+//-----------------------------------------------------------------------------
 std::string MeshGeometry::str(bool verbose) const
 {
   std::stringstream s;
@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2008.
 //
 // First added:  2006-05-08
-// Last changed: 2010-11-29
+// Last changed: 2013-12-11
 
 #ifndef __MESH_GEOMETRY_H
 #define __MESH_GEOMETRY_H
@@ -122,6 +122,9 @@ namespace dolfin
     ///
     std::size_t hash() const;
 
+    /// Return memory used by geometry (in bytes)
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -129,6 +132,7 @@ namespace dolfin
 
     // Friends
     friend class BinaryFile;
+    friend class MeshEditor;
     friend class MeshRenumbering;
 
     // Euclidean dimension
@@ -16,12 +16,14 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2007-01-30
-// Last changed: 2012-06-25
+// Last changed: 2013-12-11
 
+#include <algorithm>
 #include <vector>
 #include <boost/shared_ptr.hpp>
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/log/log.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "Cell.h"
 #include "Mesh.h"
 #include "MeshOrdering.h"
@@ -46,6 +48,32 @@ void MeshOrdering::order(Mesh& mesh)
   if (mesh.topology().dim() == 0)
     return;
 
+  // Cells may be ordered in parallel when no entities of intermediate
+  // dimensions exist, since each cell then only modifies its own
+  // connectivity
+  const std::size_t D = mesh.topology().dim();
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+  bool independent_cells = true;
+  for (std::size_t d = 1; d < D; d++)
+  {
+    if (mesh.topology().size(d) > 0)
+      independent_cells = false;
+  }
+  if (independent_cells && num_threads > 1)
+  {
+    const int num_cells = mesh.num_cells();
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads)
+    #endif
+    for (int c = 0; c < num_cells; c++)
+    {
+      Cell cell(mesh, c);
+      cell.order(local_to_global_vertex_indices);
+    }
+    return;
+  }
+
   // Iterate over all cells and order the mesh entities locally
   Progress p("Ordering mesh", mesh.num_cells());
   for (CellIterator cell(mesh); !cell.end(); ++cell)
@@ -66,6 +94,21 @@ bool MeshOrdering::ordered(const Mesh& mesh)
   const std::vector<std::size_t>& local_to_global_vertex_indices
     = mesh.topology().global_indices(0);
 
+  // Check if all cells are ordered (in parallel if requested)
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+  if (num_threads > 1)
+  {
+    const int num_cells = mesh.num_cells();
+    bool ordered = true;
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for num_threads(num_threads) reduction(&&:ordered)
+    #endif
+    for (int c = 0; c < num_cells; c++)
+      ordered = ordered && Cell(mesh, c).ordered(local_to_global_vertex_indices);
+    return ordered;
+  }
+
   // Check if all cells are ordered
   Progress p("Checking mesh ordering", mesh.num_cells());
   for (CellIterator cell(mesh); !cell.end(); ++cell)
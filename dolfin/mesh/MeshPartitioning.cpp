@@ -21,7 +21,7 @@
 // Modified by Garth N. Wells 2011-2012
 //
 // First added:  2008-12-01
-// Last changed: 2013-04-20
+// Last changed: 2013-12-11
 
 #include <algorithm>
 #include <iterator>
@@ -171,7 +171,7 @@ void MeshPartitioning::build(Mesh& mesh, const LocalMeshData& mesh_data,
 
   // Distribute vertices
   std::vector<std::size_t> vertex_indices;
-  boost::multi_array<double, 2> vertex_coordinates;
+  std::vector<double> vertex_coordinates;
   std::map<std::size_t, std::size_t> vertex_global_to_local;
   distribute_vertices(mesh_data, cell_vertices, vertex_indices,
                       vertex_global_to_local, vertex_coordinates);
@@ -260,7 +260,7 @@ void MeshPartitioning::distribute_vertices(const LocalMeshData& mesh_data,
                     const boost::multi_array<std::size_t, 2>& cell_vertices,
                     std::vector<std::size_t>& vertex_indices,
                     std::map<std::size_t, std::size_t>& vertex_global_to_local,
-                    boost::multi_array<double, 2>& vertex_coordinates)
+                    std::vector<double>& vertex_coordinates)
 {
   // This function distributes all vertices (coordinates and
   // local-to-global mapping) according to the cells that are stored on
@@ -337,7 +337,7 @@ void MeshPartitioning::distribute_vertices(const LocalMeshData& mesh_data,
     num_local_vertices += received_vertex_coordinates[p].size()/gdim;
 
   // Store coordinates and construct global to local mapping
-  vertex_coordinates.resize(boost::extents[num_local_vertices][gdim]);
+  vertex_coordinates.resize(num_local_vertices*gdim);
   vertex_indices.resize(num_local_vertices);
   std::size_t v = 0;
   for (std::size_t p = 0; p < num_processes; ++p)
@@ -346,7 +346,7 @@ void MeshPartitioning::distribute_vertices(const LocalMeshData& mesh_data,
          i += gdim)
     {
       for (std::size_t j = 0; j < gdim; ++j)
-        vertex_coordinates[v][j] = received_vertex_coordinates[p][i + j];
+        vertex_coordinates[v*gdim + j] = received_vertex_coordinates[p][i + j];
 
       const std::size_t global_vertex_index
         = vertex_location[p][index_counters[p]++];
@@ -359,10 +359,10 @@ void MeshPartitioning::distribute_vertices(const LocalMeshData& mesh_data,
 }
 //-----------------------------------------------------------------------------
 void MeshPartitioning::build_mesh(Mesh& mesh,
-              const std::vector<std::size_t>& global_cell_indices,
+              std::vector<std::size_t>& global_cell_indices,
               const boost::multi_array<std::size_t, 2>& cell_global_vertices,
-              const std::vector<std::size_t>& vertex_indices,
-              const boost::multi_array<double, 2>& vertex_coordinates,
+              std::vector<std::size_t>& vertex_indices,
+              std::vector<double>& vertex_coordinates,
               const std::map<std::size_t, std::size_t>& vertex_global_to_local,
               std::size_t tdim, std::size_t gdim, std::size_t num_global_cells,
               std::size_t num_global_vertices)
@@ -378,21 +378,13 @@ void MeshPartitioning::build_mesh(Mesh& mesh,
   MeshEditor editor;
   editor.open(mesh, tdim, gdim);
 
-  // Add vertices
-  editor.init_vertices(vertex_coordinates.size());
-  Point point(gdim);
-  dolfin_assert(vertex_indices.size() == vertex_coordinates.size());
-  for (std::size_t i = 0; i < vertex_coordinates.size(); ++i)
-  {
-    for (std::size_t j = 0; j < gdim; ++j)
-      point[j] = vertex_coordinates[i][j];
-    editor.add_vertex_global(i, vertex_indices[i], point);
-  }
+  // Add vertices (swapped into the mesh)
+  dolfin_assert(vertex_indices.size()*gdim == vertex_coordinates.size());
+  editor.set_vertices(vertex_coordinates, vertex_indices);
 
   // Add cells
-  editor.init_cells(cell_global_vertices.size());
   const std::size_t num_cell_vertices = tdim + 1;
-  std::vector<std::size_t> cell(num_cell_vertices);
+  std::vector<unsigned int> cells(cell_global_vertices.size()*num_cell_vertices);
   for (std::size_t i = 0; i < cell_global_vertices.size(); ++i)
   {
     for (std::size_t j = 0; j < num_cell_vertices; ++j)
@@ -401,10 +393,10 @@ void MeshPartitioning::build_mesh(Mesh& mesh,
       std::map<std::size_t, std::size_t>::const_iterator iter
           = vertex_global_to_local.find(cell_global_vertices[i][j]);
       dolfin_assert(iter != vertex_global_to_local.end());
-      cell[j] = iter->second;
+      cells[i*num_cell_vertices + j] = iter->second;
     }
-    editor.add_cell(i, global_cell_indices[i], cell);
   }
+  editor.set_cells(cells, global_cell_indices);
 
   // Close mesh: Note that this must be done after creating the global
   // vertex map or otherwise the ordering in mesh.close() will be wrong
@@ -423,9 +415,11 @@ void MeshPartitioning::build_mesh(Mesh& mesh,
 
   // Build sorted array of global boundary vertex indices (global
   // numbering)
+  const std::vector<std::size_t>& global_vertex_indices
+    = mesh.topology().global_indices(0);
   std::vector<std::size_t> global_vertex_send(boundary_size);
   for (std::size_t i = 0; i < boundary_size; ++i)
-    global_vertex_send[i] = vertex_indices[boundary_vertex_map[i]];
+    global_vertex_send[i] = global_vertex_indices[boundary_vertex_map[i]];
   std::sort(global_vertex_send.begin(), global_vertex_send.end());
 
   // Receive buffer
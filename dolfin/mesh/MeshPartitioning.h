@@ -94,19 +94,22 @@ namespace dolfin
                                  std::vector<std::size_t>& cell_local_to_global_indices,
                                  boost::multi_array<std::size_t, 2>& cell_local_vertices);
 
-    // Distribute vertices
+    // Distribute vertices (vertex_coordinates is num_vertices x gdim,
+    // row-major)
     static void distribute_vertices(const LocalMeshData& data,
                   const boost::multi_array<std::size_t, 2>& cell_local_vertices,
                   std::vector<std::size_t>& vertex_local_to_global_indices,
                   std::map<std::size_t, std::size_t>& vertex_global_to_local_indices,
-                  boost::multi_array<double, 2>& vertex_coordinates);
+                  std::vector<double>& vertex_coordinates);
 
-    // Build mesh
+    // Build mesh. The global cell indices, vertex indices and vertex
+    // coordinates are swapped into the mesh without copying (and left
+    // empty)
     static void build_mesh(Mesh& mesh,
-                   const std::vector<std::size_t>& global_cell_indices,
+                   std::vector<std::size_t>& global_cell_indices,
                    const boost::multi_array<std::size_t, 2>& cell_vertices,
-                   const std::vector<std::size_t>& vertex_indices,
-                   const boost::multi_array<double, 2>& vertex_coordinates,
+                   std::vector<std::size_t>& vertex_indices,
+                   std::vector<double>& vertex_coordinates,
                    const std::map<std::size_t, std::size_t>& vertex_global_to_local_indices,
                    std::size_t tdim, std::size_t gdim, std::size_t num_global_cells,
                    std::size_t num_global_vertices);
@@ -18,16 +18,25 @@
 // Modified by Garth N. Wells, 2011.
 //
 // First added:  2010-11-27
-// Last changed: 2011-01-16
+// Last changed: 2013-12-11
 
 #include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
 #include <vector>
+#include <boost/cstdint.hpp>
 
 #include <dolfin/log/log.h>
+#include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
 #include <dolfin/common/utils.h>
+#include <dolfin/graph/BoostGraphOrdering.h>
+#include <dolfin/graph/GraphBuilder.h>
 #include "Cell.h"
 #include "Mesh.h"
+#include "MeshData.h"
+#include "MeshDomains.h"
 #include "MeshEditor.h"
 #include "MeshTopology.h"
 #include "MeshGeometry.h"
@@ -35,6 +44,100 @@
 
 using namespace dolfin;
 
+namespace
+{
+  // Compute key of point (integer coordinates X with given number of
+  // bits) along Morton (Z-order) curve by interleaving bits
+  boost::uint64_t morton_key(const std::vector<boost::uint32_t>& X,
+                             std::size_t bits)
+  {
+    boost::uint64_t key = 0;
+    for (int j = bits - 1; j >= 0; --j)
+      for (std::size_t i = 0; i < X.size(); ++i)
+        key = (key << 1) | ((X[i] >> j) & 1);
+    return key;
+  }
+
+  // Compute key of point (integer coordinates X with given number of
+  // bits) along Hilbert curve. The coordinates are transformed to
+  // the transposed Hilbert index (J. Skilling, Programming the Hilbert
+  // curve, AIP Conf. Proc. 707, 2004), which is then interleaved.
+  boost::uint64_t hilbert_key(std::vector<boost::uint32_t> X,
+                              std::size_t bits)
+  {
+    const std::size_t n = X.size();
+    const boost::uint32_t M = boost::uint32_t(1) << (bits - 1);
+
+    // Inverse undo excess work
+    for (boost::uint32_t Q = M; Q > 1; Q >>= 1)
+    {
+      const boost::uint32_t P = Q - 1;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (X[i] & Q)
+          X[0] ^= P;
+        else
+        {
+          const boost::uint32_t t = (X[0] ^ X[i]) & P;
+          X[0] ^= t;
+          X[i] ^= t;
+        }
+      }
+    }
+
+    // Gray encode
+    for (std::size_t i = 1; i < n; ++i)
+      X[i] ^= X[i - 1];
+    boost::uint32_t t = 0;
+    for (boost::uint32_t Q = M; Q > 1; Q >>= 1)
+      if (X[n - 1] & Q)
+        t ^= Q - 1;
+    for (std::size_t i = 0; i < n; ++i)
+      X[i] ^= t;
+
+    return morton_key(X, bits);
+  }
+
+  // Compare indices by their keys (ties broken by index)
+  class CompareCurveKeys
+  {
+  public:
+
+    CompareCurveKeys(const std::vector<boost::uint64_t>& keys) : _keys(keys) {}
+
+    bool operator() (std::size_t i, std::size_t j) const
+    { return _keys[i] < _keys[j] || (_keys[i] == _keys[j] && i < j); }
+
+  private:
+
+    const std::vector<boost::uint64_t>& _keys;
+
+  };
+
+  // Compare indices by their vertex lists in flat array of keys
+  class CompareEntityKeys
+  {
+  public:
+
+    CompareEntityKeys(const std::vector<unsigned int>& keys, std::size_t width)
+      : _keys(keys), _width(width) {}
+
+    bool operator() (std::size_t i, std::size_t j) const
+    {
+      return std::lexicographical_compare(_keys.begin() + i*_width,
+                                          _keys.begin() + (i + 1)*_width,
+                                          _keys.begin() + j*_width,
+                                          _keys.begin() + (j + 1)*_width);
+    }
+
+  private:
+
+    const std::vector<unsigned int>& _keys;
+    const std::size_t _width;
+
+  };
+}
+
 //-----------------------------------------------------------------------------
 dolfin::Mesh MeshRenumbering::renumber_by_color(const Mesh& mesh,
                                  const std::vector<std::size_t> coloring_type)
@@ -263,3 +366,392 @@ void MeshRenumbering::compute_renumbering(const Mesh& mesh,
   }
 }
 //-----------------------------------------------------------------------------
+std::vector<std::vector<std::size_t> >
+MeshRenumbering::renumber(Mesh& mesh, std::string method)
+{
+  Timer timer("Renumber mesh");
+
+  MeshTopology& topology = mesh.topology();
+  MeshDomains& domains = mesh.domains();
+  MeshData& data = mesh.data();
+  const std::size_t D = topology.dim();
+  const std::size_t num_vertices = mesh.num_vertices();
+  const std::size_t num_cells = mesh.num_cells();
+  const bool serial = MPI::num_processes() == 1;
+  const bool ordered = mesh.ordered();
+
+  std::vector<std::vector<std::size_t> > new_indices(D + 1);
+  if (num_cells == 0)
+    return new_indices;
+
+  // Compute order of cells
+  std::vector<std::size_t> cell_order;
+  if (method == "hilbert" || method == "morton")
+    cell_order = compute_cell_order_sfc(mesh, method);
+  else if (method == "rcm")
+    cell_order = compute_cell_order_rcm(mesh);
+  else
+  {
+    dolfin_error("MeshRenumbering.cpp",
+                 "renumber mesh",
+                 "Unknown renumbering method \"%s\"", method.c_str());
+  }
+  dolfin_assert(cell_order.size() == num_cells);
+
+  // Number cells
+  std::vector<std::size_t>& new_cell_indices = new_indices[D];
+  new_cell_indices.resize(num_cells);
+  for (std::size_t c = 0; c < num_cells; ++c)
+    new_cell_indices[cell_order[c]] = c;
+
+  // Number vertices in order of first occurence in renumbered cells
+  // (vertices not belonging to any cell last)
+  const MeshConnectivity& cv = topology(D, 0);
+  const std::size_t num_cell_vertices = cv.size(0);
+  const std::size_t not_numbered = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t>& new_vertex_indices = new_indices[0];
+  new_vertex_indices.assign(num_vertices, not_numbered);
+  std::size_t vertex_index = 0;
+  for (std::size_t c = 0; c < num_cells; ++c)
+  {
+    const unsigned int* vertices = cv(cell_order[c]);
+    for (std::size_t i = 0; i < num_cell_vertices; ++i)
+      if (new_vertex_indices[vertices[i]] == not_numbered)
+        new_vertex_indices[vertices[i]] = vertex_index++;
+  }
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    if (new_vertex_indices[v] == not_numbered)
+      new_vertex_indices[v] = vertex_index++;
+
+  // Find entities of intermediate dimensions that must be recomputed
+  // (computed or marked), and compute their keys in the new vertex
+  // numbering
+  std::vector<bool> recompute(D + 1, false);
+  std::vector<std::vector<unsigned int> > old_keys(D + 1);
+  for (std::size_t d = 1; d < D; ++d)
+  {
+    recompute[d] = topology.size(d) > 0
+      || (!domains.is_empty() && d <= domains.max_dim()
+          && !domains.markers(d).empty())
+      || (d < data._arrays.size() && !data._arrays[d].empty());
+    if (recompute[d])
+    {
+      mesh.init(d);
+      compute_entity_keys(mesh, d, new_vertex_indices, old_keys[d]);
+    }
+  }
+
+  // Renumber cell-vertex connectivity
+  std::vector<unsigned int> connections(num_cells*num_cell_vertices);
+  for (std::size_t c = 0; c < num_cells; ++c)
+  {
+    const unsigned int* vertices = cv(cell_order[c]);
+    for (std::size_t i = 0; i < num_cell_vertices; ++i)
+      connections[c*num_cell_vertices + i] = new_vertex_indices[vertices[i]];
+  }
+  topology(D, 0).set(connections, num_cell_vertices);
+
+  // Renumber coordinates
+  const MeshGeometry& geometry = mesh.geometry();
+  const std::size_t gdim = geometry.dim();
+  std::vector<double> coordinates(num_vertices*gdim);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+  {
+    std::copy(geometry.x(v), geometry.x(v) + gdim,
+              coordinates.begin() + new_vertex_indices[v]*gdim);
+  }
+  std::vector<double> x(gdim);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+  {
+    std::copy(coordinates.begin() + v*gdim,
+              coordinates.begin() + (v + 1)*gdim, x.begin());
+    mesh.geometry().set(v, x);
+  }
+
+  // Clear all connectivity except cell-vertex connectivity, entities
+  // of intermediate dimensions and colorings
+  mesh.clean();
+  std::vector<std::size_t> global_size(D + 1);
+  std::vector<std::vector<std::size_t> > global_indices(D + 1);
+  std::vector<std::map<unsigned int, std::set<unsigned int> > >
+    shared_entities(D + 1);
+  for (std::size_t d = 0; d <= D; ++d)
+  {
+    global_size[d] = topology.size_global(d);
+    global_indices[d] = topology.global_indices(d);
+    shared_entities[d].swap(topology.shared_entities(d));
+    if (d > 0 && d < D)
+    {
+      topology.init(d, 0);
+      topology.init_global_indices(d, 0);
+    }
+  }
+  topology.coloring.clear();
+  mesh._tree.reset();
+
+  // Renumber cell orientations
+  std::vector<int>& cell_orientations = mesh.cell_orientations();
+  if (!cell_orientations.empty())
+  {
+    const std::vector<int> orientations(cell_orientations);
+    for (std::size_t c = 0; c < num_cells; ++c)
+      cell_orientations[new_cell_indices[c]] = orientations[c];
+  }
+
+  // Renumber global vertex indices (on a single process, global
+  // indices are local indices)
+  if (!global_indices[0].empty())
+  {
+    topology.init_global_indices(0, num_vertices);
+    for (std::size_t v = 0; v < num_vertices; ++v)
+    {
+      topology.set_global_index(0, new_vertex_indices[v],
+                                serial ? new_vertex_indices[v]
+                                       : global_indices[0][v]);
+    }
+    global_indices[0].clear();
+  }
+
+  // Reorder cell vertices according to UFC convention if mesh was
+  // ordered. Ordering clears the cell orientations, so they are
+  // restored, and flipped for cells whose vertices were reordered by
+  // an odd permutation.
+  mesh._ordered = false;
+  if (ordered)
+  {
+    const std::vector<int> orientations(cell_orientations);
+    mesh.order();
+    if (!orientations.empty())
+    {
+      mesh.cell_orientations() = orientations;
+      const MeshConnectivity& ordered_cv = topology(D, 0);
+      for (std::size_t c = 0; c < num_cells; ++c)
+      {
+        if (orientations[c] < 0)
+          continue;
+
+        // Count inversions of the vertex order
+        const unsigned int* vertices = ordered_cv(c);
+        const unsigned int* old_vertices = &connections[c*num_cell_vertices];
+        std::size_t num_inversions = 0;
+        for (std::size_t i = 0; i < num_cell_vertices; ++i)
+        {
+          const std::size_t pos_i = std::find(vertices,
+                                              vertices + num_cell_vertices,
+                                              old_vertices[i]) - vertices;
+          for (std::size_t j = i + 1; j < num_cell_vertices; ++j)
+          {
+            const std::size_t pos_j = std::find(vertices,
+                                                vertices + num_cell_vertices,
+                                                old_vertices[j]) - vertices;
+            if (pos_i > pos_j)
+              ++num_inversions;
+          }
+        }
+        if (num_inversions % 2 == 1)
+          mesh.cell_orientations()[c] = 1 - orientations[c];
+      }
+    }
+  }
+
+  // Recompute entities and compute their numbering
+  for (std::size_t d = 1; d < D; ++d)
+  {
+    if (!recompute[d])
+      continue;
+
+    const std::size_t num_entities = mesh.init(d);
+    topology.init_global(d, global_size[d]);
+    std::vector<unsigned int> new_keys;
+    compute_entity_keys(mesh, d, std::vector<std::size_t>(), new_keys);
+    new_indices[d] = match_entity_keys(old_keys[d], new_keys, num_entities);
+  }
+
+  // Renumber global indices and shared entities
+  for (std::size_t d = 0; d <= D; ++d)
+  {
+    const std::vector<std::size_t>& new_index = new_indices[d];
+    if (!global_indices[d].empty())
+    {
+      dolfin_assert(global_indices[d].size() == new_index.size());
+      topology.init_global_indices(d, new_index.size());
+      for (std::size_t i = 0; i < new_index.size(); ++i)
+      {
+        topology.set_global_index(d, new_index[i],
+                                  serial ? new_index[i]
+                                         : global_indices[d][i]);
+      }
+    }
+
+    std::map<unsigned int, std::set<unsigned int> >::const_iterator e;
+    for (e = shared_entities[d].begin(); e != shared_entities[d].end(); ++e)
+    {
+      dolfin_assert(e->first < new_index.size());
+      topology.shared_entities(d)[new_index[e->first]] = e->second;
+    }
+  }
+
+  // Renumber mesh domains
+  if (!domains.is_empty())
+  {
+    for (std::size_t d = 0; d <= std::min(D, domains.max_dim()); ++d)
+    {
+      std::map<std::size_t, std::size_t>& markers = domains.markers(d);
+      std::map<std::size_t, std::size_t> new_markers;
+      std::map<std::size_t, std::size_t>::const_iterator marker;
+      for (marker = markers.begin(); marker != markers.end(); ++marker)
+      {
+        dolfin_assert(marker->first < new_indices[d].size());
+        new_markers[new_indices[d][marker->first]] = marker->second;
+      }
+      markers.swap(new_markers);
+    }
+  }
+
+  // Renumber mesh data (arrays of values for all entities)
+  for (std::size_t d = 0; d <= D && d < data._arrays.size(); ++d)
+  {
+    std::map<std::string, std::vector<std::size_t> >::iterator array;
+    for (array = data._arrays[d].begin(); array != data._arrays[d].end();
+         ++array)
+    {
+      std::vector<std::size_t>& values = array->second;
+      if (values.size() != new_indices[d].size())
+        continue;
+      const std::vector<std::size_t> old_values(values);
+      for (std::size_t i = 0; i < values.size(); ++i)
+        values[new_indices[d][i]] = old_values[i];
+    }
+  }
+
+  return new_indices;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::size_t>
+MeshRenumbering::compute_cell_order_sfc(const Mesh& mesh, std::string method)
+{
+  const MeshGeometry& geometry = mesh.geometry();
+  const MeshConnectivity& cv = mesh.topology()(mesh.topology().dim(), 0);
+  const std::size_t gdim = geometry.dim();
+  const std::size_t num_cells = mesh.num_cells();
+  const std::size_t num_cell_vertices = cv.size(0);
+
+  // Compute bounding box of mesh
+  std::vector<double> x_min(gdim, std::numeric_limits<double>::max());
+  std::vector<double> x_max(gdim, -std::numeric_limits<double>::max());
+  for (std::size_t v = 0; v < mesh.num_vertices(); ++v)
+  {
+    for (std::size_t i = 0; i < gdim; ++i)
+    {
+      x_min[i] = std::min(x_min[i], geometry.x(v, i));
+      x_max[i] = std::max(x_max[i], geometry.x(v, i));
+    }
+  }
+
+  // Number of bits for each coordinate (at most 64 in total)
+  const std::size_t bits = std::min(64/gdim, (std::size_t) 32);
+  const double max_coordinate
+    = (double) ((boost::uint64_t(1) << bits) - 1);
+
+  // Compute key of each cell midpoint, scaled to bounding box
+  std::vector<boost::uint64_t> keys(num_cells);
+  std::vector<boost::uint32_t> X(gdim);
+  for (std::size_t c = 0; c < num_cells; ++c)
+  {
+    const unsigned int* vertices = cv(c);
+    for (std::size_t i = 0; i < gdim; ++i)
+    {
+      double x = 0.0;
+      for (std::size_t j = 0; j < num_cell_vertices; ++j)
+        x += geometry.x(vertices[j], i);
+      x /= num_cell_vertices;
+
+      const double h = x_max[i] - x_min[i];
+      X[i] = h > 0.0 ? (boost::uint32_t) ((x - x_min[i])/h*max_coordinate) : 0;
+    }
+    keys[c] = method == "hilbert" ? hilbert_key(X, bits) : morton_key(X, bits);
+  }
+
+  // Sort cells by key
+  std::vector<std::size_t> cell_order(num_cells);
+  for (std::size_t c = 0; c < num_cells; ++c)
+    cell_order[c] = c;
+  std::sort(cell_order.begin(), cell_order.end(), CompareCurveKeys(keys));
+
+  return cell_order;
+}
+//-----------------------------------------------------------------------------
+std::vector<std::size_t>
+MeshRenumbering::compute_cell_order_rcm(const Mesh& mesh)
+{
+  // Build dual graph (cells connected by facets)
+  const std::size_t D = mesh.topology().dim();
+  const Graph graph = GraphBuilder::local_graph(mesh, D, D - 1);
+
+  // Compute reverse Cuthill-McKee numbering (old -> new) and invert
+  const std::vector<std::size_t> new_cell_indices
+    = BoostGraphOrdering::compute_cuthill_mckee(graph, true);
+  std::vector<std::size_t> cell_order(new_cell_indices.size());
+  for (std::size_t c = 0; c < new_cell_indices.size(); ++c)
+    cell_order[new_cell_indices[c]] = c;
+
+  return cell_order;
+}
+//-----------------------------------------------------------------------------
+void MeshRenumbering::compute_entity_keys(const Mesh& mesh, std::size_t dim,
+                           const std::vector<std::size_t>& new_vertex_indices,
+                           std::vector<unsigned int>& keys)
+{
+  const MeshConnectivity& ev = mesh.topology()(dim, 0);
+  const std::size_t num_entities = mesh.num_entities(dim);
+  const std::size_t width = ev.size(0);
+
+  keys.resize(num_entities*width);
+  for (std::size_t e = 0; e < num_entities; ++e)
+  {
+    const unsigned int* vertices = ev(e);
+    std::vector<unsigned int>::iterator key = keys.begin() + e*width;
+    for (std::size_t i = 0; i < width; ++i)
+    {
+      key[i] = new_vertex_indices.empty() ? vertices[i]
+                                          : new_vertex_indices[vertices[i]];
+    }
+    std::sort(key, key + width);
+  }
+}
+//-----------------------------------------------------------------------------
+std::vector<std::size_t>
+MeshRenumbering::match_entity_keys(const std::vector<unsigned int>& old_keys,
+                                   const std::vector<unsigned int>& new_keys,
+                                   std::size_t num_entities)
+{
+  if (old_keys.size() != new_keys.size())
+  {
+    dolfin_error("MeshRenumbering.cpp",
+                 "renumber mesh entities",
+                 "Number of entities changed during renumbering");
+  }
+  const std::size_t width = num_entities > 0 ? old_keys.size()/num_entities : 0;
+
+  // Sort old and new entities by key
+  std::vector<std::size_t> old_order(num_entities), new_order(num_entities);
+  for (std::size_t e = 0; e < num_entities; ++e)
+    old_order[e] = new_order[e] = e;
+  std::sort(old_order.begin(), old_order.end(),
+            CompareEntityKeys(old_keys, width));
+  std::sort(new_order.begin(), new_order.end(),
+            CompareEntityKeys(new_keys, width));
+
+  // Match entities with same key
+  std::vector<std::size_t> new_index(num_entities);
+  for (std::size_t i = 0; i < num_entities; ++i)
+  {
+    dolfin_assert(std::equal(old_keys.begin() + old_order[i]*width,
+                             old_keys.begin() + (old_order[i] + 1)*width,
+                             new_keys.begin() + new_order[i]*width));
+    new_index[old_order[i]] = new_order[i];
+  }
+
+  return new_index;
+}
+//-----------------------------------------------------------------------------
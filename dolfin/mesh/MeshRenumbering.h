@@ -18,12 +18,15 @@
 // Modified by Garth N. Wells, 2011.
 //
 // First added:  2010-11-27
-// Last changed: 2011-01-16
+// Last changed: 2013-12-11
 
 #ifndef __MESH_RENUMBERING_H
 #define __MESH_RENUMBERING_H
 
+#include <string>
 #include <vector>
+#include <dolfin/log/log.h>
+#include "MeshFunction.h"
 
 namespace dolfin
 {
@@ -53,8 +56,84 @@ namespace dolfin
     static Mesh renumber_by_color(const Mesh& mesh,
                                   std::vector<std::size_t> coloring);
 
+    /// Renumber the cells and vertices of a mesh in place to improve
+    /// data locality. Cells are ordered along a space-filling curve
+    /// through the cell midpoints ("hilbert" or "morton"), or by
+    /// reverse Cuthill-McKee on the dual graph of the mesh ("rcm").
+    /// Vertices are numbered in the order of their first occurence
+    /// in the renumbered cells.
+    ///
+    /// The geometry, global indices, shared entities, cell
+    /// orientations, mesh domains and mesh data are renumbered
+    /// accordingly. Entities of intermediate dimensions that have
+    /// been computed are recomputed, and all connectivity except
+    /// cell-vertex connectivity and all colorings are cleared. Mesh functions
+    /// stored outside of the mesh may be renumbered with the
+    /// returned numbering.
+    ///
+    /// *Arguments*
+    ///     mesh (_Mesh_)
+    ///         Mesh to be renumbered.
+    ///     method (std::string)
+    ///         "hilbert" (default), "morton" or "rcm".
+    /// *Returns*
+    ///     std::vector<std::vector<std::size_t> >
+    ///         The new index of each old mesh entity for each
+    ///         topological dimension (empty if no entities exist).
+    static std::vector<std::vector<std::size_t> >
+      renumber(Mesh& mesh, std::string method="hilbert");
+
+    /// Renumber the values of a mesh function on a mesh that has been
+    /// renumbered by renumber(mesh, method).
+    ///
+    /// *Arguments*
+    ///     f (_MeshFunction_)
+    ///         Mesh function to be renumbered.
+    ///     new_indices (std::vector<std::vector<std::size_t> >)
+    ///         Numbering returned by renumber(mesh, method).
+    template <typename T>
+    static void renumber(MeshFunction<T>& f,
+                const std::vector<std::vector<std::size_t> >& new_indices)
+    {
+      const std::size_t dim = f.dim();
+      if (dim >= new_indices.size() || new_indices[dim].size() != f.size())
+      {
+        dolfin_error("MeshRenumbering.h",
+                     "renumber mesh function",
+                     "Numbering does not match mesh function of dimension %d",
+                     dim);
+      }
+
+      const std::vector<T> values(f.values(), f.values() + f.size());
+      for (std::size_t i = 0; i < values.size(); ++i)
+        f[new_indices[dim][i]] = values[i];
+    }
+
   private:
 
+    // Compute order of cells (old cell index of each new cell) along
+    // a space-filling curve through the cell midpoints
+    static std::vector<std::size_t>
+      compute_cell_order_sfc(const Mesh& mesh, std::string method);
+
+    // Compute order of cells (old cell index of each new cell) by
+    // reverse Cuthill-McKee on the dual graph
+    static std::vector<std::size_t> compute_cell_order_rcm(const Mesh& mesh);
+
+    // Compute sorted vertex lists (keys) of all entities of given
+    // dimension, with vertices mapped by new_vertex_indices (if
+    // not empty)
+    static void compute_entity_keys(const Mesh& mesh, std::size_t dim,
+                     const std::vector<std::size_t>& new_vertex_indices,
+                     std::vector<unsigned int>& keys);
+
+    // Match entities given by old and new keys, returning the new
+    // index of each old entity
+    static std::vector<std::size_t>
+      match_entity_keys(const std::vector<unsigned int>& old_keys,
+                        const std::vector<unsigned int>& new_keys,
+                        std::size_t num_entities);
+
     static void compute_renumbering(const Mesh& mesh,
                                     const std::vector<std::size_t>& coloring,
                                     std::vector<double>& coordinates,
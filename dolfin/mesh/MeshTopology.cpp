@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-08
-// Last changed: 2013-02-03
+// Last changed: 2013-12-11
 
 #include <numeric>
 #include <sstream>
@@ -192,6 +192,51 @@ size_t MeshTopology::hash() const
   return (*this)(dim(), 0).hash();
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshTopology::memory_usage_global_indices(std::size_t dim) const
+{
+  dolfin_assert(dim < _global_indices.size());
+  return _global_indices[dim].capacity()*sizeof(std::size_t);
+}
+//-----------------------------------------------------------------------------
+std::size_t MeshTopology::memory_usage() const
+{
+  std::size_t memory = sizeof(*this)
+    + num_entities.capacity()*sizeof(unsigned int)
+    + global_num_entities.capacity()*sizeof(std::size_t);
+
+  // Connectivity
+  for (std::size_t d0 = 0; d0 < connectivity.size(); d0++)
+    for (std::size_t d1 = 0; d1 < connectivity[d0].size(); d1++)
+      memory += connectivity[d0][d1].memory_usage();
+
+  // Global indices
+  for (std::size_t d = 0; d < _global_indices.size(); d++)
+    memory += memory_usage_global_indices(d);
+
+  // Shared entities
+  std::map<unsigned int, std::map<unsigned int,
+                                  std::set<unsigned int> > >::const_iterator e;
+  for (e = _shared_entities.begin(); e != _shared_entities.end(); ++e)
+  {
+    std::map<unsigned int, std::set<unsigned int> >::const_iterator p;
+    for (p = e->second.begin(); p != e->second.end(); ++p)
+      memory += (p->second.size() + 1)*sizeof(unsigned int);
+  }
+
+  // Colorings
+  std::map<std::vector<std::size_t>,
+           std::pair<std::vector<std::size_t>,
+                     std::vector<std::vector<std::size_t> > > >::const_iterator c;
+  for (c = coloring.begin(); c != coloring.end(); ++c)
+  {
+    memory += c->second.first.capacity()*sizeof(std::size_t);
+    for (std::size_t i = 0; i < c->second.second.size(); i++)
+      memory += c->second.second[i].capacity()*sizeof(std::size_t);
+  }
+
+  return memory;
+}
+//-----------------------------------------------------------------------------
 std::string MeshTopology::str(bool verbose) const
 {
   const std::size_t _dim = num_entities.size() - 1;
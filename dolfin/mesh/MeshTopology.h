@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-08
-// Last changed: 2012-10-25
+// Last changed: 2013-12-11
 
 #ifndef __MESH_TOPOLOGY_H
 #define __MESH_TOPOLOGY_H
@@ -126,6 +126,15 @@ namespace dolfin
     /// Return hash based on the hash of cell-vertex connectivity
     size_t hash() const;
 
+    /// Return memory used by global indices of entities of given
+    /// dimension (in bytes)
+    std::size_t memory_usage_global_indices(std::size_t dim) const;
+
+    /// Return memory used by topology (in bytes), including
+    /// connectivity, global indices, shared entities and colorings.
+    /// Memory used by map nodes is not included.
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -146,6 +155,7 @@ namespace dolfin
 
     // Friends
     friend class BinaryFile;
+    friend class MeshEditor;
 
     // Number of mesh entities for each topological dimension
     std::vector<unsigned int> num_entities;
@@ -19,7 +19,7 @@
 // Modified by Kristoffer Sleim, 2008.
 //
 // First added:  2007-12-12
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #include <dolfin/log/log.h>
 #include "Cell.h"
@@ -92,6 +92,13 @@ void PointCell::refine_cell(Cell& cell, MeshEditor& editor,
                "Refinement of a point cell is not defined");
 }
 //-----------------------------------------------------------------------------
+void PointCell::refine_cell(const Cell& cell, unsigned int* cells) const
+{
+  dolfin_error("PointCell.cpp",
+               "refine cell",
+               "Refinement of a point cell is not defined");
+}
+//-----------------------------------------------------------------------------
 double PointCell::volume(const MeshEntity& triangle) const
 {
   dolfin_error("PointCell.cpp",
@@ -19,7 +19,7 @@
 // Modified by Kristoffer Selim 2008
 //
 // First added:  2007-12-12
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #ifndef __POINT_CELL_H
 #define __POINT_CELL_H
@@ -61,6 +61,9 @@ namespace dolfin
     /// Refine cell uniformly
     void refine_cell(Cell& cell, MeshEditor& editor, std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (vertices of new cells)
+    void refine_cell(const Cell& cell, unsigned int* cells) const;
+
     /// Compute (generalized) volume (area) of triangle
     double volume(const MeshEntity& triangle) const;
 
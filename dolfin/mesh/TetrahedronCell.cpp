@@ -21,11 +21,12 @@
 // Modified by Kristoffer Selim 2008
 //
 // First added:  2006-06-05
-// Last changed: 2013-12-09
+// Last changed: 2013-12-11
 
 #include <algorithm>
 #include <dolfin/log/log.h>
 #include "Cell.h"
+#include "Edge.h"
 #include "Facet.h"
 #include "MeshEditor.h"
 #include "MeshGeometry.h"
@@ -130,6 +131,21 @@ void TetrahedronCell::create_entities(std::vector<std::vector<std::size_t> >& e,
 //-----------------------------------------------------------------------------
 void TetrahedronCell::refine_cell(Cell& cell, MeshEditor& editor,
                                   std::size_t& current_cell) const
+{
+  // Compute the 8 new cells
+  unsigned int cells[8*4];
+  refine_cell(cell, cells);
+
+  // Add cells
+  std::vector<std::size_t> vertices(4);
+  for (std::size_t i = 0; i < 8; i++)
+  {
+    std::copy(cells + 4*i, cells + 4*(i + 1), vertices.begin());
+    editor.add_cell(current_cell++, vertices);
+  }
+}
+//-----------------------------------------------------------------------------
+void TetrahedronCell::refine_cell(const Cell& cell, unsigned int* cells) const
 {
   // Get vertices and edges
   const unsigned int* v = cell.entities(0);
@@ -138,71 +154,70 @@ void TetrahedronCell::refine_cell(Cell& cell, MeshEditor& editor,
   dolfin_assert(e);
 
   // Get offset for new vertex indices
-  const std::size_t offset = cell.mesh().num_vertices();
+  const Mesh& mesh = cell.mesh();
+  const std::size_t offset = mesh.num_vertices();
 
   // Compute indices for the ten new vertices
   const std::size_t v0 = v[0];
   const std::size_t v1 = v[1];
   const std::size_t v2 = v[2];
   const std::size_t v3 = v[3];
-  const std::size_t e0 = offset + e[find_edge(0, cell)];
-  const std::size_t e1 = offset + e[find_edge(1, cell)];
-  const std::size_t e2 = offset + e[find_edge(2, cell)];
-  const std::size_t e3 = offset + e[find_edge(3, cell)];
-  const std::size_t e4 = offset + e[find_edge(4, cell)];
-  const std::size_t e5 = offset + e[find_edge(5, cell)];
+  const std::size_t i0 = e[find_edge(0, cell)];
+  const std::size_t i1 = e[find_edge(1, cell)];
+  const std::size_t i2 = e[find_edge(2, cell)];
+  const std::size_t i3 = e[find_edge(3, cell)];
+  const std::size_t i4 = e[find_edge(4, cell)];
+  const std::size_t i5 = e[find_edge(5, cell)];
+  const std::size_t e0 = offset + i0;
+  const std::size_t e1 = offset + i1;
+  const std::size_t e2 = offset + i2;
+  const std::size_t e3 = offset + i3;
+  const std::size_t e4 = offset + i4;
+  const std::size_t e5 = offset + i5;
 
   // Regular refinement creates 8 new cells but we need to be careful
   // to make the partition in a way that does not make the aspect
   // ratio worse in each refinement. We do this by cutting the middle
   // octahedron along the shortest of three possible paths.
-  dolfin_assert(editor._mesh);
-  const Point p0 = editor._mesh->geometry().point(e0);
-  const Point p1 = editor._mesh->geometry().point(e1);
-  const Point p2 = editor._mesh->geometry().point(e2);
-  const Point p3 = editor._mesh->geometry().point(e3);
-  const Point p4 = editor._mesh->geometry().point(e4);
-  const Point p5 = editor._mesh->geometry().point(e5);
+  const Point p0 = Edge(mesh, i0).midpoint();
+  const Point p1 = Edge(mesh, i1).midpoint();
+  const Point p2 = Edge(mesh, i2).midpoint();
+  const Point p3 = Edge(mesh, i3).midpoint();
+  const Point p4 = Edge(mesh, i4).midpoint();
+  const Point p5 = Edge(mesh, i5).midpoint();
   const double d05 = p0.distance(p5);
   const double d14 = p1.distance(p4);
   const double d23 = p2.distance(p3);
 
-  // Data structure to hold cells
-  std::vector<std::vector<std::size_t> > cells(8, std::vector<std::size_t>(4));
-
   // First create the 4 congruent tetrahedra at the corners
-  cells[0][0] = v0; cells[0][1] = e3; cells[0][2] = e4; cells[0][3] = e5;
-  cells[1][0] = v1; cells[1][1] = e1; cells[1][2] = e2; cells[1][3] = e5;
-  cells[2][0] = v2; cells[2][1] = e0; cells[2][2] = e2; cells[2][3] = e4;
-  cells[3][0] = v3; cells[3][1] = e0; cells[3][2] = e1; cells[3][3] = e3;
+  unsigned int* c = cells;
+  c[0] = v0; c[1] = e3; c[2] = e4; c[3] = e5; c += 4;
+  c[0] = v1; c[1] = e1; c[2] = e2; c[3] = e5; c += 4;
+  c[0] = v2; c[1] = e0; c[2] = e2; c[3] = e4; c += 4;
+  c[0] = v3; c[1] = e0; c[2] = e1; c[3] = e3; c += 4;
 
   // Then divide the remaining octahedron into 4 tetrahedra
   if (d05 <= d14 && d14 <= d23)
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e5;
-    cells[5][0] = e0; cells[5][1] = e1; cells[5][2] = e3; cells[5][3] = e5;
-    cells[6][0] = e0; cells[6][1] = e2; cells[6][2] = e4; cells[6][3] = e5;
-    cells[7][0] = e0; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    c[0] = e0; c[1] = e1; c[2] = e2; c[3] = e5; c += 4;
+    c[0] = e0; c[1] = e1; c[2] = e3; c[3] = e5; c += 4;
+    c[0] = e0; c[1] = e2; c[2] = e4; c[3] = e5; c += 4;
+    c[0] = e0; c[1] = e3; c[2] = e4; c[3] = e5;
   }
   else if (d14 <= d23)
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e4;
-    cells[5][0] = e0; cells[5][1] = e1; cells[5][2] = e3; cells[5][3] = e4;
-    cells[6][0] = e1; cells[6][1] = e2; cells[6][2] = e4; cells[6][3] = e5;
-    cells[7][0] = e1; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    c[0] = e0; c[1] = e1; c[2] = e2; c[3] = e4; c += 4;
+    c[0] = e0; c[1] = e1; c[2] = e3; c[3] = e4; c += 4;
+    c[0] = e1; c[1] = e2; c[2] = e4; c[3] = e5; c += 4;
+    c[0] = e1; c[1] = e3; c[2] = e4; c[3] = e5;
   }
   else
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e3;
-    cells[5][0] = e0; cells[5][1] = e2; cells[5][2] = e3; cells[5][3] = e4;
-    cells[6][0] = e1; cells[6][1] = e2; cells[6][2] = e3; cells[6][3] = e5;
-    cells[7][0] = e2; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    c[0] = e0; c[1] = e1; c[2] = e2; c[3] = e3; c += 4;
+    c[0] = e0; c[1] = e2; c[2] = e3; c[3] = e4; c += 4;
+    c[0] = e1; c[1] = e2; c[2] = e3; c[3] = e5; c += 4;
+    c[0] = e2; c[1] = e3; c[2] = e4; c[3] = e5;
   }
-
-  // Add cells
-  std::vector<std::vector<std::size_t> >::const_iterator _cell;
-  for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-    editor.add_cell(current_cell++, *_cell);
 }
 //-----------------------------------------------------------------------------
 void TetrahedronCell::refine_cellIrregular(Cell& cell, MeshEditor& editor,
@@ -20,7 +20,7 @@
 // Modified by Kristoffer Selim, 2008.
 //
 // First added:  2006-06-05
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #ifndef __TETRAHEDRON_CELL_H
 #define __TETRAHEDRON_CELL_H
@@ -62,6 +62,9 @@ namespace dolfin
     void refine_cell(Cell& cell, MeshEditor& editor,
                      std::size_t& current_cell) const;
 
+    /// Regular refinement of cell (vertices of new cells)
+    void refine_cell(const Cell& cell, unsigned int* cells) const;
+
     /// Irregular refinement of cell
     void refine_cellIrregular(Cell& cell, MeshEditor& editor,
                               std::size_t& current_cell, std::size_t refinement_rule,
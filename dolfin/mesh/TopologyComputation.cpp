@@ -1,4 +1,4 @@
-// Copyright (C) 2006-2010 Anders Logg
+// Copyright (C) 2006-2013 Anders Logg
 //
 // This file is part of DOLFIN.
 //
@@ -18,14 +18,16 @@
 // Modified by Garth N. Wells 2012.
 //
 // First added:  2006-06-02
-// Last changed: 2012-02-14
+// Last changed: 2013-12-11
 
 #include <algorithm>
+#include <limits>
 #include <vector>
 
 #include <dolfin/common/Timer.h>
 #include <dolfin/common/utils.h>
 #include <dolfin/log/log.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "CellType.h"
 #include "Mesh.h"
 #include "MeshConnectivity.h"
@@ -35,6 +37,145 @@
 
 using namespace dolfin;
 
+namespace
+{
+  // Lexicographic comparison of keys (vertex lists of length n) of
+  // cell entities, ties broken by cell entity
+  class CompareKeys
+  {
+  public:
+
+    CompareKeys(const std::vector<unsigned int>& keys, std::size_t n)
+      : _keys(keys), _n(n) {}
+
+    bool operator() (unsigned int p0, unsigned int p1) const
+    {
+      const unsigned int* k0 = &_keys[p0*_n];
+      const unsigned int* k1 = &_keys[p1*_n];
+      for (std::size_t i = 0; i < _n; ++i)
+      {
+        if (k0[i] != k1[i])
+          return k0[i] < k1[i];
+      }
+      return p0 < p1;
+    }
+
+  private:
+
+    const std::vector<unsigned int>& _keys;
+    const std::size_t _n;
+
+  };
+
+  // Computation of the entities of dimension d1 connected to an
+  // entity of dimension d0 through entities of dimension d (with
+  // workspace for one thread)
+  class EntityIntersection
+  {
+  public:
+
+    EntityIntersection(const MeshTopology& topology, std::size_t d0,
+                       std::size_t d1, std::size_t d)
+      : _connectivity0(topology(d0, d)), _connectivity1(topology(d, d1)),
+        _vertices0(topology(d0, 0)), _vertices1(topology(d1, 0)),
+        _same_dimension(d0 == d1), _visited(topology.size(d1), false) {}
+
+    // Compute connections of entity e0, and set them in connectivity
+    // (if not zero). Returns the number of connections.
+    std::size_t compute(std::size_t e0, MeshConnectivity* connectivity)
+    {
+      const unsigned int* e = _connectivity0(e0);
+      const std::size_t num_e = _connectivity0.size(e0);
+
+      // Sorted list of e0 vertex indices (necessary to test for
+      // presence of one list in another)
+      if (!_same_dimension)
+      {
+        _e0.assign(_vertices0(e0), _vertices0(e0) + _vertices0.size(e0));
+        std::sort(_e0.begin(), _e0.end());
+      }
+
+      // Initialise visited to false for all neighbours of e0. The loop
+      // structure mirrors the one below.
+      for (std::size_t i = 0; i < num_e; ++i)
+      {
+        const unsigned int* e1 = _connectivity1(e[i]);
+        const std::size_t num_e1 = _connectivity1.size(e[i]);
+        for (std::size_t j = 0; j < num_e1; ++j)
+          _visited[e1[j]] = false;
+      }
+
+      // Iterate over all connected entities of dimension d, and over
+      // their connected entities of dimension d1
+      std::size_t num_connections = 0;
+      for (std::size_t i = 0; i < num_e; ++i)
+      {
+        const unsigned int* e1 = _connectivity1(e[i]);
+        const std::size_t num_e1 = _connectivity1.size(e[i]);
+        for (std::size_t j = 0; j < num_e1; ++j)
+        {
+          // Skip already visited connected entities (to avoid
+          // duplicates)
+          if (_visited[e1[j]])
+            continue;
+          _visited[e1[j]] = true;
+
+          if (_same_dimension)
+          {
+            // An entity is not a neighbor to itself
+            if (e1[j] == e0)
+              continue;
+          }
+          else
+          {
+            // Entity e1 must be completely contained in e0
+            _e1.assign(_vertices1(e1[j]),
+                       _vertices1(e1[j]) + _vertices1.size(e1[j]));
+            std::sort(_e1.begin(), _e1.end());
+            if (!std::includes(_e0.begin(), _e0.end(),
+                               _e1.begin(), _e1.end()))
+            {
+              continue;
+            }
+          }
+
+          if (connectivity)
+            connectivity->set(e0, e1[j], num_connections);
+          ++num_connections;
+        }
+      }
+
+      return num_connections;
+    }
+
+  private:
+
+    // Connectivity d0 - d, d - d1, d0 - 0 and d1 - 0
+    const MeshConnectivity& _connectivity0;
+    const MeshConnectivity& _connectivity1;
+    const MeshConnectivity& _vertices0;
+    const MeshConnectivity& _vertices1;
+
+    const bool _same_dimension;
+
+    // A bitmap used to ensure we do not store duplicates
+    std::vector<bool> _visited;
+
+    // Sorted vertex lists of entities
+    std::vector<unsigned int> _e0;
+    std::vector<unsigned int> _e1;
+
+  };
+
+  // Check if cell entities p0 and p1 have the same key
+  bool equal_keys(const std::vector<unsigned int>& keys, std::size_t n,
+                  unsigned int p0, unsigned int p1)
+  {
+    return std::equal(keys.begin() + p0*n, keys.begin() + (p0 + 1)*n,
+                      keys.begin() + p1*n);
+  }
+}
+
 //-----------------------------------------------------------------------------
 std::size_t TopologyComputation::compute_entities(Mesh& mesh, std::size_t dim)
 {
@@ -42,16 +183,19 @@ std::size_t TopologyComputation::compute_entities(Mesh& mesh, std::size_t dim)
   // to generating the connectivity dim - 0 (connections to vertices)
   // and the connectivity mesh.topology().dim() - dim (connections from cells).
   //
-  // We generate entities by iterating over all cells and generating a
-  // new entity only on its first occurence. Entities also contained
-  // in a previously visited cell are not generated. The new entities
-  // are computed in three steps:
+  // Entities are numbered in the order of their first occurence when
+  // iterating over cells (and over the entities of each cell). They
+  // are computed without searching neighbouring cells in four steps:
   //
-  //   1. Iterate over cells and count new entities
+  //   1. Generate the sorted vertex list (key) of each entity of each
+  //      cell in a flat array
   //
-  //   2. Allocate memory / prepare data structures
+  //   2. Bucket the cell entities by their first (smallest) vertex
   //
-  //   3. Iterate over cells and add new entities
+  //   3. Sort each bucket by key, and map each cell entity to the
+  //      first cell entity with the same key
+  //
+  //   4. Number the first occurences of keys in order
 
   // Get mesh topology and connectivity
   MeshTopology& topology = mesh.topology();
@@ -79,11 +223,6 @@ std::size_t TopologyComputation::compute_entities(Mesh& mesh, std::size_t dim)
                  "Connectivity for topological dimension %d exists but entities are missing", dim);
   }
 
-  //info("Computing mesh entities of topological dimension %d.", dim);
-
-  // Compute connectivity dim - dim if not already computed
-  compute_connectivity(mesh, mesh.topology().dim(), mesh.topology().dim());
-
   // Start timer
   //info("Creating mesh entities of dimension %d.", dim);
   Timer timer("compute entities dim = " + to_string(dim));
@@ -91,100 +230,117 @@ std::size_t TopologyComputation::compute_entities(Mesh& mesh, std::size_t dim)
   // Get cell type
   const CellType& cell_type = mesh.type();
 
-  // Initialize local array of entities
+  // Number of entities and vertices per entity, and total number of
+  // cell entities
+  const std::size_t num_cells = mesh.num_cells();
+  const std::size_t num_vertices = mesh.num_vertices();
   const std::size_t m = cell_type.num_entities(dim);
   const std::size_t n = cell_type.num_vertices(dim);
-  std::vector<std::vector<std::size_t> > entities(m, std::vector<std::size_t>(n, 0));
-
-  // List of entity e indices connected to cell
-  std::vector<std::vector<std::size_t> > connectivity_ce(mesh.num_cells());
-
-  // List of vertces indices connected to entity e
-  std::vector<std::vector<std::size_t> > connectivity_ev;
-
-  // List entities e (std::size_t index, std::vector<std::size_t> vertex_list) connected to each cell
-  std::vector<std::vector<std::pair<std::size_t, std::vector<std::size_t> > > > ce_list(mesh.num_cells());
-
-  std::size_t current_entity = 0;
-  std::size_t max_ce_connections = 1;
-  for (MeshEntityIterator c(mesh, mesh.topology().dim()); !c.end(); ++c)
+  const std::size_t num_cell_entities = num_cells*m;
+  if (num_cell_entities > std::numeric_limits<unsigned int>::max())
   {
-    // Cell index
-    const std::size_t c_index = c->index();
-
-    // Reserve space to reduce dynamic allocations
-    connectivity_ce[c_index].reserve(max_ce_connections);
-    ce_list[c_index].reserve(max_ce_connections);
-
-    // Get vertices from cell
-    const unsigned int* vertices = c->entities(0);
-    dolfin_assert(vertices);
+    dolfin_error("TopologyComputation.cpp",
+                 "compute topological entities",
+                 "Number of cell entities exceeds range of unsigned int");
+  }
 
-    // Create entities
-    cell_type.create_entities(entities, dim, vertices);
+  // Get number of threads
+  #ifdef HAS_OPENMP
+  const int num_threads = std::max((std::size_t) parameters["num_threads"],
+                                   (std::size_t) 1);
+  #endif
+
+  // Step 1: compute keys (sorted vertex lists) of all cell entities
+  const MeshConnectivity& cv = topology(topology.dim(), 0);
+  std::vector<unsigned int> keys(num_cell_entities*n);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel num_threads(num_threads)
+  #endif
+  {
+    std::vector<std::vector<std::size_t> >
+      entities(m, std::vector<std::size_t>(n, 0));
 
-    // Iterate over the given list of entities
-    std::vector<std::vector<std::size_t> >::iterator entity;
-    for (entity = entities.begin(); entity != entities.end(); ++entity)
+    #ifdef HAS_OPENMP
+    #pragma omp for
+    #endif
+    for (int c = 0; c < (int) num_cells; ++c)
     {
-      // Sort entities (so that we can use equality testing later)
-      std::sort(entity->begin(), entity->end());
-
-      // Iterate over connected cells and look for entity
-      for (MeshEntityIterator c0(*c, mesh.topology().dim()); !c0.end(); ++c0)
+      cell_type.create_entities(entities, dim, cv(c));
+      for (std::size_t i = 0; i < m; ++i)
       {
-        const std::size_t c0_index = c0->index();
-
-        // Check only previously visited cells
-        if (c0_index >= c_index)
-          continue;
-
-        // Entities connected to c0
-        const std::vector<std::pair<std::size_t, std::vector<std::size_t> > >& c0_list = ce_list[c0_index];
-
-        std::vector<std::pair<std::size_t, std::vector<std::size_t> > >::const_iterator other_entity;
-        for (other_entity = c0_list.begin(); other_entity != c0_list.end(); ++other_entity)
-        {
-          // Note: Comparison relies on container being ordered
-          if (other_entity->second == *entity)
-          {
-            // Entity already exists, so pick the index
-            connectivity_ce[c_index].push_back(other_entity->first);
-
-            goto found;
-          }
-        }
+        std::sort(entities[i].begin(), entities[i].end());
+        std::copy(entities[i].begin(), entities[i].end(),
+                  keys.begin() + (c*m + i)*n);
       }
+    }
+  }
 
-      // Add (index, list of vertices) pair to ce_list for cell
-      ce_list[c_index].push_back(std::make_pair(current_entity, *entity));
-
-      // Add new entity index to cell - e connectivity
-      connectivity_ce[c_index].push_back(current_entity);
-
-      // Add list of new entity vertices
-      connectivity_ev.push_back(*entity);
-
-      // Update max vector size (used to reserve space for performance);
-      max_ce_connections = std::max(max_ce_connections, connectivity_ce[c_index].size());
-
-      // Increase counter
-      current_entity++;
+  // Step 2: bucket cell entities by first vertex (in order of cell
+  // entities within each bucket)
+  std::vector<unsigned int> bucket_offsets(num_vertices + 1, 0);
+  for (std::size_t p = 0; p < num_cell_entities; ++p)
+    ++bucket_offsets[keys[p*n] + 1];
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    bucket_offsets[v + 1] += bucket_offsets[v];
+  std::vector<unsigned int> buckets(num_cell_entities);
+  {
+    std::vector<unsigned int> position(bucket_offsets.begin(),
+                                       bucket_offsets.end() - 1);
+    for (std::size_t p = 0; p < num_cell_entities; ++p)
+      buckets[position[keys[p*n]]++] = p;
+  }
 
-      // Entity found, don't need to create
-      found:
-      ;
+  // Step 3: sort buckets by key and find first cell entity with same
+  // key as each cell entity
+  std::vector<unsigned int> entity_index(num_cell_entities);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1024)
+  #endif
+  for (int v = 0; v < (int) num_vertices; ++v)
+  {
+    std::vector<unsigned int>::iterator begin
+      = buckets.begin() + bucket_offsets[v];
+    std::vector<unsigned int>::iterator end
+      = buckets.begin() + bucket_offsets[v + 1];
+    std::sort(begin, end, CompareKeys(keys, n));
+    for (std::vector<unsigned int>::iterator p = begin; p != end; ++p)
+    {
+      if (p != begin && equal_keys(keys, n, *(p - 1), *p))
+        entity_index[*p] = entity_index[*(p - 1)];
+      else
+        entity_index[*p] = *p;
+    }
+  }
+  std::vector<unsigned int>().swap(buckets);
+  std::vector<unsigned int>().swap(bucket_offsets);
+
+  // Step 4: number first occurences of keys in order of cell
+  // entities (entity_index holds the first occurence of the key of
+  // each cell entity, which precedes it), and collect their vertices
+  std::vector<unsigned int> connectivity_ev;
+  std::size_t num_entities = 0;
+  for (std::size_t p = 0; p < num_cell_entities; ++p)
+  {
+    const std::size_t first = entity_index[p];
+    if (first == p)
+    {
+      connectivity_ev.insert(connectivity_ev.end(), keys.begin() + p*n,
+                             keys.begin() + (p + 1)*n);
+      entity_index[p] = num_entities++;
     }
+    else
+      entity_index[p] = entity_index[first];
   }
+  std::vector<unsigned int>().swap(keys);
 
   // Initialise connectivity data structure
-  topology.init(dim, connectivity_ev.size());
+  topology.init(dim, num_entities);
 
   // Copy connectivity data into static MeshTopology data structures
-  ce.set(connectivity_ce);
-  ev.set(connectivity_ev);
+  ce.set(entity_index, m);
+  ev.set(connectivity_ev, n);
 
-  return connectivity_ev.size();
+  return num_entities;
 }
 //-----------------------------------------------------------------------------
 void TopologyComputation::compute_connectivity(Mesh& mesh,
@@ -267,15 +423,22 @@ void TopologyComputation::compute_connectivity(Mesh& mesh,
 //----------------------------------------------------------------------------
 void TopologyComputation::compute_from_transpose(Mesh& mesh, std::size_t d0, std::size_t d1)
 {
-  // The transpose is computed in three steps:
+  // The transpose is computed in three steps, with the entities of
+  // dimension d0 divided into one contiguous range per thread:
   //
   //   1. Iterate over entities of dimension d1 and count the number
-  //      of connections for each entity of dimension d0
+  //      of connections for each entity of dimension d0 in the range
+  //      of the thread
   //
-  //   2. Allocate memory / prepare data structures
+  //   2. Compute the offset of the first connection of each entity of
+  //      dimension d0 (exclusive prefix sum)
   //
   //   3. Iterate again over entities of dimension d1 and add connections
-  //      for each entity of dimension d0
+  //      for each entity of dimension d0 in the range of the thread
+  //
+  // Each thread only writes to the counts and connections of its own
+  // entities, and connections of each entity are added in order of the
+  // entities of dimension d1, as in a serial computation.
 
   log(TRACE, "Computing mesh connectivity %d - %d from transpose.", d0, d1);
 
@@ -284,31 +447,84 @@ void TopologyComputation::compute_from_transpose(Mesh& mesh, std::size_t d0, std
   MeshConnectivity& connectivity = topology(d0, d1);
 
   // Need connectivity d1 - d0
-  dolfin_assert(!topology(d1, d0).empty());
+  const MeshConnectivity& transpose = topology(d1, d0);
+  dolfin_assert(!transpose.empty());
 
-  // Temporary array
-  std::vector<std::size_t> tmp(topology.size(d0), 0);
+  const std::size_t num_entities0 = topology.size(d0);
+  const std::size_t num_entities1 = topology.size(d1);
+  #ifdef HAS_OPENMP
+  const int num_threads = std::max((std::size_t) parameters["num_threads"],
+                                   (std::size_t) 1);
+  #else
+  const int num_threads = 1;
+  #endif
+
+  // Number of connections of entity e0 (step 1), stored at e0 + 1
+  std::vector<unsigned int> offsets(num_entities0 + 1, 0);
 
   // Count the number of connections
-  for (MeshEntityIterator e1(mesh, d1); !e1.end(); ++e1)
-    for (MeshEntityIterator e0(*e1, d0); !e0.end(); ++e0)
-      tmp[e0->index()]++;
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    const unsigned int begin = t*num_entities0/num_threads;
+    const unsigned int end = (t + 1)*num_entities0/num_threads;
+    for (std::size_t e1 = 0; e1 < num_entities1; ++e1)
+    {
+      const unsigned int* e0 = transpose(e1);
+      const std::size_t num_e0 = transpose.size(e1);
+      for (std::size_t i = 0; i < num_e0; ++i)
+      {
+        if (e0[i] >= begin && e0[i] < end)
+          ++offsets[e0[i] + 1];
+      }
+    }
+  }
 
-  // Initialize the number of connections
-  connectivity.init(tmp);
+  // Compute offsets of first connection of each entity
+  for (std::size_t e0 = 0; e0 < num_entities0; ++e0)
+    offsets[e0 + 1] += offsets[e0];
+
+  // Add the connections, using the offset of each entity as the
+  // position of its next connection (so the offset of entity e0 ends
+  // up in position e0 + 1)
+  std::vector<unsigned int> connections(offsets[num_entities0]);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  #endif
+  for (int t = 0; t < num_threads; ++t)
+  {
+    const unsigned int begin = t*num_entities0/num_threads;
+    const unsigned int end = (t + 1)*num_entities0/num_threads;
+    for (std::size_t e1 = 0; e1 < num_entities1; ++e1)
+    {
+      const unsigned int* e0 = transpose(e1);
+      const std::size_t num_e0 = transpose.size(e1);
+      for (std::size_t i = 0; i < num_e0; ++i)
+      {
+        if (e0[i] >= begin && e0[i] < end)
+          connections[offsets[e0[i]]++] = e1;
+      }
+    }
+  }
 
-  // Reset current position for each entity
-  std::fill(tmp.begin(), tmp.end(), 0);
+  // Shift offsets back
+  for (std::size_t e0 = num_entities0; e0 > 0; --e0)
+    offsets[e0] = offsets[e0 - 1];
+  offsets[0] = 0;
 
-  // Add the connections
-  for (MeshEntityIterator e1(mesh, d1); !e1.end(); ++e1)
-    for (MeshEntityIterator e0(*e1, d0); !e0.end(); ++e0)
-      connectivity.set(e0->index(), e1->index(), tmp[e0->index()]++);
+  connectivity.set(connections, offsets);
 }
 //----------------------------------------------------------------------------
 void TopologyComputation::compute_from_intersection(Mesh& mesh,
                                                     std::size_t d0, std::size_t d1, std::size_t d)
 {
+  // The connectivity is computed in two passes over the (independent)
+  // entities of dimension d0: the first pass counts the connections
+  // of each entity, and the second pass adds them to the allocated
+  // connectivity
+
   log(TRACE, "Computing mesh connectivity %d - %d from intersection %d - %d - %d.",
       d0, d1, d0, d, d1);
 
@@ -320,68 +536,42 @@ void TopologyComputation::compute_from_intersection(Mesh& mesh,
   dolfin_assert(!topology(d0, d).empty());
   dolfin_assert(!topology(d, d1).empty());
 
-  // Temporary dynamic storage, later copied into static storage
-  std::vector<std::vector<std::size_t> > connectivity(topology.size(d0));
-
-  // A bitmap used to ensure we do not store duplicates
-  std::vector<bool> e1_visited(topology.size(d1));
+  const std::size_t num_entities0 = topology.size(d0);
+  #ifdef HAS_OPENMP
+  const int num_threads = std::max((std::size_t) parameters["num_threads"],
+                                   (std::size_t) 1);
+  #endif
 
-  // Iterate over all entities of dimension d0
-  std::size_t max_size = 1;
-  for (MeshEntityIterator e0(mesh, d0); !e0.end(); ++e0)
+  // Count the number of connections
+  std::vector<std::size_t> num_connections(num_entities0);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel num_threads(num_threads)
+  #endif
   {
-    // Get set of connected entities for current entity
-    std::vector<std::size_t>& entities = connectivity[e0->index()];
-
-    // Reserve space
-    entities.reserve(max_size);
-
-    // Sorted list of e0 vertex indices (necessary to test for presence
-    // of one list in another)
-    std::vector<std::size_t> _e0(e0->entities(0), e0->entities(0) + e0->num_entities(0));
-    std::sort(_e0.begin(), _e0.end());
-
-    // Initialise e1_visited to false for all neighbours of e0. The loop
-    // structure mirrors the one below.
-    for (MeshEntityIterator e(*e0, d); !e.end(); ++e)
-      for (MeshEntityIterator e1(*e, d1); !e1.end(); ++e1)
-        e1_visited[e1->index()] = false;
-
-    // Iterate over all connected entities of dimension d
-    for (MeshEntityIterator e(*e0, d); !e.end(); ++e)
-    {
-      // Iterate over all connected entities of dimension d1
-      for (MeshEntityIterator e1(*e, d1); !e1.end(); ++e1)
-      {
-        // Skip already visited connected entities (to avoid duplicates)
-        if (e1_visited[e1->index()])
-          continue;
-        e1_visited[e1->index()] = true;
-
-        if (d0 == d1)
-        {
-          // An entity is not a neighbor to itself (duplicate index entries removed at end)
-          if (e0->index() != e1->index())
-            entities.push_back(e1->index());
-        }
-        else
-        {
-          // Sorted list of e1 vertex indices
-          std::vector<std::size_t> _e1(e1->entities(0), e1->entities(0) + e1->num_entities(0));
-          std::sort(_e1.begin(), _e1.end());
+    EntityIntersection intersection(topology, d0, d1, d);
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(dynamic, 256)
+    #endif
+    for (int e0 = 0; e0 < (int) num_entities0; ++e0)
+      num_connections[e0] = intersection.compute(e0, 0);
+  }
 
-          // Entity e1 must be completely contained in e0
-          if (std::includes(_e0.begin(), _e0.end(), _e1.begin(), _e1.end()))
-            entities.push_back(e1->index());
-        }
-      }
-    }
+  // Initialize the number of connections
+  MeshConnectivity& connectivity = topology(d0, d1);
+  connectivity.init(num_connections);
+  std::vector<std::size_t>().swap(num_connections);
 
-    // Store maximum size
-    max_size = std::max(entities.size(), max_size);
+  // Add the connections
+  #ifdef HAS_OPENMP
+  #pragma omp parallel num_threads(num_threads)
+  #endif
+  {
+    EntityIntersection intersection(topology, d0, d1, d);
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(dynamic, 256)
+    #endif
+    for (int e0 = 0; e0 < (int) num_entities0; ++e0)
+      intersection.compute(e0, &connectivity);
   }
-
-  // Copy to static storage
-  topology(d0, d1).set(connectivity);
 }
 //-----------------------------------------------------------------------------
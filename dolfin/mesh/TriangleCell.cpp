@@ -22,7 +22,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-06-05
-// Last changed: 2013-12-09
+// Last changed: 2013-12-11
 
 #include <algorithm>
 #include <dolfin/log/log.h>
@@ -104,6 +104,21 @@ void TriangleCell::create_entities(std::vector<std::vector<std::size_t> >& e,
 //-----------------------------------------------------------------------------
 void TriangleCell::refine_cell(Cell& cell, MeshEditor& editor,
                                std::size_t& current_cell) const
+{
+  // Compute the four new cells
+  unsigned int cells[4*3];
+  refine_cell(cell, cells);
+
+  // Add cells
+  std::vector<std::size_t> vertices(3);
+  for (std::size_t i = 0; i < 4; i++)
+  {
+    std::copy(cells + 3*i, cells + 3*(i + 1), vertices.begin());
+    editor.add_cell(current_cell++, vertices);
+  }
+}
+//-----------------------------------------------------------------------------
+void TriangleCell::refine_cell(const Cell& cell, unsigned int* cells) const
 {
   // Get vertices and edges
   const unsigned int* v = cell.entities(0);
@@ -123,16 +138,10 @@ void TriangleCell::refine_cell(Cell& cell, MeshEditor& editor,
   const std::size_t e2 = offset + e[find_edge(2, cell)];
 
   // Create four new cells
-  std::vector<std::vector<std::size_t> > cells(4, std::vector<std::size_t>(3));
-  cells[0][0] = v0; cells[0][1] = e2; cells[0][2] = e1;
-  cells[1][0] = v1; cells[1][1] = e0; cells[1][2] = e2;
-  cells[2][0] = v2; cells[2][1] = e1; cells[2][2] = e0;
-  cells[3][0] = e0; cells[3][1] = e1; cells[3][2] = e2;
-
-  // Add cells
-  std::vector<std::vector<std::size_t> >::const_iterator _cell;
-  for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-    editor.add_cell(current_cell++, *_cell);
+  cells[0] = v0; cells[1]  = e2; cells[2]  = e1;
+  cells[3] = v1; cells[4]  = e0; cells[5]  = e2;
+  cells[6] = v2; cells[7]  = e1; cells[8]  = e0;
+  cells[9] = e0; cells[10] = e1; cells[11] = e2;
 }
 //-----------------------------------------------------------------------------
 double TriangleCell::volume(const MeshEntity& triangle) const
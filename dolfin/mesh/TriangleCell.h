@@ -19,7 +19,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-06-05
-// Last changed: 2013-08-26
+// Last changed: 2013-12-11
 
 #ifndef __TRIANGLE_CELL_H
 #define __TRIANGLE_CELL_H
@@ -60,6 +60,9 @@ namespace dolfin
     void refine_cell(Cell& cell, MeshEditor& editor,
                      std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (vertices of new cells)
+    void refine_cell(const Cell& cell, unsigned int* cells) const;
+
     /// Compute (generalized) volume (area) of triangle
     double volume(const MeshEntity& triangle) const;
 
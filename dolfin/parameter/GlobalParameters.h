@@ -18,7 +18,7 @@
 // Modified by Fredrik Valdmanis, 2011
 //
 // First added:  2009-07-02
-// Last changed: 2013-06-21
+// Last changed: 2013-12-11
 
 #ifndef __GLOBAL_PARAMETERS_H
 #define __GLOBAL_PARAMETERS_H
@@ -72,14 +72,35 @@ namespace dolfin
       // Number of threads to run, 0 = run serial version
       p.add("num_threads", 0);
 
+      // Multithreaded assembler: color-by-color (OpenMpAssembler) or
+      // block-wise with work stealing (WorkStealingAssembler)
+      std::set<std::string> allowed_threaded_assemblers;
+      allowed_threaded_assemblers.insert("coloring");
+      allowed_threaded_assemblers.insert("work_stealing");
+      p.add("threaded_assembler", "coloring", allowed_threaded_assemblers);
+
       // DOF reordering when running in serial
       p.add("reorder_dofs_serial", true);
 
-      // Allowed dofs ordering libraries and set default
+      // DOF reordering on refined meshes. If false, dof maps created
+      // on a refined mesh (see adapt) reuse the numbering of the
+      // parent dof map on unrefined cells (serial only)
+      p.add("reorder_dofs_refined", true);
+
+      // Allowed dofs ordering libraries and set default. Besides
+      // reverse Cuthill-McKee (Boost) and Gibbs-Poole-Stockmeyer
+      // (SCOTCH), nodes may be numbered in the order they are first
+      // touched by cells ("first_touch") or by nested dissection
+      // ("nested_dissection"). Components of vector-valued spaces are
+      // always interleaved
       std::set<std::string> allowed_dof_ordering_libraries;
       allowed_dof_ordering_libraries.insert("Boost");
       allowed_dof_ordering_libraries.insert("random");
       allowed_dof_ordering_libraries.insert("SCOTCH");
+      allowed_dof_ordering_libraries.insert("first_touch");
+      #ifdef HAS_SCOTCH
+      allowed_dof_ordering_libraries.insert("nested_dissection");
+      #endif
       std::string default_dof_ordering_library = "Boost";
       #ifdef HAS_SCOTCH
       default_dof_ordering_library = "SCOTCH";
@@ -137,11 +158,15 @@ namespace dolfin
       // Graph coloring
       std::set<std::string> allowed_coloring_libraries;
       allowed_coloring_libraries.insert("Boost");
+      allowed_coloring_libraries.insert("JonesPlassmann");
       #ifdef HAS_TRILINOS
       allowed_coloring_libraries.insert("Zoltan");
       #endif
       p.add("graph_coloring_library", "Boost", allowed_coloring_libraries);
 
+      // Even out the sizes of color classes after graph coloring
+      p.add("balance_graph_coloring", false);
+
       // Mesh refinement
       std::set<std::string> allowed_refinement_algorithms;
       std::string default_refinement_algorithm("recursive_bisection");
@@ -158,6 +183,7 @@ namespace dolfin
       std::string default_backend("uBLAS");
       allowed_backends.insert("uBLAS");
       allowed_backends.insert("STL");
+      allowed_backends.insert("CSR");
       #ifdef HAS_PETSC
       allowed_backends.insert("PETSc");
       default_backend = "PETSc";
@@ -176,6 +202,10 @@ namespace dolfin
             default_backend,
             allowed_backends);
 
+      // Create matrices of vector-valued spaces in block format (PETSc
+      // BAIJ) when the dofs are blocked
+      p.add("block_matrices", false);
+
       // Add nested parameter sets
       p.add(KrylovSolver::default_parameters());
       p.add(LUSolver::default_parameters());
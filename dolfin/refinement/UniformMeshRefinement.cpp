@@ -1,4 +1,4 @@
-// Copyright (C) 2006-2010 Anders Logg
+// Copyright (C) 2006-2013 Anders Logg
 //
 // This file is part of DOLFIN.
 //
@@ -18,11 +18,16 @@
 // Modified by Garth N. Wells, 2010
 //
 // First added:  2006-06-08
-// Last changed: 2011-04-07
+// Last changed: 2013-12-11
 
+#include <algorithm>
+#include <vector>
 #include <dolfin/math/dolfin_math.h>
 #include <dolfin/log/dolfin_log.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshData.h>
 #include <dolfin/mesh/MeshTopology.h>
 #include <dolfin/mesh/MeshGeometry.h>
 #include <dolfin/mesh/MeshConnectivity.h>
@@ -62,6 +67,8 @@ void UniformMeshRefinement::refine(Mesh& refined_mesh,
                  "refine mesh",
                  "Mesh is not ordered according to the UFC numbering convention, consider calling mesh.order()");
 
+  Timer timer("Uniform mesh refinement");
+
   // Get cell type
   const CellType& cell_type = mesh.type();
 
@@ -71,38 +78,79 @@ void UniformMeshRefinement::refine(Mesh& refined_mesh,
               mesh.topology().dim(), mesh.geometry().dim());
 
   // Get size of mesh
+  const std::size_t D = mesh.topology().dim();
+  const std::size_t gdim = mesh.geometry().dim();
   const std::size_t num_vertices = mesh.size(0);
   const std::size_t num_edges = mesh.size(1);
-  const std::size_t num_cells = mesh.size(mesh.topology().dim());
+  const std::size_t num_cells = mesh.size(D);
+
+  // Each cell is divided into the same number of cells, so the new
+  // cells of cell c start at position c*num_children
+  const std::size_t num_children = ipow(2, D);
+  const std::size_t num_cell_vertices = cell_type.num_vertices(D);
 
   // Specify number of vertices and cells
   editor.init_vertices(num_vertices + num_edges);
-  editor.init_cells(ipow(2, mesh.topology().dim())*num_cells);
-
-  // Add old vertices
-  std::size_t vertex = 0;
-  for (VertexIterator v(mesh); !v.end(); ++v)
+  editor.init_cells(num_children*num_cells);
+
+  // The vertices and cells of the refined mesh are written directly
+  // into its preallocated geometry and topology (in parallel when
+  // num_threads > 1), instead of being added one at a time
+  MeshGeometry& geometry = refined_mesh.geometry();
+  MeshTopology& topology = refined_mesh.topology();
+  const MeshConnectivity& edge_vertices = mesh.topology()(1, 0);
+  #ifdef HAS_OPENMP
+  const std::size_t num_threads
+    = std::max((std::size_t) parameters["num_threads"], (std::size_t) 1);
+  #endif
+
+  // Add old vertices and new vertices at edge midpoints (numbered by
+  // edge)
+  #ifdef HAS_OPENMP
+  #pragma omp parallel num_threads(num_threads)
+  #endif
   {
-    editor.add_vertex(vertex, v->point());
-    vertex++;
+    std::vector<double> x(gdim);
+
+    #ifdef HAS_OPENMP
+    #pragma omp for
+    #endif
+    for (int v = 0; v < (int) (num_vertices + num_edges); ++v)
+    {
+      if (v < (int) num_vertices)
+        std::copy(mesh.geometry().x(v), mesh.geometry().x(v) + gdim, x.begin());
+      else
+      {
+        const unsigned int* e = edge_vertices(v - num_vertices);
+        for (std::size_t i = 0; i < gdim; ++i)
+          x[i] = (mesh.geometry().x(e[0], i) + mesh.geometry().x(e[1], i))/2.0;
+      }
+      geometry.set(v, x);
+      topology.set_global_index(0, v, v);
+    }
   }
 
-  // Add new vertices
-  for (EdgeIterator e(mesh); !e.end(); ++e)
+  // Add cells, and store parent cell of each cell
+  std::vector<unsigned int> connections(num_children*num_cells*num_cell_vertices);
+  std::vector<std::size_t>& parent_cell
+    = refined_mesh.data().create_array("parent_cell", D);
+  parent_cell.resize(num_children*num_cells);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for num_threads(num_threads)
+  #endif
+  for (int c = 0; c < (int) num_cells; ++c)
   {
-    editor.add_vertex(vertex, e->midpoint());
-    vertex++;
+    const Cell cell(mesh, c);
+    cell_type.refine_cell(cell, &connections[c*num_children*num_cell_vertices]);
+    for (std::size_t i = c*num_children; i < (c + 1)*num_children; ++i)
+    {
+      parent_cell[i] = c;
+      topology.set_global_index(D, i, i);
+    }
   }
+  topology(D, 0).set(connections, num_cell_vertices);
 
-  // Add cells
-  std::size_t current_cell = 0;
-  for (CellIterator c(mesh); !c.end(); ++c)
-    cell_type.refine_cell(*c, editor, current_cell);
-
-  // Close editor
+  // Close editor (orders mesh)
   editor.close();
-
-  // Make sure that mesh is ordered after refinement
-  //refined_mesh.order();
 }
 //-----------------------------------------------------------------------------
@@ -70,6 +70,8 @@ PROBLEM_RENAMES(NonlinearVariational)
 					 const std::vector<std::pair<std::size_t, std::size_t> >&,
 					 std::string method="topological");
 
+%ignore dolfin::MatrixFreeOperator::MatrixFreeOperator(const Form&);
+
 %ignore dolfin::LinearVariationalProblem::LinearVariationalProblem(const Form&,
                                                                    const Form&,
                                                                    Function&);
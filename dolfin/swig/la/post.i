@@ -755,6 +755,8 @@ _matrix_vector_mul_map = {}
 // Run the downcast macro
 // ---------------------------------------------------------------------------
 AS_BACKEND_TYPE_MACRO(uBLASVector)
+AS_BACKEND_TYPE_MACRO(CSRVector)
+AS_BACKEND_TYPE_MACRO(CSRMatrix)
 
 // NOTE: Silly SWIG force us to describe the type explicit for uBLASMatrices
 %inline %{
@@ -782,8 +784,9 @@ _as_backend_type_map[uBLASSparseMatrix] = _as_backend_type_uBLASSparseMatrix
 // Fill lookup map
 // ---------------------------------------------------------------------------
 %pythoncode %{
-_matrix_vector_mul_map[uBLASSparseMatrix] = [uBLASVector]
-_matrix_vector_mul_map[uBLASDenseMatrix]  = [uBLASVector]
+_matrix_vector_mul_map[uBLASSparseMatrix] = [uBLASVector, CSRVector]
+_matrix_vector_mul_map[uBLASDenseMatrix]  = [uBLASVector, CSRVector]
+_matrix_vector_mul_map[CSRMatrix] = [CSRVector, uBLASVector]
 %}
 
 // ---------------------------------------------------------------------------
@@ -982,8 +985,11 @@ _matrix_vector_mul_map[EpetraMatrix] = [EpetraVector]
 %pythoncode %{
 def get_tensor_type(tensor):
     "Return the concrete subclass of tensor."
-    for k, v in _has_type_map.items():
-        if v(tensor):
+    # A tensor may also have the type of a base class (a CSRVector is
+    # a uBLASVector), so return the most derived type
+    types = [k for k, v in _has_type_map.items() if v(tensor)]
+    for k in types:
+        if all(issubclass(k, t) for t in types):
             return k
     common.dolfin_error("dolfin/swig/la/post.i",
                         "extract backend type for %s" % type(tensor).__name__,
@@ -24,7 +24,7 @@
 // Modified by Johan Hake 2008-2009
 //
 // First added:  2007-01-21
-// Last changed: 2011-04-20
+// Last changed: 2013-12-11
 
 //=============================================================================
 // SWIG directives for the DOLFIN la kernel module (pre)
@@ -138,6 +138,14 @@
 
 //-----------------------------------------------------------------------------
 %ignore dolfin::uBLASVector::operator ()(std::size_t i) const;
+
+// Raw storage of CSRMatrix is accessed through data()
+%ignore dolfin::CSRMatrix::cols;
+%ignore dolfin::CSRMatrix::values;
+%ignore dolfin::CSRMatrix::row_ptr;
+
+// Raw storage of MultiVector is accessed through get() and set()
+%ignore dolfin::MultiVector::data;
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
@@ -197,6 +205,8 @@
 %ignore dolfin::GenericMatrix::getitem;
 %ignore dolfin::GenericMatrix::setitem;
 %ignore dolfin::GenericMatrix::operator();
+%ignore dolfin::GenericMatrix::assembly_plan;
+%ignore dolfin::GenericMatrix::set_assembly_plan;
 
 
 //-----------------------------------------------------------------------------
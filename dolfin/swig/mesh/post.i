@@ -178,6 +178,7 @@ def __len__(self):
 %template(FaceFunction ## TYPENAME) dolfin::FaceFunction<TYPE>;
 %template(FacetFunction ## TYPENAME) dolfin::FacetFunction<TYPE>;
 %template(VertexFunction ## TYPENAME) dolfin::VertexFunction<TYPE>;
+%template(renumber) dolfin::MeshRenumbering::renumber<TYPE>;
 
 //-----------------------------------------------------------------------------
 // Modifying the interface of Hierarchical
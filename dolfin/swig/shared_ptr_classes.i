@@ -24,7 +24,7 @@
 // Modified by Andre Massing, 2013.
 //
 // First added:  2007-11-25
-// Last changed: 2013-10-30
+// Last changed: 2013-12-11
 
 //=============================================================================
 // SWIG directives for the shared_ptr stored classes in PyDOLFIN
@@ -84,6 +84,8 @@
 %shared_ptr(dolfin::DofMap)
 %shared_ptr(dolfin::CCFEMDofMap)
 %shared_ptr(dolfin::Form)
+%shared_ptr(dolfin::AssemblyPlan)
+%shared_ptr(dolfin::MatrixFreeOperator)
 %shared_ptr(dolfin::FiniteElement)
 %shared_ptr(dolfin::BasisFunction)
 %shared_ptr(dolfin::MultiStageScheme)
@@ -194,6 +196,7 @@
 %shared_ptr(dolfin::GenericTensor)
 %shared_ptr(dolfin::GenericVector)
 %shared_ptr(dolfin::LinearAlgebraObject)
+%shared_ptr(dolfin::MultiVector)
 %shared_ptr(dolfin::Scalar)
 
 %shared_ptr(dolfin::Matrix)
@@ -205,6 +208,8 @@
 %shared_ptr(dolfin::uBLASMatrix<boost::numeric::ublas::compressed_matrix<double,\
             boost::numeric::ublas::row_major> >)
 %shared_ptr(dolfin::uBLASVector)
+%shared_ptr(dolfin::CSRMatrix)
+%shared_ptr(dolfin::CSRVector)
 
 #ifdef HAS_PETSC
 %shared_ptr(dolfin::PETScBaseMatrix)
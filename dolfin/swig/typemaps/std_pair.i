@@ -17,7 +17,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2011-01-25
-// Last changed: 2013-08-27
+// Last changed: 2013-12-10
 
 //-----------------------------------------------------------------------------
 // User macro for defining in typmaps for std::pair of a pointer to some
@@ -253,3 +253,23 @@ IN_TYPEMAPS_STD_PAIR_OF_POINTER_AND_DOUBLE(MeshFunction<bool>)
 
   $result = Py_BuildValue("OO", x0, x1);
 }
+
+//-----------------------------------------------------------------------------
+// Out typemap for std::pair<std::vector<unsigned int>, std::vector<double> >
+//-----------------------------------------------------------------------------
+%typemap(out) std::pair<std::vector<unsigned int>, std::vector<double> >
+{
+  npy_intp n0 = $1.first.size();
+  npy_intp n1 = $1.second.size();
+
+  PyArrayObject *x0 = reinterpret_cast<PyArrayObject*>(PyArray_SimpleNew(1, &n0, NPY_UINT));
+  PyArrayObject *x1 = reinterpret_cast<PyArrayObject*>(PyArray_SimpleNew(1, &n1, NPY_DOUBLE));
+
+  unsigned int* data0 = static_cast<unsigned int*>(PyArray_DATA(x0));
+  double* data1 = static_cast<double*>(PyArray_DATA(x1));
+
+  std::copy($1.first.begin(),  $1.first.end(),  data0);
+  std::copy($1.second.begin(), $1.second.end(), data1);
+
+  $result = Py_BuildValue("OO", x0, x1);
+}
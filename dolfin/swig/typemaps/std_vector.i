@@ -547,6 +547,35 @@ const std::vector<TYPE>&  ARG_NAME
 }
 %enddef
 
+//-----------------------------------------------------------------------------
+// Macro for defining an out typemap for std::vector<std::vector<TYPE> >
+// where TYPE is a primitive. It returns a list of NumPy arrays.
+//
+// TYPE       : The primitive type
+// NUMPY_TYPE : The type of the NumPy array that will be returned
+//-----------------------------------------------------------------------------
+%define OUT_TYPEMAP_STD_VECTOR_OF_STD_VECTOR_OF_PRIMITIVES(TYPE, NUMPY_TYPE)
+
+%typemap(out) std::vector<std::vector<TYPE> > (npy_intp adims,
+                                               PyObject* inner_array,
+                                               std::size_t i)
+{
+  // OUT_TYPEMAP_STD_VECTOR_OF_STD_VECTOR_OF_PRIMITIVES(TYPE, NUMPY_TYPE)
+  $result = PyList_New($1.size());
+  for (i = 0; i < $1.size(); i++)
+  {
+    adims = $1[i].size();
+    inner_array = PyArray_SimpleNew(1, &adims, NUMPY_TYPE);
+    TYPE* data = static_cast<TYPE*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(inner_array)));
+    std::copy($1[i].begin(), $1[i].end(), data);
+
+    // PyList_SET_ITEM steals the reference to inner_array
+    PyList_SET_ITEM($result, i, inner_array);
+  }
+}
+
+%enddef
+
 //-----------------------------------------------------------------------------
 // Out typemap for std::vector<std::pair<std:string, std:string>
 //-----------------------------------------------------------------------------
@@ -641,3 +670,7 @@ IN_TYPEMAP_STD_VECTOR_OF_SMALL_DOLFIN_TYPES(Point)
 IN_TYPEMAP_STD_VECTOR_OF_SMALL_DOLFIN_TYPES(MeshEntity)
 IN_TYPEMAP_STD_VECTOR_OF_STD_VECTOR_OF_PRIMITIVES(std::size_t, INT32, facets,
                                                   std_size_t)
+IN_TYPEMAP_STD_VECTOR_OF_STD_VECTOR_OF_PRIMITIVES(std::size_t, INT32,
+                                                  new_indices, std_size_t)
+
+OUT_TYPEMAP_STD_VECTOR_OF_STD_VECTOR_OF_PRIMITIVES(std::size_t, NPY_UINTP)
@@ -32,9 +32,10 @@ rely on the dolfin::Form class which is not used on the Python side."""
 # Modified by Joachim B. Haga, 2012.
 #
 # First added:  2007-08-15
-# Last changed: 2013-02-18
+# Last changed: 2013-11-11
 
-__all__ = ["assemble", "assemble_system", "SystemAssembler"]
+__all__ = ["assemble", "assemble_system", "SystemAssembler",
+           "MatrixFreeOperator"]
 
 import types
 
@@ -60,6 +61,8 @@ def assemble(form,
              add_values=False,
              finalize_tensor=True,
              keep_diagonal=False,
+             tensor_batch_size=1,
+             use_assembly_plan=False,
              backend=None,
              form_compiler_parameters=None,
              bcs=None):
@@ -105,6 +108,18 @@ def assemble(form,
     so every diagonal entry can be changed in a future (for example
     by ident() or ident_zeros()).
 
+    If ``tensor_batch_size`` is larger than one, element tensors over
+    cells are computed in batches of the given number of cells and
+    added to the tensor one batch at a time.
+
+    If ``use_assembly_plan`` is set to True, the positions of the
+    element matrix entries in the value storage of the matrix are
+    recorded when a bilinear form is assembled. Later calls with the
+    same ``tensor`` and ``reset_sparsity`` set to False then add the
+    element matrices over cells directly into the value storage. The
+    plan is recomputed if the mesh, the function spaces or the
+    sparsity pattern of the matrix change.
+
     Specific form compiler parameters can be provided by the
     ``form_compiler_parameters`` argument. Form compiler parameters
     can also be controlled using the global parameters stored in
@@ -195,6 +210,8 @@ def assemble(form,
     assembler.add_values = add_values
     assembler.finalize_tensor = finalize_tensor
     assembler.keep_diagonal = keep_diagonal
+    assembler.tensor_batch_size = tensor_batch_size
+    assembler.use_assembly_plan = use_assembly_plan
     assembler.assemble(tensor,
                  dolfin_form)
 
@@ -462,3 +479,26 @@ class SystemAssembler(cpp.SystemAssembler):
 
         # Call C++ assemble function
         cpp.SystemAssembler.__init__(self, A_dolfin_form, b_dolfin_form, bcs)
+
+class MatrixFreeOperator(cpp.MatrixFreeOperator):
+    __doc__ = cpp.MatrixFreeOperator.__doc__
+    def __init__(self, a,
+                 coefficients=None,
+                 function_spaces=None,
+                 form_compiler_parameters=None):
+        """
+        Create a matrix-free operator computing the action of a
+        bilinear form
+
+        * Arguments *
+           a (ufl.Form, _Form_)
+              Bilinear form
+        """
+        # First check if we got a cpp.Form which originates from cpp layer
+        if isinstance(a, cpp.Form) and not hasattr(a, "_compiled_form"):
+            a_dolfin_form = a
+        else:
+            a_dolfin_form = Form(a, function_spaces, coefficients,
+                                 form_compiler_parameters=form_compiler_parameters)
+
+        cpp.MatrixFreeOperator.__init__(self, a_dolfin_form)
@@ -365,6 +365,106 @@ class Assembly(unittest.TestCase):
         self.assertAlmostEqual(assemble(L).norm("l2"), b_l2_norm, 10)
         parameters["num_threads"] = 0
 
+    def test_batched_cell_assembly(self):
+
+        mesh = UnitSquareMesh(7, 5)
+        V = VectorFunctionSpace(mesh, "CG", 2)
+        v = TestFunction(V)
+        u = TrialFunction(V)
+        f = Expression(("x[0]", "x[1]*x[1]"))
+        a = inner(grad(v), grad(u))*dx + inner(f, f)*inner(v, u)*dx
+        L = inner(v, f)*dx
+
+        A_norm = assemble(a).norm("frobenius")
+        b_norm = assemble(L).norm("l2")
+
+        # Batch sizes larger than, dividing and not dividing number of cells
+        for batch_size in [1000, 10, 7]:
+            A = assemble(a, tensor_batch_size=batch_size)
+            b = assemble(L, tensor_batch_size=batch_size)
+            self.assertAlmostEqual(A.norm("frobenius"), A_norm, 10)
+            self.assertAlmostEqual(b.norm("l2"), b_norm, 10)
+
+        # Backends that merge the blocks of a batch
+        if MPI.num_processes() == 1:
+            for Tensor in [uBLASSparseMatrix, uBLASDenseMatrix]:
+                A = Tensor()
+                assemble(a, tensor=A, tensor_batch_size=10)
+                self.assertAlmostEqual(A.norm("frobenius"), A_norm, 10)
+
+    def test_assembly_plan(self):
+
+        mesh = UnitSquareMesh(6, 6)
+        V = FunctionSpace(mesh, "CG", 2)
+        v = TestFunction(V)
+        u = TrialFunction(V)
+        c = Constant(1.0)
+        a = c*inner(grad(v), grad(u))*dx + v*u*ds
+
+        A = assemble(a, use_assembly_plan=True)
+        A_norm = A.norm("frobenius")
+
+        # Reassembly with plan, including after changing a coefficient
+        for value in [1.0, 2.0]:
+            c.assign(value)
+            assemble(a, tensor=A, reset_sparsity=False, use_assembly_plan=True)
+            B = assemble(a)
+            self.assertAlmostEqual(A.norm("frobenius"), B.norm("frobenius"), 10)
+
+        # Plan must be rebuilt for a new mesh and function space
+        mesh = UnitSquareMesh(4, 6)
+        V = FunctionSpace(mesh, "CG", 2)
+        v = TestFunction(V)
+        u = TrialFunction(V)
+        a = inner(grad(v), grad(u))*dx
+        A = assemble(a, use_assembly_plan=True)
+        assemble(a, tensor=A, reset_sparsity=False, use_assembly_plan=True)
+        self.assertAlmostEqual(A.norm("frobenius"),
+                               assemble(a).norm("frobenius"), 10)
+
+        # Plan must be rebuilt when the matrix is reinitialized with
+        # another sparsity pattern (same mesh and dofmaps)
+        a_dS = inner(grad(v), grad(u))*dx + jump(v)*jump(u)*dS
+        assemble(a_dS, tensor=A)
+        assemble(a, tensor=A, reset_sparsity=False, use_assembly_plan=True)
+        self.assertAlmostEqual(A.norm("frobenius"),
+                               assemble(a).norm("frobenius"), 10)
+
+    def test_work_stealing_assembly(self):
+
+        # Work stealing assembler not supported in parallel
+        if MPI.num_processes() != 1:
+            return
+
+        mesh = UnitCubeMesh(4, 4, 4)
+        V = FunctionSpace(mesh, "CG", 2)
+        v = TestFunction(V)
+        u = TrialFunction(V)
+        f = Constant(10.0)
+        a = inner(grad(v), grad(u))*dx + v*u*ds
+        L = v*f*dx + v*f*ds
+        M = f*dx + f*ds
+        n = FacetNormal(mesh)
+        h = CellSize(mesh)
+        h_avg = (h('+') + h('-'))/2
+        S = inner(jump(grad(v), n), jump(grad(u), n))/h_avg*dS
+
+        # Reference values from serial assembly
+        A_norm = assemble(a).norm("frobenius")
+        b_norm = assemble(L).norm("l2")
+        m = assemble(M)
+        S_norm = assemble(S).norm("frobenius")
+
+        # Assemble multi-threaded with work stealing
+        parameters["threaded_assembler"] = "work_stealing"
+        parameters["num_threads"] = 4
+        self.assertAlmostEqual(assemble(a).norm("frobenius"), A_norm, 10)
+        self.assertAlmostEqual(assemble(L).norm("l2"), b_norm, 10)
+        self.assertAlmostEqual(assemble(M), m, 10)
+        self.assertAlmostEqual(assemble(S).norm("frobenius"), S_norm, 10)
+        parameters["num_threads"] = 0
+        parameters["threaded_assembler"] = "coloring"
+
     def test_nonsquare_assembly(self):
         """Test assembly of a rectangular matrix"""
 
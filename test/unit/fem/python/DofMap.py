@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2009-07-28
-# Last changed: 2009-07-28
+# Last changed: 2013-12-11
 
 import unittest
 import numpy as np
@@ -281,6 +281,109 @@ class DofMapTest(unittest.TestCase):
             dofs = V.dofmap().tabulate_entity_dofs(0, i)
             self.assertTrue(all(d==cd for d, cd in zip(dofs, cdofs)))
 
+    def test_dof_ordering(self):
+        "Dof ordering strategies"
+
+        mesh = UnitSquareMesh(6, 6)
+        f = Expression(("x[0]*x[0]", "x[1]*x[0]"), degree=2)
+
+        def bandwidth(V):
+            return max(max(V.dofmap().cell_dofs(c.index()))
+                       - min(V.dofmap().cell_dofs(c.index()))
+                       for c in cells(mesh))
+
+        library = parameters["dof_ordering_library"]
+        reorder = parameters["reorder_dofs_serial"]
+        parameters["reorder_dofs_serial"] = True
+        try:
+            bandwidths = {}
+            for ordering in parameters.get_range("dof_ordering_library"):
+                if ordering == "SCOTCH" and not has_scotch():
+                    continue
+                parameters["dof_ordering_library"] = ordering
+                V = VectorFunctionSpace(mesh, "CG", 2)
+                self.assertEqual(V.dim(), 2*13*13)
+
+                if MPI.num_processes() == 1:
+                    # Dofs are a permutation of 0, ..., dim - 1
+                    all_dofs = set()
+                    for cell in cells(mesh):
+                        all_dofs.update(V.dofmap().cell_dofs(cell.index()))
+                    self.assertEqual(sorted(all_dofs), range(V.dim()))
+
+                    # Components are interleaved
+                    for cell in cells(mesh):
+                        dofs = V.dofmap().cell_dofs(cell.index())
+                        n = len(dofs)/2
+                        for i in range(n):
+                            self.assertEqual(dofs[i] % 2, 0)
+                            self.assertEqual(dofs[n + i], dofs[i] + 1)
+
+                    # First touch numbers the nodes of cell 0 first
+                    if ordering == "first_touch":
+                        dofs = V.dofmap().cell_dofs(0)
+                        n = len(dofs)/2
+                        self.assertEqual(sorted(dofs[:n]/2), range(n))
+
+                    bandwidths[ordering] = bandwidth(V)
+
+                # Interpolation is exact
+                u = interpolate(f, V)
+                x = Point(0.3, 0.7)
+                self.assertAlmostEqual(u(x)[0], f(x)[0])
+                self.assertAlmostEqual(u(x)[1], f(x)[1])
+
+            # Bandwidth reducing orderings beat a random ordering
+            if MPI.num_processes() == 1:
+                for ordering in ("Boost", "SCOTCH"):
+                    if ordering in bandwidths:
+                        self.assertTrue(bandwidths[ordering]
+                                        < bandwidths["random"])
+        finally:
+            parameters["dof_ordering_library"] = library
+            parameters["reorder_dofs_serial"] = reorder
+
+    def test_refined_dofmap(self):
+        "Dofmap on refined mesh reusing parent numbering"
+        if MPI.num_processes() > 1:
+            return
+
+        mesh = UnitSquareMesh(8, 8)
+        markers = CellFunction("bool", mesh, False)
+        for cell in cells(mesh):
+            markers[cell] = cell.midpoint().x() < 0.3
+
+        f = Expression("x[0]*x[0] + 2*x[1]*x[1]*x[0]", degree=3)
+        for family, degree in [("CG", 2), ("CG", 3)]:
+            for V in [FunctionSpace(mesh, family, degree),
+                      VectorFunctionSpace(mesh, family, degree)]:
+                reorder = parameters["reorder_dofs_refined"]
+                parameters["reorder_dofs_refined"] = False
+                try:
+                    W = adapt(V, markers)
+                finally:
+                    parameters["reorder_dofs_refined"] = reorder
+
+                # Numbering of parent is kept on a cell far from the
+                # refined region
+                parent = Cell(mesh, mesh.num_cells() - 1)
+                parent_dofs = V.dofmap().cell_dofs(parent.index())
+                num_matches = 0
+                for cell in cells(W.mesh()):
+                    if cell.midpoint().distance(parent.midpoint()) < DOLFIN_EPS:
+                        dofs = W.dofmap().cell_dofs(cell.index())
+                        self.assertEqual(list(np.argsort(dofs)),
+                                         list(np.argsort(parent_dofs)))
+                        num_matches += 1
+                self.assertEqual(num_matches, 1)
+
+                # Dofmap is consistent
+                if V.num_sub_spaces() == 0:
+                    u = interpolate(f, W)
+                    for vertex in vertices(W.mesh()):
+                        x = vertex.point()
+                        self.assertAlmostEqual(u(x), f(x))
+
     def test_mpi_dofmap_stats(self):
         if MPI.num_processes() > 1:
             
@@ -0,0 +1,97 @@
+"""Unit tests for MatrixFreeOperator"""
+
+# Copyright (C) 2013 The DOLFIN authors
+#
+# This file is part of DOLFIN.
+#
+# DOLFIN is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DOLFIN is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+#
+# First added:  2013-11-11
+# Last changed: 2013-11-11
+
+import unittest
+import numpy
+from dolfin import *
+
+# Backends supporting the LinearOperator interface
+backends = ["PETSc", "uBLAS"]
+
+class MatrixFreeOperatorTest(unittest.TestCase):
+
+    def test_action(self):
+
+        mesh = UnitSquareMesh(6, 5)
+        V = FunctionSpace(mesh, "CG", 2)
+        v = TestFunction(V)
+        u = TrialFunction(V)
+        c = Expression("1.0 + x[0]")
+        a = c*inner(grad(v), grad(u))*dx + v*u*ds
+
+        A = assemble(a)
+        x = Function(V).vector()
+        x[:] = numpy.arange(V.dim(), dtype="d")
+        y_ref = Vector()
+        A.mult(x, y_ref)
+
+        # Serial and multithreaded cell loop
+        for num_threads in [0, 3]:
+            parameters["num_threads"] = num_threads
+            O = MatrixFreeOperator(a)
+            self.assertEqual(O.size(0), V.dim())
+            y = Vector()
+            O.mult(x, y)
+            self.assertAlmostEqual((y - y_ref).norm("l2")/y_ref.norm("l2"),
+                                   0.0, 12)
+        parameters["num_threads"] = 0
+
+    def test_krylov_solve(self):
+
+        default_backend = parameters["linear_algebra_backend"]
+        for backend in backends:
+
+            # Check whether backend is available
+            if not has_linear_algebra_backend(backend):
+                continue
+
+            # Skip testing uBLAS in parallel
+            if MPI.num_processes() > 1 and backend == "uBLAS":
+                continue
+
+            parameters["linear_algebra_backend"] = backend
+
+            mesh = UnitSquareMesh(8, 8)
+            V = FunctionSpace(mesh, "Lagrange", 1)
+            u = TrialFunction(V)
+            v = TestFunction(V)
+            f = Constant(1.0)
+            a = dot(grad(u), grad(v))*dx + u*v*dx
+            L = f*v*dx
+            b = assemble(L)
+
+            x = Vector()
+            solve(assemble(a), x, b, "gmres", "none")
+            norm_ref = norm(x, "l2")
+
+            O = MatrixFreeOperator(a)
+            x = Function(V).vector()
+            solve(O, x, b, "gmres", "none")
+            self.assertAlmostEqual(norm(x, "l2"), norm_ref, 10)
+
+        parameters["linear_algebra_backend"] = default_backend
+
+if __name__ == "__main__":
+    print ""
+    print "Testing class MatrixFreeOperator"
+    print "--------------------------------"
+    unittest.main()
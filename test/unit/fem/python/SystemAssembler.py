@@ -21,7 +21,7 @@
 # Modified by Anders Logg 2011
 #
 # First added:  2011-10-04
-# Last changed: 2013-06-02
+# Last changed: 2013-11-12
 
 import unittest
 import numpy
@@ -226,6 +226,42 @@ class TestSystemAssembler(unittest.TestCase):
             self.assertAlmostEqual(error, 0.0)
 
 
+    def test_reuse_boundary_matrices(self):
+
+        mesh = UnitSquareMesh(16, 16)
+        V = FunctionSpace(mesh, "Lagrange", 1)
+        u, v = TrialFunction(V), TestFunction(V)
+        f = Constant(1.0)
+        g = Expression("t*x[0]", t=1.0)
+        bc = DirichletBC(V, g, "on_boundary")
+
+        a = inner(grad(u), grad(v))*dx
+        L = f*v*dx
+
+        assembler = SystemAssembler(a, L, bc)
+        assembler.reuse_boundary_matrices = True
+
+        # Assemble system (stores boundary matrices)
+        A, b = Matrix(), Vector()
+        assembler.assemble(A, b)
+
+        # Assemble RHS only for changed data, with and without reuse
+        for t in [2.0, 3.0]:
+            f.assign(t)
+            g.t = t
+            b_reuse = Vector()
+            assembler.assemble(b_reuse)
+            _, b_ref = assemble_system(a, L, bc)
+            b_reuse.axpy(-1.0, b_ref)
+            self.assertAlmostEqual(b_reuse.norm("linf"), 0.0, 10)
+
+        # Clearing stored matrices recomputes them
+        assembler.clear_boundary_matrices()
+        b_reuse = Vector()
+        assembler.assemble(b_reuse)
+        b_reuse.axpy(-1.0, b_ref)
+        self.assertAlmostEqual(b_reuse.norm("linf"), 0.0, 10)
+
 if __name__ == "__main__":
     print ""
     print "Testing class SystemAssembler"
@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2011-03-23
-# Last changed: 2011-03-23
+# Last changed: 2013-12-11
 
 import unittest
 from dolfin import *
@@ -241,6 +241,28 @@ class Interface(unittest.TestCase):
         self.assertRaises(TypeError, u0, [0,0,0,0])
         self.assertRaises(TypeError, u0, [0,0])
 
+    def test_eval_many(self):
+        if MPI.num_processes() > 1:
+            return
+        import numpy
+        u = Function(W)
+        u.interpolate(Expression(("x[0]*x[1]", "x[1]*x[2]", "x[2]*x[0]")))
+
+        # Random points followed by points along a line
+        numpy.random.seed(1)
+        x = numpy.random.rand(50, 3)
+        t = numpy.linspace(0.0, 1.0, 50)
+        x = numpy.vstack((x, numpy.array([t, 0.3 + 0*t, 1.0 - t]).T))
+
+        values = numpy.zeros(3*len(x))
+        u.eval_many(values, x.flatten())
+        for i in range(len(x)):
+            for j in range(3):
+                self.assertAlmostEqual(values[3*i + j], u(x[i])[j])
+
+        self.assertRaises(RuntimeError, u.eval_many, numpy.zeros(2),
+                          x.flatten())
+
 class ScalarFunctions(unittest.TestCase):
     def test_constant_float_conversion(self):
         c = Constant(3.45)
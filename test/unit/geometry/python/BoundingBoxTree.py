@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2013-04-15
-# Last changed: 2013-11-14
+# Last changed: 2013-12-10
 
 import unittest
 import numpy
@@ -27,6 +27,7 @@ from dolfin import BoundingBoxTree
 from dolfin import UnitIntervalMesh, UnitSquareMesh, UnitCubeMesh
 from dolfin import Point
 from dolfin import MPI
+from dolfin import parameters
 
 class BoundingBoxTreeTest(unittest.TestCase):
 
@@ -378,6 +379,124 @@ class BoundingBoxTreeTest(unittest.TestCase):
             self.assertEqual(entity, reference[0])
             self.assertAlmostEqual(distance, reference[1])
 
+    #--- batched queries with list of points ---
+
+    def test_compute_batched_collisions_2d(self):
+
+        numpy.random.seed(1)
+        points = [Point(*x) for x in numpy.random.rand(100, 2)]
+        mesh = UnitSquareMesh(16, 16)
+        tree = BoundingBoxTree()
+        tree.build(mesh)
+
+        entities, offsets = tree.compute_collisions(points)
+        self.assertEqual(len(offsets), len(points) + 1)
+        for i, p in enumerate(points):
+            self.assertEqual(sorted(entities[offsets[i]:offsets[i + 1]]),
+                             sorted(tree.compute_collisions(p)))
+
+        entities, offsets = tree.compute_entity_collisions(points)
+        for i, p in enumerate(points):
+            self.assertEqual(sorted(entities[offsets[i]:offsets[i + 1]]),
+                             sorted(tree.compute_entity_collisions(p)))
+
+    def test_compute_batched_first_entity_collision_3d(self):
+
+        numpy.random.seed(2)
+        x = 1.2*numpy.random.rand(100, 3) - 0.1
+        points = [Point(*_x) for _x in x]
+        mesh = UnitCubeMesh(8, 8, 8)
+        tree = BoundingBoxTree()
+        tree.build(mesh)
+
+        entities = tree.compute_first_entity_collision(points)
+        for i, p in enumerate(points):
+            self.assertEqual(entities[i],
+                             tree.compute_first_entity_collision(p))
+
+    def test_compute_batched_closest_entity_3d(self):
+
+        numpy.random.seed(3)
+        x = 1.4*numpy.random.rand(100, 3) - 0.2
+        points = [Point(*_x) for _x in x]
+        mesh = UnitCubeMesh(8, 8, 8)
+        tree = BoundingBoxTree()
+        tree.build(mesh)
+
+        entities, distances = tree.compute_closest_entity(points)
+        for i, p in enumerate(points):
+            entity, distance = tree.compute_closest_entity(p)
+            self.assertEqual(entities[i], entity)
+            self.assertAlmostEqual(distances[i], distance)
+
+    #--- parallel build and refit ---
+
+    def test_build_parallel_3d(self):
+
+        numpy.random.seed(4)
+        points = [Point(*x) for x in numpy.random.rand(50, 3)]
+        mesh = UnitCubeMesh(12, 12, 12)
+        tree = BoundingBoxTree()
+        tree.build(mesh)
+
+        num_threads = parameters["num_threads"]
+        parameters["num_threads"] = 3
+        tree_parallel = BoundingBoxTree()
+        tree_parallel.build(mesh)
+        parameters["num_threads"] = num_threads
+
+        for p in points:
+            self.assertEqual(tree_parallel.compute_first_entity_collision(p),
+                             tree.compute_first_entity_collision(p))
+            self.assertEqual(sorted(tree_parallel.compute_collisions(p)),
+                             sorted(tree.compute_collisions(p)))
+
+    def test_refit_2d(self):
+
+        numpy.random.seed(5)
+        points = [Point(*x) for x in 2.0*numpy.random.rand(50, 2)]
+        mesh = UnitSquareMesh(16, 16)
+        tree = BoundingBoxTree()
+        tree.build(mesh)
+
+        # Stretch mesh and refit tree
+        x = mesh.coordinates()
+        x[:, 0] *= 2.0
+        x[:, 1] = 2.0*x[:, 1]**2
+        tree.refit()
+
+        tree_rebuilt = BoundingBoxTree()
+        tree_rebuilt.build(mesh)
+        for p in points:
+            self.assertEqual(sorted(tree.compute_entity_collisions(p)),
+                             sorted(tree_rebuilt.compute_entity_collisions(p)))
+            self.assertAlmostEqual(tree.compute_closest_entity(p)[1],
+                                   tree_rebuilt.compute_closest_entity(p)[1])
+
+    def test_refit_vertices_2d(self):
+
+        mesh = UnitSquareMesh(8, 8)
+        tree = BoundingBoxTree()
+        tree.build(mesh, 0)
+
+        # Stretch mesh and refit tree
+        x = mesh.coordinates()
+        x[:, 0] *= 2.0
+        x[:, 1] = 2.0*x[:, 1]**2
+        tree.refit()
+
+        for i, x_i in enumerate(mesh.coordinates()):
+            self.assertTrue(i in tree.compute_collisions(Point(*x_i)))
+
+    def test_translate_refits_mesh_tree(self):
+
+        mesh = UnitSquareMesh(8, 8)
+        tree = mesh.bounding_box_tree()
+        mesh.translate(Point(2.0, 0.0))
+        self.assertEqual(len(tree.compute_entity_collisions(Point(0.5, 0.5))), 0)
+        if MPI.num_processes() == 1:
+            self.assertTrue(len(tree.compute_entity_collisions(Point(2.5, 0.5))) > 0)
+
 if __name__ == "__main__":
     print ""
     print "Testing BoundingBoxTree"
@@ -146,6 +146,61 @@ if has_hdf5():
             result = F0.vector() - F1.vector()
             self.assertTrue(result.array().all() == 0)
 
+        def test_save_and_read_compressed_function(self):
+            mesh = UnitSquareMesh(10,10)
+            Q = FunctionSpace(mesh, "CG", 3)
+            F0 = Function(Q)
+            F1 = Function(Q)
+            E = Expression("x[0]")
+            F0.interpolate(E)
+
+            # Save to compressed HDF5 File
+            hdf5_file = HDF5File("function_compressed.h5", "w")
+            hdf5_file.parameters["compression"] = 4
+            hdf5_file.write(F0, "function")
+            hdf5_file.write(mesh, "mesh")
+            del hdf5_file
+
+            # Read back from file
+            hdf5_file = HDF5File("function_compressed.h5", "r")
+            hdf5_file.read(F1, "function")
+            result = F0.vector() - F1.vector()
+            self.assertAlmostEqual(result.norm("linf"), 0.0)
+            mesh1 = Mesh()
+            hdf5_file.read(mesh1, "mesh")
+            self.assertEqual(mesh.size_global(2), mesh1.size_global(2))
+
+        def test_save_and_read_function_series(self):
+            mesh = UnitSquareMesh(10,10)
+            Q = FunctionSpace(mesh, "CG", 2)
+            F0 = Function(Q)
+            F1 = Function(Q)
+
+            # Stage five steps, with room for two steps in the buffer
+            hdf5_file = HDF5File("function_series.h5", "w")
+            hdf5_file.parameters["series_buffer_size"] = 2
+            for i in range(5):
+                F0.interpolate(Expression("t*x[0]", t=float(i)))
+                hdf5_file.write(F0, "function", 0.1*i)
+            hdf5_file.flush()
+
+            # Steps are rows of a single dataset
+            self.assertTrue(hdf5_file.has_dataset("function/vector_series"))
+            self.assertFalse(hdf5_file.has_dataset("function/vector_1"))
+            self.assertTrue(hdf5_file.has_dataset("function/timestamps"))
+            times = hdf5_file.read_timestamps("function")
+            self.assertEqual(len(times), 5)
+            self.assertAlmostEqual(times[3], 0.3)
+            del hdf5_file
+
+            # Read back steps from file
+            hdf5_file = HDF5File("function_series.h5", "r")
+            for i in range(5):
+                F0.interpolate(Expression("t*x[0]", t=float(i)))
+                hdf5_file.read(F1, "function", i)
+                result = F0.vector() - F1.vector()
+                self.assertAlmostEqual(result.norm("linf"), 0.0)
+
     class HDF5_Mesh(unittest.TestCase):
 
         def test_save_and_read_mesh_2D(self):
@@ -20,9 +20,10 @@
 # Modified by Anders Logg 2012
 #
 # First added:  2012-02-21
-# Last changed: 2012-08-27
+# Last changed: 2013-12-11
 
 import unittest
+import numpy
 from dolfin import *
 
 # Assemble system
@@ -75,6 +76,261 @@ if has_linear_algebra_backend("PETSc"):
                 solver.solve(A, x_petsc, as_backend_type(b))
                 self.assertAlmostEqual(x_petsc.norm("l2"), direct_norm, 5)
 
+        def test_pipelined_krylov_solver(self):
+            "Test pipelined methods of PETScKrylovSolver"
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            methods = [method for method, descr in PETScKrylovSolver.methods()]
+            for method in ["pipecg", "pgmres"]:
+                if not method in methods:
+                    continue
+                x_petsc = PETScVector()
+                solver = PETScKrylovSolver(method, "jacobi")
+                solver.parameters["relative_tolerance"] = 1e-10
+                solver.solve(A, x_petsc, as_backend_type(b))
+                self.assertAlmostEqual(x_petsc.norm("l2"), direct_norm, 5)
+
+if MPI.num_processes() == 1:
+    class uBLASKrylovSolverTester(unittest.TestCase):
+
+        def test_amg_preconditioner(self):
+            "Test uBLASKrylovSolver with AMG preconditioner"
+            # Solve first using direct solver
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble uBLAS system
+            A_ublas = assemble(a, backend=uBLASSparseFactory.instance())
+            b_ublas = assemble(L, backend=uBLASSparseFactory.instance())
+            bc.apply(A_ublas, b_ublas)
+
+            solver = uBLASKrylovSolver("bicgstab", "amg")
+            solver.parameters["relative_tolerance"] = 1e-10
+            for structure in ["different_nonzero_pattern",
+                              "same_nonzero_pattern", "same"]:
+                for smoother in ["chebyshev", "jacobi"]:
+                    solver.parameters["preconditioner"]["structure"] = structure
+                    solver.parameters["preconditioner"]["amg"]["smoother"] = smoother
+                    x_ublas = uBLASVector()
+                    num_iterations = solver.solve(A_ublas, x_ublas, b_ublas)
+                    self.assertAlmostEqual(x_ublas.norm("l2"), direct_norm, 5)
+                    self.assertTrue(num_iterations < 20)
+
+        def test_ilu_preconditioner(self):
+            "Test uBLASKrylovSolver with ILU(k) preconditioner"
+            # Assemble a system that is large enough for the level
+            # scheduled ILU to use several threads (1024 rows per thread)
+            mesh = UnitSquareMesh(64, 64)
+            V = FunctionSpace(mesh, 'CG', 1)
+            bc = DirichletBC(V, Constant(0.0), lambda x, on_boundary: on_boundary)
+            u, v = TrialFunction(V), TestFunction(V)
+            a, L = inner(grad(u), grad(v))*dx, Constant(1.0)*v*dx
+            self.assertTrue(V.dim() >= 4*1024)
+
+            # Solve first using direct solver
+            A = assemble(a)
+            b = assemble(L)
+            bc.apply(A, b)
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble uBLAS system
+            A_ublas = assemble(a, backend=uBLASSparseFactory.instance())
+            b_ublas = assemble(L, backend=uBLASSparseFactory.instance())
+            bc.apply(A_ublas, b_ublas)
+
+            solver = uBLASKrylovSolver("gmres", "ilu")
+            solver.parameters["relative_tolerance"] = 1e-10
+            ilu_parameters = solver.parameters["preconditioner"]["ilu"]
+            num_threads = parameters["num_threads"]
+            iterations = []
+            try:
+                for fill_level in [0, 1, 2]:
+                    ilu_parameters["fill_level"] = fill_level
+
+                    # Sequential solve with one thread
+                    parameters["num_threads"] = 1
+                    ilu_parameters["schedule"] = "sequential"
+                    x_sequential = uBLASVector()
+                    sequential_iterations = solver.solve(A_ublas, x_sequential,
+                                                         b_ublas)
+                    self.assertAlmostEqual(x_sequential.norm("l2"),
+                                           direct_norm, 5)
+
+                    # Level scheduled solve with four threads
+                    parameters["num_threads"] = 4
+                    ilu_parameters["schedule"] = "level"
+                    x_level = uBLASVector()
+                    iterations.append(solver.solve(A_ublas, x_level, b_ublas))
+
+                    # Level scheduling does not change the factorization
+                    self.assertEqual(iterations[-1], sequential_iterations)
+                    x_level.axpy(-1.0, x_sequential)
+                    self.assertAlmostEqual(x_level.norm("linf"), 0.0, 10)
+            finally:
+                parameters["num_threads"] = num_threads
+
+            # Fill-in reduces the number of iterations
+            self.assertTrue(iterations[1] < iterations[0])
+            self.assertTrue(iterations[2] < iterations[0])
+
+        def test_pipelined_krylov_solver(self):
+            "Test pipelined methods of PETScKrylovSolver"
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            methods = [method for method, descr in PETScKrylovSolver.methods()]
+            for method in ["pipecg", "pgmres"]:
+                if not method in methods:
+                    continue
+                x_petsc = PETScVector()
+                solver = PETScKrylovSolver(method, "jacobi")
+                solver.parameters["relative_tolerance"] = 1e-10
+                solver.solve(A, x_petsc, as_backend_type(b))
+                self.assertAlmostEqual(x_petsc.norm("l2"), direct_norm, 5)
+
+if MPI.num_processes() == 1:
+    class uBLASKrylovSolverTester(unittest.TestCase):
+
+        def test_amg_preconditioner(self):
+            "Test uBLASKrylovSolver with AMG preconditioner"
+            # Solve first using direct solver
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble uBLAS system
+            A_ublas = assemble(a, backend=uBLASSparseFactory.instance())
+            b_ublas = assemble(L, backend=uBLASSparseFactory.instance())
+            bc.apply(A_ublas, b_ublas)
+
+            solver = uBLASKrylovSolver("bicgstab", "amg")
+            solver.parameters["relative_tolerance"] = 1e-10
+            for structure in ["different_nonzero_pattern",
+                              "same_nonzero_pattern", "same"]:
+                for smoother in ["chebyshev", "jacobi"]:
+                    solver.parameters["preconditioner"]["structure"] = structure
+                    solver.parameters["preconditioner"]["amg"]["smoother"] = smoother
+                    x_ublas = uBLASVector()
+                    num_iterations = solver.solve(A_ublas, x_ublas, b_ublas)
+                    self.assertAlmostEqual(x_ublas.norm("l2"), direct_norm, 5)
+                    self.assertTrue(num_iterations < 20)
+
+        def test_ilu_preconditioner(self):
+            "Test uBLASKrylovSolver with ILU(k) preconditioner"
+            # Solve first using direct solver
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble uBLAS system
+            A_ublas = assemble(a, backend=uBLASSparseFactory.instance())
+            b_ublas = assemble(L, backend=uBLASSparseFactory.instance())
+            bc.apply(A_ublas, b_ublas)
+
+            solver = uBLASKrylovSolver("gmres", "ilu")
+            solver.parameters["relative_tolerance"] = 1e-10
+            for fill_level in [0, 1, 2]:
+                solver.parameters["preconditioner"]["ilu"]["fill_level"] = fill_level
+                iterations = []
+                for schedule in ["sequential", "level"]:
+                    solver.parameters["preconditioner"]["ilu"]["schedule"] = schedule
+                    x_ublas = uBLASVector()
+                    iterations.append(solver.solve(A_ublas, x_ublas, b_ublas))
+                    self.assertAlmostEqual(x_ublas.norm("l2"), direct_norm, 5)
+
+                # Level scheduling does not change the factorization
+                self.assertEqual(iterations[0], iterations[1])
+
+        def test_pipelined_krylov_solver(self):
+            "Test pipelined methods of uBLASKrylovSolver"
+            # Solve first using direct solver
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble symmetric uBLAS system
+            A_ublas, b_ublas = assemble_system(a, L, bc,
+                                   backend=uBLASSparseFactory.instance())
+
+            iterations = {}
+            for method in ["pipecg", "pgmres", "gmres"]:
+                solver = uBLASKrylovSolver(method, "ilu")
+                solver.parameters["relative_tolerance"] = 1e-10
+                x_ublas = uBLASVector()
+                iterations[method] = solver.solve(A_ublas, x_ublas, b_ublas)
+                self.assertAlmostEqual(x_ublas.norm("l2"), direct_norm, 5)
+
+            # Single reduction GMRES takes the same number of
+            # iterations as GMRES in exact arithmetic
+            self.assertTrue(abs(iterations["pgmres"] - iterations["gmres"]) <= 2)
+
+        def test_multiple_rhs(self):
+            "Test uBLASKrylovSolver with multiple right-hand sides"
+            # Assemble symmetric uBLAS system
+            A_ublas, b_ublas = assemble_system(a, L, bc,
+                                   backend=uBLASSparseFactory.instance())
+
+            # Create right-hand sides and solve one at a time
+            k = 4
+            B = MultiVector(b_ublas, k)
+            single_norms, single_iterations = [], []
+            for j in range(k):
+                b_j = b_ublas.copy()
+                b_j.set_local(b_ublas.array()*numpy.linspace(1.0, 2.0, b_ublas.size())**j)
+                B.set(b_j, j)
+                x_j = uBLASVector()
+                solver = uBLASKrylovSolver("pipecg", "ilu")
+                solver.parameters["relative_tolerance"] = 1e-10
+                single_iterations.append(solver.solve(A_ublas, x_j, b_j))
+                single_norms.append(x_j.norm("l2"))
+
+            # Solve with block CG and with one method per right-hand side
+            for method in ["cg", "bicgstab"]:
+                X = MultiVector()
+                solver = uBLASKrylovSolver(method, "ilu")
+                solver.parameters["relative_tolerance"] = 1e-10
+                iterations = solver.solve(A_ublas, X, B)
+                self.assertEqual(X.num_vectors(), k)
+                x_j = b_ublas.copy()
+                for j in range(k):
+                    X.get(x_j, j)
+                    self.assertAlmostEqual(x_j.norm("l2"), single_norms[j], 5)
+
+                # Block CG searches a larger Krylov space
+                if method == "cg":
+                    self.assertTrue(iterations <= max(single_iterations))
+
+    class CSRKrylovSolverTester(unittest.TestCase):
+
+        def test_krylov_solver(self):
+            "Test uBLASKrylovSolver with CSR matrix"
+            # Solve first using direct solver
+            x = Vector()
+            solve(A, x, b, "lu")
+            direct_norm = x.norm("l2")
+
+            # Assemble CSR system
+            A_csr = assemble(a, backend=CSRFactory.instance())
+            b_csr = assemble(L, backend=CSRFactory.instance())
+            bc.apply(A_csr, b_csr)
+            self.assertTrue(isinstance(as_backend_type(A_csr), CSRMatrix))
+            self.assertAlmostEqual(A_csr.norm("frobenius"),
+                                   A.norm("frobenius"), 10)
+
+            for prec in ["none", "ilu", "amg"]:
+                for method in ["cg", "gmres", "bicgstab", "pgmres"]:
+                    x_csr = CSRVector()
+                    solver = uBLASKrylovSolver(method, prec)
+                    solver.parameters["relative_tolerance"] = 1e-10
+                    solver.solve(A_csr, x_csr, b_csr)
+                    self.assertAlmostEqual(x_csr.norm("l2"), direct_norm, 5)
+
 if __name__ == "__main__":
 
     # Turn off DOLFIN output
@@ -22,9 +22,10 @@
 # Modified by Jan Blechta 2013
 #
 # First added:  2011-03-03
-# Last changed: 2013-03-30
+# Last changed: 2013-12-11
 
 import unittest
+import numpy
 from dolfin import *
 
 class AbstractBaseTest(object):
@@ -305,6 +306,9 @@ if MPI.num_processes() == 1:
         backend     = "uBLAS"
         sub_backend = "Dense"
 
+    class CSRTester(DataTester, AbstractBaseTest, unittest.TestCase):
+        backend     = "CSR"
+
     if has_linear_algebra_backend("PETScCusp"):
         class PETScCuspTester(DataNotWorkingTester, AbstractBaseTest, unittest.TestCase):
             backend    = "PETScCusp"
@@ -313,6 +317,43 @@ if has_linear_algebra_backend("PETSc"):
     class PETScTester(DataNotWorkingTester, AbstractBaseTest, unittest.TestCase):
         backend    = "PETSc"
 
+        def test_block_matrix(self):
+            "Test that block (BAIJ) matrices give the same operator"
+            mesh = UnitCubeMesh(4, 4, 4)
+            V = VectorFunctionSpace(mesh, "Lagrange", 1)
+            u, v = TrialFunction(V), TestFunction(V)
+            a = inner(grad(u), grad(v))*dx + inner(u, v)*dx
+
+            block_matrices = parameters["block_matrices"]
+            reorder_dofs = parameters["reorder_dofs_serial"]
+            parameters["reorder_dofs_serial"] = True
+            try:
+                parameters["block_matrices"] = False
+                A = assemble(a)
+                parameters["block_matrices"] = True
+                B = assemble(a)
+            finally:
+                parameters["block_matrices"] = block_matrices
+                parameters["reorder_dofs_serial"] = reorder_dofs
+
+            # Check that the block format was selected
+            A_petsc, B_petsc = as_backend_type(A), as_backend_type(B)
+            self.assertTrue(isinstance(B_petsc, PETScMatrix))
+            self.assertEqual(A_petsc.block_size(), 1)
+            self.assertEqual(B_petsc.block_size(), 3)
+            if has_petsc4py():
+                self.assertTrue("baij" in B_petsc.mat().getType())
+                self.assertEqual(B_petsc.mat().getBlockSize(), 3)
+
+            self.assertAlmostEqual(A.norm("frobenius"), B.norm("frobenius"))
+            x = Function(V).vector()
+            x.set_local(numpy.arange(x.local_size(), dtype="d"))
+            y, z = Vector(), Vector()
+            A.mult(x, y)
+            B.mult(x, z)
+            y.axpy(-1.0, z)
+            self.assertAlmostEqual(y.norm("linf"), 0.0)
+
 if has_linear_algebra_backend("Epetra"):
     class EpetraTester(DataNotWorkingTester, AbstractBaseTest, unittest.TestCase):
         backend    = "Epetra"
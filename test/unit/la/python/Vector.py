@@ -20,7 +20,7 @@
 # Modified by Anders Logg 2011
 #
 # First added:  2011-03-01
-# Last changed: 2011-11-17
+# Last changed: 2013-12-11
 
 import unittest
 from dolfin import *
@@ -357,6 +357,9 @@ if MPI.num_processes() == 1:
         backend     = "uBLAS"
         sub_backend = "Dense"
 
+    class CSRTester(DataTester, AbstractBaseTest, unittest.TestCase):
+        backend     = "CSR"
+
     if has_linear_algebra_backend("PETScCusp"):
         class PETScCuspTester(DataNotWorkingTester, AbstractBaseTest, unittest.TestCase):
             backend    = "PETScCusp"
@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2011-12-21
-# Last changed:se
+# Last changed: 2013-12-11
 
 import unittest
 from dolfin import *
@@ -43,6 +43,33 @@ class solveTest(unittest.TestCase):
         self.assertAlmostEqual(factor, sqrt(size*value*value))
         self.assertAlmostEqual(x.norm("l2"), 1.0)
 
+    def test_multiple_rhs(self):
+        mesh = UnitSquareMesh(16, 16)
+        V = FunctionSpace(mesh, "CG", 1)
+        u, v = TrialFunction(V), TestFunction(V)
+        A = assemble(inner(grad(u), grad(v))*dx + u*v*dx)
+
+        # Right-hand sides
+        k = 3
+        sources = [Constant(1.0), Expression("x[0]"), Expression("x[0]*x[1]")]
+        B = MultiVector(assemble(sources[0]*v*dx), k)
+        x = Vector()
+        norms = []
+        for j in range(k):
+            b = assemble(sources[j]*v*dx)
+            B.set(b, j)
+            solve(A, x, b, "lu")
+            norms.append(x.norm("l2"))
+
+        # Solve for all right-hand sides with one factorization
+        X = MultiVector()
+        solve(A, X, B, "lu")
+        self.assertEqual(X.num_vectors(), k)
+        x = assemble(sources[0]*v*dx)
+        for j in range(k):
+            X.get(x, j)
+            self.assertAlmostEqual(x.norm("l2"), norms[j], 10)
+
 if __name__ == "__main__":
 
     # Turn off DOLFIN output
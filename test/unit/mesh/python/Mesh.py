@@ -24,7 +24,7 @@
 # Modified by Oeyvind Evju 2013
 #
 # First added:  2006-08-08
-# Last changed: 2013-10-11
+# Last changed: 2013-12-11
 
 import unittest
 import numpy
@@ -85,6 +85,35 @@ class MeshRefinement(unittest.TestCase):
         self.assertEqual(mesh.size_global(0), 3135)
         self.assertEqual(mesh.size_global(3), 15120)
 
+    def testRefineThreaded(self):
+        """Refine mesh uniformly using multiple threads."""
+        if MPI.num_processes() > 1:
+            return
+        for mesh in [UnitIntervalMesh(10), UnitSquareMesh(5, 7),
+                     UnitCubeMesh(3, 4, 5)]:
+            num_threads = parameters["num_threads"]
+            try:
+                parameters["num_threads"] = 1
+                mesh1 = refine(mesh)
+                parameters["num_threads"] = 3
+                mesh3 = refine(mesh)
+            finally:
+                parameters["num_threads"] = num_threads
+
+            # Same mesh independent of number of threads
+            self.assertTrue((mesh1.coordinates() == mesh3.coordinates()).all())
+            self.assertTrue((mesh1.cells() == mesh3.cells()).all())
+
+            # Parent cells are stored and may be used to adapt mesh
+            # functions
+            f = CellFunction("size_t", mesh)
+            for cell in cells(mesh):
+                f[cell] = cell.index()
+            g = adapt(f, mesh3)
+            for cell in cells(mesh3):
+                parent = Cell(mesh, g[cell])
+                self.assertTrue(parent.contains(cell.midpoint()))
+
 class BoundaryExtraction(unittest.TestCase):
 
     def testBoundaryComputation(self):
@@ -307,6 +336,176 @@ class MeshOrientations(unittest.TestCase):
             mesh.init_cell_orientations(Expression(("x[0]", "x[1]", "x[2]")))
             print mesh.cell_orientations()
 
+class MeshEntityComputation(unittest.TestCase):
+
+    def test_compute_entities(self):
+        """Compute edges and facets of mesh of unit cube."""
+        mesh = UnitCubeMesh(3, 4, 5)
+        mesh.init(1)
+        mesh.init(2)
+
+        # Euler characteristic of ball
+        self.assertEqual(mesh.num_vertices() - mesh.num_edges()
+                         + mesh.num_faces() - mesh.num_cells(), 1)
+
+        for dim in [1, 2]:
+            # Entities are numbered in order of first occurence, and
+            # their vertices belong to the cell
+            num_entities = 0
+            for cell in cells(mesh):
+                cell_vertices = set(cell.entities(0))
+                for e in cell.entities(dim):
+                    if e == num_entities:
+                        num_entities += 1
+                    self.assertTrue(e < num_entities)
+                    entity = MeshEntity(mesh, dim, e)
+                    vertices = entity.entities(0)
+                    self.assertEqual(len(vertices), dim + 1)
+                    self.assertTrue(set(vertices).issubset(cell_vertices))
+            self.assertEqual(num_entities, mesh.size(dim))
+
+    def test_compute_connectivity(self):
+        """Compute connectivity from transpose and intersection."""
+        def connectivity(num_threads):
+            old_num_threads = parameters["num_threads"]
+            parameters["num_threads"] = num_threads
+            try:
+                mesh = UnitCubeMesh(3, 4, 5)
+                mesh.init(2, 3)
+                mesh.init(0, 3)
+                mesh.init(3, 3)
+                mesh.init(2, 1)
+            finally:
+                parameters["num_threads"] = old_num_threads
+            return mesh, [[list(e.entities(d)) for e in entities(mesh, d0)]
+                          for (d0, d) in [(2, 3), (0, 3), (3, 3), (2, 1)]]
+
+        mesh, c = connectivity(0)
+
+        # Transpose: cells of each facet (vertex) in increasing order,
+        # each containing the facet (vertex)
+        for (d0, connections) in [(2, c[0]), (0, c[1])]:
+            self.assertEqual(sum(len(cells) for cells in connections),
+                             4*mesh.num_cells())
+            for (e0, cells) in enumerate(connections):
+                self.assertEqual(cells, sorted(cells))
+                for cell in cells:
+                    self.assertTrue(e0 in Cell(mesh, cell).entities(d0))
+
+        # Intersection: neighbours are distinct and not the cell itself,
+        # and edges of facets are contained in facets
+        for (cell, neighbours) in enumerate(c[2]):
+            self.assertEqual(len(set(neighbours)), len(neighbours))
+            self.assertFalse(cell in neighbours)
+        for (facet, edges) in enumerate(c[3]):
+            self.assertEqual(len(edges), 3)
+            vertices = set(Face(mesh, facet).entities(0))
+            for edge in edges:
+                self.assertTrue(set(Edge(mesh, edge).entities(0)).issubset(vertices))
+
+        # Same result with several threads
+        self.assertEqual(connectivity(3)[1], c)
+
+class MeshMemoryUsage(unittest.TestCase):
+
+    def test_memory_usage(self):
+        """Report memory usage of mesh data structures."""
+        mesh = UnitCubeMesh(4, 4, 4)
+        m0 = mesh.memory_usage()
+        self.assertTrue(m0 > 4*mesh.num_cells()*4 + 3*mesh.num_vertices()*8)
+
+        # Edges are stored with two 32-bit vertex indices each
+        mesh.init(1)
+        m1 = mesh.memory_usage()
+        self.assertTrue(m1 - m0 >= 2*mesh.num_edges()*4)
+        self.assertTrue("connectivity 1 - 0" in mesh.str(True))
+
+class MeshRenumber(unittest.TestCase):
+
+    def test_renumber(self):
+        """Renumber mesh along space-filling curves and by RCM."""
+        def midpoints(mesh, dim):
+            return [tuple(e.midpoint()[i] for i in range(3))
+                    for e in entities(mesh, dim)]
+
+        def cell_vertices(mesh):
+            x = mesh.coordinates()
+            return [[tuple(x[v]) for v in c.entities(0)] for c in cells(mesh)]
+
+        def orientation(X):
+            X = numpy.array(X)
+            return numpy.sign(numpy.linalg.det(X[1:] - X[0]))
+
+        def parity(p):
+            return (-1)**sum(1 for i in range(len(p))
+                             for j in range(i + 1, len(p)) if p[i] > p[j])
+
+        for method in ["hilbert", "morton", "rcm"]:
+            mesh = UnitCubeMesh(4, 4, 4)
+            mesh.init(2)
+            D = mesh.topology().dim()
+            x = [midpoints(mesh, dim) for dim in range(D + 1)]
+            X = cell_vertices(mesh)
+
+            # Mark cells and facets by their old indices
+            f = CellFunction("size_t", mesh)
+            for c in range(mesh.num_cells()):
+                f[c] = c
+            for facet in facets(mesh):
+                if facet.exterior():
+                    mesh.domains().set_marker((facet.index(),
+                                               facet.index() + 1), D - 1)
+            markers = dict(mesh.domains().markers(D - 1).iteritems())
+
+            new_indices = MeshRenumbering.renumber(mesh, method)
+            MeshRenumbering.renumber(f, new_indices)
+
+            # Old entity i is new entity new_indices[dim][i]
+            self.assertEqual(len(new_indices), D + 1)
+            y = [midpoints(mesh, dim) for dim in range(D + 1)]
+            for dim in (0, D - 1, D):
+                self.assertEqual(sorted(new_indices[dim]),
+                                 range(len(x[dim])))
+                for i, j in enumerate(new_indices[dim]):
+                    for k in range(3):
+                        self.assertAlmostEqual(x[dim][i][k], y[dim][j][k])
+
+            # Mesh functions and mesh domains follow the numbering
+            for c in range(mesh.num_cells()):
+                self.assertEqual(f[int(new_indices[D][c])], c)
+            self.assertEqual(dict(mesh.domains().markers(D - 1).iteritems()),
+                             dict((int(new_indices[D - 1][i]), m)
+                                  for i, m in markers.iteritems()))
+
+            # Cells have the same vertex coordinates, and orientations
+            # only change by the permutation of the cell vertices
+            Y = cell_vertices(mesh)
+            self.assertEqual(set(tuple(sorted(v)) for v in X),
+                             set(tuple(sorted(v)) for v in Y))
+            for i, j in enumerate(new_indices[D]):
+                self.assertEqual(sorted(X[i]), sorted(Y[j]))
+                p = [X[i].index(y) for y in Y[j]]
+                self.assertEqual(orientation(Y[j]),
+                                 parity(p)*orientation(X[i]))
+
+            # Mesh remains ordered
+            self.assertTrue(mesh.ordered())
+
+    def test_renumber_cell_orientations(self):
+        """Renumber mesh and check that cell orientations are kept."""
+        if MPI.num_processes() == 1:
+            normal = Expression(("x[0] - 0.5", "x[1] - 0.5", "x[2] - 0.5"))
+            for method in ["hilbert", "rcm"]:
+                mesh = BoundaryMesh(UnitCubeMesh(2, 2, 2), "exterior")
+                mesh.init_cell_orientations(normal)
+                MeshRenumbering.renumber(mesh, method)
+                orientations = mesh.cell_orientations().copy()
+
+                # Orientations must agree with recomputed orientations
+                mesh.init_cell_orientations(normal)
+                self.assertEqual(list(orientations),
+                                 list(mesh.cell_orientations()))
+
 class MeshSharedEntities(unittest.TestCase):
     def test_shared_entities(self):
         for ind, MeshClass in enumerate([UnitIntervalMesh, UnitSquareMesh, UnitCubeMesh]):
@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2013-08-10
-# Last changed:
+# Last changed: 2013-12-11
 
 import unittest
 from dolfin import *
@@ -37,5 +37,46 @@ class MeshColoring(unittest.TestCase):
             mesh.color("edge")
             mesh.color("facet")
 
+    def test_balanced_threaded_coloring(self):
+        """Color mesh cells with Jones-Plassmann and balancing."""
+
+        library = parameters["graph_coloring_library"]
+        num_threads = parameters["num_threads"]
+        try:
+            parameters["graph_coloring_library"] = "JonesPlassmann"
+
+            # Coloring does not depend on number of threads
+            colors = []
+            for n in [1, 3]:
+                parameters["num_threads"] = n
+                mesh = UnitCubeMesh(8, 8, 8)
+                colors.append(list(mesh.color("vertex")))
+            self.assertEqual(colors[0], colors[1])
+
+            # Balanced coloring is valid, with the same number of colors
+            # and classes of more even size
+            parameters["balance_graph_coloring"] = True
+            mesh = UnitCubeMesh(8, 8, 8)
+            balanced_colors = mesh.color("vertex")
+            num_colors = max(colors[0]) + 1
+            self.assertEqual(max(balanced_colors) + 1, num_colors)
+            mesh.init(0, mesh.topology().dim())
+            for v in vertices(mesh):
+                cell_colors = [balanced_colors[c]
+                               for c in v.entities(mesh.topology().dim())]
+                self.assertEqual(len(cell_colors), len(set(cell_colors)))
+            sizes = [0]*num_colors
+            balanced_sizes = [0]*num_colors
+            for c in colors[0]:
+                sizes[c] += 1
+            for c in balanced_colors:
+                balanced_sizes[c] += 1
+            self.assertTrue(max(balanced_sizes) - min(balanced_sizes) <=
+                            max(sizes) - min(sizes))
+        finally:
+            parameters["balance_graph_coloring"] = False
+            parameters["graph_coloring_library"] = library
+            parameters["num_threads"] = num_threads
+
 if __name__ == "__main__":
     unittest.main()
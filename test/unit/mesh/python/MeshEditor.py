@@ -18,7 +18,7 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2006-08-08
-# Last changed: 2011-08-22
+# Last changed: 2013-12-11
 
 import unittest
 import numpy
@@ -46,5 +46,25 @@ class MeshEditorTest(unittest.TestCase):
         # Close editor
         editor.close()
 
+    def test_bulk_mesh(self):
+        "Meshes built with the bulk editor API and threaded ordering"
+
+        # BoxMesh passes prebuilt arrays to the editor
+        mesh = UnitCubeMesh(3, 3, 3)
+        self.assertEqual(mesh.num_vertices(), 64)
+        self.assertEqual(mesh.num_cells(), 6*27)
+        self.assertTrue(mesh.ordered())
+        self.assertAlmostEqual(sum(c.volume() for c in cells(mesh)), 1.0)
+
+        # Ordering with several threads gives the same mesh
+        num_threads = parameters["num_threads"]
+        parameters["num_threads"] = 3
+        mesh_threaded = UnitCubeMesh(3, 3, 3)
+        parameters["num_threads"] = num_threads
+        self.assertTrue(mesh_threaded.ordered())
+        self.assertTrue(numpy.all(mesh.cells() == mesh_threaded.cells()))
+        self.assertTrue(numpy.all(mesh.coordinates() ==
+                                  mesh_threaded.coordinates()))
+
 if __name__ == "__main__":
     unittest.main()
@@ -35,7 +35,7 @@ tests = {
     "book":           ["chapter_1", "chapter_10"],
     "fem":            ["solving", "Assembler", "DirichletBC", "DofMap", \
                        "FiniteElement", "Form", "SystemAssembler",
-                       "LocalSolver", "manifolds"],
+                       "LocalSolver", "MatrixFreeOperator", "manifolds"],
     "function":       ["Constant", "ConstrainedFunctionSpace", \
                        "Expression", "Function", "FunctionAssigner", \
                        "FunctionSpace", "SpecialFunctions", \